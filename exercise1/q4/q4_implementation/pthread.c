@@ -38,6 +38,8 @@
 #include <sys/sysinfo.h>
 #include <errno.h>
 
+#include "rtinit.h"
+
 #define USEC_PER_MSEC (1000)
 #define NANOSEC_PER_SEC (1000000000)
 #define NUM_CPU_CORES (1)
@@ -90,11 +92,9 @@ void print_scheduler(void);
 
 void main(void)
 {
-    /* Lock memory */
-    if(mlockall(MCL_CURRENT|MCL_FUTURE) == -1) {
-        printf("mlockall failed: %m\n");
+    /* Lock memory, prefault the heap and stack */
+    if(rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES) != 0)
         exit(-2);
-    }
 
     struct timeval current_time_val;
     int i, rc, scope;
@@ -108,6 +108,9 @@ void main(void)
     pthread_attr_t main_attr;
     pid_t mainpid;
     cpu_set_t allcpuset;
+    rt_faults_t initFaults;
+
+    rt_faults(&initFaults);
 
     printf("Starting LCM Invariant Scheduler for Linux\n");
 
@@ -183,6 +186,7 @@ void main(void)
         rc=pthread_attr_setinheritsched(&rt_sched_attr[i], PTHREAD_EXPLICIT_SCHED);
         rc=pthread_attr_setschedpolicy(&rt_sched_attr[i], SCHED_FIFO);
         rc=pthread_attr_setaffinity_np(&rt_sched_attr[i], sizeof(cpu_set_t), &threadcpu);
+        rt_stack_attr(&rt_sched_attr[i]);
 
         rt_param[i].sched_priority=rt_max_prio-i;
         pthread_attr_setschedparam(&rt_sched_attr[i], &rt_param[i]);
@@ -254,6 +258,7 @@ void main(void)
     for(i=0;i<NUM_THREADS;i++)
         pthread_join(threads[i], NULL);
 
+    rt_print_faults("after RT init", &initFaults);
    printf("\nTEST COMPLETE\n");
 }
 
@@ -269,6 +274,8 @@ void *Scheduler(void *threadp)
     unsigned long long seqCnt=0;
     threadParams_t *threadParams = (threadParams_t *)threadp;
 
+    rt_prefault_stack();
+
     // Display elapsed time
     gettimeofday(&current_time_val, (struct timezone *)0);
     CRIT_LOG("Scheduler thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
@@ -382,6 +389,8 @@ void *Fib10(void *threadp)
     unsigned long long S1Cnt=0;
     threadParams_t *threadParams = (threadParams_t *)threadp;
 
+    rt_prefault_stack();
+
     // FIB PARAMS
     unsigned int idx = 0, jdx = 1;
     unsigned int seqCnt = 40;
@@ -424,6 +433,8 @@ void *Fib20(void *threadp)
     unsigned long long S2Cnt=0;
     threadParams_t *threadParams = (threadParams_t *)threadp;
 
+    rt_prefault_stack();
+
     // FIB PARAMS
     unsigned int idx = 0, jdx = 1;
     unsigned int seqCnt = 47;
@@ -8,6 +8,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "rtinit.h"
+
 #define NUM_THREADS (4)
 #define NUM_CPUS (4)
 
@@ -140,6 +142,7 @@ void *counterThread(void *threadp)
     thread=pthread_self();
     CPU_ZERO(&cpuset);
 
+    rt_prefault_stack();
 
     clock_gettime(CLOCK_REALTIME, &start_time);
     // COMPUTE SECTION
@@ -213,6 +216,11 @@ void print_scheduler(void)
 int main (int argc, char *argv[])
 {
    int rc, idx;
+   rt_faults_t initFaults;
+
+   // lock memory and prefault the heap and stack before any thread runs
+   rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
+   rt_faults(&initFaults);
 
    // get count of system resources.
    printf("This system has %d processors with %d available\n", get_nprocs_conf(), get_nprocs());
@@ -244,6 +252,7 @@ int main (int argc, char *argv[])
        rc=pthread_attr_init(&rt_sched_attr[idx]);
        rc=pthread_attr_setinheritsched(&rt_sched_attr[idx], PTHREAD_EXPLICIT_SCHED);
        rc=pthread_attr_setschedpolicy(&rt_sched_attr[idx], SCHED_FIFO);
+       rt_stack_attr(&rt_sched_attr[idx]);
 
        // config priority to one less than the max allowed for fifo scheduling. 
        rt_param[idx].sched_priority=rt_max_prio-idx-1;
@@ -264,5 +273,6 @@ int main (int argc, char *argv[])
    for(idx=0;idx<NUM_THREADS;idx++)
        pthread_join(threads[idx], NULL);
 
+   rt_print_faults("after RT init", &initFaults);
    printf("\nTEST COMPLETE\n");
 }
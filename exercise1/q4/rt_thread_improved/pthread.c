@@ -8,6 +8,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "rtinit.h"
+
 #define NUM_THREADS (4)
 #define NUM_CPUS (4)
 
@@ -142,6 +144,7 @@ void *workerThread(void *threadp)
     struct timespec thread_dt = {0, 0};
     threadParams_t *threadParams = (threadParams_t *)threadp;
 
+    rt_prefault_stack();
 
     clock_gettime(CLOCK_REALTIME, &start_time);
     // COMPUTE SECTION
@@ -208,6 +211,11 @@ int main (int argc, char *argv[])
    int i;
    cpu_set_t threadcpu;
    int coreid;
+   rt_faults_t initFaults;
+
+   // lock memory and prefault the heap and stack before any thread runs
+   rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
+   rt_faults(&initFaults);
 
    numberOfProcessors = get_nprocs_conf();
 
@@ -254,6 +262,7 @@ int main (int argc, char *argv[])
        rc=pthread_attr_setinheritsched(&rt_sched_attr[i], PTHREAD_EXPLICIT_SCHED);
        rc=pthread_attr_setschedpolicy(&rt_sched_attr[i], MY_SCHEDULER);
        rc=pthread_attr_setaffinity_np(&rt_sched_attr[i], sizeof(cpu_set_t), &threadcpu);
+       rt_stack_attr(&rt_sched_attr[i]);
 
        // set schedule priority 
        rt_param[i].sched_priority=rt_max_prio-i-1;
@@ -275,5 +284,6 @@ int main (int argc, char *argv[])
    for(i=0;i<NUM_THREADS;i++)
        pthread_join(threads[i], NULL);
 
+   rt_print_faults("after RT init", &initFaults);
    printf("\nTEST COMPLETE\n");
 }
@@ -99,90 +99,130 @@
 #include <pthread.h>
 #include <sched.h>
 #include <time.h>
-#include <semaphore.h>
 
 #include <syslog.h>
 #include <sys/time.h>
 #include <sys/sysinfo.h>
-#include <errno.h>
+
+#include "sequencer.h"
+#include "seqplace.h"
+#include "rtinit.h"
 
 #define USEC_PER_MSEC (1000)
-#define NANOSEC_PER_SEC (1000000000)
-#define NUM_CPU_CORES (1)
 #define TRUE (1)
 #define FALSE (0)
 
-#define NUM_THREADS (7+1)
+#define SEQ_RATE_HZ (30)
+// Event log records per thread, drained every 10 msec.
+#define EVLOG_RING_RECORDS (4096)
+#define EV_RELEASE (SEQ_EV_USER)
 
-int abortTest=FALSE;
-int abortS1=FALSE, abortS2=FALSE, abortS3=FALSE, abortS4=FALSE, abortS5=FALSE, abortS6=FALSE, abortS7=FALSE;
-sem_t semS1, semS2, semS3, semS4, semS5, semS6, semS7;
-struct timeval start_time_val;
+#define SEQ_PERIODS (900)
+
+// Used for prio below to run a service at RT_MIN rather than RT_MAX-prio.
+#define PRIO_RT_MIN (-1)
 
 typedef struct
 {
-    int threadIdx;
-    unsigned long long sequencePeriods;
-} threadParams_t;
+    const char *name;
+    unsigned int divisor;   // released every divisor sequencer loops
+    int prio;               // RT_MAX-prio, or PRIO_RT_MIN
+    unsigned int runtime;   // usec per release under SCHED_DEADLINE ("-d")
+} service_config_t;
+
+// One row per service; rates, priorities and budgets are changed here only.
+static const service_config_t serviceConfig[] =
+{
+    {"Frame Sampler",                        10, 1, 100},       // Service_1 @ 3 Hz
+    {"Time-stamp with Image Analysis",       30, 2, 100},       // Service_2 @ 1 Hz
+    {"Difference Image Proc",                60, 3, 100},       // Service_3 @ 0.5 Hz
+    {"Time-stamp Image Save to File",        30, 3, 100},       // Service_4 @ 1 Hz
+    {"Processed Image Save to File",         60, 3, 100},       // Service_5 @ 0.5 Hz
+    {"Send Time-stamped Image to Remote",    30, 2, 100},       // Service_6 @ 1 Hz
+    {"10 sec Tick Debug",                   300, PRIO_RT_MIN, 100} // Service_7 @ 0.1 Hz
+};
 
+#define NUM_SERVICES (sizeof(serviceConfig) / sizeof(serviceConfig[0]))
 
-void *Sequencer(void *threadp);
+struct timeval start_time_val;
 
-void *Service_1(void *threadp);
-void *Service_2(void *threadp);
-void *Service_3(void *threadp);
-void *Service_4(void *threadp);
-void *Service_5(void *threadp);
-void *Service_6(void *threadp);
-void *Service_7(void *threadp);
+void log_release(seq_service_t *service, unsigned long long release);
 double getTimeMsec(void);
 void print_scheduler(void);
 
 
-void main(void)
+void main(int argc, char *argv[])
 {
     struct timeval current_time_val;
-    int i, rc, scope;
-    cpu_set_t threadcpu;
-    pthread_t threads[NUM_THREADS];
-    threadParams_t threadParams[NUM_THREADS];
-    pthread_attr_t rt_sched_attr[NUM_THREADS];
+    int rc, scope;
+    unsigned int i;
+    int option = 0, deadline = FALSE, steerIrqs = FALSE;
+    const char *logPath = NULL, *wcetPath = NULL, *placement = NULL;
     int rt_max_prio, rt_min_prio;
-    struct sched_param rt_param[NUM_THREADS];
     struct sched_param main_param;
     pthread_attr_t main_attr;
     pid_t mainpid;
-    cpu_set_t allcpuset;
+    seq_cpus_t cpus;
+    rt_faults_t startFaults, steadyFaults;
+    sequencer_t seq;
+    evlog_t eventLog;
+
+    // "-r" or "-t" picks the sequencer backend, "-d" runs the services under
+    // SCHED_DEADLINE, "-l <file>" logs in binary, "-w <file>" writes the
+    // observed WCETs for the feasibility tests, "-c auto|<core map>" places
+    // the threads on CPUs (see seqplace.h) and "-i" moves the interrupts it
+    // can off the real-time CPUs
+    for(i=1; i < (unsigned int)argc; i++)
+    {
+        if((argv[i][0] == '-') && (argv[i][1] == 'l') && (i+1 < (unsigned int)argc))
+            logPath = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'w') && (i+1 < (unsigned int)argc))
+            wcetPath = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'c') && (i+1 < (unsigned int)argc))
+            placement = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'd'))
+            deadline = TRUE;
+        else if((argv[i][0] == '-') && (argv[i][1] == 'i'))
+            steerIrqs = TRUE;
+        else if(argv[i][0] == '-')
+            option = argv[i][1];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Lock memory and prefault the heap and main stack, so no page fault
+    // lands in a release; the service threads prefault their own stacks
+    ////////////////////////////////////////////////////////////////////////////
+    rt_faults(&startFaults);
+    rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Init time variables
+    ////////////////////////////////////////////////////////////////////////////
     printf("Starting Sequencer Demo\n");
     gettimeofday(&start_time_val, (struct timezone *)0);
     gettimeofday(&current_time_val, (struct timezone *)0);
     syslog(LOG_CRIT, "Sequencer @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
 
-   printf("System has %d processors configured and %d available.\n", get_nprocs_conf(), get_nprocs());
-
-   CPU_ZERO(&allcpuset);
-
-   for(i=0; i < NUM_CPU_CORES; i++)
-       CPU_SET(i, &allcpuset);
+    printf("System has %d processors configured and %d available.\n", get_nprocs_conf(), get_nprocs());
 
-   printf("Using CPUS=%d from total available.\n", CPU_COUNT(&allcpuset));
-
-
-    // initialize the sequencer semaphores
-    //
-    if (sem_init (&semS1, 0, 0)) { printf ("Failed to initialize S1 semaphore\n"); exit (-1); }
-    if (sem_init (&semS2, 0, 0)) { printf ("Failed to initialize S2 semaphore\n"); exit (-1); }
-    if (sem_init (&semS3, 0, 0)) { printf ("Failed to initialize S3 semaphore\n"); exit (-1); }
-    if (sem_init (&semS4, 0, 0)) { printf ("Failed to initialize S4 semaphore\n"); exit (-1); }
-    if (sem_init (&semS5, 0, 0)) { printf ("Failed to initialize S5 semaphore\n"); exit (-1); }
-    if (sem_init (&semS6, 0, 0)) { printf ("Failed to initialize S6 semaphore\n"); exit (-1); }
-    if (sem_init (&semS7, 0, 0)) { printf ("Failed to initialize S7 semaphore\n"); exit (-1); }
+    ////////////////////////////////////////////////////////////////////////////
+    // CONFIG CPUs
+    //      * Online and isolated (isolcpus=) CPUs from sysfs; real-time
+    //      * threads go on the isolated ones if there are any
+    ////////////////////////////////////////////////////////////////////////////
+    if(seq_read_cpus(&cpus) != 0)
+        exit(-1);
+    printf("Using CPUS=%d from total available.\n", CPU_COUNT(&cpus.rt));
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Set scheduler=SCHED_FIFO and max priority for main thread
+    ////////////////////////////////////////////////////////////////////////////
     mainpid=getpid();
 
     rt_max_prio = sched_get_priority_max(SCHED_FIFO);
     rt_min_prio = sched_get_priority_min(SCHED_FIFO);
+    printf("rt_max_prio=%d\n", rt_max_prio);
+    printf("rt_min_prio=%d\n", rt_min_prio);
 
     rc=sched_getparam(mainpid, &main_param);
     main_param.sched_priority=rt_max_prio;
@@ -190,7 +230,10 @@ void main(void)
     if(rc < 0) perror("main_param");
     print_scheduler();
 
-
+    ////////////////////////////////////////////////////////////////////////////
+    // Get pthread attribute scope
+    ////////////////////////////////////////////////////////////////////////////
+    pthread_attr_init(&main_attr);
     pthread_attr_getscope(&main_attr, &scope);
 
     if(scope == PTHREAD_SCOPE_SYSTEM)
@@ -200,395 +243,97 @@ void main(void)
     else
       printf("PTHREAD SCOPE UNKNOWN\n");
 
-    printf("rt_max_prio=%d\n", rt_max_prio);
-    printf("rt_min_prio=%d\n", rt_min_prio);
-
-    for(i=0; i < NUM_THREADS; i++)
+    ////////////////////////////////////////////////////////////////////////////
+    // Register services
+    //      * Sequencer = RT_MAX @ SEQ_RATE_HZ
+    //      * One service per serviceConfig row, SCHED_FIFO at its priority
+    //      * No affinity unless "-c": Linux load balances the threads over
+    //      * the cores
+    ////////////////////////////////////////////////////////////////////////////
+    if(seq_init(&seq, SEQ_RATE_HZ, SEQ_PERIODS) != 0)
+        exit(-1);
+
+    // By default each release is an absolute time from the sequencer's
+    // start, so wakeup overhead cannot accumulate.  "-r" runs the original
+    // relative nanosleep() loop instead, for comparison, and "-t" reads a
+    // periodic timerfd, releasing any ticks it missed in one batch.
+    if(option == 'r') seq.backend = SEQ_RELATIVE;
+    else if(option == 't') seq.backend = SEQ_TIMERFD;
+
+    for(i=0; i < NUM_SERVICES; i++)
     {
-
-      CPU_ZERO(&threadcpu);
-      CPU_SET(3, &threadcpu);
-
-      rc=pthread_attr_init(&rt_sched_attr[i]);
-      rc=pthread_attr_setinheritsched(&rt_sched_attr[i], PTHREAD_EXPLICIT_SCHED);
-      rc=pthread_attr_setschedpolicy(&rt_sched_attr[i], SCHED_FIFO);
-      //rc=pthread_attr_setaffinity_np(&rt_sched_attr[i], sizeof(cpu_set_t), &threadcpu);
-
-      rt_param[i].sched_priority=rt_max_prio-i;
-      pthread_attr_setschedparam(&rt_sched_attr[i], &rt_param[i]);
-
-      threadParams[i].threadIdx=i;
+        if(seq_add_service(&seq, serviceConfig[i].name, serviceConfig[i].divisor,
+                           (serviceConfig[i].prio == PRIO_RT_MIN) ? rt_min_prio : rt_max_prio-serviceConfig[i].prio,
+                           SEQ_NO_AFFINITY, log_release, NULL) < 0)
+            exit(-1);
+        if(seq_set_budget(&seq, (int)i, (unsigned long long)serviceConfig[i].runtime * 1000, 0) != 0)
+            exit(-1);
     }
-   
-    printf("Service threads will run on %d CPU cores\n", CPU_COUNT(&threadcpu));
-
-    // Create Service threads which will block awaiting release for:
-    //
-
-    // Servcie_1 = RT_MAX-1	@ 3 Hz
-    //
-    rt_param[1].sched_priority=rt_max_prio-1;
-    pthread_attr_setschedparam(&rt_sched_attr[1], &rt_param[1]);
-    rc=pthread_create(&threads[1],               // pointer to thread descriptor
-                      &rt_sched_attr[1],         // use specific attributes
-                      //(void *)0,               // default attributes
-                      Service_1,                 // thread function entry point
-                      (void *)&(threadParams[1]) // parameters to pass in
-                     );
-    if(rc < 0)
-        perror("pthread_create for service 1");
-    else
-        printf("pthread_create successful for service 1\n");
-
-
-    // Service_2 = RT_MAX-2	@ 1 Hz
-    //
-    rt_param[2].sched_priority=rt_max_prio-2;
-    pthread_attr_setschedparam(&rt_sched_attr[2], &rt_param[2]);
-    rc=pthread_create(&threads[2], &rt_sched_attr[2], Service_2, (void *)&(threadParams[2]));
-    if(rc < 0)
-        perror("pthread_create for service 2");
-    else
-        printf("pthread_create successful for service 2\n");
-
-
-    // Service_3 = RT_MAX-3	@ 0.5 Hz
-    //
-    rt_param[3].sched_priority=rt_max_prio-3;
-    pthread_attr_setschedparam(&rt_sched_attr[3], &rt_param[3]);
-    rc=pthread_create(&threads[3], &rt_sched_attr[3], Service_3, (void *)&(threadParams[3]));
-    if(rc < 0)
-        perror("pthread_create for service 3");
-    else
-        printf("pthread_create successful for service 3\n");
-
-
-    // Service_4 = RT_MAX-2	@ 1 Hz
-    //
-    rt_param[4].sched_priority=rt_max_prio-3;
-    pthread_attr_setschedparam(&rt_sched_attr[4], &rt_param[4]);
-    rc=pthread_create(&threads[4], &rt_sched_attr[4], Service_4, (void *)&(threadParams[4]));
-    if(rc < 0)
-        perror("pthread_create for service 4");
-    else
-        printf("pthread_create successful for service 4\n");
-
-
-    // Service_5 = RT_MAX-3	@ 0.5 Hz
-    //
-    rt_param[5].sched_priority=rt_max_prio-3;
-    pthread_attr_setschedparam(&rt_sched_attr[5], &rt_param[5]);
-    rc=pthread_create(&threads[5], &rt_sched_attr[5], Service_5, (void *)&(threadParams[5]));
-    if(rc < 0)
-        perror("pthread_create for service 5");
-    else
-        printf("pthread_create successful for service 5\n");
-
-
-    // Service_6 = RT_MAX-2	@ 1 Hz
-    //
-    rt_param[6].sched_priority=rt_max_prio-2;
-    pthread_attr_setschedparam(&rt_sched_attr[6], &rt_param[6]);
-    rc=pthread_create(&threads[6], &rt_sched_attr[6], Service_6, (void *)&(threadParams[6]));
-    if(rc < 0)
-        perror("pthread_create for service 6");
-    else
-        printf("pthread_create successful for service 6\n");
 
+    // "-d" gives each service its runtime per period under SCHED_DEADLINE in
+    // place of its priority, so a service that overruns its budget is
+    // throttled rather than starving the ones below it
+    if(deadline)
+        seq.policy = SEQ_SCHED_DEADLINE;
 
-    // Service_7 = RT_MIN	0.1 Hz
-    //
-    rt_param[7].sched_priority=rt_min_prio;
-    pthread_attr_setschedparam(&rt_sched_attr[7], &rt_param[7]);
-    rc=pthread_create(&threads[7], &rt_sched_attr[7], Service_7, (void *)&(threadParams[7]));
-    if(rc < 0)
-        perror("pthread_create for service 7");
-    else
-        printf("pthread_create successful for service 7\n");
-
-
-    // Wait for service threads to initialize and await relese by sequencer.
-    //
-    // Note that the sleep is not necessary of RT service threads are created wtih 
-    // correct POSIX SCHED_FIFO priorities compared to non-RT priority of this main
-    // program.
-    //
-    // usleep(1000000);
- 
-    // Create Sequencer thread, which like a cyclic executive, is highest prio
-    printf("Start sequencer\n");
-    threadParams[0].sequencePeriods=900;
-
-    // Sequencer = RT_MAX	@ 30 Hz
-    //
-    rt_param[0].sched_priority=rt_max_prio;
-    pthread_attr_setschedparam(&rt_sched_attr[0], &rt_param[0]);
-    rc=pthread_create(&threads[0], &rt_sched_attr[0], Sequencer, (void *)&(threadParams[0]));
-    if(rc < 0)
-        perror("pthread_create for sequencer service 0");
-    else
-        printf("pthread_create successful for sequeencer service 0\n");
-
-
-   for(i=0;i<NUM_THREADS;i++)
-       pthread_join(threads[i], NULL);
-
-   printf("\nTEST COMPLETE\n");
-}
-
-
-void *Sequencer(void *threadp)
-{
-    struct timeval current_time_val;
-    struct timespec delay_time = {0,33333333}; // delay for 33.33 msec, 30 Hz
-    struct timespec remaining_time;
-    double current_time;
-    double residual;
-    int rc, delay_cnt=0;
-    unsigned long long seqCnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Sequencer thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Sequencer thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    do
+    if(placement != NULL)
     {
-        delay_cnt=0; residual=0.0;
-
-        //gettimeofday(&current_time_val, (struct timezone *)0);
-        //syslog(LOG_CRIT, "Sequencer thread prior to delay @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-        do
-        {
-            rc=nanosleep(&delay_time, &remaining_time);
-
-            if(rc == EINTR)
-            { 
-                residual = remaining_time.tv_sec + ((double)remaining_time.tv_nsec / (double)NANOSEC_PER_SEC);
-
-                if(residual > 0.0) printf("residual=%lf, sec=%d, nsec=%d\n", residual, (int)remaining_time.tv_sec, (int)remaining_time.tv_nsec);
- 
-                delay_cnt++;
-            }
-            else if(rc < 0)
-            {
-                perror("Sequencer nanosleep");
-                exit(-1);
-            }
-           
-        } while((residual > 0.0) && (delay_cnt < 100));
-
-        seqCnt++;
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Sequencer cycle %llu @ sec=%d, msec=%d\n", seqCnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-
-        if(delay_cnt > 1) printf("Sequencer looping delay %d\n", delay_cnt);
-
-
-        // Release each service at a sub-rate of the generic sequencer rate
-
-        // Servcie_1 = RT_MAX-1	@ 3 Hz
-        if((seqCnt % 10) == 0) sem_post(&semS1);
-
-        // Service_2 = RT_MAX-2	@ 1 Hz
-        if((seqCnt % 30) == 0) sem_post(&semS2);
-
-        // Service_3 = RT_MAX-3	@ 0.5 Hz
-        if((seqCnt % 60) == 0) sem_post(&semS3);
-
-        // Service_4 = RT_MAX-2	@ 1 Hz
-        if((seqCnt % 30) == 0) sem_post(&semS4);
-
-        // Service_5 = RT_MAX-3	@ 0.5 Hz
-        if((seqCnt % 60) == 0) sem_post(&semS5);
-
-        // Service_6 = RT_MAX-2	@ 1 Hz
-        if((seqCnt % 30) == 0) sem_post(&semS6);
-
-        // Service_7 = RT_MIN	0.1 Hz
-        if((seqCnt % 300) == 0) sem_post(&semS7);
-
-        //gettimeofday(&current_time_val, (struct timezone *)0);
-        //syslog(LOG_CRIT, "Sequencer release all sub-services @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    } while(!abortTest && (seqCnt < threadParams->sequencePeriods));
-
-    sem_post(&semS1); sem_post(&semS2); sem_post(&semS3);
-    sem_post(&semS4); sem_post(&semS5); sem_post(&semS6);
-    sem_post(&semS7);
-    abortS1=TRUE; abortS2=TRUE; abortS3=TRUE;
-    abortS4=TRUE; abortS5=TRUE; abortS6=TRUE;
-    abortS7=TRUE;
-
-    pthread_exit((void *)0);
-}
-
-
-
-void *Service_1(void *threadp)
-{
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S1Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Frame Sampler thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Frame Sampler thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS1)
-    {
-        sem_wait(&semS1);
-        S1Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Frame Sampler release %llu @ sec=%d, msec=%d\n", S1Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    }
-
-    pthread_exit((void *)0);
-}
-
-
-void *Service_2(void *threadp)
-{
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S2Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Time-stamp with Image Analysis thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Time-stamp with Image Analysis thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS2)
-    {
-        sem_wait(&semS2);
-        S2Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Time-stamp with Image Analysis release %llu @ sec=%d, msec=%d\n", S2Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_3(void *threadp)
-{
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S3Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Difference Image Proc thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Difference Image Proc thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS3)
-    {
-        sem_wait(&semS3);
-        S3Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Difference Image Proc release %llu @ sec=%d, msec=%d\n", S3Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
+        if(seq_place(&seq, &cpus, placement) != 0)
+            exit(-1);
+        seq_print_placement(&seq, &cpus);
     }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_4(void *threadp)
-{
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S4Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Time-stamp Image Save to File thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Time-stamp Image Save to File thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS4)
-    {
-        sem_wait(&semS4);
-        S4Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Time-stamp Image Save to File release %llu @ sec=%d, msec=%d\n", S4Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_5(void *threadp)
-{
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S5Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Processed Image Save to File thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Processed Image Save to File thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS5)
-    {
-        sem_wait(&semS5);
-        S5Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Processed Image Save to File release %llu @ sec=%d, msec=%d\n", S5Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_6(void *threadp)
-{
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S6Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Send Time-stamped Image to Remote thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("Send Time-stamped Image to Remote thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS6)
-    {
-        sem_wait(&semS6);
-        S6Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Send Time-stamped Image to Remote release %llu @ sec=%d, msec=%d\n", S6Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    }
-
-    pthread_exit((void *)0);
+    if(steerIrqs)
+        seq_steer_irqs(&cpus);
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Event log instead of syslog() in the release path
+    //      * One ring per thread, so logging never takes a lock
+    //      * Drained at RT_MIN to syslog, or to the "-l" file for evlog_decode
+    ////////////////////////////////////////////////////////////////////////////
+    if(evlog_init(&eventLog, NUM_SERVICES+1, EVLOG_RING_RECORDS, logPath) != 0)
+        exit(-1);
+    evlog_define(&eventLog, EV_RELEASE, "release %llu");
+    seq.log = &eventLog;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Start the service threads, then the sequencer thread w/highest priority
+    ////////////////////////////////////////////////////////////////////////////
+    printf("Start sequencer\n");
+    if(seq_start(&seq) != 0)
+        exit(-1);
+
+    if(evlog_start(&eventLog, rt_min_prio) != 0)
+        exit(-1);
+    rt_faults(&steadyFaults);
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Wait for threads to complete
+    ////////////////////////////////////////////////////////////////////////////
+    seq_join(&seq);
+    rt_print_faults("since start", &startFaults);
+    rt_print_faults("once running", &steadyFaults);
+    evlog_stop(&eventLog);
+    seq_print_stats(&seq);
+    if(wcetPath != NULL)
+        seq_write_wcet(&seq, wcetPath);
+    seq_destroy(&seq);
+    evlog_destroy(&eventLog);
+
+    printf("\nTEST COMPLETE\n");
 }
 
-void *Service_7(void *threadp)
+////////////////////////////////////////////////////////////////////////////////
+// Service release callback, run by each service thread once per release
+//      * LOG RELEASE (the event log adds the thread and time)
+////////////////////////////////////////////////////////////////////////////////
+void log_release(seq_service_t *service, unsigned long long release)
 {
-    struct timeval current_time_val;
-    double current_time;
-    unsigned long long S7Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "10 sec Tick Debug thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    printf("10 sec Tick Debug thread @ sec=%d, msec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-
-    while(!abortS7)
-    {
-        sem_wait(&semS7);
-        S7Cnt++;
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "10 Sec Tick Debug release %llu @ sec=%d, msec=%d\n", S7Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec/USEC_PER_MSEC);
-    }
-
-    pthread_exit((void *)0);
+    evlog_write(service->ring, EV_RELEASE, release, 0, 0, 0);
 }
 
-
+////////////////////////////////////////////////////////////////////////////////
+// getTimeMsec never used
+////////////////////////////////////////////////////////////////////////////////
 double getTimeMsec(void)
 {
   struct timespec event_ts = {0, 0};
@@ -597,7 +342,9 @@ double getTimeMsec(void)
   return ((event_ts.tv_sec)*1000.0) + ((event_ts.tv_nsec)/1000000.0);
 }
 
-
+////////////////////////////////////////////////////////////////////////////////
+// print_scheduler is used
+////////////////////////////////////////////////////////////////////////////////
 void print_scheduler(void)
 {
    int schedType;
@@ -619,4 +366,3 @@ void print_scheduler(void)
            printf("Pthread Policy is UNKNOWN\n"); exit(-1);
    }
 }
-
@@ -0,0 +1,511 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Feasibility decision tests shared by feasibility_tests and feasibility_bench.
+// See the header of feasibility_tests.c for the references each test is based on.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "feasibility.h"
+#include "qpa.h"
+
+// tests only print their working when this is set
+int feasibility_verbose = TRUE;
+
+int rate_monotonic_least_upper_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+  double utility_sum=0.0, lub=0.0;
+  int idx;
+
+  // Sum the C(i) over the T(i)
+  for(idx=0; idx < numServices; idx++)
+  {
+    utility_sum += ((double)wcet[idx] / (double)period[idx]);
+    if(feasibility_verbose)
+      printf("for %d, wcet=%lf, period=%lf, utility_sum = %lf\n", idx, (double)wcet[idx], (double)period[idx], utility_sum);
+  }
+
+  // Compute LUB for number of services
+  lub = (double)numServices * (pow(2.0, (1.0/((double)numServices))) - 1.0);
+  
+  
+  // print stuff
+  if(feasibility_verbose)
+  {
+    printf("===LUB STATS===\n");
+    printf("For %d, Utility_sum = %lf\n", numServices, utility_sum);
+    printf("LUB = %lf\n", lub);
+  }
+
+  // Compare the utilty to the bound and return feasibility
+  if(utility_sum <= lub)
+	  return TRUE;
+  else
+	  return FALSE;
+}
+
+int completion_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+  int i, j;
+  uint64_t an, anext;
+  
+  // assume feasible until we find otherwise
+  int set_feasible=TRUE;
+   
+  //printf("numServices=%d\n", numServices);
+ 
+  // For all services in the analysis 
+  for (i=0; i < numServices; i++)
+  {
+       an=0; anext=0;
+       
+       for (j=0; j <= i; j++)
+       {
+           an=t64_add(an, wcet[j]);
+       }
+       
+	   //printf("i=%d, an=%d\n", i, an);
+
+       while(1)
+       {
+             anext=wcet[i];
+	     
+             for (j=0; j < i; j++)
+                 anext = t64_add(anext, t64_mul(t64_ceil_div(an, period[j]), wcet[j]));
+		 
+             if (anext == an)
+                break;
+             else
+                an=anext;
+
+             // past the deadline the iteration can only grow, and it never
+             // converges if the higher priority load is over 100%
+             if (an > deadline[i])
+                break;
+
+			 //printf("an=%d, anext=%d\n", an, anext);
+       }
+       
+	   //printf("an=%d, deadline[%d]=%d\n", an, i, deadline[i]);
+
+       if (an > deadline[i])
+       {
+          set_feasible=FALSE;
+       }
+  }
+  
+  return set_feasible;
+}
+
+int scheduling_point_feasibility(U32_T numServices, U32_T period[], 
+				 U32_T wcet[], U32_T deadline[])
+{
+   int rc = TRUE, i, j, k, status;
+   uint64_t l, temp;
+
+   // For all services in the analysis
+   for (i=0; i < numServices; i++) // iterate from highest to lowest priority
+   {
+      status=0;
+
+      // Look for all available CPU minus what has been used by higher priority services
+      for (k=0; k<=i; k++) 
+      {
+	  // find available CPU windows and take them
+          for (l=1; l <= (period[i] / period[k]); l++)
+          {
+               temp=0;
+
+               for (j=0; j<=i; j++) temp = t64_add(temp, t64_mul(wcet[j], t64_ceil_div(l*period[k], period[j])));
+
+	       // Can we get the CPU we need or not?
+               if (temp <= (l*period[k]))
+			   {
+				   // insufficient CPU during our period, therefore infeasible
+				   status=1;
+				   break;
+			   }
+           }
+           if (status) break;
+      }
+
+      if (!status) rc=FALSE;
+   }
+   return rc;
+}
+
+int earliest_deadline_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   // variable declerations
+   int ed_idx;
+   int64_t ed_val_min, ed_val_current;
+   uint64_t max_tick = hyperperiod(numServices, period);
+   uint64_t et_so_far[numServices];
+
+   // the schedule repeats every hyperperiod, so one of them decides the set.
+   // when that is too many ticks to step through use the exact demand bound
+   // test instead, with the same T=D service model as the simulation.
+   if((max_tick == 0) || (max_tick > FEASIBILITY_SIM_LIMIT))
+   {
+      return edf_qpa_feasibility(numServices, period, wcet, period);
+   }
+
+   // initialize "execution time so far" array to zero
+   for(int i = 0; i < numServices; i++)
+   {
+      et_so_far[i] = 0;
+   }
+
+   // loop for global tick simulation, up to and including the end of the
+   // first hyperperiod so that the last jobs' deadlines are checked
+   for(uint64_t current_tick = 0; current_tick <= max_tick; current_tick++)
+   {
+      ed_val_min = INT64_MAX;
+      ed_idx = -1;
+
+      //printf("@TICK=%d\n", current_tick);
+
+      // iterate through each service
+      for(int idx = 0; idx < numServices; idx++)
+      {
+         // a job that is still unfinished when its next period starts has
+         // missed its deadline. this is not caught below when two services
+         // tie on the last tick and only one of them gets to run.
+         if((current_tick != 0) && (current_tick % period[idx] == 0) && (wcet[idx] != et_so_far[idx]))
+         {
+            return FALSE;
+         }
+
+         // check if the current task has completed executing.
+         if (wcet[idx] == et_so_far[idx])
+         {
+            // if the current tick value is not evenly divisible by the current
+            // service's period then skip this task because it has already
+            // completed it's processing before it's deadline.  
+            if(current_tick % period[idx] != 0)
+            {
+               continue;
+            }
+            else
+            {
+               // otherwise, it is the start of a new period for this task, and
+               // it must start over. reset this tasks execution time counter.
+               et_so_far[idx] = 0;
+            }
+            
+         }
+
+         // calculate time until deadline
+         ed_val_current = (
+            (int64_t)(period[idx] - (current_tick % period[idx]))
+         );
+         
+         //printf("SERVICE_%d LAXITY=%d\n", idx+1, ll_val_current);
+
+         // if the time remaining until the deadline is less than the
+         // remaining computation time for the task, then the task will fail to
+         // meet it's deadline. 
+         if(ed_val_current < (int64_t)(wcet[idx] - et_so_far[idx]))
+         {
+            // printf("Failed on service %d\n", idx+1);
+            return FALSE;
+         }
+
+         // if the tasks deadline is sooner than the current minimum deadline,
+         // set its value as the new minimum.
+         if(ed_val_min > ed_val_current)
+         {
+            ed_idx = idx;
+            ed_val_min = ed_val_current;
+         }
+
+         
+      }
+      // printf("\n");
+      
+      // increment the elapsed time (time it has been able to process) for the
+      // task with least laxity. no service is ready on an idle tick.
+      if(ed_idx >= 0)
+         et_so_far[ed_idx] += 1;
+
+      // printf("Running task: %d @TICK=%d\n", ll_idx+1, current_tick);
+   }
+
+   return TRUE;
+}
+
+int least_laxity_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   // variable declerations
+   int ll_idx;
+   int64_t ll_val_min, ll_val_current;
+   uint64_t max_tick = hyperperiod(numServices, period);
+   uint64_t et_so_far[numServices];
+
+   // LLF is optimal on one core just like EDF, so past the simulation limit
+   // the same exact demand bound test decides the set.
+   if((max_tick == 0) || (max_tick > FEASIBILITY_SIM_LIMIT))
+   {
+      return edf_qpa_feasibility(numServices, period, wcet, period);
+   }
+
+   // initialize "execution time so far" array to zero
+   for(int i = 0; i < numServices; i++)
+   {
+      et_so_far[i] = 0;
+   }
+
+   // loop for global tick simulation, up to and including the end of the
+   // first hyperperiod so that the last jobs' deadlines are checked
+   for(uint64_t current_tick = 0; current_tick <= max_tick; current_tick++)
+   {
+      ll_val_min = INT64_MAX;
+      ll_idx = -1;
+
+      //printf("@TICK=%d\n", current_tick);
+
+      // iterate through each service
+      for(int idx = 0; idx < numServices; idx++)
+      {
+         // a job that is still unfinished when its next period starts has
+         // missed its deadline. this is not caught below when two services
+         // tie on the last tick and only one of them gets to run.
+         if((current_tick != 0) && (current_tick % period[idx] == 0) && (wcet[idx] != et_so_far[idx]))
+         {
+            return FALSE;
+         }
+
+         // check if the current task has completed executing.
+         if (wcet[idx] == et_so_far[idx])
+         {
+            // if the current tick value is not evenly divisible by the current
+            // service's period then skip this task because it has already
+            // completed it's processing before it' deadline.  
+            if(current_tick % period[idx] != 0)
+            {
+               continue;
+            }
+            else
+            {
+               // otherwise, it is the start of a new period for this task, and
+               // it must start over. reset this tasks execution time counter.
+               et_so_far[idx] = 0;
+            }
+            
+         }
+
+         // calculate lax time
+         ll_val_current = (
+            (int64_t)(period[idx] - (current_tick % period[idx])) - (int64_t)(wcet[idx] - et_so_far[idx])
+         );
+         
+         //printf("SERVICE_%d LAXITY=%d\n", idx+1, ll_val_current);
+
+         // if the laxity is negative, then the task cannot meet its deadline
+         // and therfore the set of tasks is not feasable under LLF scheduling
+         // policy. Return false in this case
+         if(ll_val_current < 0)
+         {
+            // printf("Failed on service %d\n", idx+1);
+            return FALSE;
+         }
+
+         // if the tasks least laxity is less than the current least laxity of
+         // previous calculated tasks, then save its index and ll value.
+         if(ll_val_min > ll_val_current)
+         {
+            ll_idx = idx;
+            ll_val_min = ll_val_current;
+         }
+
+         
+      }
+      // printf("\n");
+      
+      // increment the elapsed time (time it has been able to process) for the
+      // task with least laxity. no service is ready on an idle tick.
+      if(ll_idx >= 0)
+         et_so_far[ll_idx] += 1;
+
+      // printf("Running task: %d @TICK=%d\n", ll_idx+1, current_tick);
+   }
+
+   return TRUE;
+}
+
+int deadline_monotonic(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+  uint64_t interference;
+
+  // (C(i) + I(D(i))) / D(i) > 1 exactly when C(i) + I(D(i)) > D(i), which
+  // keeps the whole check in integers
+  for (int i = 0; i < numServices; i++) {
+        interference = 0;
+        for (int j = 0; j<=i-1; j++) {
+            interference = t64_add(interference, t64_mul(t64_ceil_div(deadline[i], period[j]), wcet[j]));
+        }
+
+        if (t64_add(wcet[i], interference) > deadline[i]) 
+            return FALSE;
+  }
+  return TRUE;
+}
+
+uint64_t t64_lcm(uint64_t a, uint64_t b)
+{
+   uint64_t x = a, y = b, r;
+
+   while (y != 0)
+   {
+      r = x % y; x = y; y = r;
+   }
+
+   if ((a / x) > (UINT64_MAX / b))
+      return 0;
+
+   return (a / x) * b;
+}
+
+uint64_t hyperperiod(U32_T numServices, U32_T period[])
+{
+   uint64_t lcm = 1;
+   U32_T i;
+
+   for (i = 0; (i < numServices) && (lcm != 0); i++)
+      lcm = t64_lcm(lcm, period[i]);
+
+   return lcm;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Exact utilization test
+//      * keep U so far as N/D, D the hyperperiod so far, in little endian
+//      * 32 bit limbs, which needs at most one limb per period plus two for
+//      * a term above 1 and the carry
+//      * FOR each service, with g = gcd(D, T(i)):
+//      *       N/D + C(i)/T(i) = (N*(T(i)/g) + C(i)*(D/g)) / (D*(T(i)/g))
+//      *       stop as soon as N > D, since U only grows
+////////////////////////////////////////////////////////////////////////////////
+static uint32_t mp_mod(const uint32_t *a, U32_T len, uint32_t m)
+{
+   uint64_t r = 0;
+
+   while (len-- > 0)
+      r = ((r << 32) | a[len]) % m;
+
+   return (uint32_t)r;
+}
+
+static U32_T mp_div(uint32_t *q, const uint32_t *a, U32_T len, uint32_t m)
+{
+   uint64_t r = 0, cur;
+   U32_T i = len;
+
+   while (i-- > 0)
+   {
+      cur = (r << 32) | a[i];
+      q[i] = (uint32_t)(cur / m);
+      r = cur % m;
+   }
+
+   while ((len > 0) && (q[len - 1] == 0))
+      len--;
+
+   return len;
+}
+
+static U32_T mp_mul(uint32_t *a, U32_T len, uint32_t m)
+{
+   uint64_t carry = 0;
+   U32_T i;
+
+   for (i = 0; i < len; i++)
+   {
+      carry += (uint64_t)a[i] * m;
+      a[i] = (uint32_t)carry;
+      carry >>= 32;
+   }
+
+   if (carry != 0)
+      a[len++] = (uint32_t)carry;
+
+   return len;
+}
+
+static U32_T mp_add(uint32_t *a, U32_T alen, const uint32_t *b, U32_T blen)
+{
+   uint64_t carry = 0;
+   U32_T i;
+
+   for (i = 0; (i < blen) || ((i < alen) && (carry != 0)); i++)
+   {
+      carry += (uint64_t)((i < alen) ? a[i] : 0) + ((i < blen) ? b[i] : 0);
+      a[i] = (uint32_t)carry;
+      carry >>= 32;
+   }
+   if (i > alen)
+      alen = i;
+
+   if (carry != 0)
+      a[alen++] = (uint32_t)carry;
+
+   return alen;
+}
+
+static int mp_cmp(const uint32_t *a, U32_T alen, const uint32_t *b, U32_T blen)
+{
+   if (alen != blen)
+      return (alen > blen) ? 1 : -1;
+
+   while (alen-- > 0)
+   {
+      if (a[alen] != b[alen])
+         return (a[alen] > b[alen]) ? 1 : -1;
+   }
+
+   return 0;
+}
+
+int utilization_at_most_one(U32_T numServices, U32_T period[], U32_T wcet[])
+{
+   uint32_t *num, *den, *term, g, r, x, m;
+   U32_T nlen = 0, dlen = 1, tlen, i, limbs = numServices + 3;
+   int result = TRUE;
+
+   if ((num = calloc(3 * (size_t)limbs, sizeof(uint32_t))) == NULL)
+      return -1;
+   den = num + limbs;
+   term = den + limbs;
+   den[0] = 1;
+
+   for (i = 0; (i < numServices) && (result == TRUE); i++)
+   {
+      if (wcet[i] == 0)
+         continue;
+
+      // g = gcd(D, T(i)) = gcd(T(i), D mod T(i))
+      g = period[i];
+      r = mp_mod(den, dlen, period[i]);
+      while (r != 0)
+      {
+         x = g % r; g = r; r = x;
+      }
+      m = period[i] / g;
+
+      tlen = mp_div(term, den, dlen, g);
+      tlen = mp_mul(term, tlen, wcet[i]);
+      nlen = mp_mul(num, nlen, m);
+      dlen = mp_mul(den, dlen, m);
+      nlen = mp_add(num, nlen, term, tlen);
+
+      if (mp_cmp(num, nlen, den, dlen) > 0)
+         result = FALSE;
+   }
+
+   free(num);
+   return result;
+}
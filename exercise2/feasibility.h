@@ -0,0 +1,72 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Common types and feasibility test declarations.  Every test takes the
+// service set as parallel arrays ordered from highest to lowest priority and
+// returns TRUE if the set is feasible, FALSE otherwise.
+
+#ifndef FEASIBILITY_H
+#define FEASIBILITY_H
+
+#include <stdint.h>
+
+#define TRUE 1
+#define FALSE 0
+#define U32_T unsigned int
+
+// set to FALSE to silence the per-service working printed by some tests
+extern int feasibility_verbose;
+
+// function declerations
+int completion_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int scheduling_point_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int rate_monotonic_least_upper_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int least_laxity_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int earliest_deadline_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int deadline_monotonic(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// The simulation based tests step through at most this many ticks (or, for
+// the event driven simulator, jobs) of one hyperperiod.  Beyond it, or when
+// the hyperperiod does not fit in 64 bits, they fall back to an exact
+// analytic test for the same policy.
+#define FEASIBILITY_SIM_LIMIT (1ULL << 20)
+
+// 64 bit time arithmetic.  Periods, WCETs and deadlines are 32 bit inputs,
+// but every time, demand and interference derived from them is 64 bit.
+// Sums and products saturate at T64_MAX rather than wrap: that is later
+// than any deadline, so an overflow can only turn a feasible answer into an
+// infeasible one, never report a missed deadline as met.
+#define T64_MAX UINT64_MAX
+
+static inline uint64_t t64_add(uint64_t a, uint64_t b)
+{
+   uint64_t r;
+
+   return __builtin_add_overflow(a, b, &r) ? T64_MAX : r;
+}
+
+static inline uint64_t t64_mul(uint64_t a, uint64_t b)
+{
+   uint64_t r;
+
+   return __builtin_mul_overflow(a, b, &r) ? T64_MAX : r;
+}
+
+static inline uint64_t t64_ceil_div(uint64_t num, uint64_t den)
+{
+   return (num / den) + ((num % den) != 0);
+}
+
+// least common multiple, or 0 if it does not fit in 64 bits
+uint64_t t64_lcm(uint64_t a, uint64_t b);
+
+// least common multiple of the periods, or 0 if it does not fit in 64 bits
+uint64_t hyperperiod(U32_T numServices, U32_T period[]);
+
+// TRUE if sum(C(i)/T(i)) <= 1 exactly, FALSE if not, -1 if out of memory.
+// Sums over the exact hyperperiod in multiple precision, so it also
+// settles sets within rounding of U = 1 whose hyperperiod is past 64 bits.
+int utilization_at_most_one(U32_T numServices, U32_T period[], U32_T wcet[]);
+
+#endif
@@ -0,0 +1,535 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Batch feasibility evaluator for schedulability ratio studies.
+//
+// Runs every feasibility test on each of a large number of service sets,
+// spread over all cores with a work stealing pool, and prints the fraction
+// of sets each test accepts per utilization bucket.
+//
+// Sets are either generated (UUniFast utilizations, seeded so any run can be
+// repeated exactly regardless of thread count) or read from a file:
+//
+//    CSV    - one service per line as set,period,wcet[,deadline]; lines with
+//             the same set number form one set, '#' lines are skipped
+//    binary - "FSET" followed by, for each set, a uint32 service count and
+//             that many (period, wcet, deadline) uint32 triples, native endian
+//
+// Generated sets can be written to the binary format with -w instead of
+// being tested, so a study can be rerun on exactly the same input.
+//
+// Tests run on each set: RM LUB, completion time (run as the equivalent
+// incremental RTA, which also terminates when U > 1), scheduling point, EDF
+// (QPA), LLF (event driven simulation over one hyperperiod, skipped when the
+// hyperperiod is above the -l limit) and DM.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "feasibility.h"
+#include "rta.h"
+#include "qpa.h"
+#include "sched_sim.h"
+#include "spf.h"
+#include "taskgen.h"
+#include "work_pool.h"
+
+#define NANOSEC_PER_SEC (1000000000)
+#define MAX_SERVICES (4096)
+#define MAX_DIVISORS (1344)
+#define CHUNK_SIZE (256)
+
+enum
+{
+   TEST_RM_LUB = 0,
+   TEST_CTF,
+   TEST_SPF,
+   TEST_EDF,
+   TEST_LLF,
+   TEST_DM,
+   NUM_TESTS
+};
+
+static const char *test_names[NUM_TESTS] = {"RM LUB", "CTF", "SPF", "EDF", "LLF", "DM"};
+
+typedef struct
+{
+   uint64_t sets;
+   uint64_t checked[NUM_TESTS];
+   uint64_t accepted[NUM_TESTS];
+} bucket_t;
+
+typedef struct
+{
+   // sets read from a file, stored back to back
+   uint64_t num_sets;
+   uint64_t *set_start;
+   U32_T *set_size;
+   U32_T *period, *wcet, *deadline;
+
+   // generator
+   int generate;
+   uint64_t seed;
+   U32_T num_services;
+   double util_min, util_max;
+   double deadline_min;         // D drawn from [max(C, deadline_min*T), T]
+   U32_T period_min, period_max;
+   U32_T hyper;                 // if non-zero, periods are divisors of hyper
+   U32_T divisors[MAX_DIVISORS];
+   U32_T num_divisors;
+
+   uint64_t sim_limit;          // largest hyperperiod LLF will simulate
+   double bucket_width;
+   int num_buckets;
+   bucket_t *buckets;           // [worker][bucket], merged at the end
+} batch_t;
+
+static void usage(const char *prog)
+{
+   printf("Usage: %s [options]\n", prog);
+   printf("  -i file     read sets from a .csv or binary file\n");
+   printf("  -g count    generate count sets instead (default 100000)\n");
+   printf("  -n num      services per generated set (default 10)\n");
+   printf("  -u min:max  total utilization range of generated sets (default 0.5:1.0)\n");
+   printf("  -p min:max  period range of generated sets (default 10:1000)\n");
+   printf("  -H hyper    draw periods from the divisors of hyper (default log-uniform)\n");
+   printf("  -d frac     constrained deadlines, D from [frac*T, T] (default D=T)\n");
+   printf("  -s seed     generator seed (default 5623)\n");
+   printf("  -w file     write the generated sets to a binary file and exit\n");
+   printf("  -j threads  worker threads (default all online cores)\n");
+   printf("  -b width    utilization bucket width (default 0.05)\n");
+   printf("  -l limit    largest hyperperiod the LLF simulation runs on (default 1000000)\n");
+}
+
+// per set generator, seeded from the set number so the result does not
+// depend on which thread gets the set
+static void generate_set(batch_t *b, uint64_t index, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   taskgen_rng_t rng;
+   double util;
+   U32_T i, lo;
+
+   taskgen_seed(&rng, b->seed ^ ((index + 1) * 0x9E3779B97F4A7C15ULL));
+   taskgen_next(&rng);
+
+   util = b->util_min + (b->util_max - b->util_min) * taskgen_uniform(&rng);
+
+   if (b->num_divisors)
+      taskgen_generate_from(&rng, b->num_services, util, b->divisors, b->num_divisors, period, wcet, deadline);
+   else
+      taskgen_generate(&rng, b->num_services, util, b->period_min, b->period_max, period, wcet, deadline);
+
+   if (b->deadline_min < 1.0)
+   {
+      for (i = 0; i < b->num_services; i++)
+      {
+         lo = (U32_T)(b->deadline_min * (double)period[i]);
+         if (lo < wcet[i])
+            lo = wcet[i];
+         if (lo < period[i])
+            deadline[i] = lo + (U32_T)(taskgen_next(&rng) % (period[i] - lo + 1));
+      }
+   }
+}
+
+// insertion sort of the three arrays on key[], ties broken on tie[]
+static void sort_services(U32_T n, U32_T key[], U32_T tie[], U32_T other[])
+{
+   U32_T i, j, k, t, o;
+
+   for (i = 1; i < n; i++)
+   {
+      k = key[i]; t = tie[i]; o = other[i];
+      for (j = i; (j > 0) && ((key[j - 1] > k) || ((key[j - 1] == k) && (tie[j - 1] > t))); j--)
+      {
+         key[j] = key[j - 1]; tie[j] = tie[j - 1]; other[j] = other[j - 1];
+      }
+      key[j] = k; tie[j] = t; other[j] = o;
+   }
+}
+
+static void evaluate_set(batch_t *b, bucket_t *buckets, U32_T n, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   U32_T dm_period[n], dm_wcet[n], dm_deadline[n];
+   int result[NUM_TESTS], run[NUM_TESTS];
+   double util = 0.0;
+   uint64_t hyper;
+   bucket_t *bucket;
+   int idx, t;
+   U32_T i;
+
+   for (i = 0; i < n; i++)
+      util += (double)wcet[i] / (double)period[i];
+
+   idx = (int)(util / b->bucket_width);
+   if (idx >= b->num_buckets)
+      idx = b->num_buckets - 1;
+   bucket = &buckets[idx];
+
+   for (t = 0; t < NUM_TESTS; t++)
+      run[t] = TRUE;
+
+   // the fixed priority tests expect RM order, DM expects deadline order
+   sort_services(n, period, deadline, wcet);
+
+   memcpy(dm_period, period, n * sizeof(U32_T));
+   memcpy(dm_wcet, wcet, n * sizeof(U32_T));
+   memcpy(dm_deadline, deadline, n * sizeof(U32_T));
+   sort_services(n, dm_deadline, dm_period, dm_wcet);
+
+   result[TEST_RM_LUB] = rate_monotonic_least_upper_bound(n, period, wcet, deadline);
+   result[TEST_CTF] = response_time_feasibility(n, period, wcet, deadline);
+   result[TEST_SPF] = reduced_scheduling_point_feasibility(n, period, wcet, deadline);
+   result[TEST_EDF] = edf_qpa_feasibility(n, period, wcet, deadline);
+   result[TEST_DM] = deadline_monotonic(n, dm_period, dm_wcet, dm_deadline);
+
+   hyper = hyperperiod(n, period);
+   if ((hyper != 0) && (hyper <= b->sim_limit))
+      result[TEST_LLF] = sim_llf_feasibility(n, period, wcet, deadline);
+   else
+      run[TEST_LLF] = FALSE;
+
+   bucket->sets++;
+   for (t = 0; t < NUM_TESTS; t++)
+   {
+      if (!run[t])
+         continue;
+      bucket->checked[t]++;
+      if (result[t] == TRUE)
+         bucket->accepted[t]++;
+   }
+}
+
+static void batch_chunk(void *ctx, int worker, uint64_t start, uint64_t end)
+{
+   batch_t *b = (batch_t *)ctx;
+   bucket_t *buckets = &b->buckets[worker * b->num_buckets];
+   U32_T period[MAX_SERVICES], wcet[MAX_SERVICES], deadline[MAX_SERVICES];
+   uint64_t s;
+   U32_T n;
+
+   for (s = start; s < end; s++)
+   {
+      if (b->generate)
+      {
+         n = b->num_services;
+         generate_set(b, s, period, wcet, deadline);
+      }
+      else
+      {
+         // tests sort in place, so work on a copy
+         n = b->set_size[s];
+         memcpy(period, &b->period[b->set_start[s]], n * sizeof(U32_T));
+         memcpy(wcet, &b->wcet[b->set_start[s]], n * sizeof(U32_T));
+         memcpy(deadline, &b->deadline[b->set_start[s]], n * sizeof(U32_T));
+      }
+
+      evaluate_set(b, buckets, n, period, wcet, deadline);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Set files
+////////////////////////////////////////////////////////////////////////////////
+static int add_service(batch_t *b, uint64_t *cap, U32_T period, U32_T wcet, U32_T deadline)
+{
+   uint64_t total = b->num_sets ? b->set_start[b->num_sets - 1] + b->set_size[b->num_sets - 1] : 0;
+
+   if (total == *cap)
+   {
+      *cap = *cap ? 2 * *cap : 4096;
+      b->period = realloc(b->period, *cap * sizeof(U32_T));
+      b->wcet = realloc(b->wcet, *cap * sizeof(U32_T));
+      b->deadline = realloc(b->deadline, *cap * sizeof(U32_T));
+      if ((b->period == NULL) || (b->wcet == NULL) || (b->deadline == NULL))
+         return -1;
+   }
+
+   b->period[total] = period;
+   b->wcet[total] = wcet;
+   b->deadline[total] = deadline;
+   b->set_size[b->num_sets - 1]++;
+
+   return 0;
+}
+
+static int start_set(batch_t *b)
+{
+   uint64_t total = b->num_sets ? b->set_start[b->num_sets - 1] + b->set_size[b->num_sets - 1] : 0;
+
+   if ((b->num_sets & (b->num_sets - 1)) == 0)
+   {
+      b->set_start = realloc(b->set_start, (b->num_sets ? 2 * b->num_sets : 1) * sizeof(uint64_t));
+      b->set_size = realloc(b->set_size, (b->num_sets ? 2 * b->num_sets : 1) * sizeof(U32_T));
+      if ((b->set_start == NULL) || (b->set_size == NULL))
+         return -1;
+   }
+
+   b->set_start[b->num_sets] = total;
+   b->set_size[b->num_sets] = 0;
+   b->num_sets++;
+
+   return 0;
+}
+
+static int read_sets(batch_t *b, const char *path)
+{
+   FILE *in;
+   char magic[4], line[256];
+   uint32_t n, rec[3], i;
+   unsigned long set, last_set = (unsigned long)-1, period, wcet, deadline;
+   uint64_t cap = 0;
+   int fields, rc = 0;
+
+   if ((in = fopen(path, "rb")) == NULL)
+   {
+      perror(path);
+      return -1;
+   }
+
+   if ((fread(magic, 1, 4, in) == 4) && (memcmp(magic, "FSET", 4) == 0))
+   {
+      while ((rc == 0) && (fread(&n, sizeof(n), 1, in) == 1))
+      {
+         if ((n == 0) || (n > MAX_SERVICES) || (start_set(b) < 0))
+         {
+            rc = -1;
+            break;
+         }
+
+         for (i = 0; i < n; i++)
+         {
+            if ((fread(rec, sizeof(uint32_t), 3, in) != 3) || (rec[0] == 0) ||
+                (add_service(b, &cap, rec[0], rec[1], rec[2]) < 0))
+            {
+               rc = -1;
+               break;
+            }
+         }
+      }
+   }
+   else
+   {
+      rewind(in);
+      while ((rc == 0) && fgets(line, sizeof(line), in))
+      {
+         fields = sscanf(line, "%lu,%lu,%lu,%lu", &set, &period, &wcet, &deadline);
+         if (fields < 3)
+            continue;   // header, comment or blank line
+         if (fields == 3)
+            deadline = period;
+
+         if ((b->num_sets == 0) || (set != last_set))
+         {
+            if (start_set(b) < 0)
+               rc = -1;
+            last_set = set;
+         }
+
+         if ((rc == 0) && ((b->set_size[b->num_sets - 1] >= MAX_SERVICES) ||
+                           (period == 0) || (add_service(b, &cap, period, wcet, deadline) < 0)))
+            rc = -1;
+      }
+   }
+
+   if (rc < 0)
+      fprintf(stderr, "%s: bad set %llu\n", path, (unsigned long long)b->num_sets);
+
+   fclose(in);
+   return rc;
+}
+
+static int write_sets(batch_t *b, uint64_t count, const char *path)
+{
+   U32_T period[MAX_SERVICES], wcet[MAX_SERVICES], deadline[MAX_SERVICES];
+   uint32_t n = b->num_services, i;
+   uint64_t s;
+   FILE *out;
+
+   if ((out = fopen(path, "wb")) == NULL)
+   {
+      perror(path);
+      return -1;
+   }
+
+   fwrite("FSET", 1, 4, out);
+   for (s = 0; s < count; s++)
+   {
+      generate_set(b, s, period, wcet, deadline);
+      fwrite(&n, sizeof(n), 1, out);
+      for (i = 0; i < n; i++)
+      {
+         fwrite(&period[i], sizeof(uint32_t), 1, out);
+         fwrite(&wcet[i], sizeof(uint32_t), 1, out);
+         fwrite(&deadline[i], sizeof(uint32_t), 1, out);
+      }
+   }
+
+   return fclose(out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Report
+////////////////////////////////////////////////////////////////////////////////
+static void print_report(batch_t *b, int num_threads, double seconds)
+{
+   bucket_t total[b->num_buckets], sum;
+   int w, k, t;
+
+   memset(total, 0, sizeof(total));
+   memset(&sum, 0, sizeof(sum));
+
+   for (w = 0; w < num_threads; w++)
+   {
+      for (k = 0; k < b->num_buckets; k++)
+      {
+         bucket_t *src = &b->buckets[w * b->num_buckets + k];
+
+         total[k].sets += src->sets;
+         sum.sets += src->sets;
+         for (t = 0; t < NUM_TESTS; t++)
+         {
+            total[k].checked[t] += src->checked[t];
+            total[k].accepted[t] += src->accepted[t];
+            sum.checked[t] += src->checked[t];
+            sum.accepted[t] += src->accepted[t];
+         }
+      }
+   }
+
+   printf("%llu sets on %d threads in %.3f sec, %.0f sets/sec\n\n",
+          (unsigned long long)sum.sets, num_threads, seconds,
+          (seconds > 0.0) ? (double)sum.sets / seconds : 0.0);
+
+   printf("%-13s %10s", "U bucket", "sets");
+   for (t = 0; t < NUM_TESTS; t++)
+      printf(" %7s", test_names[t]);
+   printf("\n");
+
+   for (k = 0; k < b->num_buckets; k++)
+   {
+      if (total[k].sets == 0)
+         continue;
+
+      if (k == b->num_buckets - 1)
+         printf("[%4.2f,  inf) %10llu", k * b->bucket_width, (unsigned long long)total[k].sets);
+      else
+         printf("[%4.2f,%5.2f) %10llu", k * b->bucket_width, (k + 1) * b->bucket_width,
+                (unsigned long long)total[k].sets);
+
+      for (t = 0; t < NUM_TESTS; t++)
+      {
+         if (total[k].checked[t])
+            printf(" %7.4f", (double)total[k].accepted[t] / (double)total[k].checked[t]);
+         else
+            printf(" %7s", "-");
+      }
+      printf("\n");
+   }
+
+   if (sum.checked[TEST_LLF] < sum.sets)
+      printf("\nLLF skipped on %llu sets with a hyperperiod above the -l limit\n",
+             (unsigned long long)(sum.sets - sum.checked[TEST_LLF]));
+}
+
+int main(int argc, char *argv[])
+{
+   batch_t b;
+   const char *in_path = NULL, *out_path = NULL;
+   uint64_t count = 100000;
+   int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   struct timespec start, stop;
+   double seconds;
+   int opt;
+
+   memset(&b, 0, sizeof(b));
+   b.generate = TRUE;
+   b.seed = 5623;
+   b.num_services = 10;
+   b.util_min = 0.5; b.util_max = 1.0;
+   b.deadline_min = 1.0;
+   b.period_min = 10; b.period_max = 1000;
+   b.sim_limit = 1000000;
+   b.bucket_width = 0.05;
+
+   while ((opt = getopt(argc, argv, "i:g:n:u:p:H:d:s:w:j:b:l:h")) != -1)
+   {
+      switch (opt)
+      {
+         case 'i': in_path = optarg; b.generate = FALSE; break;
+         case 'g': count = strtoull(optarg, NULL, 0); break;
+         case 'n': b.num_services = (U32_T)strtoul(optarg, NULL, 0); break;
+         case 'u': sscanf(optarg, "%lf:%lf", &b.util_min, &b.util_max); break;
+         case 'p': sscanf(optarg, "%u:%u", &b.period_min, &b.period_max); break;
+         case 'H': b.hyper = (U32_T)strtoul(optarg, NULL, 0); break;
+         case 'd': b.deadline_min = strtod(optarg, NULL); break;
+         case 's': b.seed = strtoull(optarg, NULL, 0); break;
+         case 'w': out_path = optarg; break;
+         case 'j': num_threads = atoi(optarg); break;
+         case 'b': b.bucket_width = strtod(optarg, NULL); break;
+         case 'l': b.sim_limit = strtoull(optarg, NULL, 0); break;
+         default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : -1;
+      }
+   }
+
+   if ((b.num_services < 1) || (b.num_services > MAX_SERVICES) ||
+       (b.period_min < 1) || (b.period_max < b.period_min) ||
+       (b.bucket_width <= 0.0) || (num_threads < 1))
+   {
+      usage(argv[0]);
+      return -1;
+   }
+
+   if (b.hyper)
+   {
+      b.num_divisors = taskgen_divisors(b.hyper, b.period_min, b.period_max, b.divisors, MAX_DIVISORS);
+      if (b.num_divisors == 0)
+      {
+         printf("No divisors of %u in [%u, %u]\n", b.hyper, b.period_min, b.period_max);
+         return -1;
+      }
+   }
+
+   if (out_path != NULL)
+      return write_sets(&b, count, out_path);
+
+   if (in_path != NULL)
+   {
+      if (read_sets(&b, in_path) < 0)
+         return -1;
+      count = b.num_sets;
+   }
+
+   // buckets up to U=1.2, the last one also takes everything above
+   b.num_buckets = (int)(1.2 / b.bucket_width + 0.5) + 1;
+   b.buckets = calloc((size_t)num_threads * b.num_buckets, sizeof(bucket_t));
+   if (b.buckets == NULL)
+      return -1;
+
+   feasibility_verbose = FALSE;
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   if (work_pool_run(count, CHUNK_SIZE, num_threads, batch_chunk, &b) < 0)
+   {
+      perror("work_pool_run");
+      return -1;
+   }
+   clock_gettime(CLOCK_MONOTONIC, &stop);
+
+   seconds = (double)(stop.tv_sec - start.tv_sec) +
+             (double)(stop.tv_nsec - start.tv_nsec) / (double)NANOSEC_PER_SEC;
+
+   print_report(&b, num_threads, seconds);
+
+   free(b.buckets);
+   free(b.set_start); free(b.set_size);
+   free(b.period); free(b.wcet); free(b.deadline);
+
+   return 0;
+}
@@ -0,0 +1,1303 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Benchmarks for the feasibility tests on synthetic service sets.
+//
+// Usage: feasibility_bench <benchmark> [seed]
+//
+//    rta   - incremental response_time_analysis() vs completion_time_feasibility()
+//    qpa   - edf_qpa_feasibility() vs the earliest_deadline_first() simulation
+//    sim   - discrete event simulator vs the tick simulations, and a
+//            nanosecond resolution run of the 3000 Hz seqgen service set
+//    simd  - structure of arrays kernels vs the scalar tests on 1000 services
+//    spf   - reduced scheduling point set vs scheduling_point_feasibility()
+//    sens  - sensitivity reports for 100 service sets under RM, DM and EDF
+//    wide  - every test on usec and nsec resolution sets whose hyperperiods
+//            and demand sums do not fit in 16 or 32 bits
+//    part  - partitioning 10,000 services onto 64 cores against a 1 sec
+//            target, and the core map of the Q3 seqgen set on 4 cores
+//    global- acceptance and runtime of the global G-EDF and G-RM tests
+//            against partitioned RM and EDF on 1 to 8 cores
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "feasibility.h"
+#include "global.h"
+#include "partition.h"
+#include "rta.h"
+#include "qpa.h"
+#include "sched_sim.h"
+#include "sensitivity.h"
+#include "spf.h"
+#include "taskgen.h"
+#include "taskset.h"
+
+#define NANOSEC_PER_SEC (1000000000)
+
+// every 10,000 service partition should take well under this
+#define PART_TARGET_MSEC (1000)
+
+static double elapsed_usec(struct timespec *start, struct timespec *stop)
+{
+   return ((double)(stop->tv_sec - start->tv_sec) * (double)NANOSEC_PER_SEC +
+           (double)(stop->tv_nsec - start->tv_nsec)) / 1000.0;
+}
+
+static void usage(const char *prog)
+{
+   printf("Usage: %s <benchmark> [seed]\n", prog);
+   printf("   rta   - incremental RTA vs completion time test\n");
+   printf("   qpa   - EDF QPA vs tick EDF simulation\n");
+   printf("   sim   - discrete event simulator vs tick simulations\n");
+   printf("   simd  - SoA/SIMD kernels vs scalar tests, 1000 services\n");
+   printf("   spf   - reduced vs full scheduling point test\n");
+   printf("   sens  - sensitivity analysis of 100 service sets\n");
+   printf("   wide  - all tests on sets with 64 bit hyperperiods\n");
+   printf("   part  - partitioned multicore allocation, 10000 services on 64 cores\n");
+   printf("   global- global G-EDF/G-RM tests vs partitioning, 1 to 8 cores\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RTA benchmark
+//      * FOR each set size from 10 to 10,000 services:
+//      *       generate sets at U=0.70 with periods in [100n, 100000n], wide
+//      *       enough that rounding WCETs to whole ticks keeps U near 0.70
+//      *       time completion_time_feasibility() and response_time_analysis()
+//      *       check both tests reach the same decision on every set
+////////////////////////////////////////////////////////////////////////////////
+static int bench_rta(uint64_t seed)
+{
+   U32_T sizes[] = {10, 100, 1000, 10000};
+   U32_T num_sets[] = {1000, 100, 10, 1};
+   U32_T *period, *wcet, *deadline, *response;
+   U32_T n, s, k, feasible;
+   int ctf_result, rta_result, mismatches = 0;
+   double ctf_usec, rta_usec;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+
+   taskgen_seed(&rng, seed);
+
+   printf("%8s %6s %14s %14s %9s %9s\n", "services", "sets", "CTF usec/set", "RTA usec/set", "speedup", "feasible");
+
+   for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+   {
+      n = sizes[k];
+      period = malloc(n * sizeof(U32_T));
+      wcet = malloc(n * sizeof(U32_T));
+      deadline = malloc(n * sizeof(U32_T));
+      response = malloc(n * sizeof(U32_T));
+      ctf_usec = 0.0; rta_usec = 0.0; feasible = 0;
+
+      for (s = 0; s < num_sets[k]; s++)
+      {
+         taskgen_generate(&rng, n, 0.70, 100 * n, 100000 * n, period, wcet, deadline);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         ctf_result = completion_time_feasibility(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         ctf_usec += elapsed_usec(&start, &stop);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         rta_result = response_time_analysis(n, period, wcet, deadline, response);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         rta_usec += elapsed_usec(&start, &stop);
+
+         if (ctf_result != rta_result)
+            mismatches++;
+         if (rta_result == TRUE)
+            feasible++;
+      }
+
+      printf("%8u %6u %14.2f %14.2f %8.1fx %4u/%-4u\n", n, num_sets[k],
+             ctf_usec / num_sets[k], rta_usec / num_sets[k],
+             (rta_usec > 0.0) ? ctf_usec / rta_usec : 0.0, feasible, num_sets[k]);
+
+      fflush(stdout);
+      free(period); free(wcet); free(deadline); free(response);
+   }
+
+   if (mismatches)
+      printf("ERROR: %d sets where RTA and CTF disagree\n", mismatches);
+
+   return mismatches ? -1 : 0;
+}
+
+// Service set with periods drawn from the divisors of 7200, so the
+// hyperperiod is short enough for the tick simulations to actually step
+// through instead of falling back to QPA.
+static void generate_small_hyperperiod(taskgen_rng_t *rng, U32_T n, double total_util,
+                                       U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   static U32_T divisors[64];
+   static U32_T num_divisors = 0;
+
+   if (num_divisors == 0)
+      num_divisors = taskgen_divisors(7200, 10, 7200, divisors, 64);
+
+   taskgen_generate_from(rng, n, total_util, divisors, num_divisors, period, wcet, deadline);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// QPA benchmark
+//      * FOR each set size and utilization:
+//      *       generate sets whose hyperperiod fits in the simulation window
+//      *       time earliest_deadline_first() and edf_qpa_feasibility()
+//      *       check both tests reach the same decision on every set
+////////////////////////////////////////////////////////////////////////////////
+static int bench_qpa(uint64_t seed)
+{
+   U32_T sizes[] = {5, 10, 20, 50};
+   double utils[] = {0.50, 0.80, 0.95, 1.00};
+   U32_T num_sets = 50;
+   U32_T period[50], wcet[50], deadline[50];
+   U32_T n, s, k, u, feasible;
+   int sim_result, qpa_result, mismatches = 0;
+   double sim_usec, qpa_usec;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+
+   taskgen_seed(&rng, seed);
+
+   printf("%8s %6s %6s %14s %14s %9s %9s\n", "services", "U", "sets", "SIM usec/set", "QPA usec/set", "speedup", "feasible");
+
+   for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+   {
+      for (u = 0; u < sizeof(utils) / sizeof(utils[0]); u++)
+      {
+         n = sizes[k];
+         sim_usec = 0.0; qpa_usec = 0.0; feasible = 0;
+
+         for (s = 0; s < num_sets; s++)
+         {
+            generate_small_hyperperiod(&rng, n, utils[u], period, wcet, deadline);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            sim_result = earliest_deadline_first(n, period, wcet, deadline);
+            clock_gettime(CLOCK_MONOTONIC, &stop);
+            sim_usec += elapsed_usec(&start, &stop);
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            qpa_result = edf_qpa_feasibility(n, period, wcet, deadline);
+            clock_gettime(CLOCK_MONOTONIC, &stop);
+            qpa_usec += elapsed_usec(&start, &stop);
+
+            if (sim_result != qpa_result)
+               mismatches++;
+            if (qpa_result == TRUE)
+               feasible++;
+         }
+
+         printf("%8u %6.2f %6u %14.2f %14.2f %8.1fx %4u/%-4u\n", n, utils[u], num_sets,
+                sim_usec / num_sets, qpa_usec / num_sets,
+                (qpa_usec > 0.0) ? sim_usec / qpa_usec : 0.0, feasible, num_sets);
+         fflush(stdout);
+      }
+   }
+
+   if (mismatches)
+      printf("ERROR: %d sets where QPA and the EDF simulation disagree\n", mismatches);
+
+   return mismatches ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Discrete event simulator benchmark
+//      * FOR each set size, on sets whose hyperperiod divides 7200 ticks:
+//      *       time the tick EDF and LLF simulations against the event
+//      *       driven EDF and LLF, and check the decisions agree
+//      *       check the event driven RM decision against RTA
+//      * Simulate the exercise5 Q3 seqgen set (3000 Hz sequencer and seven
+//      * sub-rate services) at nanosecond resolution over its hyperperiod
+//      * and print the start of the job trace
+////////////////////////////////////////////////////////////////////////////////
+static int bench_sim(uint64_t seed)
+{
+   U32_T sizes[] = {5, 10, 20, 50};
+   U32_T num_sets = 100;
+   U32_T period[50], wcet[50], deadline[50];
+   U32_T n, s, k;
+   int tick, event, mismatches = 0;
+   double edf_tick, edf_event, llf_tick, llf_event;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+   sim_result_t result;
+   sim_trace_t trace[24];
+
+   // Q3 seqgen: 3000 Hz sequencer, services every 10/30/30/30/60/60/300
+   // sequencer cycles, in RM order with made-up WCETs (U=0.76), in ns
+   U32_T seq_period[] = {333333, 3333330, 9999990, 9999990, 9999990, 19999980, 19999980, 99999900};
+   U32_T seq_wcet[]   = {20000, 500000, 1000000, 1000000, 1000000, 2000000, 2000000, 5000000};
+   U32_T seq_n = sizeof(seq_period) / sizeof(seq_period[0]);
+
+   taskgen_seed(&rng, seed);
+
+   printf("%8s %6s %15s %15s %15s %15s\n", "services", "sets", "tick EDF usec", "event EDF usec", "tick LLF usec", "event LLF usec");
+
+   for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+   {
+      n = sizes[k];
+      edf_tick = 0.0; edf_event = 0.0; llf_tick = 0.0; llf_event = 0.0;
+
+      for (s = 0; s < num_sets; s++)
+      {
+         // sweep U from 0.5 to 1.0 over the sets
+         generate_small_hyperperiod(&rng, n, 0.5 + 0.5 * (double)s / (double)(num_sets - 1), period, wcet, deadline);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         tick = earliest_deadline_first(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         edf_tick += elapsed_usec(&start, &stop);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         event = sim_edf_feasibility(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         edf_event += elapsed_usec(&start, &stop);
+         mismatches += (tick != event);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         tick = least_laxity_first(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         llf_tick += elapsed_usec(&start, &stop);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         event = sim_llf_feasibility(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         llf_event += elapsed_usec(&start, &stop);
+         mismatches += (tick != event);
+
+         mismatches += (sim_rm_feasibility(n, period, wcet, deadline) !=
+                        response_time_feasibility(n, period, wcet, deadline));
+      }
+
+      printf("%8u %6u %15.2f %15.2f %15.2f %15.2f\n", n, num_sets,
+             edf_tick / num_sets, edf_event / num_sets, llf_tick / num_sets, llf_event / num_sets);
+      fflush(stdout);
+   }
+
+   if (mismatches)
+      printf("ERROR: %d decisions where the event driven simulator disagrees\n", mismatches);
+
+   printf("\nQ3 seqgen service set, ns resolution, hyperperiod %llu ns\n",
+          (unsigned long long)hyperperiod(seq_n, seq_period));
+
+   memset(&result, 0, sizeof(result));
+   result.trace = trace;
+   result.trace_cap = sizeof(trace) / sizeof(trace[0]);
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   sched_simulate(seq_n, seq_period, seq_wcet, seq_period, &sim_policy_rm, 0, FALSE, &result);
+   clock_gettime(CLOCK_MONOTONIC, &stop);
+
+   printf("RM: %llu jobs, %llu preemptions, %llu misses, %llu events in %.2f usec\n",
+          (unsigned long long)result.jobs_released, (unsigned long long)result.preemptions,
+          (unsigned long long)result.deadline_misses, (unsigned long long)result.events,
+          elapsed_usec(&start, &stop));
+   sched_sim_print_trace(stdout, &result);
+
+   return mismatches ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SoA kernel benchmark
+//      * FOR a sweep of 1000 service sets from U=0.50 to U=1.00:
+//      *       load the set into a taskset_t
+//      *       compare the utilization sum bit for bit with the scalar sum
+//      *       time RM LUB, RTA and DM on the arrays and on the taskset_t
+//      *       check every decision and every response time agrees
+////////////////////////////////////////////////////////////////////////////////
+static int bench_simd(uint64_t seed)
+{
+   U32_T n = 1000, num_sets = 200;
+   U32_T *period, *wcet, *deadline, *response, *soa_response;
+   U32_T s, i;
+   double scalar_util, soa_util, lub_usec[2] = {0.0, 0.0}, rta_usec[2] = {0.0, 0.0}, dm_usec[2] = {0.0, 0.0};
+   int mismatches = 0, scalar_result, soa_result, feasible = 0;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+   taskset_t ts;
+
+   period = malloc(n * sizeof(U32_T));
+   wcet = malloc(n * sizeof(U32_T));
+   deadline = malloc(n * sizeof(U32_T));
+   response = malloc(n * sizeof(U32_T));
+   soa_response = malloc(n * sizeof(U32_T));
+   if (!period || !wcet || !deadline || !response || !soa_response || (taskset_init(&ts, n) < 0))
+   {
+      printf("ERROR: out of memory\n");
+      return -1;
+   }
+
+   taskgen_seed(&rng, seed);
+   feasibility_verbose = FALSE;
+
+   printf("kernel: %s, %u sets of %u services\n", taskset_kernel_name(), num_sets, n);
+
+   for (s = 0; s < num_sets; s++)
+   {
+      taskgen_generate(&rng, n, 0.5 + 0.5 * (double)s / (double)(num_sets - 1), 100 * n, 100000 * n, period, wcet, deadline);
+      taskset_load(&ts, n, period, wcet, deadline);
+
+      // utilization must match the scalar loop to the last bit
+      scalar_util = 0.0;
+      for (i = 0; i < n; i++)
+         scalar_util += ((double)wcet[i] / (double)period[i]);
+      soa_util = taskset_utilization(&ts);
+      if (memcmp(&scalar_util, &soa_util, sizeof(double)) != 0)
+         mismatches++;
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      scalar_result = rate_monotonic_least_upper_bound(n, period, wcet, deadline);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      lub_usec[0] += elapsed_usec(&start, &stop);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      soa_result = taskset_rm_lub(&ts);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      lub_usec[1] += elapsed_usec(&start, &stop);
+      mismatches += (scalar_result != soa_result);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      scalar_result = response_time_analysis(n, period, wcet, deadline, response);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      rta_usec[0] += elapsed_usec(&start, &stop);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      soa_result = taskset_response_time_analysis(&ts, soa_response);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      rta_usec[1] += elapsed_usec(&start, &stop);
+      mismatches += (scalar_result != soa_result);
+      mismatches += (memcmp(response, soa_response, n * sizeof(U32_T)) != 0);
+      feasible += (soa_result == TRUE);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      scalar_result = deadline_monotonic(n, period, wcet, deadline);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      dm_usec[0] += elapsed_usec(&start, &stop);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      soa_result = taskset_deadline_monotonic(&ts);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      dm_usec[1] += elapsed_usec(&start, &stop);
+      mismatches += (scalar_result != soa_result);
+   }
+
+   printf("%8s %16s %16s %9s\n", "test", "scalar usec/set", "SoA usec/set", "speedup");
+   printf("%8s %16.2f %16.2f %8.1fx\n", "RM LUB", lub_usec[0] / num_sets, lub_usec[1] / num_sets,
+          (lub_usec[1] > 0.0) ? lub_usec[0] / lub_usec[1] : 0.0);
+   printf("%8s %16.2f %16.2f %8.1fx\n", "RTA", rta_usec[0] / num_sets, rta_usec[1] / num_sets,
+          (rta_usec[1] > 0.0) ? rta_usec[0] / rta_usec[1] : 0.0);
+   printf("%8s %16.2f %16.2f %8.1fx\n", "DM", dm_usec[0] / num_sets, dm_usec[1] / num_sets,
+          (dm_usec[1] > 0.0) ? dm_usec[0] / dm_usec[1] : 0.0);
+   printf("RTA feasible: %d/%u\n", feasible, num_sets);
+
+   if (mismatches)
+      printf("ERROR: %d results where the SoA kernels and the scalar tests disagree\n", mismatches);
+
+   taskset_free(&ts);
+   free(period); free(wcet); free(deadline); free(response); free(soa_response);
+
+   return mismatches ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scheduling point benchmark
+//      * FOR each set size, on sets with a 1000:1 period ratio:
+//      *       time scheduling_point_feasibility() and the reduced test
+//      *       check both tests reach the same decision on every set
+//      * FOR period ratios up to 1,000,000:1, time the reduced test alone
+//      * and report how many points it checked
+////////////////////////////////////////////////////////////////////////////////
+static int bench_spf(uint64_t seed)
+{
+   U32_T sizes[] = {5, 10, 20, 50};
+   U32_T num_sets[] = {200, 100, 20, 5};
+   U32_T ratios[] = {1000, 10000, 100000, 1000000};
+   U32_T period[50], wcet[50], deadline[50];
+   U32_T n, s, k, feasible;
+   int full_result, reduced_result, mismatches = 0;
+   double full_usec, reduced_usec;
+   uint64_t points, checked;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+
+   taskgen_seed(&rng, seed);
+
+   printf("period ratio 1000:1\n");
+   printf("%8s %6s %15s %15s %9s %9s\n", "services", "sets", "full usec/set", "reduced usec", "speedup", "feasible");
+
+   for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+   {
+      n = sizes[k];
+      full_usec = 0.0; reduced_usec = 0.0; feasible = 0;
+
+      for (s = 0; s < num_sets[k]; s++)
+      {
+         // sweep U from 0.6 to 1.0 over the sets
+         taskgen_generate(&rng, n, 0.6 + 0.4 * (double)s / (double)(num_sets[k] - 1), 100, 100000, period, wcet, deadline);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         full_result = scheduling_point_feasibility(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         full_usec += elapsed_usec(&start, &stop);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         reduced_result = reduced_scheduling_point_feasibility(n, period, wcet, deadline);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         reduced_usec += elapsed_usec(&start, &stop);
+
+         if (full_result != reduced_result)
+            mismatches++;
+         if (reduced_result == TRUE)
+            feasible++;
+      }
+
+      printf("%8u %6u %15.2f %15.2f %8.1fx %4u/%-4u\n", n, num_sets[k],
+             full_usec / num_sets[k], reduced_usec / num_sets[k],
+             (reduced_usec > 0.0) ? full_usec / reduced_usec : 0.0, feasible, num_sets[k]);
+      fflush(stdout);
+   }
+
+   printf("\nreduced test only, 20 services, 20 sets per ratio\n");
+   printf("%8s %15s %15s %9s\n", "ratio", "reduced usec", "points/set", "feasible");
+
+   for (k = 0; k < sizeof(ratios) / sizeof(ratios[0]); k++)
+   {
+      reduced_usec = 0.0; points = 0; feasible = 0;
+
+      for (s = 0; s < 20; s++)
+      {
+         taskgen_generate(&rng, 20, 0.6 + 0.4 * (double)s / 19.0, 100, 100 * ratios[k], period, wcet, deadline);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         reduced_result = reduced_scheduling_point_checked(20, period, wcet, deadline, &checked);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         reduced_usec += elapsed_usec(&start, &stop);
+         points += checked;
+
+         // the reduced test is exact, so it has to agree with RTA
+         if (reduced_result != response_time_feasibility(20, period, wcet, deadline))
+            mismatches++;
+         if (reduced_result == TRUE)
+            feasible++;
+      }
+
+      printf("%8u %15.2f %15.1f %4u/%-4u\n", ratios[k], reduced_usec / 20, (double)points / 20.0, feasible, 20);
+      fflush(stdout);
+   }
+
+   if (mismatches)
+      printf("ERROR: %d sets where the reduced scheduling point test disagrees\n", mismatches);
+
+   return mismatches ? -1 : 0;
+}
+
+// Reference for the sensitivity benchmark: the exact test on a copy sorted
+// into priority order, with no utilization shortcuts.
+static int reference_feasible(sensitivity_policy_t policy, U32_T n, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   U32_T p[100], c[100], d[100], key[100], i, j, k;
+   int implicit = TRUE;
+
+   if (policy == SENSITIVITY_EDF)
+   {
+      // with D=T, EDF is feasible iff U <= 1 (QPA would have to cover the
+      // whole hyperperiod at U=1)
+      for (i = 0; i < n; i++)
+         implicit = implicit && (deadline[i] == period[i]);
+      if (implicit)
+         return (utilization_at_most_one(n, period, wcet) == TRUE) ? TRUE : FALSE;
+
+      return edf_qpa_feasibility(n, period, wcet, deadline);
+   }
+
+   // stable insertion sort by period (RM) or deadline (DM)
+   for (i = 0; i < n; i++)
+   {
+      k = (policy == SENSITIVITY_RM) ? period[i] : deadline[i];
+      for (j = i; (j > 0) && (key[j - 1] > k); j--)
+      {
+         key[j] = key[j - 1]; p[j] = p[j - 1]; c[j] = c[j - 1]; d[j] = d[j - 1];
+      }
+      key[j] = k; p[j] = period[i]; c[j] = wcet[i]; d[j] = deadline[i];
+   }
+
+   return response_time_feasibility(n, p, c, d);
+}
+
+// Largest feasible C(i) by trying every value up to D(i), 0 if none.
+static U32_T brute_max_wcet(sensitivity_policy_t policy, U32_T n, U32_T period[], U32_T wcet[],
+                            U32_T deadline[], U32_T i)
+{
+   U32_T saved = wcet[i], c, best = 0;
+
+   for (c = 1; c <= deadline[i]; c++)
+   {
+      wcet[i] = c;
+      if (reference_feasible(policy, n, period, wcet, deadline))
+         best = c;
+   }
+
+   wcet[i] = saved;
+   return best;
+}
+
+// Smallest feasible T(i) from C(i) (or a fixed D(i)) up to limit, 0 if none.
+static U32_T brute_min_period(sensitivity_policy_t policy, U32_T n, U32_T period[], U32_T wcet[],
+                              U32_T deadline[], U32_T i, U32_T limit)
+{
+   U32_T saved = period[i], saved_deadline = deadline[i], t, found = 0;
+   int implicit = (saved_deadline == saved);
+
+   for (t = implicit ? wcet[i] : saved_deadline; (t <= limit) && (found == 0); t++)
+   {
+      period[i] = t;
+      if (implicit)
+         deadline[i] = t;
+      if ((t >= wcet[i]) && reference_feasible(policy, n, period, wcet, deadline))
+         found = t;
+   }
+
+   period[i] = saved;
+   deadline[i] = saved_deadline;
+   return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sensitivity benchmark
+//      * FOR RM and EDF with D=T, DM with D in [T/2, T] on 100 services, and
+//      * EDF with D in [T/2, T] on 20 services with shorter periods (near
+//      * U=1 QPA has to cover a very long busy period), at U from 0.60 to 0.95:
+//      *       time a full sensitivity report
+//      *       check every max C(i) is feasible and max C(i) + 1 is not
+//      *       check every min T(i) is feasible and min T(i) - 1 is not
+//      *       check the WCET scaling factor gives a feasible set
+//      * FOR the same four cases on small sets with short periods:
+//      *       check every max C(i) and min T(i), from the report and from
+//      *       the single margin calls, against a brute force search
+//      * Check hand picked D=T sets at U = 1 and within 2^-60 of it
+//      * Print the report for a 5 service set
+////////////////////////////////////////////////////////////////////////////////
+static int bench_sens(uint64_t seed)
+{
+   struct
+   {
+      sensitivity_policy_t policy;
+      const char *name;
+      int constrained;
+      U32_T n, min_period, max_period;
+   } runs[] = {
+      {SENSITIVITY_RM,  "RM",  FALSE, 100, 10000, 10000000},
+      {SENSITIVITY_DM,  "DM",  TRUE,  100, 10000, 10000000},
+      {SENSITIVITY_EDF, "EDF", FALSE, 100, 10000, 10000000},
+      {SENSITIVITY_EDF, "EDF", TRUE,  20,  100,   10000},
+   };
+   struct
+   {
+      const char *name;
+      U32_T n;
+      U32_T period[4], wcet[4], max_wcet[4];
+   } at_one[] = {
+      {"U = 1", 4, {4, 24, 24, 24}, {1, 7, 10, 1}, {1, 7, 10, 1}},
+      {"U = 1 - 2^-64", 2, {4294967291U, 4294967279U}, {357913941U, 3937053339U},
+                           {357913941U, 3937053339U}},
+      {"U = 1 + 2^-64", 2, {4294967291U, 4294967279U}, {3937053350U, 357913940U},
+                           {3937053349U, 357913939U}},
+   };
+   U32_T num_sets = 8, num_small = 500;
+   U32_T period[100], wcet[100], deadline[100], max_wcet[100], min_period[100], scaled[100];
+   U32_T single[100], expect;
+   U32_T n, s, i, k, saved, saved_deadline;
+   double util, usec, worst_usec;
+   uint64_t calls, pruned;
+   int errors = 0, mismatches;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+   sensitivity_t report;
+
+   taskgen_seed(&rng, seed);
+
+   printf("%6s %6s %8s %6s %14s %14s %12s %12s\n", "policy", "D", "services", "sets",
+          "avg msec/set", "max msec/set", "exact tests", "pruned");
+
+   for (k = 0; k < sizeof(runs) / sizeof(runs[0]); k++)
+   {
+      n = runs[k].n;
+      usec = 0.0; worst_usec = 0.0; calls = 0; pruned = 0;
+
+      for (s = 0; s < num_sets; s++)
+      {
+         util = 0.60 + 0.35 * (double)s / (double)(num_sets - 1);
+         taskgen_generate(&rng, n, util, runs[k].min_period, runs[k].max_period, period, wcet, deadline);
+
+         if (runs[k].constrained)
+         {
+            for (i = 0; i < n; i++)
+            {
+               deadline[i] = period[i] / 2 + (U32_T)(taskgen_uniform(&rng) * (double)(period[i] / 2));
+               if (deadline[i] < wcet[i])
+                  deadline[i] = wcet[i];
+            }
+         }
+
+         report.max_wcet = max_wcet;
+         report.min_period = min_period;
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         sensitivity_report(runs[k].policy, n, period, wcet, deadline, &report);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         usec += elapsed_usec(&start, &stop);
+         if (elapsed_usec(&start, &stop) > worst_usec)
+            worst_usec = elapsed_usec(&start, &stop);
+         calls += report.oracle_calls;
+         pruned += report.pruned;
+
+         for (i = 0; i < n; i++)
+         {
+            saved = wcet[i];
+            if (max_wcet[i] != 0)
+            {
+               wcet[i] = max_wcet[i];
+               errors += !reference_feasible(runs[k].policy, n, period, wcet, deadline);
+            }
+            wcet[i] = max_wcet[i] + 1;
+            errors += reference_feasible(runs[k].policy, n, period, wcet, deadline);
+            wcet[i] = saved;
+
+            saved = period[i]; saved_deadline = deadline[i];
+            if (min_period[i] != 0)
+            {
+               period[i] = min_period[i];
+               if (saved_deadline == saved)
+                  deadline[i] = period[i];
+               errors += !reference_feasible(runs[k].policy, n, period, wcet, deadline);
+
+               // one less is either infeasible or below a bound the search
+               // never goes under
+               period[i] = min_period[i] - 1;
+               if (saved_deadline == saved)
+                  deadline[i] = period[i];
+               if ((period[i] >= wcet[i]) && (period[i] >= deadline[i]))
+                  errors += reference_feasible(runs[k].policy, n, period, wcet, deadline);
+            }
+            period[i] = saved; deadline[i] = saved_deadline;
+         }
+
+         for (i = 0; i < n; i++)
+            scaled[i] = (U32_T)ceil(report.wcet_scale * (double)wcet[i]);
+         if (report.wcet_scale > 0.0)
+            errors += !reference_feasible(runs[k].policy, n, period, scaled, deadline);
+      }
+
+      printf("%6s %6s %8u %6u %14.3f %14.3f %12llu %12llu\n", runs[k].name,
+             runs[k].constrained ? "<=T" : "=T", n, num_sets,
+             usec / num_sets / 1000.0, worst_usec / 1000.0,
+             (unsigned long long)(calls / num_sets), (unsigned long long)(pruned / num_sets));
+      fflush(stdout);
+   }
+
+   printf("\n%6s %6s %8s %6s %12s\n", "policy", "D", "services", "sets", "brute force");
+
+   for (k = 0; k < sizeof(runs) / sizeof(runs[0]); k++)
+   {
+      mismatches = 0;
+
+      for (s = 0; s < num_small; s++)
+      {
+         n = 2 + s % 4;
+         util = 0.50 + 0.50 * taskgen_uniform(&rng);
+         taskgen_generate(&rng, n, util, 5, 60, period, wcet, deadline);
+
+         if (runs[k].constrained)
+         {
+            for (i = 0; i < n; i++)
+            {
+               deadline[i] = period[i] / 2 + (U32_T)(taskgen_uniform(&rng) * (double)(period[i] / 2));
+               if (deadline[i] < wcet[i])
+                  deadline[i] = wcet[i];
+            }
+         }
+
+         report.max_wcet = max_wcet;
+         report.min_period = min_period;
+         sensitivity_report(runs[k].policy, n, period, wcet, deadline, &report);
+         sensitivity_max_wcet(runs[k].policy, n, period, wcet, deadline, scaled);
+         sensitivity_min_period(runs[k].policy, n, period, wcet, deadline, single);
+
+         for (i = 0; i < n; i++)
+         {
+            expect = brute_max_wcet(runs[k].policy, n, period, wcet, deadline, i);
+            mismatches += (max_wcet[i] != expect) + (scaled[i] != expect);
+
+            // past the limit the search may still find a (very long) period
+            expect = brute_min_period(runs[k].policy, n, period, wcet, deadline, i, 4096);
+            if ((expect != 0) || (min_period[i] <= 4096))
+               mismatches += (min_period[i] != expect);
+            if ((expect != 0) || (single[i] <= 4096))
+               mismatches += (single[i] != expect);
+         }
+      }
+
+      printf("%6s %6s %8s %6u %12d\n", runs[k].name, runs[k].constrained ? "<=T" : "=T",
+             "2-5", num_small, mismatches);
+      errors += mismatches;
+   }
+
+   // U exactly 1 sums to just above 1 in double, and the two sets with
+   // 4294967291 * 4294967279 +- 1 in the numerator round to exactly 1
+   for (k = 0; k < sizeof(at_one) / sizeof(at_one[0]); k++)
+   {
+      n = at_one[k].n;
+      memcpy(period, at_one[k].period, n * sizeof(U32_T));
+      memcpy(deadline, at_one[k].period, n * sizeof(U32_T));
+      memcpy(wcet, at_one[k].wcet, n * sizeof(U32_T));
+
+      sensitivity_max_wcet(SENSITIVITY_EDF, n, period, wcet, deadline, max_wcet);
+      for (i = 0; i < n; i++)
+      {
+         if (max_wcet[i] != at_one[k].max_wcet[i])
+         {
+            printf("ERROR: %s: max C(%u) = %u, expected %u\n", at_one[k].name, i + 1,
+                   max_wcet[i], at_one[k].max_wcet[i]);
+            errors++;
+         }
+      }
+   }
+
+   if (errors)
+      printf("ERROR: %d sensitivity results failed the reference check\n", errors);
+
+   printf("\nRM sensitivity of a 5 service set\n");
+   taskgen_generate(&rng, 5, 0.80, 10, 1000, period, wcet, deadline);
+   report.max_wcet = max_wcet;
+   report.min_period = min_period;
+   sensitivity_report(SENSITIVITY_RM, 5, period, wcet, deadline, &report);
+   sensitivity_print(stdout, 5, period, wcet, deadline, &report);
+
+   return errors ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Wide time domain benchmark
+//      * Run every RM and EDF test on hand picked sets whose hyperperiod is
+//      * past the old 65535 tick window or 64 bits, or whose demand sums
+//      * wrap in 32 bits, and check each against the known answer
+//      * FOR a sweep of sets with periods from 1 msec to 100 sec in usec:
+//      *       check every test against RTA (RM) and U <= 1 (EDF, D=T)
+////////////////////////////////////////////////////////////////////////////////
+typedef struct
+{
+   const char *name;
+   U32_T n;
+   U32_T period[8];
+   U32_T wcet[8];
+   int rm;
+   int edf;
+} wide_case_t;
+
+// runs every test of both families on an RM ordered D=T set, returns the
+// number that disagree with the expected answers
+static int wide_check(const char *name, U32_T n, U32_T period[], U32_T wcet[], int rm, int edf, taskset_t *ts, int print)
+{
+   int (*rm_tests[])(U32_T, U32_T[], U32_T[], U32_T[]) = {completion_time_feasibility, response_time_feasibility,
+      scheduling_point_feasibility, reduced_scheduling_point_feasibility, sim_rm_feasibility};
+   const char *rm_names[] = {"CTF", "RTA", "SPF", "reduced SPF", "event RM", "SoA RTA"};
+   int (*edf_tests[])(U32_T, U32_T[], U32_T[], U32_T[]) = {earliest_deadline_first, least_laxity_first,
+      edf_qpa_feasibility, sim_edf_feasibility, sim_llf_feasibility};
+   const char *edf_names[] = {"tick EDF", "tick LLF", "QPA", "event EDF", "event LLF"};
+   U32_T k, num_rm = sizeof(rm_tests) / sizeof(rm_tests[0]), num_edf = sizeof(edf_tests) / sizeof(edf_tests[0]);
+   uint64_t hyper = hyperperiod(n, period);
+   int errors = 0, result;
+   struct timespec start, stop;
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+
+   for (k = 0; k <= num_rm; k++)
+   {
+      if (k < num_rm)
+         result = rm_tests[k](n, period, wcet, period);
+      else
+      {
+         taskset_load(ts, n, period, wcet, period);
+         result = taskset_response_time_analysis(ts, NULL);
+      }
+
+      if (result != rm)
+      {
+         printf("ERROR: %s: %s says %s\n", name, rm_names[k], result ? "FEASIBLE" : "INFEASIBLE");
+         errors++;
+      }
+   }
+
+   for (k = 0; k < num_edf; k++)
+   {
+      if ((result = edf_tests[k](n, period, wcet, period)) != edf)
+      {
+         printf("ERROR: %s: %s says %s\n", name, edf_names[k], result ? "FEASIBLE" : "INFEASIBLE");
+         errors++;
+      }
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &stop);
+
+   if (print)
+   {
+      if (hyper == 0)
+         printf("%-24s %22s", name, "> 2^64");
+      else
+         printf("%-24s %22llu", name, (unsigned long long)hyper);
+      printf(" %10s %10s %12.2f\n", rm ? "FEASIBLE" : "INFEASIBLE", edf ? "FEASIBLE" : "INFEASIBLE",
+             elapsed_usec(&start, &stop));
+      fflush(stdout);
+   }
+
+   return errors;
+}
+
+static int bench_wide(uint64_t seed)
+{
+   wide_case_t cases[] =
+   {
+      // Q3 seqgen at nsec resolution (see the sim benchmark), hyperperiod
+      // 0.1 sec = 100 million ticks
+      {"seqgen Q3 nsec", 8, {333333, 3333330, 9999990, 9999990, 9999990, 19999980, 19999980, 99999900},
+                            {20000, 500000, 1000000, 1000000, 1000000, 2000000, 2000000, 5000000}, TRUE, TRUE},
+      // 3 kHz sequencer plus 100, 20 and 10 Hz services in usec
+      {"3 kHz + 10 Hz usec", 4, {333, 10000, 50000, 100000}, {100, 2000, 10000, 20000}, TRUE, TRUE},
+      // a miss at t=99999, past the end of the old 65535 tick window
+      {"late miss", 2, {3, 99999}, {1, 66667}, FALSE, FALSE},
+      // one tick over U = 1 with a hyperperiod of 3 * 2^19 ticks, past the
+      // simulation limit
+      {"U>1 long hyperperiod", 2, {3, 3 << 19}, {1, (2 << 19) + 1}, FALSE, FALSE},
+      // coprime periods near 2^32, hyperperiod far past 2^64
+      {"coprime nsec", 3, {4294967291U, 4294967279U, 4294967231U}, {1000000000, 1000000000, 1000000000}, TRUE, TRUE},
+      // two 3 sec jobs in 4 sec: C(1) + C(2) wraps to 1.7 sec in 32 bits
+      {"32 bit wrap", 2, {4000000000U, 4000000000U}, {3000000000U, 3000000000U}, FALSE, FALSE},
+      // 4.3 million preemptions of 999 ticks each: ceil(D/T)*C plus the
+      // 10 msec WCET wraps to a few hundred msec in 32 bits
+      {"demand wrap", 2, {1000, 4294967295U}, {999, 10000000}, FALSE, FALSE},
+   };
+   U32_T num_cases = sizeof(cases) / sizeof(cases[0]);
+   U32_T sizes[] = {5, 10, 20};
+   U32_T num_sets = 100;
+   U32_T period[20], wcet[20], deadline[20];
+   U32_T n, s, k, i;
+   int errors = 0, rm, edf;
+   double util, usec;
+   char name[32];
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+   taskset_t ts;
+
+   if (taskset_init(&ts, 20) < 0)
+      return -1;
+
+   printf("%-24s %22s %10s %10s %12s\n", "set", "hyperperiod", "RM", "EDF", "usec");
+
+   for (k = 0; k < num_cases; k++)
+      errors += wide_check(cases[k].name, cases[k].n, cases[k].period, cases[k].wcet, cases[k].rm, cases[k].edf, &ts, TRUE);
+
+   taskgen_seed(&rng, seed);
+
+   printf("\n%8s %6s %14s %9s %9s\n", "services", "sets", "usec/set", "RM", "EDF");
+
+   for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+   {
+      n = sizes[k];
+      usec = 0.0; rm = 0; edf = 0;
+
+      for (s = 0; s < num_sets; s++)
+      {
+         // sweep U from 0.5 to 1.05 over the sets
+         taskgen_generate(&rng, n, 0.5 + 0.55 * (double)s / (double)(num_sets - 1), 1000, 100000000, period, wcet, deadline);
+
+         util = 0.0;
+         for (i = 0; i < n; i++)
+            util += (double)wcet[i] / (double)period[i];
+
+         snprintf(name, sizeof(name), "set %u/%u", n, s);
+
+         clock_gettime(CLOCK_MONOTONIC, &start);
+         errors += wide_check(name, n, period, wcet, response_time_feasibility(n, period, wcet, period),
+                              (util <= 1.0) ? TRUE : FALSE, &ts, FALSE);
+         clock_gettime(CLOCK_MONOTONIC, &stop);
+         usec += elapsed_usec(&start, &stop);
+
+         rm += response_time_feasibility(n, period, wcet, period);
+         edf += (util <= 1.0);
+      }
+
+      printf("%8u %6u %14.2f %4u/%-4u %4u/%-4u\n", n, num_sets, usec / num_sets, rm, num_sets, edf, num_sets);
+      fflush(stdout);
+   }
+
+   taskset_free(&ts);
+
+   if (errors)
+      printf("ERROR: %d decisions disagree with the expected answer\n", errors);
+
+   return errors ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Partitioning benchmark
+//      * FOR RM and EDF with D=T and DM and EDF with D in [T/2, T], at total
+//      * U of 0.70 and 0.90 per core, 10,000 services on 64 cores:
+//      *       time first, best and worst fit decreasing
+//      *       check every core against the exact test on its own
+//      * Print the 4 core partition and core map of the Q3 seqgen set
+////////////////////////////////////////////////////////////////////////////////
+
+// Reruns the exact uniprocessor test on every core from scratch, returns
+// the number of cores that fail it.
+static int partition_check(partition_policy_t policy, U32_T numCores, U32_T n, U32_T period[],
+                           U32_T wcet[], U32_T deadline[], const partition_t *part)
+{
+   U32_T *p = malloc(n * sizeof(U32_T)), *c = malloc(n * sizeof(U32_T)), *d = malloc(n * sizeof(U32_T));
+   U32_T core, i, j, m, key;
+   int bad = 0;
+
+   if (!p || !c || !d)
+   {
+      free(p); free(c); free(d);
+      return -1;
+   }
+
+   for (core = 0; core < numCores; core++)
+   {
+      // stable insertion sort by period (RM) or deadline (DM)
+      for (i = 0, m = 0; i < n; i++)
+      {
+         if (part->core[i] != core)
+            continue;
+
+         key = (policy == PARTITION_RM) ? period[i] : deadline[i];
+         for (j = m; (policy != PARTITION_EDF) && (j > 0) &&
+                     (((policy == PARTITION_RM) ? p[j - 1] : d[j - 1]) > key); j--)
+         {
+            p[j] = p[j - 1]; c[j] = c[j - 1]; d[j] = d[j - 1];
+         }
+         p[j] = period[i]; c[j] = wcet[i]; d[j] = deadline[i];
+         m++;
+      }
+
+      // an idle core has no busy period for QPA to search
+      if (m == 0)
+         continue;
+
+      if (policy == PARTITION_EDF)
+         bad += !edf_qpa_feasibility(m, p, c, d);
+      else
+         bad += !response_time_feasibility(m, p, c, d);
+   }
+
+   for (i = 0; i < n; i++)
+      bad += (part->core[i] != PARTITION_NONE) && (part->core[i] >= numCores);
+
+   free(p); free(c); free(d);
+   return bad;
+}
+
+static int bench_part(uint64_t seed)
+{
+   struct
+   {
+      partition_policy_t policy;
+      int constrained;
+   } runs[] = {
+      {PARTITION_RM,  FALSE},
+      {PARTITION_DM,  TRUE},
+      {PARTITION_EDF, FALSE},
+      {PARTITION_EDF, TRUE},
+   };
+   partition_fit_t fits[] = {PARTITION_FIRST_FIT, PARTITION_BEST_FIT, PARTITION_WORST_FIT};
+   double utils[] = {0.70, 0.90};
+   U32_T n = 10000, cores = 64;
+   U32_T *period = malloc(n * sizeof(U32_T)), *wcet = malloc(n * sizeof(U32_T));
+   U32_T *deadline = malloc(n * sizeof(U32_T)), *core = malloc(n * sizeof(U32_T));
+   U32_T i, k, u, f;
+   int errors = 0, bad;
+   struct timespec start, stop;
+   double msec, slowest = 0.0;
+   taskgen_rng_t rng;
+   partition_t part;
+
+   // Q3 seqgen set from the sim benchmark, ns
+   U32_T seq_period[] = {333333, 3333330, 9999990, 9999990, 9999990, 19999980, 19999980, 99999900};
+   U32_T seq_wcet[]   = {20000, 500000, 1000000, 1000000, 1000000, 2000000, 2000000, 5000000};
+   U32_T seq_n = sizeof(seq_period) / sizeof(seq_period[0]);
+
+   if (!period || !wcet || !deadline || !core)
+   {
+      free(period); free(wcet); free(deadline); free(core);
+      return -1;
+   }
+
+   part.core = core;
+   taskgen_seed(&rng, seed);
+
+   printf("%u services on %u cores\n", n, cores);
+   printf("%6s %6s %6s %10s %12s %10s %12s %12s\n", "policy", "D", "U/core", "fit", "msec", "unplaced",
+          "exact tests", "pruned");
+
+   for (k = 0; k < sizeof(runs) / sizeof(runs[0]); k++)
+   {
+      for (u = 0; u < sizeof(utils) / sizeof(utils[0]); u++)
+      {
+         taskgen_generate(&rng, n, utils[u] * (double)cores, 1000, 1000000, period, wcet, deadline);
+
+         // UUniFast over 64 cores worth of utilization can hand one service
+         // more than a core; cap those at one whole core
+         for (i = 0; i < n; i++)
+         {
+            if (wcet[i] > period[i])
+               wcet[i] = period[i];
+            if (runs[k].constrained)
+               deadline[i] = period[i] / 2 + (U32_T)(taskgen_uniform(&rng) * (double)(period[i] / 2));
+            if (deadline[i] < wcet[i])
+               deadline[i] = wcet[i];
+         }
+
+         for (f = 0; f < sizeof(fits) / sizeof(fits[0]); f++)
+         {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            if (partition_services(runs[k].policy, fits[f], cores, n, period, wcet, deadline, &part) < 0)
+            {
+               printf("ERROR: out of memory\n");
+               return -1;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &stop);
+            msec = elapsed_usec(&start, &stop) / 1000.0;
+            if (msec > slowest)
+               slowest = msec;
+
+            bad = partition_check(runs[k].policy, cores, n, period, wcet, deadline, &part);
+            if (bad)
+               printf("ERROR: %d cores of the %s %s partition fail the exact test\n", bad,
+                      partition_policy_name(runs[k].policy), partition_fit_name(fits[f]));
+            errors += bad;
+
+            printf("%6s %6s %6.2f %10s %12.3f %10u %12llu %12llu\n", partition_policy_name(runs[k].policy),
+                   runs[k].constrained ? "<=T" : "=T", utils[u], partition_fit_name(fits[f]),
+                   msec, part.unassigned,
+                   (unsigned long long)part.exact_tests, (unsigned long long)part.pruned);
+            fflush(stdout);
+         }
+      }
+   }
+
+   printf("slowest partition %.3f msec, target %d msec%s\n", slowest, PART_TARGET_MSEC,
+          (slowest < PART_TARGET_MSEC) ? "" : " (MISSED)");
+
+   printf("\nQ3 seqgen service set, RM worst fit decreasing on 4 cores\n");
+   partition_services(PARTITION_RM, PARTITION_WORST_FIT, 4, seq_n, seq_period, seq_wcet, seq_period, &part);
+   errors += partition_check(PARTITION_RM, 4, seq_n, seq_period, seq_wcet, seq_period, &part);
+   partition_print(stdout, 4, seq_n, seq_period, seq_wcet, &part);
+   printf("\n");
+   partition_print_affinity(stdout, 4, seq_n, &part);
+
+   free(period); free(wcet); free(deadline); free(core);
+
+   if (errors)
+      printf("ERROR: %d partition checks failed\n", errors);
+
+   return errors ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Global vs partitioned benchmark
+//      * FOR 1, 2, 4 and 8 cores, and total U from 0.3 to 0.9 per core:
+//      *       generate 200 sets of 5 services per core with D = T, and
+//      *       200 with D in [T/2, T], periods in [10, 1000], no service
+//      *       over one whole core
+//      *       time G-EDF GFB and BAK, G-RM RTA-LC, and first fit
+//      *       partitioning under RM and EDF
+//      *       print the share of sets each test accepts
+//      *       check that no test accepts a set with U above the core
+//      *       count, and that on one core every accepted set passes the
+//      *       exact uniprocessor test
+//      * check a set that only BAK accepts
+//
+// With D = T the two G-EDF tests accept the same sets in every row.  With
+// D <= T they part ways: BAK charges every (T(i) - D(i)) against the
+// shortest deadlines, so it takes far fewer of these sets, but it is not
+// dominated, since one heavy service with D = T can sink the GFB density
+// bound on its own, as in the fixed set.
+////////////////////////////////////////////////////////////////////////////////
+static int bench_global(uint64_t seed)
+{
+   enum {GFB, BAK, RTA_LC, P_RM, P_EDF, NUM_TESTS};
+   const char *names[NUM_TESTS] = {"GFB", "BAK", "RTA-LC", "P-RM", "P-EDF"};
+   U32_T cores[] = {1, 2, 4, 8};
+   double utils[] = {0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9};
+   U32_T num_sets = 200, max_n = 40;
+   U32_T period[40], wcet[40], deadline[40], core[40];
+   U32_T accepted[NUM_TESTS], c, u, s, i, t, m, n, constrained;
+   double usec[NUM_TESTS], total_util;
+   int result[NUM_TESTS], errors = 0;
+   struct timespec start, stop;
+   taskgen_rng_t rng;
+   partition_t part;
+
+   // 2 cores, density 1.206 against the GFB bound 2 - 12/14 = 1.143
+   U32_T bak_period[] = {16, 14, 18}, bak_wcet[] = {1, 12, 2}, bak_deadline[] = {6, 14, 11};
+
+   taskgen_seed(&rng, seed);
+   part.core = core;
+
+   result[GFB] = global_edf_gfb(2, 3, bak_period, bak_wcet, bak_deadline);
+   result[BAK] = global_edf_bak(2, 3, bak_period, bak_wcet, bak_deadline);
+   printf("2 cores, C/T/D 1/16/6 12/14/14 2/18/11: GFB %s, BAK %s\n\n", result[GFB] ? "accepts" : "rejects",
+          result[BAK] ? "accepts" : "rejects");
+   if (result[GFB] || !result[BAK])
+   {
+      printf("ERROR: expected GFB to reject and BAK to accept\n");
+      errors++;
+   }
+
+   printf("%5s %5s %4s", "cores", "U/m", "D");
+   for (t = 0; t < NUM_TESTS; t++)
+      printf(" %7s", names[t]);
+   printf("   usec/set:");
+   for (t = 0; t < NUM_TESTS; t++)
+      printf(" %7s", names[t]);
+   printf("\n");
+
+   for (c = 0; c < sizeof(cores) / sizeof(cores[0]); c++)
+   {
+      m = cores[c];
+      n = 5 * m;
+      if (n > max_n)
+         n = max_n;
+
+      for (constrained = FALSE; constrained <= TRUE; constrained++)
+      {
+         for (u = 0; u < sizeof(utils) / sizeof(utils[0]); u++)
+         {
+            for (t = 0; t < NUM_TESTS; t++)
+            {
+               accepted[t] = 0;
+               usec[t] = 0.0;
+            }
+
+            for (s = 0; s < num_sets; s++)
+            {
+               taskgen_generate(&rng, n, utils[u] * (double)m, 10, 1000, period, wcet, deadline);
+
+               total_util = 0.0;
+               for (i = 0; i < n; i++)
+               {
+                  if (wcet[i] > period[i])
+                     wcet[i] = period[i];
+                  if (constrained)
+                     deadline[i] = period[i] / 2 + (U32_T)(taskgen_uniform(&rng) * (double)(period[i] / 2));
+                  if (deadline[i] < wcet[i])
+                     deadline[i] = wcet[i];
+                  total_util += (double)wcet[i] / (double)period[i];
+               }
+
+               for (t = 0; t < NUM_TESTS; t++)
+               {
+                  clock_gettime(CLOCK_MONOTONIC, &start);
+                  switch (t)
+                  {
+                     case GFB:
+                        result[t] = global_edf_gfb(m, n, period, wcet, deadline);
+                        break;
+                     case BAK:
+                        result[t] = global_edf_bak(m, n, period, wcet, deadline);
+                        break;
+                     case RTA_LC:
+                        result[t] = global_fp_rta_lc(m, n, period, wcet, deadline);
+                        break;
+                     case P_RM:
+                        result[t] = (partition_services(PARTITION_RM, PARTITION_FIRST_FIT, m, n, period, wcet,
+                                                        deadline, &part) == 0);
+                        break;
+                     default:
+                        result[t] = (partition_services(PARTITION_EDF, PARTITION_FIRST_FIT, m, n, period, wcet,
+                                                        deadline, &part) == 0);
+                        break;
+                  }
+                  clock_gettime(CLOCK_MONOTONIC, &stop);
+                  usec[t] += elapsed_usec(&start, &stop);
+
+                  if (result[t])
+                     accepted[t]++;
+
+                  if (result[t] && (total_util > (double)m + 1e-9))
+                  {
+                     printf("ERROR: %s accepts a set with U=%.4f on %u cores\n", names[t], total_util, m);
+                     errors++;
+                  }
+               }
+
+               // on one core the global tests must not be more optimistic
+               // than the exact ones
+               if ((m == 1) && ((result[GFB] || result[BAK]) && !edf_qpa_feasibility(n, period, wcet, deadline)))
+               {
+                  printf("ERROR: a G-EDF bound accepts a set uniprocessor EDF misses\n");
+                  errors++;
+               }
+               if ((m == 1) && result[RTA_LC] && !response_time_feasibility(n, period, wcet, deadline))
+               {
+                  printf("ERROR: RTA-LC accepts a set uniprocessor RTA misses\n");
+                  errors++;
+               }
+            }
+
+            printf("%5u %5.2f %4s", m, utils[u], constrained ? "<=T" : "=T");
+            for (t = 0; t < NUM_TESTS; t++)
+               printf(" %6.1f%%", 100.0 * (double)accepted[t] / (double)num_sets);
+            printf("            ");
+            for (t = 0; t < NUM_TESTS; t++)
+               printf(" %7.2f", usec[t] / num_sets);
+            printf("\n");
+            fflush(stdout);
+         }
+      }
+   }
+
+   return errors ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+   uint64_t seed = 5623;
+
+   if (argc < 2)
+   {
+      usage(argv[0]);
+      return -1;
+   }
+
+   if (argc > 2)
+      seed = strtoull(argv[2], NULL, 0);
+
+   if (strcmp(argv[1], "rta") == 0)
+      return bench_rta(seed);
+   if (strcmp(argv[1], "qpa") == 0)
+      return bench_qpa(seed);
+   if (strcmp(argv[1], "sim") == 0)
+      return bench_sim(seed);
+   if (strcmp(argv[1], "simd") == 0)
+      return bench_simd(seed);
+   if (strcmp(argv[1], "spf") == 0)
+      return bench_spf(seed);
+   if (strcmp(argv[1], "sens") == 0)
+      return bench_sens(seed);
+   if (strcmp(argv[1], "wide") == 0)
+      return bench_wide(seed);
+   if (strcmp(argv[1], "part") == 0)
+      return bench_part(seed);
+   if (strcmp(argv[1], "global") == 0)
+      return bench_global(seed);
+
+   usage(argv[0]);
+   return -1;
+}
@@ -52,9 +52,11 @@
 #include <stdio.h>
 #include <stdint.h>
 
-#define TRUE 1
-#define FALSE 0
-#define U32_T unsigned int
+#include "feasibility.h"
+#include "rta.h"
+#include "qpa.h"
+#include "sched_sim.h"
+#include "spf.h"
 
 // U=0.7333
 U32_T ex0_period[] = {2, 10, 15};
@@ -96,14 +98,6 @@ U32_T ex8_wcet[] = {1, 1, 1, 2};
 U32_T ex9_period[] = {6, 8, 12, 24};
 U32_T ex9_wcet[] = {1, 2, 4, 6};
 
-// function declerations
-int completion_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
-int scheduling_point_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
-int rate_monotonic_least_upper_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
-int least_laxity_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
-int earliest_deadline_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
-int deadline_monotonic(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
-
 void run_feasibility_test(
 	U32_T numServices, 
 	U32_T period[], 
@@ -176,6 +170,19 @@ void run_feasibility_test(
 			printf("CTF   : INFEASIBLE\n");
 	}
 
+   // worst case response time of each service, highest priority first
+   {
+      U32_T response[numServices];
+
+      if(response_time_analysis(numServices, period, wcet, period, response) == TRUE)
+         printf("RTA   : FEASIBLE   R=");
+      else
+         printf("RTA   : INFEASIBLE R=");
+
+      for(int idx = 0; idx < numServices; idx++)
+         printf("%u%s", response[idx], (idx < numServices-1) ? ", " : "\n");
+   }
+
 
 	if(SPF != NULL)
 	{
@@ -225,338 +232,45 @@ int main(void)
    
     // EX 0
     numServices = 3;
-    run_feasibility_test(numServices, ex0_period, ex0_wcet, ex0_period, 0, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex0_period, ex0_wcet, ex0_period, 0, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     // EX 1
     numServices = 3;
-    run_feasibility_test(numServices, ex1_period, ex1_wcet, ex1_period, 1, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex1_period, ex1_wcet, ex1_period, 1, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     // EX 2
     numServices = 4;
-    run_feasibility_test(numServices, ex2_period, ex2_wcet, ex1_period, 2, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex2_period, ex2_wcet, ex1_period, 2, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     // EX 3
     numServices = 3;
-    run_feasibility_test(numServices, ex3_period, ex3_wcet, ex3_period, 3, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex3_period, ex3_wcet, ex3_period, 3, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     // EX 4
     numServices = 3;
-    run_feasibility_test(numServices, ex4_period, ex4_wcet, ex4_period, 4, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex4_period, ex4_wcet, ex4_period, 4, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     // EX 5
     numServices = 3;
-    run_feasibility_test(numServices, ex5_period, ex5_wcet, ex5_period, 5, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex5_period, ex5_wcet, ex5_period, 5, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
     
     // EX 6
     numServices = 4;
-    run_feasibility_test(numServices, ex6_period, ex6_wcet, ex6_period, 6, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex6_period, ex6_wcet, ex6_period, 6, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     // EX 7
     numServices = 3;
-    run_feasibility_test(numServices, ex7_period, ex7_wcet, ex7_period, 7, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex7_period, ex7_wcet, ex7_period, 7, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
     
     // EX 8
     numServices = 4;
-    run_feasibility_test(numServices, ex8_period, ex8_wcet, ex4_period, 8, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex8_period, ex8_wcet, ex4_period, 8, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
     //run_feasibility_test(numServices, ex8_period, ex8_wcet, ex4_period, 8, NULL, NULL, NULL, least_laxity_first);
     
     // EX 9
     numServices = 4;
-    run_feasibility_test(numServices, ex9_period, ex9_wcet, ex4_period, 9, completion_time_feasibility, rate_monotonic_least_upper_bound, scheduling_point_feasibility, least_laxity_first, earliest_deadline_first, deadline_monotonic);
+    run_feasibility_test(numServices, ex9_period, ex9_wcet, ex4_period, 9, completion_time_feasibility, rate_monotonic_least_upper_bound, reduced_scheduling_point_feasibility, sim_llf_feasibility, edf_qpa_feasibility, deadline_monotonic);
 
     printf("\n\n");
 
 }
-
-
-int rate_monotonic_least_upper_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
-{
-  double utility_sum=0.0, lub=0.0;
-  int idx;
-
-  // Sum the C(i) over the T(i)
-  for(idx=0; idx < numServices; idx++)
-  {
-    utility_sum += ((double)wcet[idx] / (double)period[idx]);
-    printf("for %d, wcet=%lf, period=%lf, utility_sum = %lf\n", idx, (double)wcet[idx], (double)period[idx], utility_sum);
-  }
-
-  // Compute LUB for number of services
-  lub = (double)numServices * (pow(2.0, (1.0/((double)numServices))) - 1.0);
-  
-  
-  // print stuff
-  printf("===LUB STATS===\n");
-  printf("For %d, Utility_sum = %lf\n", numServices, utility_sum);
-  printf("LUB = %lf\n", lub);
-
-  // Compare the utilty to the bound and return feasibility
-  if(utility_sum <= lub)
-	  return TRUE;
-  else
-	  return FALSE;
-}
-
-int completion_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
-{
-  int i, j;
-  U32_T an, anext;
-  
-  // assume feasible until we find otherwise
-  int set_feasible=TRUE;
-   
-  //printf("numServices=%d\n", numServices);
- 
-  // For all services in the analysis 
-  for (i=0; i < numServices; i++)
-  {
-       an=0; anext=0;
-       
-       for (j=0; j <= i; j++)
-       {
-           an+=wcet[j];
-       }
-       
-	   //printf("i=%d, an=%d\n", i, an);
-
-       while(1)
-       {
-             anext=wcet[i];
-	     
-             for (j=0; j < i; j++)
-                 anext += ceil(((double)an)/((double)period[j]))*wcet[j];
-		 
-             if (anext == an)
-                break;
-             else
-                an=anext;
-
-			 //printf("an=%d, anext=%d\n", an, anext);
-       }
-       
-	   //printf("an=%d, deadline[%d]=%d\n", an, i, deadline[i]);
-
-       if (an > deadline[i])
-       {
-          set_feasible=FALSE;
-       }
-  }
-  
-  return set_feasible;
-}
-
-int scheduling_point_feasibility(U32_T numServices, U32_T period[], 
-				 U32_T wcet[], U32_T deadline[])
-{
-   int rc = TRUE, i, j, k, l, status, temp;
-
-   // For all services in the analysis
-   for (i=0; i < numServices; i++) // iterate from highest to lowest priority
-   {
-      status=0;
-
-      // Look for all available CPU minus what has been used by higher priority services
-      for (k=0; k<=i; k++) 
-      {
-	  // find available CPU windows and take them
-          for (l=1; l <= (floor((double)period[i]/(double)period[k])); l++)
-          {
-               temp=0;
-
-               for (j=0; j<=i; j++) temp += wcet[j] * ceil((double)l*(double)period[k]/(double)period[j]);
-
-	       // Can we get the CPU we need or not?
-               if (temp <= (l*period[k]))
-			   {
-				   // insufficient CPU during our period, therefore infeasible
-				   status=1;
-				   break;
-			   }
-           }
-           if (status) break;
-      }
-
-      if (!status) rc=FALSE;
-   }
-   return rc;
-}
-
-int earliest_deadline_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
-{
-   // variable declerations
-   int ed_idx, ed_val_min, ed_val_current;
-   uint16_t max_tick = 0xFFFF;
-   int et_so_far[numServices];
-
-   // initialize "execution time so far" array to zero
-   for(int i = 0; i < numServices; i++)
-   {
-      et_so_far[i] = 0;
-   }
-
-   // loop for global tick simulation
-   for(int current_tick = 0; current_tick < max_tick; current_tick++)
-   {
-      ed_val_min = 0xFFFF;
-      ed_idx = -1;
-
-      //printf("@TICK=%d\n", current_tick);
-
-      // iterate through each service
-      for(int idx = 0; idx < numServices; idx++)
-      {
-         // check if the current task has completed executing. 
-         if (wcet[idx] == et_so_far[idx])
-         {
-            // if the current tick value is not evenly divisible by the current
-            // service's period then skip this task because it has already
-            // completed it's processing before it's deadline.  
-            if(current_tick % period[idx] != 0)
-            {
-               continue;
-            }
-            else
-            {
-               // otherwise, it is the start of a new period for this task, and
-               // it must start over. reset this tasks execution time counter.
-               et_so_far[idx] = 0;
-            }
-            
-         }
-
-         // calculate time until deadline
-         ed_val_current = (
-            (period[idx] - (current_tick % period[idx]))
-         );
-         
-         //printf("SERVICE_%d LAXITY=%d\n", idx+1, ll_val_current);
-
-         // if the time remaining until the deadline is less than the
-         // remaining computation time for the task, then the task will fail to
-         // meet it's deadline. 
-         if(ed_val_current < (wcet[idx] - et_so_far[idx]))
-         {
-            // printf("Failed on service %d\n", idx+1);
-            return FALSE;
-         }
-
-         // if the tasks deadline is sooner than the current minimum deadline,
-         // set its value as the new minimum.
-         if(ed_val_min > ed_val_current)
-         {
-            ed_idx = idx;
-            ed_val_min = ed_val_current;
-         }
-
-         
-      }
-      // printf("\n");
-      
-      // increment the elapsed time (time it has been able to process) for the
-      // task with least laxity. 
-      et_so_far[ed_idx] += 1;
-
-      // printf("Running task: %d @TICK=%d\n", ll_idx+1, current_tick);
-   }
-
-   return TRUE;
-}
-
-int least_laxity_first(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
-{
-   // variable declerations
-   int ll_idx, ll_val_min, ll_val_current;
-   uint16_t max_tick = 0xFFFF;
-   int et_so_far[numServices];
-
-   // initialize "execution time so far" array to zero
-   for(int i = 0; i < numServices; i++)
-   {
-      et_so_far[i] = 0;
-   }
-
-   // loop for global tick simulation
-   for(int current_tick = 0; current_tick < max_tick; current_tick++)
-   {
-      ll_val_min = 0xFFFF;
-      ll_idx = -1;
-
-      //printf("@TICK=%d\n", current_tick);
-
-      // iterate through each service
-      for(int idx = 0; idx < numServices; idx++)
-      {
-         // check if the current task has completed executing. 
-         if (wcet[idx] == et_so_far[idx])
-         {
-            // if the current tick value is not evenly divisible by the current
-            // service's period then skip this task because it has already
-            // completed it's processing before it' deadline.  
-            if(current_tick % period[idx] != 0)
-            {
-               continue;
-            }
-            else
-            {
-               // otherwise, it is the start of a new period for this task, and
-               // it must start over. reset this tasks execution time counter.
-               et_so_far[idx] = 0;
-            }
-            
-         }
-
-         // calculate lax time
-         ll_val_current = (
-            (period[idx] - (current_tick % period[idx])) - (wcet[idx] - et_so_far[idx])
-         );
-         
-         //printf("SERVICE_%d LAXITY=%d\n", idx+1, ll_val_current);
-
-         // if the laxity is negative, then the task cannot meet its deadline
-         // and therfore the set of tasks is not feasable under LLF scheduling
-         // policy. Return false in this case
-         if(ll_val_current < 0)
-         {
-            // printf("Failed on service %d\n", idx+1);
-            return FALSE;
-         }
-
-         // if the tasks least laxity is less than the current least laxity of
-         // previous calculated tasks, then save its index and ll value.
-         if(ll_val_min > ll_val_current)
-         {
-            ll_idx = idx;
-            ll_val_min = ll_val_current;
-         }
-
-         
-      }
-      // printf("\n");
-      
-      // increment the elapsed time (time it has been able to process) for the
-      // task with least laxity. 
-      et_so_far[ll_idx] += 1;
-
-      // printf("Running task: %d @TICK=%d\n", ll_idx+1, current_tick);
-   }
-
-   return TRUE;
-}
-
-int deadline_monotonic(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
-{
-  double interference;
-  double deadline_monotonic_check = 0;
-
-  for (int i = 0; i < numServices; i++) {
-        interference = 0;
-        for (int j = 0; j<=i-1; j++) {
-            interference +=  ceil(((double)(deadline[i]))/((double)period[j]))*wcet[j];
-        }
-        deadline_monotonic_check = ((double)(wcet[i]) + interference) / ((double)deadline[i]);
-
-        if (deadline_monotonic_check > 1.0) 
-            return FALSE;
-  }
-  return TRUE;
-}
\ No newline at end of file
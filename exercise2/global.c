@@ -0,0 +1,217 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Global multiprocessor scheduling tests, see global.h.
+//
+// The two G-EDF tests are closed form density and utilization bounds in
+// double precision; BAK tries every candidate lambda for every service, so
+// it is O(n^3).  RTA-LC works in whole ticks like the uniprocessor RTA:
+// the interference of service i on service k in a window of x ticks is
+//
+//    no carry-in  W_NC(i,x) = floor(x/T(i)) C(i) + min(x mod T(i), C(i))
+//    carry-in     W_CI(i,x) = floor(y/T(i)) C(i) + C(i) + a,  y = max(x - C(i), 0)
+//                 a = min(max(y mod T(i) - (T(i) - R(i)), 0), C(i) - 1)
+//
+// each capped at x - C(k) + 1, since service k runs whenever fewer than m
+// services interfere and then needs only C(k) of the window.  The iteration
+// grows from x = C(k) until it settles or passes D(k), and every step is
+// O(k log m) for picking the m - 1 largest carry-in increments.
+
+#include <stdio.h>
+
+#include "global.h"
+
+static inline U32_T clamp_u32(uint64_t t)
+{
+   return (t > UINT32_MAX) ? UINT32_MAX : (U32_T)t;
+}
+
+int global_edf_gfb(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   double density_sum = 0.0, density_max = 0.0, density;
+   U32_T i;
+
+   // a density bound, the periods are only there for the common signature
+   (void)period;
+
+   for (i = 0; i < numServices; i++)
+   {
+      density = (double)wcet[i] / (double)deadline[i];
+      density_sum += density;
+      if (density > density_max)
+         density_max = density;
+   }
+
+   // a job that cannot fit its own deadline fails on any number of cores
+   if (density_max > 1.0)
+      return FALSE;
+
+   if (density_sum <= (double)numCores - (double)(numCores - 1) * density_max)
+      return TRUE;
+   else
+      return FALSE;
+}
+
+// The sum for service k at one choice of lambda.
+static double bak_sum(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], U32_T k, double lambda)
+{
+   double u, beta, sum = 0.0;
+   U32_T i;
+
+   for (i = 0; i < numServices; i++)
+   {
+      u = (double)wcet[i] / (double)period[i];
+      beta = u * (1.0 + ((double)period[i] - (double)deadline[i]) / (double)deadline[k]);
+      if (u > lambda)
+         beta += ((double)wcet[i] - lambda * (double)period[i]) / (double)deadline[k];
+
+      sum += (beta < 1.0) ? beta : 1.0;
+   }
+
+   return sum;
+}
+
+int global_edf_bak(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   double lambda_k, lambda;
+   U32_T i, k;
+   int found;
+
+   for (k = 0; k < numServices; k++)
+   {
+      lambda_k = (double)wcet[k] / (double)deadline[k];
+      if (lambda_k > 1.0)
+         return FALSE;
+
+      // lambda may be L(k) or any utilization at or above it; a larger one
+      // drops the extra terms of the services below it but lowers the bound
+      found = (bak_sum(numServices, period, wcet, deadline, k, lambda_k) <
+               (double)numCores * (1.0 - lambda_k) + lambda_k);
+
+      for (i = 0; (i < numServices) && !found; i++)
+      {
+         lambda = (double)wcet[i] / (double)period[i];
+         if (lambda < lambda_k)
+            continue;
+
+         found = (bak_sum(numServices, period, wcet, deadline, k, lambda) <
+                  (double)numCores * (1.0 - lambda) + lambda);
+      }
+
+      if (!found)
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+// Offers v to a min-heap of the len largest values seen so far, of room
+// entries at most.  Returns the new length.
+static U32_T top_offer(uint64_t heap[], U32_T len, U32_T room, uint64_t v)
+{
+   U32_T i, child;
+   uint64_t t;
+
+   if (room == 0)
+      return 0;
+
+   if (len < room)
+   {
+      // sift up
+      for (i = len++; (i > 0) && (heap[(i - 1) / 2] > v); i = (i - 1) / 2)
+         heap[i] = heap[(i - 1) / 2];
+      heap[i] = v;
+      return len;
+   }
+
+   if (v <= heap[0])
+      return len;
+
+   // replace the smallest and sift down
+   heap[0] = v;
+   for (i = 0; (child = 2 * i + 1) < len; i = child)
+   {
+      if ((child + 1 < len) && (heap[child + 1] < heap[child]))
+         child++;
+      if (heap[i] <= heap[child])
+         break;
+
+      t = heap[i]; heap[i] = heap[child]; heap[child] = t;
+   }
+
+   return len;
+}
+
+int global_fp_response_time_analysis(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[],
+                                     U32_T deadline[], U32_T response[])
+{
+   U32_T resp[numServices];
+   uint64_t carry[(numCores > 1) ? numCores - 1 : 1];
+   uint64_t x, xnext, cap, omega, nc, ci, y, a;
+   U32_T i, k, len;
+
+   if (numCores == 0)
+      return FALSE;
+
+   for (k = 0; k < numServices; k++)
+   {
+      x = wcet[k];
+
+      // with fewer services above it than cores, service k never waits
+      while (k >= numCores)
+      {
+         cap = x - wcet[k] + 1;
+         omega = 0;
+         len = 0;
+
+         for (i = 0; i < k; i++)
+         {
+            nc = t64_add((x / period[i]) * wcet[i], ((x % period[i]) < wcet[i]) ? (x % period[i]) : wcet[i]);
+
+            y = (x > wcet[i]) ? x - wcet[i] : 0;
+            a = ((y % period[i]) > (period[i] - resp[i])) ? (y % period[i]) - (period[i] - resp[i]) : 0;
+            if (a + 1 > wcet[i])
+               a = (wcet[i] > 0) ? wcet[i] - 1 : 0;
+            ci = t64_add(t64_add((y / period[i]) * wcet[i], wcet[i]), a);
+
+            if (nc > cap)
+               nc = cap;
+            if (ci > cap)
+               ci = cap;
+
+            omega = t64_add(omega, nc);
+            if (ci > nc)
+               len = top_offer(carry, len, numCores - 1, ci - nc);
+         }
+
+         for (i = 0; i < len; i++)
+            omega = t64_add(omega, carry[i]);
+
+         xnext = omega / numCores + wcet[k];
+         if (xnext == x)
+            break;
+
+         x = xnext;
+
+         // the iterates only grow, so one past the deadline is a miss
+         if (x > deadline[k])
+            break;
+      }
+
+      resp[k] = clamp_u32(x);
+      if (response != NULL)
+         response[k] = resp[k];
+
+      // the carry-in bound of every lower priority service assumes R(k) <= T(k)
+      if (x > deadline[k])
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+int global_fp_rta_lc(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return global_fp_response_time_analysis(numCores, numServices, period, wcet, deadline, NULL);
+}
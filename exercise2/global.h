@@ -0,0 +1,47 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Global multiprocessor scheduling tests: services are not pinned, and at
+// any time the numCores highest priority ready jobs run, wherever they were
+// running before.  All of these are sufficient tests only.  Deadlines must
+// not exceed periods.
+
+#ifndef GLOBAL_H
+#define GLOBAL_H
+
+#include "feasibility.h"
+
+// G-EDF density bound of Goossens, Funk and Baruah (2003), in the
+// constrained deadline form: sum(C(i)/D(i)) <= m - (m - 1) max(C(i)/D(i)).
+int global_edf_gfb(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// G-EDF test of Baker (2003), in the form of Bertogna, Cirinei and Lipari
+// (2005): with L(k) = C(k)/D(k), every service k needs some lambda in
+// {L(k)} and the utilizations U(i) >= L(k) for which
+//
+//    sum(min(1, B(k,i))) < m(1 - lambda) + lambda
+//
+//    B(k,i) = U(i)(1 + (T(i) - D(i))/D(k)) [+ (C(i) - lambda T(i))/D(k) if U(i) > lambda]
+int global_edf_bak(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// G-FP response time analysis with limited carry-in (RTA-LC) of Guan,
+// Stigge, Yi and Yu (2009), services ordered from highest to lowest
+// priority (by period for G-RM).  Only m - 1 higher priority services can
+// have a job carried into the busy window of service k, so
+//
+//    x = floor(Omega(x) / m) + C(k)
+//
+// where Omega(x) is the sum of every higher priority service's interference
+// without carry-in, plus the m - 1 largest extra amounts carry-in would add.
+// Each interference is capped at x - C(k) + 1.  Computes the response times
+// into response[] (may be NULL), stopping at the first service that misses,
+// whose entry is then the first iterate past its deadline.  Returns TRUE if
+// every service meets its deadline.
+int global_fp_response_time_analysis(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[],
+                                     U32_T deadline[], U32_T response[]);
+
+// Same test without the response times.
+int global_fp_rta_lc(U32_T numCores, U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+#endif
@@ -0,0 +1,768 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// First fit, best fit and worst fit decreasing partitioning with exact per
+// core admission.
+//
+// Services are sorted by decreasing utilization and placed one at a time.
+// For each service the cores are tried in the order the fit rule gives, and
+// the first core whose set stays feasible with the service added takes it.
+// A core is settled from its utilization where possible:
+//
+//    U > 1                              - rejected under every policy
+//    EDF, sum(C(i)/D(i)) <= 1           - admitted (density, exact if D = T)
+//    D = T and RM/DM, U <= n(2^(1/n) - 1)  - admitted (Liu and Layland)
+//    D = T and RM/DM, prod(U(i) + 1) <= 2  - admitted (hyperbolic bound)
+//
+// and only otherwise runs the exact test, which for EDF is itself gated by
+// the demand bounds in edf_admit().  Each core keeps its services in
+// priority order with their response times.  Adding service s above service
+// i can only make R(i) grow, so the new fixed point R' is at least R(i), and
+// then R' >= R(i) + ceil(R(i)/T(s)) * C(s).  A fixed priority trial iterates
+// each service at or below s on its own from that lower bound, lowest
+// priority first, since on a nearly full core that is where a miss is.
+//
+// First and best fit keep offering services to the fullest cores, so most
+// trials fail, and each failure would still cost a full fixed point
+// iteration of the service L that misses, usually the lowest priority one
+// (with constrained deadlines it may be any).  Instead every core keeps,
+// for its current set, the largest idle time of L, S = max(t - W(t)), and
+// the largest idle fraction, Q = max((t - W(t)) / t), over the release
+// points t in [R(L), D(L)], where W(t) = C(L) + sum(ceil(t/T(j)) * C(j))
+// over L and the services above it.  Service s placed above L adds
+// ceil(t/T(s)) * C(s) >= max(C(s), t * U(s)) to W(t), so L cannot meet its
+// deadline when C(s) > S or U(s) > Q.  That turns nearly all failing
+// trials away in constant time.  The idle curve is only built once L has
+// missed in a trial on the core as it stands, since cores with room to
+// spare seldom turn anything away and change too often for it to pay off.
+// A core keeps up to PARTITION_IDLE_CURVES of them, one per service that
+// has missed.
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "partition.h"
+#include "rta.h"
+#include "qpa.h"
+
+// idle curves kept per core
+#define PARTITION_IDLE_CURVES (8)
+
+// longest QPA search an EDF trial may need, in multiples of its largest
+// deadline
+#define PARTITION_EDF_HORIZON (16.0)
+
+typedef struct
+{
+   U32_T n, cap;
+   U32_T *id;                                // services in priority order
+   U32_T *period, *wcet, *deadline, *response;
+   double util, density, hyperbolic;
+   double dbf_offset, horizon_load;          // sum(C(i) - U(i)D(i)) and
+   U32_T max_deadline;                       // sum((T(i) - D(i))U(i))
+   int implicit;                             // every D(i) == T(i)
+   int analysed;                             // response[] holds lower bounds
+                                             // from RTA, not just 0
+   U32_T idle_count;                         // idle curves of the core as
+   U32_T idle_service[PARTITION_IDLE_CURVES];   // it stands
+   uint64_t idle_max[PARTITION_IDLE_CURVES];
+   double idle_ratio[PARTITION_IDLE_CURVES];
+} part_core_t;
+
+typedef struct
+{
+   partition_policy_t policy;
+   U32_T *period, *wcet, *deadline;          // caller arrays
+   part_core_t *core;
+   U32_T *sp, *sw, *sd, *resp;               // trial set of one core
+   U32_T trial_pos;                          // where the trial service went
+   uint64_t *heap_time;                      // release point heap for the
+   U32_T *heap_service;                      // idle curve
+   uint64_t exact_tests, pruned;
+} part_ctx_t;
+
+// decreasing C(i)/T(i), compared exactly as C(a)T(b) vs C(b)T(a), then index
+static int utilization_before(const U32_T period[], const U32_T wcet[], U32_T i, U32_T j)
+{
+   uint64_t ui = (uint64_t)wcet[i] * period[j];
+   uint64_t uj = (uint64_t)wcet[j] * period[i];
+
+   return (ui != uj) ? (ui > uj) : (i < j);
+}
+
+// Heap sort of the service indices, so the keys stay local to the call and
+// allocations can run on several threads at once.
+static void sort_by_utilization(U32_T order[], U32_T n, const U32_T period[], const U32_T wcet[])
+{
+   U32_T start, end, root, child, s;
+
+   for (start = n / 2, end = n; end > 1; )
+   {
+      if (start > 0)
+         start--;
+      else
+      {
+         end--;
+         s = order[end]; order[end] = order[0]; order[0] = s;
+      }
+
+      // sift order[start] down, the root being the last in sorted order
+      for (root = start; (child = 2 * root + 1) < end; root = child)
+      {
+         if ((child + 1 < end) && utilization_before(period, wcet, order[child], order[child + 1]))
+            child++;
+         if (!utilization_before(period, wcet, order[root], order[child]))
+            break;
+         s = order[root]; order[root] = order[child]; order[child] = s;
+      }
+   }
+}
+
+static int core_reserve(part_core_t *core, U32_T n)
+{
+   U32_T **arrays[] = {&core->id, &core->period, &core->wcet, &core->deadline, &core->response};
+   U32_T cap = core->cap ? core->cap : 16;
+   U32_T *grown;
+   size_t k;
+
+   if (n <= core->cap)
+      return 0;
+
+   while (cap < n)
+      cap *= 2;
+
+   for (k = 0; k < sizeof(arrays) / sizeof(arrays[0]); k++)
+   {
+      grown = realloc(*arrays[k], cap * sizeof(U32_T));
+      if (grown == NULL)
+         return -1;
+      *arrays[k] = grown;
+   }
+
+   core->cap = cap;
+   return 0;
+}
+
+// Where service s goes in the core's priority order: after every service
+// with an equal or smaller period (RM) or deadline (DM).  EDF cores are kept
+// in deadline order too, for the demand bounds in edf_admit().
+static U32_T priority_position(const part_ctx_t *ctx, const part_core_t *core, U32_T s)
+{
+   const U32_T *keys = (ctx->policy == PARTITION_RM) ? core->period : core->deadline;
+   U32_T key = (ctx->policy == PARTITION_RM) ? ctx->period[s] : ctx->deadline[s];
+   U32_T lo = 0, hi = core->n, mid;
+
+   // first position whose key is larger
+   while (lo < hi)
+   {
+      mid = lo + (hi - lo) / 2;
+      if (keys[mid] > key)
+         hi = mid;
+      else
+         lo = mid + 1;
+   }
+
+   return lo;
+}
+
+// Least fixed point of service i's response time recurrence at or above
+// the lower bound an, or an iterate past limit.  Every service that gets
+// this far has C(j) <= T(j), so each term is at most an + C(j) and the sum
+// is cut off at the limit long before it could overflow.
+static uint64_t fixed_point(U32_T i, U32_T period[], U32_T wcet[], uint64_t an, uint64_t limit)
+{
+   uint64_t anext;
+   U32_T j;
+
+   while (1)
+   {
+      anext = wcet[i];
+      for (j = 0; (j < i) && (anext <= limit); j++)
+         anext += ((an + period[j] - 1) / period[j]) * wcet[j];
+
+      if ((anext == an) || (anext > limit))
+         return anext;
+
+      an = anext;
+   }
+}
+
+static void heap_sift_down(uint64_t time[], U32_T service[], U32_T len, U32_T i)
+{
+   U32_T child, ts;
+   uint64_t tt;
+
+   for (; (child = 2 * i + 1) < len; i = child)
+   {
+      if ((child + 1 < len) && (time[child + 1] < time[child]))
+         child++;
+      if (time[i] <= time[child])
+         break;
+
+      tt = time[i]; time[i] = time[child]; time[child] = tt;
+      ts = service[i]; service[i] = service[child]; service[child] = ts;
+   }
+}
+
+// Largest idle time and idle fraction of the core's service L over [R(L),
+// D(L)].  W(t) is constant between release points and t - W(t) is largest
+// at the right end of each such interval, so only the release points (and
+// D(L) itself) are visited, in order, from a heap of every higher priority
+// service's next release.
+static void idle_curve(part_ctx_t *ctx, part_core_t *core, U32_T L)
+{
+   U32_T len = 0, j, c = core->idle_count++;
+   uint64_t d = core->deadline[L], t, w;
+
+   core->idle_service[c] = L;
+   core->idle_max[c] = 0;
+   core->idle_ratio[c] = 0.0;
+
+   // W at the first release point at or after R(L)
+   w = core->wcet[L];
+   for (j = 0; j < L; j++)
+   {
+      t = t64_ceil_div(core->response[L], core->period[j]) * core->period[j];
+      if (t <= d)
+      {
+         ctx->heap_time[len] = t;
+         ctx->heap_service[len++] = j;
+      }
+   }
+   for (j = len / 2; j-- > 0; )
+      heap_sift_down(ctx->heap_time, ctx->heap_service, len, j);
+
+   t = (len > 0) ? ctx->heap_time[0] : d;
+   for (j = 0; j < L; j++)
+      w = t64_add(w, t64_mul(t64_ceil_div(t, core->period[j]), core->wcet[j]));
+
+   while (1)
+   {
+      if ((w <= t) && (t > 0))
+      {
+         if (t - w > core->idle_max[c])
+            core->idle_max[c] = t - w;
+         if ((double)(t - w) / (double)t > core->idle_ratio[c])
+            core->idle_ratio[c] = (double)(t - w) / (double)t;
+      }
+
+      if (t >= d)
+         break;
+
+      // every service released at t adds one more job for any later t
+      while ((len > 0) && (ctx->heap_time[0] == t))
+      {
+         j = ctx->heap_service[0];
+         w = t64_add(w, core->wcet[j]);
+
+         if (t + core->period[j] <= d)
+            ctx->heap_time[0] = t + core->period[j];
+         else
+         {
+            ctx->heap_time[0] = ctx->heap_time[--len];
+            ctx->heap_service[0] = ctx->heap_service[len];
+         }
+         heap_sift_down(ctx->heap_time, ctx->heap_service, len, 0);
+      }
+
+      t = (len > 0) ? ctx->heap_time[0] : d;
+   }
+}
+
+// EDF trial on the n services of the scratch set, in deadline order.  The
+// demand of service j up to t is at most dbf*(t) = C(j) + U(j)(t - D(j)) for
+// t >= D(j) (Fisher, Baruah and Baker, 2006), and at least C(j), so the set
+// is feasible if sum(dbf*(D(k))) <= D(k) at every deadline and infeasible
+// if the first jobs alone overrun some D(k).  Only the sets in between go
+// to QPA, and only if its search interval, up to L* = sum((T(i) - D(i))U(i))
+// / (1 - U), is within PARTITION_EDF_HORIZON of the largest deadline.  Past
+// that U is so close to 1 that QPA crawls through millions of deadlines,
+// so the trial is declined instead, which is always safe.
+static int edf_admit(part_ctx_t *ctx, U32_T n)
+{
+   double a = 0.0, b = 0.0, la = 0.0, u;
+   uint64_t first = 0;
+   int approx = TRUE;
+   U32_T k;
+
+   for (k = 0; k < n; k++)
+   {
+      // sum(dbf*(t)) = a + b * t over the services due by t
+      u = (double)ctx->sw[k] / (double)ctx->sp[k];
+      a += (double)ctx->sw[k] - u * (double)ctx->sd[k];
+      b += u;
+      la += ((double)ctx->sp[k] - (double)ctx->sd[k]) * u;
+      first += ctx->sw[k];
+
+      if (first > ctx->sd[k])
+      {
+         ctx->pruned++;
+         return FALSE;
+      }
+
+      // rounded like the utilization sums, so kept clear of the line
+      if (a + b * (double)ctx->sd[k] > (double)ctx->sd[k] * (1.0 - 1e-9))
+         approx = FALSE;
+   }
+
+   if (approx)
+   {
+      ctx->pruned++;
+      return TRUE;
+   }
+
+   if ((b >= 1.0) || (la > (1.0 - b) * (double)ctx->sd[n - 1] * PARTITION_EDF_HORIZON))
+   {
+      ctx->pruned++;
+      return FALSE;
+   }
+
+   ctx->exact_tests++;
+   return edf_qpa_feasibility(n, ctx->sp, ctx->sw, ctx->sd);
+}
+
+// Builds the core's set with service s inserted into the scratch arrays and
+// runs the exact test on it.
+static int exact_admit(part_ctx_t *ctx, part_core_t *core, U32_T s)
+{
+   U32_T k, j, c, pos, L;
+   uint64_t an, w;
+   double u, hp_util, hp_load;
+
+   // the services admitted by a bound so far have no response times
+   if ((ctx->policy != PARTITION_EDF) && !core->analysed)
+   {
+      response_time_analysis(core->n, core->period, core->wcet, core->deadline, core->response);
+      core->analysed = TRUE;
+   }
+
+   // a service that has missed before cannot meet its deadline with s
+   // above it if s takes more than its idle time or idle fraction
+   for (c = 0; c < core->idle_count; c++)
+   {
+      L = core->idle_service[c];
+      if (((ctx->policy == PARTITION_RM) ? core->period[L] : core->deadline[L]) <=
+          ((ctx->policy == PARTITION_RM) ? ctx->period[s] : ctx->deadline[s]))
+         continue;
+
+      // the ratio is rounded, so only trust it with some margin
+      if ((ctx->wcet[s] > core->idle_max[c]) ||
+          ((double)ctx->wcet[s] / (double)ctx->period[s] > core->idle_ratio[c] + 1e-12))
+      {
+         ctx->pruned++;
+         return FALSE;
+      }
+   }
+
+   pos = priority_position(ctx, core, s);
+
+   memcpy(ctx->sp, core->period, pos * sizeof(U32_T));
+   memcpy(ctx->sw, core->wcet, pos * sizeof(U32_T));
+   memcpy(ctx->sd, core->deadline, pos * sizeof(U32_T));
+   memcpy(ctx->resp, core->response, pos * sizeof(U32_T));
+
+   ctx->sp[pos] = ctx->period[s];
+   ctx->sw[pos] = ctx->wcet[s];
+   ctx->sd[pos] = ctx->deadline[s];
+
+   memcpy(&ctx->sp[pos + 1], &core->period[pos], (core->n - pos) * sizeof(U32_T));
+   memcpy(&ctx->sw[pos + 1], &core->wcet[pos], (core->n - pos) * sizeof(U32_T));
+   memcpy(&ctx->sd[pos + 1], &core->deadline[pos], (core->n - pos) * sizeof(U32_T));
+   memcpy(&ctx->resp[pos + 1], &core->response[pos], (core->n - pos) * sizeof(U32_T));
+
+   ctx->trial_pos = pos;
+
+   if (ctx->policy == PARTITION_EDF)
+      return edf_admit(ctx, core->n + 1);
+
+   ctx->exact_tests++;
+
+   // higher priority load of the lowest priority service, for the upper
+   // bound below
+   hp_util = 0.0; hp_load = 0.0;
+   for (k = 0; k < core->n; k++)
+   {
+      u = (double)ctx->sw[k] / (double)ctx->sp[k];
+      hp_util += u;
+      hp_load += (double)ctx->sw[k] * (1.0 - u);
+   }
+
+   // lowest priority first; s itself finishes no earlier than the service
+   // just above it plus C(s)
+   for (k = core->n + 1; k-- > pos; )
+   {
+      if (k == pos)
+         an = ((pos > 0) ? (uint64_t)ctx->resp[pos - 1] : 0) + ctx->wcet[s];
+      else
+         an = t64_add(ctx->resp[k], t64_mul(t64_ceil_div(ctx->resp[k], ctx->period[s]), ctx->wcet[s]));
+
+      // R(k) <= (C(k) + sum(C(j)(1 - U(j)))) / (1 - sum(U(j))) over the
+      // services above k (Bini et al., 2009); when that already meets the
+      // deadline, keep the lower bound rather than iterate.  The sums are
+      // rounded, so the bound is only trusted with some margin.
+      if ((an <= ctx->sd[k]) &&
+          !((hp_util < 1.0 - 1e-6) &&
+            ((double)ctx->sw[k] + hp_load) / (1.0 - hp_util) * (1.0 + 1e-9) <= (double)ctx->sd[k]))
+      {
+         // one step of the recurrence at D(k) itself: W(D(k)) <= D(k)
+         // puts the fixed point at or before the deadline
+         w = ctx->sw[k];
+         for (j = 0; (j < k) && (w <= ctx->sd[k]); j++)
+            w += ((ctx->sd[k] + ctx->sp[j] - 1) / ctx->sp[j]) * ctx->sw[j];
+         if (w > ctx->sd[k])
+            an = fixed_point(k, ctx->sp, ctx->sw, an, ctx->sd[k]);
+      }
+
+      if (an > ctx->sd[k])
+      {
+         // the first miss of one of the core's own services on this
+         // version of the core; from now on most trials will end the same
+         // way.  Below s, scratch service k is the core's k - 1.
+         if ((k > pos) && (core->idle_count < PARTITION_IDLE_CURVES))
+         {
+            for (c = 0; (c < core->idle_count) && (core->idle_service[c] != k - 1); c++)
+               ;
+            if (c == core->idle_count)
+               idle_curve(ctx, core, k - 1);
+         }
+         return FALSE;
+      }
+
+      ctx->resp[k] = (U32_T)an;
+
+      if (k > 0)
+      {
+         u = (double)ctx->sw[k - 1] / (double)ctx->sp[k - 1];
+         hp_util -= u;
+         hp_load -= (double)ctx->sw[k - 1] * (1.0 - u);
+      }
+   }
+
+   return TRUE;
+}
+
+// Returns TRUE if service s fits on the core, with the trial set left in
+// the scratch arrays when the exact test ran (trial_pos is PARTITION_NONE
+// otherwise).
+static int admit(part_ctx_t *ctx, part_core_t *core, U32_T s, double u)
+{
+   double d = (double)ctx->wcet[s] / (double)ctx->deadline[s];
+   double b = core->util + u, dmax;
+   int implicit = core->implicit && (ctx->deadline[s] == ctx->period[s]);
+   U32_T n = core->n + 1;
+
+   ctx->trial_pos = PARTITION_NONE;
+
+   if (core->util + u > 1.0 + 1e-9)
+   {
+      ctx->pruned++;
+      return FALSE;
+   }
+
+   if (ctx->policy == PARTITION_EDF)
+   {
+      if (core->density + d <= 1.0)
+      {
+         ctx->pruned++;
+         return TRUE;
+      }
+
+      // At the largest deadline the dbf* sum in edf_admit() is the core's
+      // totals plus s, and so is its QPA horizon.  A trial that fails the
+      // one and is past the other is declined there after building the
+      // whole set, so decline it here (with a margin, as the totals are
+      // summed in another order).
+      dmax = (double)((ctx->deadline[s] > core->max_deadline) ? ctx->deadline[s] : core->max_deadline);
+      if ((core->dbf_offset + (double)ctx->wcet[s] - u * (double)ctx->deadline[s] + b * dmax > dmax * (1.0 + 1e-9)) &&
+          ((b >= 1.0) ||
+           (core->horizon_load + ((double)ctx->period[s] - (double)ctx->deadline[s]) * u >
+            (1.0 - b) * dmax * PARTITION_EDF_HORIZON * (1.0 + 1e-9))))
+      {
+         ctx->pruned++;
+         return FALSE;
+      }
+   }
+   else if (implicit)
+   {
+      // with D = T, DM and RM give the same priority order
+      if ((core->util + u <= (double)n * (pow(2.0, 1.0 / (double)n) - 1.0)) ||
+          (core->hyperbolic * (u + 1.0) <= 2.0))
+      {
+         ctx->pruned++;
+         return TRUE;
+      }
+   }
+
+   return exact_admit(ctx, core, s);
+}
+
+static int place(part_ctx_t *ctx, part_core_t *core, U32_T s, double u)
+{
+   U32_T pos;
+
+   if (core_reserve(core, core->n + 1) < 0)
+      return -1;
+
+   if (ctx->trial_pos != PARTITION_NONE)
+   {
+      // the exact test already built the new set, with response time lower
+      // bounds
+      pos = ctx->trial_pos;
+      memcpy(core->period, ctx->sp, (core->n + 1) * sizeof(U32_T));
+      memcpy(core->wcet, ctx->sw, (core->n + 1) * sizeof(U32_T));
+      memcpy(core->deadline, ctx->sd, (core->n + 1) * sizeof(U32_T));
+      memcpy(core->response, ctx->resp, (core->n + 1) * sizeof(U32_T));
+      memmove(&core->id[pos + 1], &core->id[pos], (core->n - pos) * sizeof(U32_T));
+      core->id[pos] = s;
+      core->n++;
+   }
+   else
+   {
+      pos = priority_position(ctx, core, s);
+
+      memmove(&core->period[pos + 1], &core->period[pos], (core->n - pos) * sizeof(U32_T));
+      memmove(&core->wcet[pos + 1], &core->wcet[pos], (core->n - pos) * sizeof(U32_T));
+      memmove(&core->deadline[pos + 1], &core->deadline[pos], (core->n - pos) * sizeof(U32_T));
+      memmove(&core->response[pos + 1], &core->response[pos], (core->n - pos) * sizeof(U32_T));
+      memmove(&core->id[pos + 1], &core->id[pos], (core->n - pos) * sizeof(U32_T));
+
+      core->period[pos] = ctx->period[s];
+      core->wcet[pos] = ctx->wcet[s];
+      core->deadline[pos] = ctx->deadline[s];
+
+      // admitted by a bound, so the response times are no longer known
+      core->response[pos] = 0;
+      core->id[pos] = s;
+      core->n++;
+      core->analysed = FALSE;
+   }
+
+   core->idle_count = 0;
+   core->util += u;
+   core->density += (double)ctx->wcet[s] / (double)ctx->deadline[s];
+   core->hyperbolic *= (u + 1.0);
+   core->dbf_offset += (double)ctx->wcet[s] - u * (double)ctx->deadline[s];
+   core->horizon_load += ((double)ctx->period[s] - (double)ctx->deadline[s]) * u;
+   if (ctx->deadline[s] > core->max_deadline)
+      core->max_deadline = ctx->deadline[s];
+   core->implicit = core->implicit && (ctx->deadline[s] == ctx->period[s]);
+
+   return 0;
+}
+
+// Keeps corder[] sorted for best fit (fullest first) or worst fit
+// (emptiest first) after core c's utilization went up.
+static void reorder(part_core_t cores[], U32_T corder[], U32_T numCores, partition_fit_t fit, U32_T c)
+{
+   U32_T k, tmp;
+
+   for (k = 0; corder[k] != c; k++)
+      ;
+
+   if (fit == PARTITION_BEST_FIT)
+   {
+      for (; (k > 0) && ((cores[corder[k - 1]].util < cores[c].util) ||
+                         ((cores[corder[k - 1]].util == cores[c].util) && (corder[k - 1] > c))); k--)
+      {
+         tmp = corder[k - 1]; corder[k - 1] = corder[k]; corder[k] = tmp;
+      }
+   }
+   else if (fit == PARTITION_WORST_FIT)
+   {
+      for (; (k + 1 < numCores) && ((cores[corder[k + 1]].util < cores[c].util) ||
+                                     ((cores[corder[k + 1]].util == cores[c].util) && (corder[k + 1] < c))); k++)
+      {
+         tmp = corder[k + 1]; corder[k + 1] = corder[k]; corder[k] = tmp;
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Partitioning
+//      * sort the services by decreasing utilization
+//      * FOR each service:
+//      *       try the cores in fit order (index, fullest or emptiest first)
+//      *       place it on the first core that admits it and update the fit
+//      *       order, or leave it unassigned if none does
+////////////////////////////////////////////////////////////////////////////////
+int partition_services(partition_policy_t policy, partition_fit_t fit, U32_T numCores,
+                       U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                       partition_t *result)
+{
+   part_ctx_t ctx;
+   U32_T *sorder, *corder;
+   U32_T i, k, s, c;
+   double u;
+   int rc = 0, placed;
+
+   memset(&ctx, 0, sizeof(ctx));
+   ctx.policy = policy;
+   ctx.period = period;
+   ctx.wcet = wcet;
+   ctx.deadline = deadline;
+
+   result->unassigned = 0;
+   result->exact_tests = 0;
+   result->pruned = 0;
+
+   sorder = malloc(numServices * sizeof(U32_T));
+   corder = malloc(numCores * sizeof(U32_T));
+   ctx.core = calloc(numCores, sizeof(part_core_t));
+   ctx.sp = malloc((numServices + 1) * sizeof(U32_T));
+   ctx.sw = malloc((numServices + 1) * sizeof(U32_T));
+   ctx.sd = malloc((numServices + 1) * sizeof(U32_T));
+   ctx.resp = malloc((numServices + 1) * sizeof(U32_T));
+   ctx.heap_time = malloc((numServices + 1) * sizeof(uint64_t));
+   ctx.heap_service = malloc((numServices + 1) * sizeof(U32_T));
+
+   if (!sorder || !corder || !ctx.core || !ctx.sp || !ctx.sw || !ctx.sd || !ctx.resp || !ctx.heap_time || !ctx.heap_service)
+   {
+      rc = -1;
+      goto done;
+   }
+
+   for (c = 0; c < numCores; c++)
+   {
+      corder[c] = c;
+      ctx.core[c].hyperbolic = 1.0;
+      ctx.core[c].implicit = TRUE;
+   }
+
+   for (i = 0; i < numServices; i++)
+   {
+      sorder[i] = i;
+      result->core[i] = PARTITION_NONE;
+   }
+
+   sort_by_utilization(sorder, numServices, period, wcet);
+
+   for (i = 0; i < numServices; i++)
+   {
+      s = sorder[i];
+      u = (double)wcet[s] / (double)period[s];
+      placed = FALSE;
+
+      for (k = 0; (k < numCores) && !placed; k++)
+      {
+         c = corder[k];
+         if (!admit(&ctx, &ctx.core[c], s, u))
+            continue;
+
+         if (place(&ctx, &ctx.core[c], s, u) < 0)
+         {
+            rc = -1;
+            goto done;
+         }
+
+         result->core[s] = c;
+         reorder(ctx.core, corder, numCores, fit, c);
+         placed = TRUE;
+      }
+
+      if (!placed)
+         result->unassigned++;
+   }
+
+   rc = (int)result->unassigned;
+
+done:
+   result->exact_tests = ctx.exact_tests;
+   result->pruned = ctx.pruned;
+
+   if (ctx.core != NULL)
+   {
+      for (c = 0; c < numCores; c++)
+      {
+         free(ctx.core[c].id);
+         free(ctx.core[c].period);
+         free(ctx.core[c].wcet);
+         free(ctx.core[c].deadline);
+         free(ctx.core[c].response);
+      }
+   }
+
+   free(ctx.core);
+   free(ctx.sp);
+   free(ctx.sw);
+   free(ctx.sd);
+   free(ctx.resp);
+   free(ctx.heap_time);
+   free(ctx.heap_service);
+   free(sorder);
+   free(corder);
+
+   return rc;
+}
+
+const char *partition_policy_name(partition_policy_t policy)
+{
+   static const char *names[] = {"RM", "DM", "EDF"};
+
+   return names[policy];
+}
+
+const char *partition_fit_name(partition_fit_t fit)
+{
+   static const char *names[] = {"first fit", "best fit", "worst fit"};
+
+   return names[fit];
+}
+
+void partition_print(FILE *out, U32_T numCores, U32_T numServices, U32_T period[],
+                     U32_T wcet[], const partition_t *result)
+{
+   U32_T c, i, count;
+   double util;
+
+   for (c = 0; c < numCores; c++)
+   {
+      count = 0; util = 0.0;
+      for (i = 0; i < numServices; i++)
+      {
+         if (result->core[i] == c)
+         {
+            count++;
+            util += (double)wcet[i] / (double)period[i];
+         }
+      }
+
+      fprintf(out, "core %-3u %5u services  U=%6.4f  ", c, count, util);
+      for (i = 0; i < numServices; i++)
+      {
+         if (result->core[i] == c)
+            fprintf(out, " S%u", i + 1);
+      }
+      fprintf(out, "\n");
+   }
+
+   if (result->unassigned)
+   {
+      fprintf(out, "unassigned   %5u services          ", result->unassigned);
+      for (i = 0; i < numServices; i++)
+      {
+         if (result->core[i] == PARTITION_NONE)
+            fprintf(out, " S%u", i + 1);
+      }
+      fprintf(out, "\n");
+   }
+}
+
+void partition_print_affinity(FILE *out, U32_T numCores, U32_T numServices, const partition_t *result)
+{
+   U32_T i;
+
+   fprintf(out, "// core of each service thread, in service order (-1: not placed)\n");
+   fprintf(out, "#define NUM_CPU_CORES (%u)\n", numCores);
+   fprintf(out, "static const int service_core[%u] =\n{", numServices);
+
+   for (i = 0; i < numServices; i++)
+   {
+      if ((i % 16) == 0)
+         fprintf(out, "\n   ");
+      fprintf(out, "%d%s", (result->core[i] == PARTITION_NONE) ? -1 : (int)result->core[i],
+              (i + 1 < numServices) ? ", " : "\n");
+   }
+
+   fprintf(out, "};\n");
+}
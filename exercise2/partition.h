@@ -0,0 +1,68 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Partitioned multicore scheduling: services are bin packed onto cores and
+// every core is then scheduled on its own as a uniprocessor.
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "feasibility.h"
+
+#define PARTITION_NONE ((U32_T)-1)
+
+// Per core scheduling policy.  RM and DM order a core's services by period
+// or deadline (ties in the order they were placed) and admit a service with
+// response time analysis, EDF uses QPA.  Deadlines must not exceed periods.
+// EDF trials whose QPA search would run past 16 times their largest deadline
+// (U within a few ppm of 1) are declined rather than decided.
+typedef enum
+{
+   PARTITION_RM,
+   PARTITION_DM,
+   PARTITION_EDF
+} partition_policy_t;
+
+// Services are placed one at a time in order of decreasing utilization, each
+// on the first core (by index), the fullest core or the emptiest core that
+// still passes the exact test with it added.
+typedef enum
+{
+   PARTITION_FIRST_FIT,
+   PARTITION_BEST_FIT,
+   PARTITION_WORST_FIT
+} partition_fit_t;
+
+// core[] is a caller array of numServices entries, indexed like the input
+// arrays.
+typedef struct
+{
+   U32_T *core;               // core of each service, PARTITION_NONE if unplaced
+   U32_T unassigned;          // services no core could take
+   uint64_t exact_tests;      // per core RTA or QPA runs
+   uint64_t pruned;           // decisions made by utilization bounds alone
+} partition_t;
+
+// Assigns every service to one of numCores cores.  Returns the number of
+// services that could not be placed (0 when the whole set is feasible), or
+// -1 if out of memory.
+int partition_services(partition_policy_t policy, partition_fit_t fit, U32_T numCores,
+                       U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                       partition_t *result);
+
+const char *partition_policy_name(partition_policy_t policy);
+const char *partition_fit_name(partition_fit_t fit);
+
+// Per core service count, utilization and service list.
+void partition_print(FILE *out, U32_T numCores, U32_T numServices, U32_T period[],
+                     U32_T wcet[], const partition_t *result);
+
+// The service to core map as a C fragment the sequencers can include and
+// pass to CPU_SET() for each service thread; unplaced services are -1.
+void partition_print_affinity(FILE *out, U32_T numCores, U32_T numServices, const partition_t *result);
+
+#endif
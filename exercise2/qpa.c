@@ -0,0 +1,152 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Quick Processor-demand Analysis for EDF.
+//
+// A synchronous set of services is EDF feasible iff U <= 1 and h(t) <= t at
+// every absolute deadline t below the bound L (Baruah, Rosier and Howell,
+// 1990).  Rather than checking every deadline below L, QPA starts at the
+// last deadline before L and walks backwards: while h(t) < t it jumps
+// straight to t = h(t), since no deadline in [h(t), t) can fail, and only
+// steps to the previous deadline when h(t) == t.  The set is feasible iff the
+// walk ends at or below the smallest relative deadline.
+//
+// Zhang, Fengxiang, and Alan Burns. "Schedulability analysis for real-time
+// systems with EDF scheduling." IEEE Transactions on Computers 58.9 (2009):
+// 1250-1258.
+//
+// Nothing here steps through the hyperperiod, so its cost does not grow with
+// it; earliest_deadline_first() falls back to this test when the hyperperiod
+// is too long to simulate.
+
+#include <stdio.h>
+
+#include "qpa.h"
+
+uint64_t edf_demand(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], uint64_t t)
+{
+   uint64_t demand = 0;
+   U32_T i;
+
+   for (i = 0; i < numServices; i++)
+   {
+      if (t >= deadline[i])
+         demand = t64_add(demand, t64_mul((t - deadline[i]) / period[i] + 1, wcet[i]));
+   }
+
+   return demand;
+}
+
+// largest absolute deadline strictly less than t, or 0 if there is none
+static uint64_t previous_deadline(U32_T numServices, U32_T period[], U32_T deadline[], uint64_t t)
+{
+   uint64_t d, d_max = 0;
+   U32_T i;
+
+   for (i = 0; i < numServices; i++)
+   {
+      if (t > deadline[i])
+      {
+         d = ((t - deadline[i] - 1) / period[i]) * period[i] + deadline[i];
+         if (d > d_max)
+            d_max = d;
+      }
+   }
+
+   return d_max;
+}
+
+uint64_t edf_demand_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   double utility_sum = 0.0, la = 0.0;
+   uint64_t w = 0, wnext, d_max = 0, cap, la_cap;
+   U32_T i;
+
+   for (i = 0; i < numServices; i++)
+   {
+      utility_sum += (double)wcet[i] / (double)period[i];
+      la += ((double)period[i] - (double)deadline[i]) * ((double)wcet[i] / (double)period[i]);
+      w += wcet[i];
+      if (deadline[i] > d_max)
+         d_max = deadline[i];
+   }
+
+   // U > 1 is infeasible under any policy; the small tolerance keeps sets
+   // with U exactly 1 (e.g. three services at 1/3) from being rejected on
+   // rounding, and the busy period cap below catches anything it lets by
+   if (utility_sum > 1.0 + 1e-9)
+      return 0;
+
+   // with U < 1, L* = max(D(max), sum((T(i) - D(i)) * U(i)) / (1 - U));
+   // otherwise the busy period is at most one hyperperiod
+   cap = hyperperiod(numServices, period);
+   if (cap == 0)
+      cap = UINT64_MAX / 2;
+   if (utility_sum < 1.0 - 1e-9)
+   {
+      la = la / (1.0 - utility_sum);
+      if (la < (double)cap)
+      {
+         la_cap = (la > (double)d_max) ? (uint64_t)la + 1 : d_max;
+         if (la_cap < cap)
+            cap = la_cap;
+      }
+   }
+
+   // synchronous busy period, w = sum(ceil(w/T(i)) * C(i))
+   while (1)
+   {
+      wnext = 0;
+      for (i = 0; i < numServices; i++)
+         wnext = t64_add(wnext, t64_mul(t64_ceil_div(w, period[i]), wcet[i]));
+
+      if (wnext == w)
+         break;
+
+      w = wnext;
+
+      // past L* the busy period no longer tightens the bound, and past
+      // the hyperperiod it never converges because U is above 1
+      if (w > cap)
+         return (utility_sum < 1.0 - 1e-9) ? cap : 0;
+   }
+
+   return (w < cap) ? w : cap;
+}
+
+int edf_qpa_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   uint64_t bound, t, h, d_min = UINT64_MAX;
+   U32_T i;
+
+   for (i = 0; i < numServices; i++)
+   {
+      if (deadline[i] < d_min)
+         d_min = deadline[i];
+   }
+
+   bound = edf_demand_bound(numServices, period, wcet, deadline);
+   if (bound == 0)
+      return FALSE;
+
+   // the busy period itself may be a deadline, so start at the last
+   // deadline at or below it
+   t = previous_deadline(numServices, period, deadline, bound + 1);
+   if (t == 0)
+      return TRUE;
+
+   h = edf_demand(numServices, period, wcet, deadline, t);
+
+   while ((h <= t) && (h > d_min))
+   {
+      if (h < t)
+         t = h;
+      else
+         t = previous_deadline(numServices, period, deadline, t);
+
+      h = edf_demand(numServices, period, wcet, deadline, t);
+   }
+
+   return (h <= d_min) ? TRUE : FALSE;
+}
@@ -0,0 +1,27 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Exact EDF feasibility by Quick Processor-demand Analysis (QPA).
+
+#ifndef QPA_H
+#define QPA_H
+
+#include <stdint.h>
+
+#include "feasibility.h"
+
+// Processor demand h(t): total WCET of all jobs released at or after time 0
+// with an absolute deadline at or before t (synchronous release).
+uint64_t edf_demand(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], uint64_t t);
+
+// Upper bound on the deadlines that need to be checked: the smaller of the
+// synchronous busy period and the George/Rivierre/Spuri bound L*.  Returns 0
+// if the total utilization exceeds 1, in which case no bound exists.
+uint64_t edf_demand_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// Exact EDF test for constrained deadlines (D <= T) taken from deadline[],
+// using the backward QPA walk of Zhang and Burns (2009).
+int edf_qpa_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+#endif
@@ -0,0 +1,248 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Incremental response time analysis, an exact test equivalent to the
+// completion time test (Joseph and Pandya, 1986).
+//
+// completion_time_feasibility() starts every service's fixed point iteration
+// from the sum of the WCETs at or above its priority and evaluates
+// ceil(an/T(j)) in double precision.  Here the iteration for service i is
+// seeded with R(i-1) + C(i) instead.  That is still a lower bound on R(i):
+// service i sees all the interference service i-1 sees plus service i-1
+// itself, so no time before R(i-1) + C(i) can satisfy its recurrence.  With
+// the periods sorted by priority most services converge in one or two
+// passes, and the ceiling is done with integer division.
+//
+// The iterates are 64 bit with saturating arithmetic, so a large WCET times
+// a large number of preemptions cannot wrap around below a deadline.  The
+// response times handed back are clamped to 32 bits; anything clamped is
+// already past every deadline.
+//
+// Since every seed is above the last iterate of the service before, the
+// iterate never goes down over the whole analysis.  For larger sets the
+// interference I(t) = sum(ceil(t/T(j)) * C(j)) is therefore carried from one
+// iterate, and one service, to the next: a heap holds each higher priority
+// service's next release, and only the services released since the last
+// iterate have their term updated.  An iteration then costs the releases it
+// passes (times log n) instead of a division for every service above.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rta.h"
+
+// below this many services the plain loop is faster than the heap
+#define RTA_HEAP_MIN (128)
+
+static inline U32_T clamp_u32(uint64_t t)
+{
+   return (t > UINT32_MAX) ? UINT32_MAX : (U32_T)t;
+}
+
+typedef struct
+{
+   uint64_t *edge;     // heap: last time the service's job count holds
+   U32_T *service;
+   uint64_t *jobs;     // by service, ceil(t/T(j)) at its last update
+   U32_T len;
+} release_heap_t;
+
+static void heap_sift_down(release_heap_t *h, U32_T i)
+{
+   U32_T child, ts;
+   uint64_t tt;
+
+   for (; (child = 2 * i + 1) < h->len; i = child)
+   {
+      if ((child + 1 < h->len) && (h->edge[child + 1] < h->edge[child]))
+         child++;
+      if (h->edge[i] <= h->edge[child])
+         break;
+
+      tt = h->edge[i]; h->edge[i] = h->edge[child]; h->edge[child] = tt;
+      ts = h->service[i]; h->service[i] = h->service[child]; h->service[child] = ts;
+   }
+}
+
+static void heap_push(release_heap_t *h, uint64_t edge, U32_T service)
+{
+   U32_T i = h->len++, parent;
+
+   for (; (i > 0) && (h->edge[parent = (i - 1) / 2] > edge); i = parent)
+   {
+      h->edge[i] = h->edge[parent];
+      h->service[i] = h->service[parent];
+   }
+   h->edge[i] = edge;
+   h->service[i] = service;
+}
+
+// Brings the interference up to iterate t from the last one, which was no
+// later, by updating every service released in between.
+static uint64_t heap_advance(release_heap_t *h, U32_T period[], U32_T wcet[], uint64_t interference, uint64_t t)
+{
+   uint64_t jobs;
+   U32_T j;
+
+   while ((h->len > 0) && (h->edge[0] < t))
+   {
+      j = h->service[0];
+      jobs = t64_ceil_div(t, period[j]);
+      interference = t64_add(interference, t64_mul(jobs - h->jobs[j], wcet[j]));
+      h->jobs[j] = jobs;
+      h->edge[0] = t64_mul(jobs, period[j]);
+      heap_sift_down(h, 0);
+   }
+
+   return interference;
+}
+
+static int response_time_analysis_heap(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                       U32_T response[], release_heap_t *h)
+{
+   U32_T i;
+   uint64_t an = 0, anext, interference = 0;
+   int set_feasible = TRUE;
+
+   for (i = 0; i < numServices; i++)
+   {
+      an = t64_add(an, wcet[i]);
+
+      while (1)
+      {
+         interference = heap_advance(h, period, wcet, interference, an);
+         anext = t64_add(wcet[i], interference);
+
+         if (anext == an)
+            break;
+
+         an = anext;
+
+         if (an > deadline[i])
+            break;
+      }
+
+      if (response != NULL)
+         response[i] = clamp_u32(an);
+
+      if (an > deadline[i])
+         set_feasible = FALSE;
+
+      // service i interferes with everything below it from here on
+      h->jobs[i] = t64_ceil_div(an, period[i]);
+      interference = t64_add(interference, t64_mul(h->jobs[i], wcet[i]));
+      heap_push(h, t64_mul(h->jobs[i], period[i]), i);
+   }
+
+   return set_feasible;
+}
+
+int response_time_analysis(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], U32_T response[])
+{
+   U32_T i, j;
+   uint64_t an = 0, anext;
+
+   release_heap_t heap;
+   int done = FALSE;
+
+   // assume feasible until we find otherwise
+   int set_feasible = TRUE;
+
+   if (numServices >= RTA_HEAP_MIN)
+   {
+      heap.len = 0;
+      heap.edge = malloc(numServices * sizeof(uint64_t));
+      heap.service = malloc(numServices * sizeof(U32_T));
+      heap.jobs = malloc(numServices * sizeof(uint64_t));
+
+      // out of memory falls back to the plain loop
+      if (heap.edge && heap.service && heap.jobs)
+      {
+         set_feasible = response_time_analysis_heap(numServices, period, wcet, deadline, response, &heap);
+         done = TRUE;
+      }
+
+      free(heap.edge); free(heap.service); free(heap.jobs);
+      if (done)
+         return set_feasible;
+   }
+
+   for (i = 0; i < numServices; i++)
+   {
+      // seed from the previous service's response time (or its last iterate
+      // if it already failed, which is still a lower bound)
+      an = t64_add(an, wcet[i]);
+
+      while (1)
+      {
+         anext = wcet[i];
+
+         for (j = 0; j < i; j++)
+            anext = t64_add(anext, t64_mul(t64_ceil_div(an, period[j]), wcet[j]));
+
+         if (anext == an)
+            break;
+
+         an = anext;
+
+         // past the deadline the iteration can only grow, and it never
+         // converges at all if the higher priority load is over 100%
+         if (an > deadline[i])
+            break;
+      }
+
+      if (response != NULL)
+         response[i] = clamp_u32(an);
+
+      if (an > deadline[i])
+         set_feasible = FALSE;
+   }
+
+   return set_feasible;
+}
+
+int response_time_analysis_from(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                U32_T response[], U32_T first)
+{
+   U32_T i, j;
+   uint64_t an, anext;
+
+   an = (first > 0) ? response[first - 1] : 0;
+
+   for (i = first; i < numServices; i++)
+   {
+      // both R(i-1) + C(i) and the caller's value are lower bounds on R(i)
+      an = t64_add(an, wcet[i]);
+      if (response[i] > an)
+         an = response[i];
+
+      while (1)
+      {
+         anext = wcet[i];
+
+         for (j = 0; j < i; j++)
+            anext = t64_add(anext, t64_mul(t64_ceil_div(an, period[j]), wcet[j]));
+
+         if (anext == an)
+            break;
+
+         an = anext;
+
+         if (an > deadline[i])
+            break;
+      }
+
+      response[i] = clamp_u32(an);
+
+      if (an > deadline[i])
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+int response_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return response_time_analysis(numServices, period, wcet, deadline, NULL);
+}
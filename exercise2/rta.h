@@ -0,0 +1,34 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Incremental response time analysis (RTA) for fixed priority services.
+
+#ifndef RTA_H
+#define RTA_H
+
+#include "feasibility.h"
+
+// Computes the worst case response time of every service, ordered from
+// highest to lowest priority, into response[] (may be NULL).  For a service
+// that misses its deadline the value stored is the first iterate that passed
+// the deadline, which is a lower bound on its true response time.
+//
+// Returns TRUE if every response time is within its deadline.
+int response_time_analysis(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], U32_T response[]);
+
+// Re-runs the analysis for a set that only changed at or below service
+// first, e.g. while searching for how far one parameter can move.
+// response[0..first-1] must hold the exact response times of the services
+// above first, and every other response[i] a lower bound on the new R(i)
+// (0, or R(i) from a set with smaller WCETs or longer periods), which the
+// iteration starts from when it is above R(i-1) + C(i).  Stops at the first
+// deadline miss.  Returns TRUE if no service from first on misses.
+int response_time_analysis_from(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                U32_T response[], U32_T first);
+
+// Same test with the common feasibility signature, so it can be passed
+// wherever completion_time_feasibility() is.
+int response_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+#endif
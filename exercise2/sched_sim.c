@@ -0,0 +1,482 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Discrete event scheduling simulator.
+//
+// earliest_deadline_first() and least_laxity_first() step one tick at a time
+// and scan every service on every tick.  Here the only points in time that
+// are visited are releases, completions and deadlines (plus, for LLF, the
+// instant the running job's laxity falls behind a waiting job's).  Pending
+// releases and deadlines are kept in one binary heap ordered by time, and
+// released jobs wait in a second binary heap ordered by the policy's key.
+//
+// Every policy orders jobs by a single key:
+//
+//    RM  - period, DM - relative deadline, EDF - absolute deadline,
+//    LLF - absolute deadline minus remaining execution time.
+//
+// The LLF key of a waiting job is constant, because its laxity (d - t - rem)
+// falls one for one with time.  Only the running job's key changes, so LLF
+// only needs one extra event for when it overtakes the best waiting key.
+//
+// A running job is only preempted by a strictly smaller key, which gives
+// FIFO order among equal priorities and keeps LLF from thrashing between
+// jobs with equal laxity.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched_sim.h"
+#include "rta.h"
+#include "qpa.h"
+
+#define EV_DEADLINE 0      // deadlines sort ahead of releases at the same time
+#define EV_RELEASE  1
+
+typedef struct
+{
+   uint64_t time;
+   uint32_t service;
+   uint32_t job;
+   int type;
+} sim_event_t;
+
+typedef struct
+{
+   sim_job_t *jobs;
+   size_t len, cap;
+} job_heap_t;
+
+typedef struct
+{
+   sim_event_t *ev;
+   size_t len, cap;
+} event_heap_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Priority policies
+////////////////////////////////////////////////////////////////////////////////
+// every key gets the static parameters, each uses what it needs
+static int64_t rm_key(const sim_job_t *job, U32_T period[], U32_T deadline[])
+{
+   (void)deadline;
+   return period[job->service];
+}
+
+static int64_t dm_key(const sim_job_t *job, U32_T period[], U32_T deadline[])
+{
+   (void)period;
+   return deadline[job->service];
+}
+
+static int64_t edf_key(const sim_job_t *job, U32_T period[], U32_T deadline[])
+{
+   (void)period; (void)deadline;
+   return (int64_t)job->deadline;
+}
+
+static int64_t llf_key(const sim_job_t *job, U32_T period[], U32_T deadline[])
+{
+   (void)period; (void)deadline;
+   return (int64_t)job->deadline - (int64_t)job->remaining;
+}
+
+const sim_policy_t sim_policy_rm  = {"RM",  rm_key,  FALSE};
+const sim_policy_t sim_policy_dm  = {"DM",  dm_key,  FALSE};
+const sim_policy_t sim_policy_edf = {"EDF", edf_key, FALSE};
+const sim_policy_t sim_policy_llf = {"LLF", llf_key, TRUE};
+
+////////////////////////////////////////////////////////////////////////////////
+// Binary heaps
+////////////////////////////////////////////////////////////////////////////////
+static int job_before(const sim_job_t *a, const sim_job_t *b)
+{
+   if (a->key != b->key)
+      return a->key < b->key;
+   if (a->service != b->service)
+      return a->service < b->service;
+   return a->job < b->job;
+}
+
+static int event_before(const sim_event_t *a, const sim_event_t *b)
+{
+   if (a->time != b->time)
+      return a->time < b->time;
+   if (a->type != b->type)
+      return a->type < b->type;
+   return a->service < b->service;
+}
+
+static int job_push(job_heap_t *h, const sim_job_t *job)
+{
+   size_t i, parent;
+   sim_job_t *grown;
+
+   if (h->len == h->cap)
+   {
+      h->cap = h->cap ? 2 * h->cap : 16;
+      grown = realloc(h->jobs, h->cap * sizeof(sim_job_t));
+      if (grown == NULL)
+         return -1;
+      h->jobs = grown;
+   }
+
+   // sift up
+   for (i = h->len++; i > 0; i = parent)
+   {
+      parent = (i - 1) / 2;
+      if (!job_before(job, &h->jobs[parent]))
+         break;
+      h->jobs[i] = h->jobs[parent];
+   }
+   h->jobs[i] = *job;
+
+   return 0;
+}
+
+static void job_pop(job_heap_t *h, sim_job_t *job)
+{
+   sim_job_t last;
+   size_t i, child;
+
+   *job = h->jobs[0];
+   last = h->jobs[--h->len];
+
+   // sift down
+   for (i = 0; (child = 2 * i + 1) < h->len; i = child)
+   {
+      if ((child + 1 < h->len) && job_before(&h->jobs[child + 1], &h->jobs[child]))
+         child++;
+      if (!job_before(&h->jobs[child], &last))
+         break;
+      h->jobs[i] = h->jobs[child];
+   }
+   h->jobs[i] = last;
+}
+
+static int event_push(event_heap_t *h, uint64_t time, uint32_t service, uint32_t job, int type)
+{
+   sim_event_t ev = {time, service, job, type};
+   size_t i, parent;
+   sim_event_t *grown;
+
+   if (h->len == h->cap)
+   {
+      h->cap = h->cap ? 2 * h->cap : 16;
+      grown = realloc(h->ev, h->cap * sizeof(sim_event_t));
+      if (grown == NULL)
+         return -1;
+      h->ev = grown;
+   }
+
+   for (i = h->len++; i > 0; i = parent)
+   {
+      parent = (i - 1) / 2;
+      if (!event_before(&ev, &h->ev[parent]))
+         break;
+      h->ev[i] = h->ev[parent];
+   }
+   h->ev[i] = ev;
+
+   return 0;
+}
+
+static void event_pop(event_heap_t *h, sim_event_t *ev)
+{
+   sim_event_t last;
+   size_t i, child;
+
+   *ev = h->ev[0];
+   last = h->ev[--h->len];
+
+   for (i = 0; (child = 2 * i + 1) < h->len; i = child)
+   {
+      if ((child + 1 < h->len) && event_before(&h->ev[child + 1], &h->ev[child]))
+         child++;
+      if (!event_before(&h->ev[child], &last))
+         break;
+      h->ev[i] = h->ev[child];
+   }
+   h->ev[i] = last;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Simulator
+////////////////////////////////////////////////////////////////////////////////
+static void trace(sim_result_t *result, uint64_t time, uint32_t service, uint32_t job, sim_trace_type_t type)
+{
+   sim_trace_t *rec;
+
+   if (result->trace == NULL)
+      return;
+
+   if (result->trace_len >= result->trace_cap)
+   {
+      result->trace_dropped++;
+      return;
+   }
+
+   rec = &result->trace[result->trace_len++];
+   rec->time = time;
+   rec->job = job;
+   rec->service = (uint16_t)service;
+   rec->type = (uint16_t)type;
+}
+
+int64_t sched_simulate(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                       const sim_policy_t *policy, uint64_t horizon, int stop_on_miss,
+                       sim_result_t *result)
+{
+   job_heap_t ready = {NULL, 0, 0};
+   event_heap_t events = {NULL, 0, 0};
+   uint32_t *finished;
+   sim_job_t running, job;
+   sim_event_t ev;
+   int have_running = FALSE;
+   uint64_t now = 0, next, t;
+   int64_t running_key;
+   int64_t rc = 0;
+   U32_T i;
+
+   // keep the caller's trace buffer, clear everything else
+   result->trace_len = 0;
+   result->trace_dropped = 0;
+   result->end_time = 0;
+   result->events = 0;
+   result->jobs_released = 0;
+   result->jobs_finished = 0;
+   result->preemptions = 0;
+   result->deadline_misses = 0;
+
+   if (horizon == 0)
+      horizon = hyperperiod(numServices, period);
+   if (horizon == 0)
+      return -1;
+
+   // jobs of one service always finish in release order, so a count of
+   // finished jobs is enough to tell whether a given job is done
+   finished = calloc(numServices, sizeof(uint32_t));
+   if (finished == NULL)
+      return -1;
+
+   for (i = 0; i < numServices; i++)
+   {
+      if (event_push(&events, 0, i, 0, EV_RELEASE) < 0)
+      {
+         rc = -1;
+         goto done;
+      }
+   }
+
+   while (events.len || ready.len || have_running)
+   {
+      result->events++;
+
+      // next point in time where something happens
+      next = UINT64_MAX;
+      if (events.len)
+         next = events.ev[0].time;
+
+      if (have_running)
+      {
+         t = now + running.remaining;
+         if (t < next)
+            next = t;
+
+         // LLF: the running key grows by one per unit of time, so it passes
+         // the best waiting key (kw - kr + 1) units from now
+         if (policy->laxity_driven && ready.len)
+         {
+            running_key = (int64_t)running.deadline - (int64_t)running.remaining;
+            t = now + (uint64_t)(ready.jobs[0].key - running_key) + 1;
+            if (t < next)
+               next = t;
+         }
+
+         running.remaining -= next - now;
+      }
+      now = next;
+
+      // completion
+      if (have_running && (running.remaining == 0))
+      {
+         trace(result, now, running.service, running.job, SIM_TRACE_FINISH);
+         finished[running.service]++;
+         result->jobs_finished++;
+         have_running = FALSE;
+      }
+
+      // deadlines, then releases, due now
+      while (events.len && (events.ev[0].time <= now))
+      {
+         event_pop(&events, &ev);
+
+         if (ev.type == EV_DEADLINE)
+         {
+            if (finished[ev.service] <= ev.job)
+            {
+               trace(result, now, ev.service, ev.job, SIM_TRACE_MISS);
+               result->deadline_misses++;
+               if (stop_on_miss)
+                  goto done;
+            }
+            continue;
+         }
+
+         job.service = ev.service;
+         job.job = ev.job;
+         job.deadline = now + deadline[ev.service];
+         job.remaining = wcet[ev.service];
+         job.key = policy->key(&job, period, deadline);
+
+         if ((job_push(&ready, &job) < 0) ||
+             (event_push(&events, job.deadline, ev.service, ev.job, EV_DEADLINE) < 0) ||
+             ((now + period[ev.service] < horizon) &&
+              (event_push(&events, now + period[ev.service], ev.service, ev.job + 1, EV_RELEASE) < 0)))
+         {
+            rc = -1;
+            goto done;
+         }
+
+         trace(result, now, ev.service, ev.job, SIM_TRACE_RELEASE);
+         result->jobs_released++;
+      }
+
+      // dispatch
+      if (ready.len == 0)
+         continue;
+
+      if (have_running)
+      {
+         running.key = policy->key(&running, period, deadline);
+         if (ready.jobs[0].key >= running.key)
+            continue;
+
+         trace(result, now, running.service, running.job, SIM_TRACE_PREEMPT);
+         result->preemptions++;
+         if (job_push(&ready, &running) < 0)
+         {
+            rc = -1;
+            goto done;
+         }
+      }
+
+      job_pop(&ready, &running);
+      have_running = TRUE;
+      trace(result, now, running.service, running.job, SIM_TRACE_START);
+   }
+
+done:
+   result->end_time = now;
+   if (rc == 0)
+      rc = (int64_t)result->deadline_misses;
+
+   free(finished);
+   free(ready.jobs);
+   free(events.ev);
+
+   return rc;
+}
+
+void sched_sim_print_trace(FILE *out, const sim_result_t *result)
+{
+   static const char *names[] = {"RELEASE", "START", "PREEMPT", "FINISH", "MISS"};
+   uint64_t i;
+
+   for (i = 0; i < result->trace_len; i++)
+   {
+      fprintf(out, "%12llu  S%-3u job %-6u %s\n",
+              (unsigned long long)result->trace[i].time,
+              result->trace[i].service + 1,
+              result->trace[i].job,
+              names[result->trace[i].type]);
+   }
+
+   if (result->trace_dropped)
+      fprintf(out, "(%llu trace records dropped)\n", (unsigned long long)result->trace_dropped);
+}
+
+// Fixed priority fallback: response time analysis on a copy of the set
+// sorted by the policy's key.  The sort is stable, so equal keys keep their
+// index order just as the simulator's FIFO tie break does.
+static int fp_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], const U32_T key[])
+{
+   U32_T sp[numServices], sw[numServices], sd[numServices], order[numServices];
+   U32_T i, j, tmp;
+
+   for (i = 0; i < numServices; i++)
+   {
+      order[i] = i;
+      for (j = i; (j > 0) && (key[order[j - 1]] > key[order[j]]); j--)
+      {
+         tmp = order[j]; order[j] = order[j - 1]; order[j - 1] = tmp;
+      }
+   }
+
+   for (i = 0; i < numServices; i++)
+   {
+      sp[i] = period[order[i]];
+      sw[i] = wcet[order[i]];
+      sd[i] = deadline[order[i]];
+   }
+
+   return response_time_analysis(numServices, sp, sw, sd, NULL);
+}
+
+static int sim_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[], const sim_policy_t *policy)
+{
+   sim_result_t result;
+   uint64_t horizon, jobs = 0;
+   double utility_sum = 0.0;
+   U32_T i;
+
+   // over 100% every policy misses within a hyperperiod, but under LLF two
+   // jobs with equal laxity swap on every tick until they do, which with
+   // long periods is billions of events.  the tolerance is the one QPA uses.
+   for (i = 0; i < numServices; i++)
+      utility_sum += (double)wcet[i] / (double)period[i];
+   if (utility_sum > 1.0 + 1e-9)
+      return FALSE;
+
+   // one hyperperiod decides the set, but it may not fit in 64 bits or may
+   // hold far too many jobs to simulate.  fall back to the exact analytic
+   // test for the same policy then; LLF, like EDF, is optimal on one core.
+   horizon = hyperperiod(numServices, period);
+   for (i = 0; (i < numServices) && (horizon != 0); i++)
+      jobs = t64_add(jobs, horizon / period[i]);
+
+   if ((horizon == 0) || (jobs > FEASIBILITY_SIM_LIMIT))
+   {
+      if (policy == &sim_policy_rm)
+         return fp_feasibility(numServices, period, wcet, deadline, period);
+      if (policy == &sim_policy_dm)
+         return fp_feasibility(numServices, period, wcet, deadline, deadline);
+
+      return edf_qpa_feasibility(numServices, period, wcet, deadline);
+   }
+
+   memset(&result, 0, sizeof(result));
+
+   return (sched_simulate(numServices, period, wcet, deadline, policy, horizon, TRUE, &result) == 0) ? TRUE : FALSE;
+}
+
+int sim_rm_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return sim_feasibility(numServices, period, wcet, deadline, &sim_policy_rm);
+}
+
+int sim_dm_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return sim_feasibility(numServices, period, wcet, deadline, &sim_policy_dm);
+}
+
+int sim_edf_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return sim_feasibility(numServices, period, wcet, deadline, &sim_policy_edf);
+}
+
+int sim_llf_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return sim_feasibility(numServices, period, wcet, deadline, &sim_policy_llf);
+}
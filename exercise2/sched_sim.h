@@ -0,0 +1,97 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Discrete event scheduling simulator for a single core.  Time advances
+// from one release, completion or deadline to the next instead of one tick
+// at a time, so the cost depends on the number of jobs in the simulated
+// interval and not on the time resolution of the periods.
+
+#ifndef SCHED_SIM_H
+#define SCHED_SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "feasibility.h"
+
+// one trace record per scheduling event, 16 bytes each
+typedef enum
+{
+   SIM_TRACE_RELEASE = 0,
+   SIM_TRACE_START,           // job (re)gains the CPU
+   SIM_TRACE_PREEMPT,         // job loses the CPU before finishing
+   SIM_TRACE_FINISH,
+   SIM_TRACE_MISS             // deadline passed with the job unfinished
+} sim_trace_type_t;
+
+typedef struct
+{
+   uint64_t time;
+   uint32_t job;              // job number within the service, from 0
+   uint16_t service;          // index into the service arrays
+   uint16_t type;             // sim_trace_type_t
+} sim_trace_t;
+
+// A job waiting for the CPU.  Lower key runs first, ties go to the lower
+// service index and then to the earlier job.
+typedef struct
+{
+   int64_t key;
+   uint64_t deadline;         // absolute
+   uint64_t remaining;        // execution time still owed
+   uint32_t service;
+   uint32_t job;
+} sim_job_t;
+
+// A priority policy computes the key of a job when it is released and again
+// whenever it is preempted.  If laxity_driven is set, the key of the running
+// job grows with time as (deadline - remaining) does, and the simulator
+// schedules a preemption at the instant it overtakes the best waiting job.
+typedef struct
+{
+   const char *name;
+   int64_t (*key)(const sim_job_t *job, U32_T period[], U32_T deadline[]);
+   int laxity_driven;
+} sim_policy_t;
+
+extern const sim_policy_t sim_policy_rm;
+extern const sim_policy_t sim_policy_dm;
+extern const sim_policy_t sim_policy_edf;
+extern const sim_policy_t sim_policy_llf;
+
+typedef struct
+{
+   // caller supplied trace buffer, may be NULL; records past trace_cap are
+   // counted in trace_dropped
+   sim_trace_t *trace;
+   uint64_t trace_cap;
+   uint64_t trace_len;
+   uint64_t trace_dropped;
+
+   uint64_t end_time;         // time the simulation stopped
+   uint64_t events;           // event loop iterations
+   uint64_t jobs_released;
+   uint64_t jobs_finished;
+   uint64_t preemptions;
+   uint64_t deadline_misses;
+} sim_result_t;
+
+// Simulates synchronous periodic releases in [0, horizon) under the given
+// policy and runs until every released job has finished (or, with
+// stop_on_miss, until the first deadline miss).  horizon 0 means one
+// hyperperiod.  Returns the number of deadline misses, or -1 if the
+// hyperperiod does not fit in 64 bits or memory runs out.
+int64_t sched_simulate(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                       const sim_policy_t *policy, uint64_t horizon, int stop_on_miss,
+                       sim_result_t *result);
+
+void sched_sim_print_trace(FILE *out, const sim_result_t *result);
+
+// Feasibility over one hyperperiod with the common test signature
+int sim_rm_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int sim_dm_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int sim_edf_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int sim_llf_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+#endif
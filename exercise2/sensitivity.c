@@ -0,0 +1,819 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Sensitivity analysis by search over the exact feasibility tests.
+//
+// Feasibility only gets harder as a WCET grows or a period shrinks, so each
+// margin is found by binary search with an exact test as the oracle
+// (response_time_analysis() for RM and DM, edf_qpa_feasibility() for EDF).
+// Before any exact test runs, the oracle settles what it can from the
+// utilization alone:
+//
+//    U > 1                              - infeasible under every policy
+//    D = T and EDF                      - feasible iff U <= 1
+//    EDF, sum(C(i)/D(i)) < 1            - feasible (density)
+//    D = T and RM, U <= n(2^(1/n) - 1)  - feasible (Liu and Layland)
+//    D = T and RM, prod(U(i) + 1) <= 2  - feasible (hyperbolic bound)
+//
+// with U within UTIL_TOLERANCE of 1 compared in exact arithmetic, since the
+// WCET searches end right at U = 1, where QPA would have to cover the whole
+// hyperperiod.  The search ranges start from the same bounds, e.g. no WCET
+// can be larger than (1 - U(others)) * T(i).
+//
+// Under fixed priorities each trial only differs from the last feasible one
+// in one service, so response_time_analysis_from() skips the services above
+// it and seeds the rest from the last feasible response times, which are
+// lower bounds for any harder trial.  When the set is feasible as given, its
+// slack (see build_slack()) gives every WCET margin with no search at all,
+// and settles most services of a period trial without running their RTA.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sensitivity.h"
+#include "rta.h"
+#include "qpa.h"
+
+#define SCALE_TOLERANCE (1e-6)
+
+// same allowance for rounding in U as edf_demand_bound(); closer to 1 than
+// this, utilization_at_most_one() decides
+#define UTIL_TOLERANCE (1e-9)
+
+#define NO_SERVICE ((U32_T)-1)
+
+#define SLACK_UNKNOWN (0)
+#define SLACK_READY   (1)
+#define SLACK_NONE    (2)
+
+// peaks slack_accepts() checks before falling back to the RTA
+#define SLACK_PEAKS (4)
+
+typedef struct
+{
+   sensitivity_policy_t policy;
+   U32_T n;
+   U32_T *period, *wcet, *deadline;          // trial parameters, caller order
+   U32_T *order;                             // priority position -> service
+   U32_T *pos;                               // service -> priority position
+   U32_T *sp, *sw, *sd, *resp;               // trial set in priority order
+   U32_T *base;                              // response times of the last
+   U32_T *orig;                              // feasible trial / original set,
+   int base_valid, orig_valid;               // by service
+   U32_T *grow;                              // slack of the set as given
+   U32_T *peaks, *peak_t, *peak_s;           // by service, see build_slack()
+   U32_T *given_pos, *given_period, *given_wcet;
+   int slack_state;
+   U32_T base_rank;                          // position of the changed
+                                             // service in the base trial
+   U32_T last_miss;                          // service that failed last
+   double ll_bound;
+   uint64_t oracle_calls, pruned;
+} sens_ctx_t;
+
+static int priority_before(const sens_ctx_t *ctx, U32_T a, U32_T b)
+{
+   U32_T ka = (ctx->policy == SENSITIVITY_RM) ? ctx->period[a] : ctx->deadline[a];
+   U32_T kb = (ctx->policy == SENSITIVITY_RM) ? ctx->period[b] : ctx->deadline[b];
+
+   return (ka != kb) ? (ka < kb) : (a < b);
+}
+
+// Insertion sort, since a search only ever moves one service at a time and
+// the order left by the previous call is almost always still sorted.
+static void sort_priority(sens_ctx_t *ctx)
+{
+   U32_T i, j, s;
+
+   for (i = 1; i < ctx->n; i++)
+   {
+      s = ctx->order[i];
+      for (j = i; (j > 0) && priority_before(ctx, s, ctx->order[j - 1]); j--)
+         ctx->order[j] = ctx->order[j - 1];
+      ctx->order[j] = s;
+   }
+
+   for (i = 0; i < ctx->n; i++)
+      ctx->pos[ctx->order[i]] = i;
+}
+
+// Copies the trial set into priority order, seeded from the base.
+static void load_trial(sens_ctx_t *ctx)
+{
+   U32_T i, s;
+
+   for (i = 0; i < ctx->n; i++)
+   {
+      s = ctx->order[i];
+      ctx->sp[i] = ctx->period[s];
+      ctx->sw[i] = ctx->wcet[s];
+      ctx->sd[i] = ctx->deadline[s];
+      ctx->resp[i] = ctx->base_valid ? ctx->base[s] : 0;
+   }
+}
+
+// Slack of the set as given, under fixed priorities with D <= T.  Service k
+// still meets its deadline when the jobs above it grow by w(t) iff some t
+// in [R(k), D(k)] has
+//
+//    s(t) = t - W(k, t) >= w(t)
+//
+// where W(k, t) is C(k) plus every job released above k before t; below
+// R(k), W(k, t) > t already.  W only steps at releases, so s peaks right
+// before each release and at D(k), and one sweep over those releases per
+// service settles every WCET margin exactly.  C(i) grown by x adds
+// x * ceil(t/T(i)) for i above k, and the jobs of i only change at its
+// releases, so the highest peak so far at each release of i (and at D(k))
+// is the only one to try.  The last few record peaks of each service are
+// kept as well, and accept most trials of a shorter period without an RTA.
+static void add_peak(sens_ctx_t *ctx, U32_T k, uint64_t t, uint64_t s)
+{
+   U32_T r = k * SLACK_PEAKS + (ctx->peaks[k] % SLACK_PEAKS);
+
+   ctx->peak_t[r] = (U32_T)t;
+   ctx->peak_s[r] = (U32_T)s;
+   ctx->peaks[k]++;
+}
+
+// next release of each service above k, min-heap on time
+static void release_sift_down(uint64_t next[], U32_T svc[], U32_T len, U32_T j)
+{
+   uint64_t t = next[j];
+   U32_T s = svc[j], c;
+
+   while ((c = 2 * j + 1) < len)
+   {
+      if ((c + 1 < len) && (next[c + 1] < next[c]))
+         c++;
+      if (next[c] >= t)
+         break;
+      next[j] = next[c];
+      svc[j] = svc[c];
+      j = c;
+   }
+   next[j] = t;
+   svc[j] = s;
+}
+
+static void reach(U32_T fit[], U32_T j, uint64_t best, uint64_t jobs)
+{
+   if (best / jobs > fit[j])
+      fit[j] = (U32_T)(best / jobs);
+}
+
+static int build_slack(sens_ctx_t *ctx)
+{
+   uint64_t *next = NULL, w, t, dk, best;
+   U32_T *svc = NULL, *fit = NULL, k, s, j, len;
+   U32_T n = ctx->n;
+   int rc = -1;
+
+   if (ctx->slack_state != SLACK_UNKNOWN)
+      return (ctx->slack_state == SLACK_READY) ? 0 : -1;
+   ctx->slack_state = SLACK_NONE;
+
+   if ((ctx->policy == SENSITIVITY_EDF) || !ctx->orig_valid)
+      return -1;
+   for (k = 0; k < n; k++)
+   {
+      if (ctx->deadline[k] > ctx->period[k])
+         return -1;
+   }
+
+   next = malloc(n * sizeof(uint64_t));
+   svc = malloc(n * sizeof(U32_T));
+   fit = malloc(n * sizeof(U32_T));
+   ctx->grow = malloc(n * sizeof(U32_T));
+   ctx->peaks = malloc(n * sizeof(U32_T));
+   ctx->peak_t = malloc(n * SLACK_PEAKS * sizeof(U32_T));
+   ctx->peak_s = malloc(n * SLACK_PEAKS * sizeof(U32_T));
+   ctx->given_pos = malloc(n * sizeof(U32_T));
+   ctx->given_period = malloc(n * sizeof(U32_T));
+   ctx->given_wcet = malloc(n * sizeof(U32_T));
+   if (!next || !svc || !fit || !ctx->grow || !ctx->peaks || !ctx->peak_t || !ctx->peak_s ||
+       !ctx->given_pos || !ctx->given_period || !ctx->given_wcet)
+      goto done;
+
+   sort_priority(ctx);
+   memcpy(ctx->given_pos, ctx->pos, n * sizeof(U32_T));
+   memcpy(ctx->given_period, ctx->period, n * sizeof(U32_T));
+   memcpy(ctx->given_wcet, ctx->wcet, n * sizeof(U32_T));
+   for (s = 0; s < n; s++)
+      ctx->grow[s] = UINT32_MAX;
+
+   for (k = 0; k < n; k++)
+   {
+      s = ctx->order[k];
+      dk = ctx->deadline[s];
+      w = ctx->orig[s];
+      best = 0;
+      ctx->peaks[s] = 0;
+
+      for (len = 0; len < k; len++)
+      {
+         j = ctx->order[len];
+         next[len] = ((((w > 0) ? w : 1) + ctx->period[j] - 1) / ctx->period[j]) * ctx->period[j];
+         svc[len] = j;
+         fit[j] = 0;
+      }
+      for (j = len / 2; j-- > 0; )
+         release_sift_down(next, svc, len, j);
+
+      for (;;)
+      {
+         // the first peak, even with no slack, keeps every service's list
+         // nonempty
+         t = ((len > 0) && (next[0] < dk)) ? next[0] : dk;
+         if ((t >= w) && ((t - w > best) || (ctx->peaks[s] == 0)))
+         {
+            best = t - w;
+            add_peak(ctx, s, t, best);
+         }
+         if (t >= dk)
+            break;
+
+         while (next[0] == t)
+         {
+            j = svc[0];
+            reach(fit, j, best, t / ctx->period[j]);
+            w += ctx->wcet[j];
+            next[0] += ctx->period[j];
+            release_sift_down(next, svc, len, 0);
+         }
+
+         // s(t) <= D(k) - W from here on
+         if ((w >= dk) || (dk - w <= best))
+            break;
+      }
+
+      // the best peak so far holds from here on, so the next release of
+      // each service above, or D(k), has the fewest jobs to try
+      for (len = 0; len < k; len++)
+      {
+         j = svc[len];
+         reach(fit, j, best, (next[len] < dk) ? next[len] / ctx->period[j] :
+                                               (dk + ctx->period[j] - 1) / ctx->period[j]);
+         if (fit[j] < ctx->grow[j])
+            ctx->grow[j] = fit[j];
+      }
+      if (best < ctx->grow[s])
+         ctx->grow[s] = (U32_T)best;
+   }
+
+   ctx->slack_state = SLACK_READY;
+   rc = 0;
+
+done:
+   free(next);
+   free(svc);
+   free(fit);
+   return rc;
+}
+
+// Whether service k, below the changed service i in the trial order, is
+// sure to meet its deadline, checking the last few peaks of k against the
+// jobs i adds to the set as given.  FALSE only means not sure.
+static int slack_accepts(const sens_ctx_t *ctx, U32_T i, U32_T k)
+{
+   U32_T r, p;
+   int64_t added;
+   uint64_t t;
+
+   for (p = 0; (p < SLACK_PEAKS) && (p < ctx->peaks[k]); p++)
+   {
+      r = k * SLACK_PEAKS + ((ctx->peaks[k] - 1 - p) % SLACK_PEAKS);
+      t = ctx->peak_t[r];
+      added = (int64_t)(((t + ctx->period[i] - 1) / ctx->period[i]) * ctx->wcet[i]);
+      if (ctx->given_pos[i] < ctx->given_pos[k])
+         added -= (int64_t)(((t + ctx->given_period[i] - 1) / ctx->given_period[i]) * ctx->given_wcet[i]);
+      if (added <= (int64_t)ctx->peak_s[r])
+         return TRUE;
+   }
+
+   return FALSE;
+}
+
+// Decides the trial set.  changed is the one service whose parameters
+// differ from the last feasible trial (NO_SERVICE if they all may), and
+// moved_up is set when its period shrank, so its own response time may have
+// dropped, if it passed another service since the base trial.  With keep set, a feasible trial becomes the new base, which
+// seeds later trials that are at least as hard.
+static int oracle(sens_ctx_t *ctx, U32_T changed, int moved_up, int keep)
+{
+   double util = 0.0, density = 0.0, hyperbolic = 1.0, u;
+   int implicit = TRUE, feasible, exact, quick;
+   U32_T i, first;
+
+   for (i = 0; i < ctx->n; i++)
+   {
+      u = (double)ctx->wcet[i] / (double)ctx->period[i];
+      util += u;
+      density += (double)ctx->wcet[i] / (double)ctx->deadline[i];
+      hyperbolic *= u + 1.0;
+      if (ctx->deadline[i] != ctx->period[i])
+         implicit = FALSE;
+   }
+
+   if (util > 1.0 + UTIL_TOLERANCE)
+      exact = FALSE;
+   else if (util < 1.0 - UTIL_TOLERANCE)
+      exact = TRUE;
+   else if ((exact = utilization_at_most_one(ctx->n, ctx->period, ctx->wcet)) < 0)
+      exact = (util <= 1.0);
+
+   if (!exact)
+   {
+      ctx->pruned++;
+      return FALSE;
+   }
+
+   if (ctx->policy == SENSITIVITY_EDF)
+   {
+      if (implicit || (density < 1.0 - UTIL_TOLERANCE))
+      {
+         ctx->pruned++;
+         return TRUE;
+      }
+
+      ctx->oracle_calls++;
+      return edf_qpa_feasibility(ctx->n, ctx->period, ctx->wcet, ctx->deadline);
+   }
+
+   if (implicit && (ctx->policy == SENSITIVITY_RM) && ((util <= ctx->ll_bound) || (hyperbolic <= 2.0)))
+   {
+      ctx->pruned++;
+      return TRUE;
+   }
+
+   ctx->oracle_calls++;
+
+   if (moved_up)
+      sort_priority(ctx);
+   load_trial(ctx);
+
+   // services above the changed one keep their response times
+   first = 0;
+   if (ctx->base_valid && (changed != NO_SERVICE))
+   {
+      first = ctx->pos[changed];
+      if (moved_up && (first != ctx->base_rank))
+         ctx->resp[first] = 0;
+   }
+
+   quick = (ctx->slack_state == SLACK_READY) && ctx->base_valid && (changed != NO_SERVICE);
+
+   // the service that missed last time is the most likely to miss again,
+   // and on its own it is much cheaper to check than everything below i
+   if ((ctx->last_miss != NO_SERVICE) && (ctx->pos[ctx->last_miss] > first) &&
+       !(quick && slack_accepts(ctx, changed, ctx->last_miss)) &&
+       !response_time_analysis_from(ctx->pos[ctx->last_miss] + 1, ctx->sp, ctx->sw, ctx->sd,
+                                    ctx->resp, ctx->pos[ctx->last_miss]))
+      return FALSE;
+
+   // whatever the slack of the set as given accepts keeps its lower bound
+   // and skips the RTA; the changed service itself only moved up, with
+   // less interference than in the set as given, so it is fine as long as
+   // its original response time still meets its deadline
+   if (quick)
+   {
+      feasible = TRUE;
+      for (i = first; feasible && (i < ctx->n); i++)
+      {
+         if ((i == first) ? !(moved_up && (ctx->wcet[changed] == ctx->given_wcet[changed]) &&
+                              (ctx->orig[changed] <= ctx->deadline[changed])) :
+                            !slack_accepts(ctx, changed, ctx->order[i]))
+            feasible = response_time_analysis_from(i + 1, ctx->sp, ctx->sw, ctx->sd, ctx->resp, i);
+      }
+   }
+   else
+      feasible = response_time_analysis_from(ctx->n, ctx->sp, ctx->sw, ctx->sd, ctx->resp, first);
+
+   if (!feasible)
+   {
+      // the pass stops at the first miss, the only response past its deadline
+      for (i = first; (i < ctx->n) && (ctx->resp[i] <= ctx->sd[i]); i++);
+      ctx->last_miss = (i < ctx->n) ? ctx->order[i] : NO_SERVICE;
+   }
+
+   if (feasible && keep)
+   {
+      for (i = 0; i < ctx->n; i++)
+         ctx->base[ctx->order[i]] = ctx->resp[i];
+      ctx->base_valid = TRUE;
+      ctx->base_rank = (changed != NO_SERVICE) ? ctx->pos[changed] : NO_SERVICE;
+   }
+
+   return feasible;
+}
+
+// back to the original parameters and response times
+static void restore_base(sens_ctx_t *ctx)
+{
+   memcpy(ctx->base, ctx->orig, ctx->n * sizeof(U32_T));
+   ctx->base_valid = ctx->orig_valid;
+   ctx->base_rank = NO_SERVICE;
+}
+
+static int ctx_init(sens_ctx_t *ctx, sensitivity_policy_t policy, U32_T n,
+                    U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   U32_T i;
+
+   memset(ctx, 0, sizeof(*ctx));
+   ctx->policy = policy;
+   ctx->n = n;
+   ctx->period = malloc(n * sizeof(U32_T));
+   ctx->wcet = malloc(n * sizeof(U32_T));
+   ctx->deadline = malloc(n * sizeof(U32_T));
+   ctx->order = malloc(n * sizeof(U32_T));
+   ctx->pos = malloc(n * sizeof(U32_T));
+   ctx->sp = malloc(n * sizeof(U32_T));
+   ctx->sw = malloc(n * sizeof(U32_T));
+   ctx->sd = malloc(n * sizeof(U32_T));
+   ctx->resp = malloc(n * sizeof(U32_T));
+   ctx->base = malloc(n * sizeof(U32_T));
+   ctx->orig = malloc(n * sizeof(U32_T));
+
+   if (!ctx->period || !ctx->wcet || !ctx->deadline || !ctx->order || !ctx->pos ||
+       !ctx->sp || !ctx->sw || !ctx->sd || !ctx->resp || !ctx->base || !ctx->orig)
+      return -1;
+
+   memcpy(ctx->period, period, n * sizeof(U32_T));
+   memcpy(ctx->wcet, wcet, n * sizeof(U32_T));
+   memcpy(ctx->deadline, deadline, n * sizeof(U32_T));
+   for (i = 0; i < n; i++)
+      ctx->order[i] = i;
+   sort_priority(ctx);
+
+   ctx->ll_bound = (double)n * (pow(2.0, (1.0/((double)n))) - 1.0);
+   ctx->last_miss = NO_SERVICE;
+
+   // response times of the original set, when it is feasible, seed every
+   // search that only makes it harder
+   if (policy != SENSITIVITY_EDF)
+   {
+      load_trial(ctx);
+      if (response_time_analysis_from(n, ctx->sp, ctx->sw, ctx->sd, ctx->resp, 0) == TRUE)
+      {
+         for (i = 0; i < n; i++)
+            ctx->orig[ctx->order[i]] = ctx->resp[i];
+         ctx->orig_valid = TRUE;
+      }
+   }
+   restore_base(ctx);
+
+   return 0;
+}
+
+static void ctx_free(sens_ctx_t *ctx)
+{
+   free(ctx->period); free(ctx->wcet); free(ctx->deadline);
+   free(ctx->order); free(ctx->pos);
+   free(ctx->sp); free(ctx->sw); free(ctx->sd); free(ctx->resp);
+   free(ctx->base); free(ctx->orig);
+   free(ctx->grow); free(ctx->peaks); free(ctx->peak_t); free(ctx->peak_s);
+   free(ctx->given_pos); free(ctx->given_period); free(ctx->given_wcet);
+}
+
+// utilization of every service but i
+static double other_utilization(const sens_ctx_t *ctx, U32_T i)
+{
+   double util = 0.0;
+   U32_T j;
+
+   for (j = 0; j < ctx->n; j++)
+   {
+      if (j != i)
+         util += (double)ctx->wcet[j] / (double)ctx->period[j];
+   }
+
+   return util;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// WCET scaling factor
+//      * the factor can be no more than 1/U, since the scaled set has
+//      * utilization of at least a*U, and is at least 1 if the set is
+//      * feasible as given
+//      * bisect until the bracket is within SCALE_TOLERANCE of 1/U
+////////////////////////////////////////////////////////////////////////////////
+static void set_scaled_wcet(sens_ctx_t *ctx, U32_T wcet[], double scale)
+{
+   double c;
+   U32_T i;
+
+   for (i = 0; i < ctx->n; i++)
+   {
+      c = ceil(scale * (double)wcet[i]);
+      ctx->wcet[i] = (c < 1.0) ? 1 : (c > (double)UINT32_MAX) ? UINT32_MAX : (U32_T)c;
+   }
+}
+
+static double search_wcet_scale(sens_ctx_t *ctx, U32_T wcet[])
+{
+   double lo = 0.0, hi, mid, limit, util = 0.0;
+   U32_T i;
+
+   for (i = 0; i < ctx->n; i++)
+      util += (double)wcet[i] / (double)ctx->period[i];
+
+   if (util == 0.0)
+      return 0.0;
+   hi = 1.0 / util;
+   limit = SCALE_TOLERANCE * hi;
+
+   // the original response times only bound trials with a >= 1
+   restore_base(ctx);
+   if (oracle(ctx, NO_SERVICE, FALSE, FALSE))
+      lo = 1.0;
+   else
+      ctx->base_valid = FALSE;
+
+   set_scaled_wcet(ctx, wcet, hi);
+   if (oracle(ctx, NO_SERVICE, FALSE, TRUE))
+      lo = hi;
+
+   while ((hi - lo) > limit)
+   {
+      mid = 0.5 * (lo + hi);
+      set_scaled_wcet(ctx, wcet, mid);
+      if (oracle(ctx, NO_SERVICE, FALSE, TRUE))
+         lo = mid;
+      else
+         hi = mid;
+   }
+
+   memcpy(ctx->wcet, wcet, ctx->n * sizeof(U32_T));
+   return lo;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Maximum WCET of service i
+//      * under fixed priorities, with the set feasible as given and D <= T,
+//      * read it off the slack of i and every service below it, no search
+//      * needed
+//      * otherwise the WCET can be no more than D(i) or
+//      * (1 - U(others)) * T(i), and under fixed priorities no more than
+//      * D(k) minus one job of every other service at or above k, for i and
+//      * each service k below it, taken from the set as given rather than
+//      * the last trial
+//      * if that is feasible it is the answer (always so for EDF with D=T)
+//      * otherwise binary search below it, from C(i) if the set is feasible
+//      * as given and from 0 if not
+////////////////////////////////////////////////////////////////////////////////
+static U32_T search_max_wcet(sens_ctx_t *ctx, U32_T i)
+{
+   U32_T saved = ctx->wcet[i], lo = 0, hi, mid, q, s;
+   double room = (1.0 + UTIL_TOLERANCE - other_utilization(ctx, i)) * (double)ctx->period[i];
+   uint64_t others = 0;
+
+   if (build_slack(ctx) == 0)
+      return ctx->wcet[i] + ctx->grow[i];
+
+   if (room < 1.0)
+      return 0;
+
+   hi = (room >= (double)ctx->deadline[i]) ? ctx->deadline[i] : (U32_T)room;
+
+   if (ctx->policy != SENSITIVITY_EDF)
+   {
+      sort_priority(ctx);
+      for (q = 0; q < ctx->n; q++)
+      {
+         s = ctx->order[q];
+         if (s != i)
+            others += ctx->wcet[s];
+         if ((q >= ctx->pos[i]) && (others + hi > ctx->deadline[s]))
+            hi = (others >= ctx->deadline[s]) ? 0 : ctx->deadline[s] - (U32_T)others;
+      }
+      if (hi == 0)
+         return 0;
+   }
+
+   restore_base(ctx);
+   if (ctx->base_valid && (saved <= hi))
+      lo = saved;
+
+   ctx->wcet[i] = hi;
+   if (oracle(ctx, i, FALSE, FALSE))
+   {
+      ctx->wcet[i] = saved;
+      return hi;
+   }
+
+   hi--;
+   while (lo < hi)
+   {
+      mid = lo + (hi - lo + 1) / 2;
+      ctx->wcet[i] = mid;
+      if (oracle(ctx, i, FALSE, TRUE))
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+
+   ctx->wcet[i] = saved;
+   return lo;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Minimum period of service i
+//      * the period can be no less than C(i), C(i) / (1 - U(others)), or a
+//      * fixed deadline
+//      * if that is feasible it is the answer
+//      * otherwise find a feasible period, T(i) if the set is feasible as
+//      * given or doubling from it if not, then binary search below it
+////////////////////////////////////////////////////////////////////////////////
+static void set_period(sens_ctx_t *ctx, U32_T i, U32_T p, int implicit)
+{
+   ctx->period[i] = p;
+   if (implicit)
+      ctx->deadline[i] = p;
+}
+
+static U32_T search_min_period(sens_ctx_t *ctx, U32_T i)
+{
+   U32_T saved_period = ctx->period[i], saved_deadline = ctx->deadline[i];
+   int implicit = (saved_deadline == saved_period);
+   double others = other_utilization(ctx, i), bound;
+   uint64_t lo, hi, mid;
+   U32_T result = 0;
+
+   if (others >= 1.0)
+      return 0;
+
+   bound = ceil((double)ctx->wcet[i] / (1.0 + UTIL_TOLERANCE - others));
+   if (bound > (double)UINT32_MAX)
+      return 0;
+
+   lo = (uint64_t)bound;
+   if (lo < ctx->wcet[i])
+      lo = ctx->wcet[i];
+   if (!implicit && (lo < saved_deadline))
+      lo = saved_deadline;
+   if (lo == 0)
+      lo = 1;
+
+   build_slack(ctx);
+   restore_base(ctx);
+
+   set_period(ctx, i, (U32_T)lo, implicit);
+   if (oracle(ctx, i, TRUE, FALSE))
+   {
+      result = (U32_T)lo;
+      goto done;
+   }
+   lo++;
+
+   if (ctx->base_valid && (saved_period >= lo))
+      hi = saved_period;
+   else
+   {
+      for (hi = (saved_period > lo) ? saved_period : lo; ; hi = 2 * hi)
+      {
+         if (hi > UINT32_MAX)
+            goto done;
+         set_period(ctx, i, (U32_T)hi, implicit);
+         if (oracle(ctx, i, TRUE, TRUE))
+            break;
+         lo = hi + 1;
+      }
+   }
+
+   while (lo < hi)
+   {
+      mid = lo + (hi - lo) / 2;
+      set_period(ctx, i, (U32_T)mid, implicit);
+      if (oracle(ctx, i, TRUE, TRUE))
+         hi = mid;
+      else
+         lo = mid + 1;
+   }
+   result = (U32_T)hi;
+
+done:
+   ctx->period[i] = saved_period;
+   ctx->deadline[i] = saved_deadline;
+   sort_priority(ctx);
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public interface
+////////////////////////////////////////////////////////////////////////////////
+int sensitivity_report(sensitivity_policy_t policy, U32_T numServices,
+                       U32_T period[], U32_T wcet[], U32_T deadline[], sensitivity_t *report)
+{
+   sens_ctx_t ctx;
+   U32_T i;
+   int rc = 0;
+
+   report->wcet_scale = 0.0;
+   report->oracle_calls = 0;
+   report->pruned = 0;
+
+   if (ctx_init(&ctx, policy, numServices, period, wcet, deadline) < 0)
+   {
+      rc = -1;
+      goto done;
+   }
+
+   report->wcet_scale = search_wcet_scale(&ctx, wcet);
+
+   for (i = 0; i < numServices; i++)
+   {
+      if (report->max_wcet != NULL)
+         report->max_wcet[i] = search_max_wcet(&ctx, i);
+      if (report->min_period != NULL)
+         report->min_period[i] = search_min_period(&ctx, i);
+   }
+
+   report->oracle_calls = ctx.oracle_calls;
+   report->pruned = ctx.pruned;
+
+done:
+   ctx_free(&ctx);
+   return rc;
+}
+
+double sensitivity_wcet_scale(sensitivity_policy_t policy, U32_T numServices,
+                              U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   sens_ctx_t ctx;
+   double scale = 0.0;
+
+   if (ctx_init(&ctx, policy, numServices, period, wcet, deadline) == 0)
+      scale = search_wcet_scale(&ctx, wcet);
+
+   ctx_free(&ctx);
+   return scale;
+}
+
+int sensitivity_max_wcet(sensitivity_policy_t policy, U32_T numServices,
+                         U32_T period[], U32_T wcet[], U32_T deadline[], U32_T max_wcet[])
+{
+   sens_ctx_t ctx;
+   U32_T i;
+   int rc = -1;
+
+   if (ctx_init(&ctx, policy, numServices, period, wcet, deadline) == 0)
+   {
+      for (i = 0; i < numServices; i++)
+         max_wcet[i] = search_max_wcet(&ctx, i);
+      rc = 0;
+   }
+
+   ctx_free(&ctx);
+   return rc;
+}
+
+int sensitivity_min_period(sensitivity_policy_t policy, U32_T numServices,
+                           U32_T period[], U32_T wcet[], U32_T deadline[], U32_T min_period[])
+{
+   sens_ctx_t ctx;
+   U32_T i;
+   int rc = -1;
+
+   if (ctx_init(&ctx, policy, numServices, period, wcet, deadline) == 0)
+   {
+      for (i = 0; i < numServices; i++)
+         min_period[i] = search_min_period(&ctx, i);
+      rc = 0;
+   }
+
+   ctx_free(&ctx);
+   return rc;
+}
+
+void sensitivity_print(FILE *out, U32_T numServices, U32_T period[], U32_T wcet[],
+                       U32_T deadline[], const sensitivity_t *report)
+{
+   U32_T i;
+
+   fprintf(out, "WCET scaling factor: %.6f\n", report->wcet_scale);
+   fprintf(out, "%8s %10s %10s %10s %10s %10s\n", "service", "C", "T", "D", "max C", "min T");
+
+   for (i = 0; i < numServices; i++)
+   {
+      fprintf(out, "%8u %10u %10u %10u ", i + 1, wcet[i], period[i], deadline[i]);
+
+      if (report->max_wcet == NULL)
+         fprintf(out, "%10s ", "-");
+      else if (report->max_wcet[i] == 0)
+         fprintf(out, "%10s ", "none");
+      else
+         fprintf(out, "%10u ", report->max_wcet[i]);
+
+      if (report->min_period == NULL)
+         fprintf(out, "%10s\n", "-");
+      else if (report->min_period[i] == 0)
+         fprintf(out, "%10s\n", "none");
+      else
+         fprintf(out, "%10u\n", report->min_period[i]);
+   }
+
+   fprintf(out, "%llu exact tests, %llu decided by utilization bounds\n",
+           (unsigned long long)report->oracle_calls, (unsigned long long)report->pruned);
+}
@@ -0,0 +1,63 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Sensitivity analysis: how far WCETs and periods can move before a service
+// set stops being feasible.
+
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "feasibility.h"
+
+// Scheduling policy the margins are computed for.  RM and DM order the
+// services by period or deadline internally (ties keep the caller's order)
+// and use response time analysis, EDF uses QPA.  Deadlines must not exceed
+// periods.
+typedef enum
+{
+   SENSITIVITY_RM,
+   SENSITIVITY_DM,
+   SENSITIVITY_EDF
+} sensitivity_policy_t;
+
+// max_wcet[] and min_period[] are caller arrays of numServices entries,
+// indexed like the input arrays.  Either may be NULL to skip that part.
+typedef struct
+{
+   double wcet_scale;         // critical scaling factor of all WCETs
+   U32_T *max_wcet;           // largest C(i) with everything else unchanged, 0 if none
+   U32_T *min_period;         // smallest T(i) with everything else unchanged, 0 if none
+   uint64_t oracle_calls;     // exact tests actually run
+   uint64_t pruned;           // decisions made by utilization bounds alone
+} sensitivity_t;
+
+// Largest factor a such that the set is still feasible when every WCET is
+// replaced by ceil(a*C(i)).  Above 1 is slack, below 1 is how far the WCETs
+// have to shrink.  Returns 0 if even one tick per service is infeasible.
+double sensitivity_wcet_scale(sensitivity_policy_t policy, U32_T numServices,
+                              U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// Largest admissible WCET of each service when all other parameters stay
+// as given.  Returns 0 on success, -1 if out of memory.
+int sensitivity_max_wcet(sensitivity_policy_t policy, U32_T numServices,
+                         U32_T period[], U32_T wcet[], U32_T deadline[], U32_T max_wcet[]);
+
+// Smallest admissible period of each service when all other parameters stay
+// as given.  A service with D(i) == T(i) keeps its deadline equal to the
+// period, otherwise the deadline is kept and the period stays at or above
+// it.  Returns 0 on success, -1 if out of memory.
+int sensitivity_min_period(sensitivity_policy_t policy, U32_T numServices,
+                           U32_T period[], U32_T wcet[], U32_T deadline[], U32_T min_period[]);
+
+// All three of the above in one pass, with counters.
+int sensitivity_report(sensitivity_policy_t policy, U32_T numServices,
+                       U32_T period[], U32_T wcet[], U32_T deadline[], sensitivity_t *report);
+
+void sensitivity_print(FILE *out, U32_T numServices, U32_T period[], U32_T wcet[],
+                       U32_T deadline[], const sensitivity_t *report);
+
+#endif
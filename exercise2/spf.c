@@ -0,0 +1,195 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Reduced scheduling point test.
+//
+// scheduling_point_feasibility() checks service i at every l*T(k) <= T(i)
+// for all k <= i, which is roughly sum(T(i)/T(k)) points per service and a
+// full demand sum at each.  Bini and Buttazzo showed that the much smaller
+// set P(i-1)(T(i)) is enough, where
+//
+//    P(0)(t) = { t }
+//    P(j)(t) = P(j-1)(floor(t/T(j))*T(j))  U  P(j-1)(t)
+//
+// so service i is schedulable iff C(i) + sum(ceil(t/T(j))*C(j), j < i) <= t
+// for some t in that set.  Every point in it is a multiple of some T(k) no
+// greater than T(i), so it is a subset of the full set and never larger.
+//
+// Bini, Enrico, and Giorgio C. Buttazzo. "Schedulability analysis of
+// periodic fixed priority systems." IEEE Transactions on Computers 53.11
+// (2004): 1462-1473.
+//
+// Demand sums are kept in a hash table keyed by t together with how many
+// services they already cover, so a point that comes up again for a lower
+// priority service only adds the terms for the services not yet counted.
+// The same table marks which points are already in the current set.
+
+#include <stdlib.h>
+
+#include "spf.h"
+
+typedef struct
+{
+   uint64_t t;          // 0 marks an empty slot
+   uint64_t demand;     // sum of ceil(t/T(j))*C(j) for j < upto
+   U32_T upto;
+   U32_T stamp;         // service whose point set last included t, plus 1
+} spf_point_t;
+
+typedef struct
+{
+   spf_point_t *slot;
+   size_t mask, len;
+} spf_memo_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Memo table, open addressing with linear probing
+////////////////////////////////////////////////////////////////////////////////
+static size_t hash_point(uint64_t t)
+{
+   t ^= t >> 33;
+   t *= 0xff51afd7ed558ccdULL;
+   t ^= t >> 33;
+   return (size_t)t;
+}
+
+static int memo_grow(spf_memo_t *memo)
+{
+   size_t old_size = memo->slot ? memo->mask + 1 : 0;
+   size_t new_size = old_size ? 2 * old_size : 1024;
+   spf_point_t *old = memo->slot;
+   size_t i, h;
+
+   memo->slot = calloc(new_size, sizeof(spf_point_t));
+   if (memo->slot == NULL)
+   {
+      memo->slot = old;
+      return -1;
+   }
+   memo->mask = new_size - 1;
+
+   for (i = 0; i < old_size; i++)
+   {
+      if (old[i].t == 0)
+         continue;
+      for (h = hash_point(old[i].t) & memo->mask; memo->slot[h].t != 0; h = (h + 1) & memo->mask);
+      memo->slot[h] = old[i];
+   }
+
+   free(old);
+   return 0;
+}
+
+static spf_point_t *memo_get(spf_memo_t *memo, uint64_t t)
+{
+   size_t h;
+
+   // keep the load factor at or below one half
+   if ((2 * (memo->len + 1) > memo->mask + 1) && (memo_grow(memo) < 0))
+      return NULL;
+
+   for (h = hash_point(t) & memo->mask; memo->slot[h].t != 0; h = (h + 1) & memo->mask)
+   {
+      if (memo->slot[h].t == t)
+         return &memo->slot[h];
+   }
+
+   memo->slot[h].t = t;
+   memo->len++;
+   return &memo->slot[h];
+}
+
+// Adds t to service i's point set unless it is already there, and checks
+// it.  Returns 1 if W(t) <= t, 0 if not (or t was a duplicate), -1 if out
+// of memory.
+static int add_point(spf_memo_t *memo, uint64_t **points, size_t *num_points, size_t *cap,
+                     uint64_t t, U32_T i, U32_T period[], U32_T wcet[])
+{
+   spf_point_t *p;
+   uint64_t *grown;
+
+   if ((p = memo_get(memo, t)) == NULL)
+      return -1;
+
+   if (p->stamp == i + 1)
+      return 0;
+   p->stamp = i + 1;
+
+   if (*num_points == *cap)
+   {
+      *cap = *cap ? 2 * *cap : 256;
+      grown = realloc(*points, *cap * sizeof(uint64_t));
+      if (grown == NULL)
+         return -1;
+      *points = grown;
+   }
+   (*points)[(*num_points)++] = t;
+
+   // bring the memoized demand up to services 0..i
+   for (; p->upto <= i; p->upto++)
+      p->demand = t64_add(p->demand, t64_mul(t64_ceil_div(t, period[p->upto]), wcet[p->upto]));
+
+   return (p->demand <= t) ? 1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Test
+//      * FOR each service i, highest priority first:
+//      *       start the point set with T(i)
+//      *       FOR j from i-1 down to 0, add floor(t/T(j))*T(j) for every
+//      *       point t already in the set
+//      *       the service is schedulable as soon as one point has W(t) <= t
+//      *       (each point is checked the moment it is added)
+////////////////////////////////////////////////////////////////////////////////
+int reduced_scheduling_point_checked(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                     uint64_t *checked)
+{
+   spf_memo_t memo = {NULL, 0, 0};
+   uint64_t *points = NULL, t;
+   size_t num_points, cap = 0, k, level_end;
+   U32_T i, j;
+   int rc = TRUE, status;
+
+   // D = T, the deadlines are only there for the common signature
+   (void)deadline;
+
+   if (checked != NULL)
+      *checked = 0;
+
+   for (i = 0; (i < numServices) && (rc == TRUE); i++)
+   {
+      num_points = 0;
+      status = add_point(&memo, &points, &num_points, &cap, period[i], i, period, wcet);
+
+      for (j = i; (j-- > 0) && (status == 0); )
+      {
+         // points added at this level are already multiples of T(j)
+         level_end = num_points;
+
+         for (k = 0; (k < level_end) && (status == 0); k++)
+         {
+            t = (points[k] / period[j]) * period[j];
+            if (t != 0)
+               status = add_point(&memo, &points, &num_points, &cap, t, i, period, wcet);
+         }
+      }
+
+      if (checked != NULL)
+         *checked += num_points;
+
+      // no point with enough CPU, or out of memory
+      if (status != 1)
+         rc = FALSE;
+   }
+
+   free(points);
+   free(memo.slot);
+
+   return rc;
+}
+
+int reduced_scheduling_point_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   return reduced_scheduling_point_checked(numServices, period, wcet, deadline, NULL);
+}
@@ -0,0 +1,25 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Scheduling point test over the reduced point set of Bini and Buttazzo.
+
+#ifndef SPF_H
+#define SPF_H
+
+#include <stdint.h>
+
+#include "feasibility.h"
+
+// Same decision as scheduling_point_feasibility() (services ordered from
+// highest to lowest priority, D = T), but only the points of the reduced
+// set P(i-1)(T(i)) are checked and demand sums are memoized across services,
+// so large period ratios no longer blow up the number of points.
+int reduced_scheduling_point_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// The same test, also storing the number of points it checked in *checked
+// (for benchmarking; safe to call from several threads at once).
+int reduced_scheduling_point_checked(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                     uint64_t *checked);
+
+#endif
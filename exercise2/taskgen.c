@@ -0,0 +1,144 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Seeded synthetic service set generator.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "taskgen.h"
+
+void taskgen_seed(taskgen_rng_t *rng, uint64_t seed)
+{
+   // xorshift must never be seeded with zero
+   rng->state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+uint64_t taskgen_next(taskgen_rng_t *rng)
+{
+   uint64_t x = rng->state;
+
+   x ^= x >> 12;
+   x ^= x << 25;
+   x ^= x >> 27;
+   rng->state = x;
+
+   return x * 0x2545F4914F6CDD1DULL;
+}
+
+double taskgen_uniform(taskgen_rng_t *rng)
+{
+   // top 53 bits give every representable double in [0, 1)
+   return (double)(taskgen_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void taskgen_uunifast(taskgen_rng_t *rng, U32_T numServices, double total_util, double util[])
+{
+   double sum = total_util, next_sum;
+   U32_T i;
+
+   for (i = 1; i < numServices; i++)
+   {
+      next_sum = sum * pow(taskgen_uniform(rng), 1.0 / (double)(numServices - i));
+      util[i - 1] = sum - next_sum;
+      sum = next_sum;
+   }
+
+   util[numServices - 1] = sum;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+   U32_T x = *(const U32_T *)a, y = *(const U32_T *)b;
+
+   return (x > y) - (x < y);
+}
+
+void taskgen_generate(taskgen_rng_t *rng, U32_T numServices, double total_util,
+                      U32_T min_period, U32_T max_period,
+                      U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   double util[numServices];
+   double log_min = log((double)min_period), log_max = log((double)max_period);
+   double c;
+   U32_T i;
+
+   taskgen_uunifast(rng, numServices, total_util, util);
+
+   for (i = 0; i < numServices; i++)
+      period[i] = (U32_T)exp(log_min + taskgen_uniform(rng) * (log_max - log_min));
+
+   // utilizations are i.i.d., so sorting only the periods keeps the
+   // distribution and gives rate monotonic order
+   qsort(period, numServices, sizeof(U32_T), compare_u32);
+
+   for (i = 0; i < numServices; i++)
+   {
+      c = floor(util[i] * (double)period[i] + 0.5);
+      wcet[i] = (c < 1.0) ? 1 : (U32_T)c;
+
+      if (deadline != NULL)
+         deadline[i] = period[i];
+   }
+}
+
+U32_T taskgen_divisors(U32_T hyper, U32_T min_period, U32_T max_period, U32_T divisors[], U32_T max_divisors)
+{
+   // no 32 bit number has more than 1344 divisors
+   U32_T found[1344];
+   U32_T d, q, count = 0, i;
+
+   for (d = 1; (uint64_t)d * d <= hyper; d++)
+   {
+      if ((hyper % d) != 0)
+         continue;
+
+      q = hyper / d;
+      if ((d >= min_period) && (d <= max_period))
+         found[count++] = d;
+      if ((q != d) && (q >= min_period) && (q <= max_period))
+         found[count++] = q;
+   }
+
+   qsort(found, count, sizeof(U32_T), compare_u32);
+
+   if (count > max_divisors)
+      count = max_divisors;
+   for (i = 0; i < count; i++)
+      divisors[i] = found[i];
+
+   return count;
+}
+
+void taskgen_generate_from(taskgen_rng_t *rng, U32_T numServices, double total_util,
+                           const U32_T choices[], U32_T num_choices,
+                           U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   double util[numServices];
+   double c;
+   U32_T i, j, key;
+
+   // choices are sorted, so sorting the indices gives RM order
+   for (i = 0; i < numServices; i++)
+      period[i] = (U32_T)(taskgen_next(rng) % num_choices);
+   for (i = 1; i < numServices; i++)
+   {
+      key = period[i];
+      for (j = i; (j > 0) && (period[j - 1] > key); j--)
+         period[j] = period[j - 1];
+      period[j] = key;
+   }
+
+   taskgen_uunifast(rng, numServices, total_util, util);
+
+   for (i = 0; i < numServices; i++)
+   {
+      period[i] = choices[period[i]];
+      c = floor(util[i] * (double)period[i] + 0.5);
+      wcet[i] = (c < 1.0) ? 1 : (U32_T)c;
+
+      if (deadline != NULL)
+         deadline[i] = period[i];
+   }
+}
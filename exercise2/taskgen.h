@@ -0,0 +1,50 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Seeded synthetic service set generator for benchmarking the feasibility
+// tests.
+
+#ifndef TASKGEN_H
+#define TASKGEN_H
+
+#include <stdint.h>
+
+#include "feasibility.h"
+
+// xorshift64* state, one per generating thread so sets are reproducible
+typedef struct
+{
+   uint64_t state;
+} taskgen_rng_t;
+
+void taskgen_seed(taskgen_rng_t *rng, uint64_t seed);
+uint64_t taskgen_next(taskgen_rng_t *rng);
+
+// uniform double in [0, 1)
+double taskgen_uniform(taskgen_rng_t *rng);
+
+// UUniFast (Bini and Buttazzo, 2005): numServices utilizations summing to
+// total_util, uniformly distributed over that simplex.
+void taskgen_uunifast(taskgen_rng_t *rng, U32_T numServices, double total_util, double util[]);
+
+// Generates a service set with UUniFast utilizations and log-uniform periods
+// in [min_period, max_period], sorted by period so the arrays are already in
+// rate monotonic priority order.  WCETs are rounded to the nearest tick (at
+// least 1) and deadline[] is set equal to period[].
+void taskgen_generate(taskgen_rng_t *rng, U32_T numServices, double total_util,
+                      U32_T min_period, U32_T max_period,
+                      U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// Sorted divisors of hyper that lie in [min_period, max_period], at most
+// max_divisors of them.  Returns how many were stored.
+U32_T taskgen_divisors(U32_T hyper, U32_T min_period, U32_T max_period, U32_T divisors[], U32_T max_divisors);
+
+// Same as taskgen_generate(), but each period is drawn uniformly from the
+// sorted list choices[] (e.g. from taskgen_divisors()), which bounds the
+// hyperperiod so the set can be simulated.
+void taskgen_generate_from(taskgen_rng_t *rng, U32_T numServices, double total_util,
+                           const U32_T choices[], U32_T num_choices,
+                           U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+#endif
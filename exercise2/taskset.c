@@ -0,0 +1,347 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Structure of arrays service set and vectorized analysis kernels.
+//
+// The kernels are picked once at run time: AVX2 on x86 processors that
+// support it (compiled with a target attribute, so the Makefile flags do not
+// change), NEON on 64 bit ARM, otherwise plain C.
+//
+// Every kernel returns exactly what the scalar code in feasibility.c does:
+//
+//  - Utilization: each C(i)/T(i) is a correctly rounded IEEE division in
+//    either form, and the quotients are added one at a time in index order,
+//    so the sum is identical to the existing scalar loop.
+//
+//  - Interference: for t < 2^52 the double quotient t/T(j) never rounds
+//    onto an integer it is not, so the ceiling matches integer ceiling
+//    division.  While every lane stays below 2^52 its terms and partial
+//    sums are whole numbers held exactly in a double.  A larger t or lane
+//    (a service with U > 1 gets there quickly) is summed again by the
+//    scalar kernel, which saturates at T64_MAX.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TASKSET_HAVE_AVX2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TASKSET_HAVE_NEON
+#endif
+
+#include "taskset.h"
+
+#define TASKSET_ALIGN (32)
+#define TASKSET_EXACT (4503599627370496.0)   // 2^52
+
+typedef double (*utilization_fn_t)(const taskset_t *ts);
+typedef uint64_t (*interference_fn_t)(const taskset_t *ts, U32_T count, uint64_t t);
+
+static utilization_fn_t utilization_kernel = NULL;
+static interference_fn_t interference_kernel = NULL;
+static const char *kernel_name = "scalar";
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+////////////////////////////////////////////////////////////////////////////////
+static double utilization_scalar(const taskset_t *ts)
+{
+   double utility_sum = 0.0;
+   U32_T i;
+
+   for (i = 0; i < ts->n; i++)
+      utility_sum += ((double)ts->wcet[i] / (double)ts->period[i]);
+
+   return utility_sum;
+}
+
+static uint64_t interference_scalar(const taskset_t *ts, U32_T count, uint64_t t)
+{
+   uint64_t sum = 0;
+   U32_T j;
+
+   for (j = 0; j < count; j++)
+      sum = t64_add(sum, t64_mul(t64_ceil_div(t, ts->period[j]), ts->wcet[j]));
+
+   return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels, 4 services per iteration
+////////////////////////////////////////////////////////////////////////////////
+#ifdef TASKSET_HAVE_AVX2
+__attribute__((target("avx2")))
+static double utilization_avx2(const taskset_t *ts)
+{
+   double utility_sum = 0.0, q[4] __attribute__((aligned(32)));
+   U32_T i = 0;
+
+   for (; i + 4 <= ts->n; i += 4)
+   {
+      _mm256_store_pd(q, _mm256_div_pd(_mm256_load_pd(&ts->wcet_d[i]), _mm256_load_pd(&ts->period_d[i])));
+
+      // keep the scalar summation order
+      utility_sum += q[0];
+      utility_sum += q[1];
+      utility_sum += q[2];
+      utility_sum += q[3];
+   }
+
+   for (; i < ts->n; i++)
+      utility_sum += ts->wcet_d[i] / ts->period_d[i];
+
+   return utility_sum;
+}
+
+__attribute__((target("avx2")))
+static uint64_t interference_avx2(const taskset_t *ts, U32_T count, uint64_t t)
+{
+   __m256d vt = _mm256_set1_pd((double)t);
+   __m256d acc = _mm256_setzero_pd();
+   __m256d q;
+   double lanes[4] __attribute__((aligned(32)));
+   uint64_t sum;
+   U32_T j = 0;
+
+   if ((double)t >= TASKSET_EXACT)
+      return interference_scalar(ts, count, t);
+
+   for (; j + 4 <= count; j += 4)
+   {
+      q = _mm256_ceil_pd(_mm256_div_pd(vt, _mm256_load_pd(&ts->period_d[j])));
+      acc = _mm256_add_pd(acc, _mm256_mul_pd(q, _mm256_load_pd(&ts->wcet_d[j])));
+   }
+
+   _mm256_store_pd(lanes, acc);
+   if ((lanes[0] >= TASKSET_EXACT) || (lanes[1] >= TASKSET_EXACT) ||
+       (lanes[2] >= TASKSET_EXACT) || (lanes[3] >= TASKSET_EXACT))
+      return interference_scalar(ts, count, t);
+
+   sum = (uint64_t)lanes[0] + (uint64_t)lanes[1] + (uint64_t)lanes[2] + (uint64_t)lanes[3];
+
+   for (; j < count; j++)
+      sum = t64_add(sum, t64_mul(t64_ceil_div(t, ts->period[j]), ts->wcet[j]));
+
+   return sum;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// NEON kernels, 2 services per iteration
+////////////////////////////////////////////////////////////////////////////////
+#ifdef TASKSET_HAVE_NEON
+static double utilization_neon(const taskset_t *ts)
+{
+   double utility_sum = 0.0;
+   float64x2_t q;
+   U32_T i = 0;
+
+   for (; i + 2 <= ts->n; i += 2)
+   {
+      q = vdivq_f64(vld1q_f64(&ts->wcet_d[i]), vld1q_f64(&ts->period_d[i]));
+      utility_sum += vgetq_lane_f64(q, 0);
+      utility_sum += vgetq_lane_f64(q, 1);
+   }
+
+   for (; i < ts->n; i++)
+      utility_sum += ts->wcet_d[i] / ts->period_d[i];
+
+   return utility_sum;
+}
+
+static uint64_t interference_neon(const taskset_t *ts, U32_T count, uint64_t t)
+{
+   float64x2_t vt = vdupq_n_f64((double)t);
+   float64x2_t acc = vdupq_n_f64(0.0);
+   float64x2_t q;
+   uint64_t sum;
+   U32_T j = 0;
+
+   if ((double)t >= TASKSET_EXACT)
+      return interference_scalar(ts, count, t);
+
+   for (; j + 2 <= count; j += 2)
+   {
+      q = vrndpq_f64(vdivq_f64(vt, vld1q_f64(&ts->period_d[j])));
+      acc = vaddq_f64(acc, vmulq_f64(q, vld1q_f64(&ts->wcet_d[j])));
+   }
+
+   if ((vgetq_lane_f64(acc, 0) >= TASKSET_EXACT) || (vgetq_lane_f64(acc, 1) >= TASKSET_EXACT))
+      return interference_scalar(ts, count, t);
+
+   sum = (uint64_t)vgetq_lane_f64(acc, 0) + (uint64_t)vgetq_lane_f64(acc, 1);
+
+   for (; j < count; j++)
+      sum = t64_add(sum, t64_mul(t64_ceil_div(t, ts->period[j]), ts->wcet[j]));
+
+   return sum;
+}
+#endif
+
+static void select_kernels(void)
+{
+   utilization_kernel = utilization_scalar;
+   interference_kernel = interference_scalar;
+   kernel_name = "scalar";
+
+#if defined(TASKSET_HAVE_AVX2)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+   {
+      utilization_kernel = utilization_avx2;
+      interference_kernel = interference_avx2;
+      kernel_name = "avx2";
+   }
+#elif defined(TASKSET_HAVE_NEON)
+   utilization_kernel = utilization_neon;
+   interference_kernel = interference_neon;
+   kernel_name = "neon";
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Container
+////////////////////////////////////////////////////////////////////////////////
+static void *alloc_aligned(size_t bytes)
+{
+   // aligned_alloc wants the size to be a multiple of the alignment
+   return aligned_alloc(TASKSET_ALIGN, (bytes + TASKSET_ALIGN - 1) & ~(size_t)(TASKSET_ALIGN - 1));
+}
+
+int taskset_init(taskset_t *ts, U32_T capacity)
+{
+   // pad to whole vectors so the kernels never need a masked load
+   U32_T padded = (capacity + 3) & ~3U;
+
+   if (utilization_kernel == NULL)
+      select_kernels();
+
+   memset(ts, 0, sizeof(*ts));
+   ts->period = alloc_aligned(padded * sizeof(U32_T));
+   ts->wcet = alloc_aligned(padded * sizeof(U32_T));
+   ts->deadline = alloc_aligned(padded * sizeof(U32_T));
+   ts->period_d = alloc_aligned(padded * sizeof(double));
+   ts->wcet_d = alloc_aligned(padded * sizeof(double));
+
+   if (!ts->period || !ts->wcet || !ts->deadline || !ts->period_d || !ts->wcet_d)
+   {
+      taskset_free(ts);
+      return -1;
+   }
+
+   ts->capacity = capacity;
+   return 0;
+}
+
+void taskset_free(taskset_t *ts)
+{
+   free(ts->period);
+   free(ts->wcet);
+   free(ts->deadline);
+   free(ts->period_d);
+   free(ts->wcet_d);
+   memset(ts, 0, sizeof(*ts));
+}
+
+int taskset_load(taskset_t *ts, U32_T n, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+   U32_T i;
+
+   if (n > ts->capacity)
+      return -1;
+
+   for (i = 0; i < n; i++)
+   {
+      ts->period[i] = period[i];
+      ts->wcet[i] = wcet[i];
+      ts->deadline[i] = (deadline != NULL) ? deadline[i] : period[i];
+      ts->period_d[i] = (double)period[i];
+      ts->wcet_d[i] = (double)wcet[i];
+   }
+   ts->n = n;
+
+   return 0;
+}
+
+const char *taskset_kernel_name(void)
+{
+   if (utilization_kernel == NULL)
+      select_kernels();
+
+   return kernel_name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Tests
+////////////////////////////////////////////////////////////////////////////////
+double taskset_utilization(const taskset_t *ts)
+{
+   return utilization_kernel(ts);
+}
+
+double taskset_ll_bound(U32_T n)
+{
+   return (double)n * (pow(2.0, (1.0/((double)n))) - 1.0);
+}
+
+uint64_t taskset_interference(const taskset_t *ts, U32_T count, uint64_t t)
+{
+   return interference_kernel(ts, count, t);
+}
+
+int taskset_rm_lub(const taskset_t *ts)
+{
+   return (taskset_utilization(ts) <= taskset_ll_bound(ts->n)) ? TRUE : FALSE;
+}
+
+int taskset_response_time_analysis(const taskset_t *ts, U32_T response[])
+{
+   uint64_t an = 0, anext;
+   int set_feasible = TRUE;
+   U32_T i;
+
+   // same seeding and termination as response_time_analysis() in rta.c
+   for (i = 0; i < ts->n; i++)
+   {
+      an = t64_add(an, ts->wcet[i]);
+
+      while (1)
+      {
+         anext = t64_add(ts->wcet[i], interference_kernel(ts, i, an));
+
+         if (anext == an)
+            break;
+
+         an = anext;
+
+         if (an > ts->deadline[i])
+            break;
+      }
+
+      if (response != NULL)
+         response[i] = (an > UINT32_MAX) ? UINT32_MAX : (U32_T)an;
+
+      if (an > ts->deadline[i])
+         set_feasible = FALSE;
+   }
+
+   return set_feasible;
+}
+
+int taskset_deadline_monotonic(const taskset_t *ts)
+{
+   U32_T i;
+
+   // (C(i) + I(D(i))) / D(i) > 1 exactly when C(i) + I(D(i)) > D(i)
+   for (i = 0; i < ts->n; i++)
+   {
+      if (t64_add(ts->wcet[i], interference_kernel(ts, i, ts->deadline[i])) > ts->deadline[i])
+         return FALSE;
+   }
+
+   return TRUE;
+}
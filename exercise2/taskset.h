@@ -0,0 +1,58 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Structure of arrays service set with vectorized analysis kernels.
+
+#ifndef TASKSET_H
+#define TASKSET_H
+
+#include <stdint.h>
+
+#include "feasibility.h"
+
+// All arrays are 32 byte aligned and padded to a multiple of 4 entries.
+// The double copies of period[] and wcet[] are what the SIMD kernels load,
+// so they are filled once when the set is loaded rather than converted on
+// every kernel call.
+typedef struct
+{
+   U32_T n;
+   U32_T capacity;
+   U32_T *period;
+   U32_T *wcet;
+   U32_T *deadline;
+   double *period_d;
+   double *wcet_d;
+} taskset_t;
+
+// Returns 0 on success, -1 if the arrays could not be allocated.
+int taskset_init(taskset_t *ts, U32_T capacity);
+void taskset_free(taskset_t *ts);
+
+// Copies a set given as the usual parallel arrays (highest priority first).
+// deadline may be NULL for D=T.  Returns -1 if n exceeds the capacity.
+int taskset_load(taskset_t *ts, U32_T n, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// Name of the kernel implementation selected at run time ("avx2", "neon" or
+// "scalar").
+const char *taskset_kernel_name(void);
+
+// Sum of C(i)/T(i), bit for bit the value rate_monotonic_least_upper_bound()
+// computes (the divisions are vectorized, the additions stay in order).
+double taskset_utilization(const taskset_t *ts);
+
+// Liu and Layland bound n(2^(1/n) - 1)
+double taskset_ll_bound(U32_T n);
+
+// sum over j < count of ceil(t / T(j)) * C(j), saturating at T64_MAX like
+// the scalar response time loop; exact for any t and any utilization
+uint64_t taskset_interference(const taskset_t *ts, U32_T count, uint64_t t);
+
+// Same decisions (and response times) as rate_monotonic_least_upper_bound(),
+// response_time_analysis() and deadline_monotonic() on the arrays.
+int taskset_rm_lub(const taskset_t *ts);
+int taskset_response_time_analysis(const taskset_t *ts, U32_T response[]);
+int taskset_deadline_monotonic(const taskset_t *ts);
+
+#endif
@@ -0,0 +1,166 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Work stealing thread pool.
+//
+// Every worker starts with a contiguous range of chunks as its deque.  It
+// takes chunks from the back of its own range and, once that is empty,
+// steals single chunks from the front of the other workers' ranges.  Owner
+// and thieves work at opposite ends, so they rarely touch the same chunk.
+// Because no work is created while the pool runs, a worker that finds every
+// deque empty can simply exit.
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "work_pool.h"
+
+typedef struct
+{
+   pthread_mutex_t lock;
+   uint64_t head;             // next chunk a thief takes
+   uint64_t tail;             // one past the next chunk the owner takes
+} work_deque_t;
+
+typedef struct
+{
+   work_deque_t *deques;
+   int num_threads;
+   uint64_t num_items;
+   uint64_t chunk_size;
+   work_pool_fn_t fn;
+   void *ctx;
+} work_pool_t;
+
+typedef struct
+{
+   work_pool_t *pool;
+   int worker;
+} work_thread_t;
+
+static int take_own(work_deque_t *dq, uint64_t *chunk)
+{
+   int found = 0;
+
+   pthread_mutex_lock(&dq->lock);
+   if (dq->head < dq->tail)
+   {
+      *chunk = --dq->tail;
+      found = 1;
+   }
+   pthread_mutex_unlock(&dq->lock);
+
+   return found;
+}
+
+static int steal(work_deque_t *dq, uint64_t *chunk)
+{
+   int found = 0;
+
+   pthread_mutex_lock(&dq->lock);
+   if (dq->head < dq->tail)
+   {
+      *chunk = dq->head++;
+      found = 1;
+   }
+   pthread_mutex_unlock(&dq->lock);
+
+   return found;
+}
+
+static void *work_thread(void *arg)
+{
+   work_thread_t *self = (work_thread_t *)arg;
+   work_pool_t *pool = self->pool;
+   uint64_t chunk, start, end;
+   int i, victim;
+
+   while (1)
+   {
+      if (!take_own(&pool->deques[self->worker], &chunk))
+      {
+         // visit the other workers starting with the next one, so thieves
+         // spread out instead of all hitting worker 0
+         for (i = 1; i < pool->num_threads; i++)
+         {
+            victim = (self->worker + i) % pool->num_threads;
+            if (steal(&pool->deques[victim], &chunk))
+               break;
+         }
+
+         if (i >= pool->num_threads)
+            break;
+      }
+
+      start = chunk * pool->chunk_size;
+      end = start + pool->chunk_size;
+      if (end > pool->num_items)
+         end = pool->num_items;
+
+      pool->fn(pool->ctx, self->worker, start, end);
+   }
+
+   return NULL;
+}
+
+int work_pool_run(uint64_t num_items, uint64_t chunk_size, int num_threads,
+                  work_pool_fn_t fn, void *ctx)
+{
+   work_pool_t pool;
+   work_thread_t *threads;
+   pthread_t *tids;
+   uint64_t num_chunks;
+   int i, created, rc = 0;
+
+   if (num_threads < 1)
+      num_threads = 1;
+   if (chunk_size < 1)
+      chunk_size = 1;
+
+   num_chunks = (num_items + chunk_size - 1) / chunk_size;
+
+   pool.deques = calloc(num_threads, sizeof(work_deque_t));
+   threads = calloc(num_threads, sizeof(work_thread_t));
+   tids = calloc(num_threads, sizeof(pthread_t));
+   if ((pool.deques == NULL) || (threads == NULL) || (tids == NULL))
+   {
+      free(pool.deques); free(threads); free(tids);
+      return -1;
+   }
+
+   pool.num_threads = num_threads;
+   pool.num_items = num_items;
+   pool.chunk_size = chunk_size;
+   pool.fn = fn;
+   pool.ctx = ctx;
+
+   for (i = 0; i < num_threads; i++)
+   {
+      pthread_mutex_init(&pool.deques[i].lock, NULL);
+      pool.deques[i].head = (num_chunks * i) / num_threads;
+      pool.deques[i].tail = (num_chunks * (i + 1)) / num_threads;
+      threads[i].pool = &pool;
+      threads[i].worker = i;
+   }
+
+   for (created = 0; created < num_threads; created++)
+   {
+      if (pthread_create(&tids[created], NULL, work_thread, &threads[created]) != 0)
+      {
+         // the threads already running will steal the missing ones' chunks
+         rc = (created == 0) ? -1 : 0;
+         break;
+      }
+   }
+
+   for (i = 0; i < created; i++)
+      pthread_join(tids[i], NULL);
+
+   for (i = 0; i < num_threads; i++)
+      pthread_mutex_destroy(&pool.deques[i].lock);
+
+   free(pool.deques); free(threads); free(tids);
+
+   return rc;
+}
@@ -0,0 +1,21 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Work stealing thread pool for batch feasibility runs.
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stdint.h>
+
+// Called for each chunk of items [start, end) on worker thread 'worker'.
+typedef void (*work_pool_fn_t)(void *ctx, int worker, uint64_t start, uint64_t end);
+
+// Splits num_items into chunks of chunk_size and runs fn over all of them on
+// num_threads threads, returning once every chunk is done.  Returns 0 on
+// success, -1 if the threads could not be created.
+int work_pool_run(uint64_t num_items, uint64_t chunk_size, int num_threads,
+                  work_pool_fn_t fn, void *ctx);
+
+#endif
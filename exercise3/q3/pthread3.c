@@ -4,6 +4,8 @@
 #include <time.h>
 #include <stdlib.h>
 
+#include "rtinit.h"
+
 #define NUM_THREADS		4
 #define START_SERVICE 		0
 #define HIGH_PRIO_SERVICE 	1
@@ -63,6 +65,8 @@ void *idleNoSem(void *threadp)
   threadParams_t *threadParams = (threadParams_t *)threadp;
   int idleIdx = threadParams->threadIdx;
 
+  rt_prefault_stack();
+
   do
   {
     FIB_TEST(seqIterations, Iterations);
@@ -86,6 +90,8 @@ void *idle(void *threadp)
   threadParams_t *threadParams = (threadParams_t *)threadp;
   int idleIdx = threadParams->threadIdx;
 
+  rt_prefault_stack();
+
   pthread_mutex_lock(&msgSem);
   CScnt++;
 
@@ -140,6 +146,7 @@ int main (int argc, char *argv[])
 {
    int rc, invSafe=0, i, scope;
    struct timespec sleepTime, dTime;
+   rt_faults_t initFaults;
 
    CScount=0;
 
@@ -157,21 +164,29 @@ int main (int argc, char *argv[])
 
    print_scheduler();
 
+   // lock memory and prefault the heap and stack before any thread runs
+   rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
+   rt_faults(&initFaults);
+
    pthread_attr_init(&rt_sched_attr[START_SERVICE]);
    pthread_attr_setinheritsched(&rt_sched_attr[START_SERVICE], PTHREAD_EXPLICIT_SCHED);
    pthread_attr_setschedpolicy(&rt_sched_attr[START_SERVICE], SCHED_FIFO);
+   rt_stack_attr(&rt_sched_attr[START_SERVICE]);
 
    pthread_attr_init(&rt_sched_attr[HIGH_PRIO_SERVICE]);
    pthread_attr_setinheritsched(&rt_sched_attr[HIGH_PRIO_SERVICE], PTHREAD_EXPLICIT_SCHED);
    pthread_attr_setschedpolicy(&rt_sched_attr[HIGH_PRIO_SERVICE], SCHED_FIFO);
+   rt_stack_attr(&rt_sched_attr[HIGH_PRIO_SERVICE]);
 
    pthread_attr_init(&rt_sched_attr[MID_PRIO_SERVICE]);
    pthread_attr_setinheritsched(&rt_sched_attr[MID_PRIO_SERVICE], PTHREAD_EXPLICIT_SCHED);
    pthread_attr_setschedpolicy(&rt_sched_attr[MID_PRIO_SERVICE], SCHED_FIFO);
+   rt_stack_attr(&rt_sched_attr[MID_PRIO_SERVICE]);
 
    pthread_attr_init(&rt_sched_attr[LOW_PRIO_SERVICE]);
    pthread_attr_setinheritsched(&rt_sched_attr[LOW_PRIO_SERVICE], PTHREAD_EXPLICIT_SCHED);
    pthread_attr_setschedpolicy(&rt_sched_attr[LOW_PRIO_SERVICE], SCHED_FIFO);
+   rt_stack_attr(&rt_sched_attr[LOW_PRIO_SERVICE]);
 
    rt_max_prio = sched_get_priority_max(SCHED_FIFO);
    rt_min_prio = sched_get_priority_min(SCHED_FIFO);
@@ -222,6 +237,8 @@ int main (int argc, char *argv[])
    else
      perror("START SERVICE");
 
+   rt_print_faults("after RT init", &initFaults);
+
 
    rc=sched_setscheduler(getpid(), SCHED_OTHER, &nrt_param);
 
@@ -239,6 +256,8 @@ void *startService(void *threadid)
    struct timespec timeNow;
    int rc;
 
+   rt_prefault_stack();
+
    runInterference=intfTime;
 
    rt_param[LOW_PRIO_SERVICE].sched_priority = rt_max_prio-20;
@@ -13,6 +13,8 @@
  * see http://linuxtv.org/docs.php for more information
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,11 +30,22 @@
 #include <sys/time.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include <linux/videodev2.h>
 
 #include <time.h>
 
+#include "rtinit.h"
+#include "seqplace.h"
+#include "convpool.h"
+#include "framequeue.h"
+#include "dmabufshare.h"
+
 #define CLEAR(x) memset(&(x), 0, sizeof(x))
 #define COLOR_CONVERT
 #define HRES 320
@@ -48,14 +61,24 @@ enum io_method
         IO_METHOD_READ,
         IO_METHOD_MMAP,
         IO_METHOD_USERPTR,
+        IO_METHOD_DMABUF,       /* mmap, exported and shared, see dmabufshare.h */
 };
 
 struct buffer 
 {
         void   *start;
         size_t  length;
+        atomic_uint refs;       /* stages holding the frame, requeued at 0 */
+        atomic_uint shared;     /* a reference held for the DMABUF consumer */
+        int     dmabuf_fd;      /* IO_METHOD_DMABUF only */
 };
 
+// Buffers the driver may be given, when the stages hold so many that it is
+// down to CAPTURE_MIN_QUEUED, CAPTURE_GROW_BUFFERS more at a time
+#define CAPTURE_MAX_BUFFERS (32)
+#define CAPTURE_MIN_QUEUED (2)
+#define CAPTURE_GROW_BUFFERS (2)
+
 static char            *dev_name;
 //static enum io_method   io = IO_METHOD_USERPTR;
 //static enum io_method   io = IO_METHOD_READ;
@@ -66,6 +89,8 @@ static unsigned int     n_buffers;
 static int              out_buf;
 static int              force_format=1;
 static int              frame_count = 30;
+static int              conv_workers = -1;
+static conv_pool_t      conv_pool;
 
 static void errno_exit(const char *s)
 {
@@ -169,125 +194,698 @@ void yuv2rgb_float(float y, float u, float v,
 }
 
 
-// This is probably the most acceptable conversion from camera YUYV to RGB
-//
-// Wikipedia has a good discussion on the details of various conversions and cites good references:
-// http://en.wikipedia.org/wiki/YUV
-//
-// Also http://www.fourcc.org/yuv.php
-//
-// What's not clear without knowing more about the camera in question is how often U & V are sampled compared
-// to Y.
-//
-// E.g. YUV444, which is equivalent to RGB, where both require 3 bytes for each pixel
-//      YUV422, which we assume here, where there are 2 bytes for each pixel, with two Y samples for one U & V,
-//              or as the name implies, 4Y and 2 UV pairs
-//      YUV420, where for every 4 Ys, there is a single UV pair, 1.5 bytes for each pixel or 36 bytes for 24 pixels
+unsigned int framecnt=0;
 
-void yuv2rgb(int y, int u, int v, unsigned char *r, unsigned char *g, unsigned char *b)
+// The capture pipeline: the main thread only dequeues and requeues V4L2
+// buffers, the conversion stage converts each frame out of its buffer into
+// a writer queue slot, and the writer stage dumps the frames to files.  A
+// frame dumped as it came, graymap or RGB, is not copied: the writer reads
+// it in the driver's buffer.  A stalled write holds up only the writer
+// queue, and the conversion stage drops a frame only once backlog frames
+// are waiting to be written.
+//
+// Frame handles: a dequeued buffer is lent to the pipeline with one
+// reference, the conversion stage's.  A stage passing the frame on in
+// place takes another for the next, each releases its own when done with
+// it, and the last release sends the buffer back to be requeued, through
+// a queue of the releasing stage's own so every queue keeps one producer.
+// When the stages hold so many buffers that the driver is down to its last
+// CAPTURE_MIN_QUEUED, the acquisition thread adds more while streaming
+// (VIDIOC_CREATE_BUFS), up to CAPTURE_MAX_BUFFERS.
+static frame_queue_t    convert_queue;      // acquisition -> conversion, dequeued buffers
+static frame_queue_t    convert_requeue;    // conversion -> acquisition, buffers released
+static frame_queue_t    write_queue;        // conversion -> writer, frames to dump
+static frame_queue_t    write_requeue;      // writer -> acquisition, buffers released
+static int              requeue_fd = -1;    // eventfd, wakes the acquisition select()
+static unsigned int     buffers_out;        // dequeued and not yet requeued
+static unsigned int     buffers_initial;    // before any were added
+static int              buffers_fixed;      // the driver cannot add buffers
+static unsigned int     backlog = 32;
+static pthread_t        convert_thread, write_thread;
+static unsigned int     last_sequence;
+static unsigned long long driver_drops, writer_drops, in_place;
+static seq_stat_t       convert_stat, write_stat, latency_stat;
+
+// DMABUF sharing, see dmabufshare.h: the conversion stage shares each frame
+// with the consumer, and the acquisition thread accepts the consumer and
+// takes its releases.  share_lock keeps the connection from closing under
+// a send.
+static char            *share_path = DMABUF_SHARE_PATH;
+static int              listen_fd = -1;
+static int              share_fd = -1;      // the consumer, or -1
+static pthread_mutex_t  share_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint      share_held;         // buffers the consumer holds
+static unsigned long long consumers, shared_frames, share_skips;
+
+static unsigned long long raw_nsec(void)
 {
-   int r1, g1, b1;
+    struct timespec now;
 
-   // replaces floating point coefficients
-   int c = y-16, d = u - 128, e = v - 128;       
-
-   // Conversion that avoids floating point
-   r1 = (298 * c           + 409 * e + 128) >> 8;
-   g1 = (298 * c - 100 * d - 208 * e + 128) >> 8;
-   b1 = (298 * c + 516 * d           + 128) >> 8;
-
-   // Computed values may need clipping.
-   if (r1 > 255) r1 = 255;
-   if (g1 > 255) g1 = 255;
-   if (b1 > 255) b1 = 255;
-
-   if (r1 < 0) r1 = 0;
-   if (g1 < 0) g1 = 0;
-   if (b1 < 0) b1 = 0;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
 
-   *r = r1 ;
-   *g = g1 ;
-   *b = b1 ;
+static void hold_buffer(unsigned int index)
+{
+    atomic_fetch_add_explicit(&buffers[index].refs, 1, memory_order_relaxed);
 }
 
+static void release_buffer(unsigned int index, frame_queue_t *requeue)
+{
+    frame_t *frame;
 
+    if(atomic_fetch_sub_explicit(&buffers[index].refs, 1, memory_order_acq_rel) != 1)
+        return;
 
-unsigned int framecnt=0;
-unsigned char bigbuffer[(1280*960)];
+    // never full, it has a slot for every buffer
+    frame = frame_queue_back(requeue);
+    frame->index = index;
+    frame_queue_push(requeue);
+    eventfd_write(requeue_fd, 1);
+}
 
-static void process_image(const void *p, int size)
+// Converts one dequeued frame into a writer queue slot, or passes it on in
+// its buffer with a reference of its own
+static void convert_image(const void *p, int size, frame_t *out)
 {
-    int i, newi, newsize=0;
-    struct timespec frame_time;
-    int y_temp, y2_temp, u_temp, v_temp;
     unsigned char *pptr = (unsigned char *)p;
+    unsigned int width = fmt.fmt.pix.width;
+    unsigned int rows;
 
-    // record when process was called
-    clock_gettime(CLOCK_REALTIME, &frame_time);    
-
-    framecnt++;
-    printf("frame %d: ", framecnt);
-
-    // This just dumps the frame to a file now, but you could replace with whatever image
-    // processing you wish.
-    //
+    out->convert_nsec = 0;
+    out->pixels = out->data;
+    out->in_place = 0;
 
     if(fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_GREY)
     {
-        printf("Dump graymap as-is size %d\n", size);
-        dump_pgm(p, size, framecnt, &frame_time);
+        out->what = "graymap as-is";
+        out->pixels = pptr;
+        out->in_place = 1;
+        out->size = size;
+        out->pgm = 1;
     }
 
     else if(fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUYV)
     {
+        // the whole rows the driver filled, never more than the frame the
+        // writer's slot was sized for, whatever bytesused says
+        rows = size/(2*width);
+        if(rows > fmt.fmt.pix.height)
+            rows = fmt.fmt.pix.height;
 
 #if defined(COLOR_CONVERT)
-        printf("Dump YUYV converted to RGB size %d\n", size);
-       
         // Pixels are YU and YV alternating, so YUYV which is 4 bytes
         // We want RGB, so RGBRGB which is 6 bytes
         //
-        for(i=0, newi=0; i<size; i=i+4, newi=newi+6)
-        {
-            y_temp=(int)pptr[i]; u_temp=(int)pptr[i+1]; y2_temp=(int)pptr[i+2]; v_temp=(int)pptr[i+3];
-            yuv2rgb(y_temp, u_temp, v_temp, &bigbuffer[newi], &bigbuffer[newi+1], &bigbuffer[newi+2]);
-            yuv2rgb(y2_temp, u_temp, v_temp, &bigbuffer[newi+3], &bigbuffer[newi+4], &bigbuffer[newi+5]);
-        }
-
-        dump_ppm(bigbuffer, ((size*6)/4), framecnt, &frame_time);
+        out->what = "YUYV converted to RGB";
+        out->convert_nsec = conv_frame(&conv_pool, CONV_RGB, pptr, out->data, width, rows);
+        out->size = rows*width*3;
+        out->pgm = 0;
 #else
-        printf("Dump YUYV converted to YY size %d\n", size);
-       
         // Pixels are YU and YV alternating, so YUYV which is 4 bytes
         // We want Y, so YY which is 2 bytes
         //
-        for(i=0, newi=0; i<size; i=i+4, newi=newi+2)
-        {
-            // Y1=first byte and Y2=third byte
-            bigbuffer[newi]=pptr[i];
-            bigbuffer[newi+1]=pptr[i+2];
-        }
-
-        dump_pgm(bigbuffer, (size/2), framecnt, &frame_time);
+        out->what = "YUYV converted to YY";
+        out->convert_nsec = conv_frame(&conv_pool, CONV_Y, pptr, out->data, width, rows);
+        out->size = rows*width;
+        out->pgm = 1;
 #endif
 
     }
 
     else if(fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_RGB24)
     {
-        printf("Dump RGB as-is size %d\n", size);
-        dump_ppm(p, size, framecnt, &frame_time);
+        out->what = "RGB as-is";
+        out->pixels = pptr;
+        out->in_place = 1;
+        out->size = size;
+        out->pgm = 0;
     }
     else
+    {
+        out->what = NULL;
+        out->size = 0;
+    }
+}
+
+static void write_image(frame_t *frame)
+{
+    printf("frame %d: ", frame->tag);
+
+    // This just dumps the frame to a file now, but you could replace with whatever image
+    // processing you wish.
+    //
+
+    if(frame->what == NULL)
     {
         printf("ERROR - unknown dump format\n");
     }
+    else
+    {
+        printf("Dump %s size %d", frame->what, frame->bytesused);
+        if(frame->convert_nsec > 0)
+            printf(" in %.3lf usec", (double)frame->convert_nsec / 1000.0);
+        printf("\n");
+
+        if(frame->pgm)
+            dump_pgm(frame->pixels, frame->size, frame->tag, &frame->frame_time);
+        else
+            dump_ppm(frame->pixels, frame->size, frame->tag, &frame->frame_time);
+    }
 
     fflush(stderr);
     //fprintf(stderr, ".");
     fflush(stdout);
 }
 
+// Shares a frame with the DMABUF consumer, if there is one and it is not
+// holding too many already, with a reference for it to release
+static void share_frame(frame_t *in)
+{
+    struct buffer *buffer = &buffers[in->index];
+    dmabuf_msg_t msg;
+
+    pthread_mutex_lock(&share_lock);
+
+    if((share_fd >= 0) && (atomic_load(&share_held) >= DMABUF_MAX_HELD))
+    {
+        share_skips++;
+    }
+    else if(share_fd >= 0)
+    {
+        CLEAR(msg);
+        msg.type = DMABUF_MSG_FRAME;
+        msg.index = in->index;
+        msg.tag = in->tag;
+        msg.sequence = in->sequence;
+        msg.bytesused = in->bytesused;
+        msg.sec = in->frame_time.tv_sec;
+        msg.nsec = in->frame_time.tv_nsec;
+
+        hold_buffer(in->index);
+        atomic_store(&buffer->shared, 1);
+        atomic_fetch_add(&share_held, 1);
+
+        if(send(share_fd, &msg, sizeof(msg), MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(msg))
+        {
+            shared_frames++;
+        }
+        else
+        {
+            // not sent, so take the reference back unless a disconnect has
+            share_skips++;
+            if(atomic_exchange(&buffer->shared, 0))
+            {
+                atomic_fetch_sub(&share_held, 1);
+                release_buffer(in->index, &convert_requeue);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&share_lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Conversion stage
+//      * LOOP until the end of the stream:
+//      *       Wait for a dequeued buffer
+//      *       Share it with the DMABUF consumer, if there is one
+//      *       IF the writer queue has a free slot: convert into it, or
+//      *       take a reference to pass the buffer itself, and pass it on
+//      *       ELSE drop the frame
+//      *       Release the buffer
+//      * Pass the end of the stream on to the writer
+////////////////////////////////////////////////////////////////////////////////
+static void *convert_stage(void *arg)
+{
+    struct timespec retry = {0, 1000000};
+    unsigned long long start;
+    frame_t *in, *out;
+
+    (void)arg;
+    rt_prefault_stack();
+
+    for(;;)
+    {
+        in = frame_queue_front(&convert_queue);
+        if(in->last)
+            break;
+
+        if(io == IO_METHOD_DMABUF)
+            share_frame(in);
+
+        start = raw_nsec();
+        out = frame_queue_back(&write_queue);
+        if(out == NULL)
+        {
+            writer_drops++;
+        }
+        else
+        {
+            out->tag = in->tag;
+            out->index = in->index;
+            out->bytesused = in->bytesused;
+            out->frame_time = in->frame_time;
+            out->dequeued_nsec = in->dequeued_nsec;
+            out->last = 0;
+            convert_image(buffers[in->index].start, in->bytesused, out);
+            if(out->in_place)
+            {
+                hold_buffer(in->index);
+                in_place++;
+            }
+            frame_queue_push(&write_queue);
+        }
+        seq_stat_record(&convert_stat, raw_nsec() - start);
+
+        release_buffer(in->index, &convert_requeue);
+        frame_queue_pop(&convert_queue);
+    }
+    frame_queue_pop(&convert_queue);
+
+    // the end is not dropped, so wait for the writer to make room
+    while((out = frame_queue_back(&write_queue)) == NULL)
+        nanosleep(&retry, NULL);
+    out->last = 1;
+    frame_queue_push(&write_queue);
+
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writer stage
+//      * LOOP until the end of the stream:
+//      *       Wait for a converted frame
+//      *       Dump it to a file
+//      *       Release its buffer if it was dumped in place
+//      *       Record the write time, and the time from dequeue to written
+////////////////////////////////////////////////////////////////////////////////
+static void *write_stage(void *arg)
+{
+    unsigned long long start, end;
+    frame_t *frame;
+
+    (void)arg;
+    rt_prefault_stack();
+
+    for(;;)
+    {
+        frame = frame_queue_front(&write_queue);
+        if(frame->last)
+            break;
+
+        start = raw_nsec();
+        write_image(frame);
+        if(frame->in_place)
+            release_buffer(frame->index, &write_requeue);
+        end = raw_nsec();
+        seq_stat_record(&write_stat, end - start);
+        seq_stat_record(&latency_stat, end - frame->dequeued_nsec);
+        frame_queue_pop(&write_queue);
+    }
+    frame_queue_pop(&write_queue);
+
+    return NULL;
+}
+
+static void start_sharing(void);
+
+static void start_pipeline(void)
+{
+    size_t frame_bytes = 0;
+    pthread_attr_t attr;
+
+    // only converted frames need memory of their own
+    if(fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUYV)
+        frame_bytes = fmt.fmt.pix.width * fmt.fmt.pix.height * 3;
+
+    // room for every buffer there may be, and the end of the stream
+    if((frame_queue_init(&convert_queue, CAPTURE_MAX_BUFFERS + 1, 0, "convert") != 0) ||
+       (frame_queue_init(&convert_requeue, CAPTURE_MAX_BUFFERS, 0, "convert requeue") != 0) ||
+       (frame_queue_init(&write_queue, backlog, frame_bytes, "write") != 0) ||
+       (frame_queue_init(&write_requeue, CAPTURE_MAX_BUFFERS, 0, "write requeue") != 0))
+        exit(EXIT_FAILURE);
+    buffers_initial = n_buffers;
+
+    requeue_fd = eventfd(0, EFD_NONBLOCK);
+    if (-1 == requeue_fd)
+        errno_exit("eventfd");
+
+    if(io == IO_METHOD_DMABUF)
+        start_sharing();
+
+    pthread_attr_init(&attr);
+    rt_stack_attr(&attr);
+    if((pthread_create(&convert_thread, &attr, convert_stage, NULL) != 0) ||
+       (pthread_create(&write_thread, &attr, write_stage, NULL) != 0))
+    {
+        fprintf(stderr, "Cannot create the pipeline threads\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// Hands a dequeued buffer to the conversion stage
+static void hand_off(unsigned int index, unsigned int bytesused)
+{
+    frame_t *frame = frame_queue_back(&convert_queue);
+
+    // never full, it has a slot for every buffer
+    assert(frame != NULL);
+
+    framecnt++;
+    frame->tag = framecnt;
+    frame->index = index;
+    frame->bytesused = bytesused;
+    frame->sequence = last_sequence;
+    clock_gettime(CLOCK_REALTIME, &frame->frame_time);
+    frame->dequeued_nsec = raw_nsec();
+    frame->last = 0;
+
+    // the conversion stage's reference
+    atomic_store_explicit(&buffers[index].refs, 1, memory_order_relaxed);
+    buffers_out++;
+    frame_queue_push(&convert_queue);
+}
+
+// Counts the frames the driver dropped, from gaps in its sequence numbers
+static void check_sequence(unsigned int sequence)
+{
+    if((framecnt > 0) && (sequence > last_sequence + 1))
+        driver_drops += sequence - last_sequence - 1;
+    last_sequence = sequence;
+}
+
+static void queue_buffer(unsigned int index)
+{
+    struct v4l2_buffer buf;
+
+    switch (io)
+    {
+        case IO_METHOD_READ:
+            /* Nothing to do, the next read() may fill it. */
+            break;
+
+        case IO_METHOD_MMAP:
+        case IO_METHOD_DMABUF:
+            CLEAR(buf);
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = index;
+
+            if (-1 == xioctl(fd, VIDIOC_QBUF, &buf))
+                    errno_exit("VIDIOC_QBUF");
+            break;
+
+        case IO_METHOD_USERPTR:
+            CLEAR(buf);
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_USERPTR;
+            buf.index = index;
+            buf.m.userptr = (unsigned long)buffers[index].start;
+            buf.length = buffers[index].length;
+
+            if (-1 == xioctl(fd, VIDIOC_QBUF, &buf))
+                    errno_exit("VIDIOC_QBUF");
+            break;
+    }
+}
+
+// Requeues every buffer the stages have released
+static void requeue_buffers(void)
+{
+    frame_queue_t *queues[] = {&convert_requeue, &write_requeue};
+    frame_t *frame;
+    unsigned int i;
+
+    for(i = 0; i < 2; i++)
+    {
+        while((frame = frame_queue_try_front(queues[i])) != NULL)
+        {
+            queue_buffer(frame->index);
+            buffers_out--;
+            frame_queue_pop(queues[i]);
+        }
+    }
+}
+
+static void map_buffer(unsigned int index);
+
+// Sends the consumer the format and the DMABUF fds of count buffers from
+// first, under share_lock.  Never blocks: a consumer too far behind to take
+// them is dropped by the caller rather than stalling acquisition.
+static int send_buffers(unsigned int first, unsigned int count)
+{
+    char control[CMSG_SPACE(sizeof(int) * DMABUF_MAX_FDS)];
+    int fds[DMABUF_MAX_FDS];
+    struct cmsghdr *cmsg;
+    struct msghdr hdr;
+    struct iovec iov;
+    dmabuf_msg_t msg;
+    unsigned int i;
+
+    if (count > DMABUF_MAX_FDS)
+        count = DMABUF_MAX_FDS;
+
+    CLEAR(msg);
+    msg.type = DMABUF_MSG_BUFFERS;
+    msg.index = first;
+    msg.count = count;
+    msg.length = buffers[first].length;
+    msg.width = fmt.fmt.pix.width;
+    msg.height = fmt.fmt.pix.height;
+    msg.pixelformat = fmt.fmt.pix.pixelformat;
+    msg.bytesperline = fmt.fmt.pix.bytesperline;
+
+    for (i = 0; i < count; ++i)
+        fds[i] = buffers[first + i].dmabuf_fd;
+
+    iov.iov_base = &msg;
+    iov.iov_len = sizeof(msg);
+    CLEAR(hdr);
+    CLEAR(control);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control;
+    hdr.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+    cmsg = CMSG_FIRSTHDR(&hdr);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+
+    return (sendmsg(share_fd, &hdr, MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(msg)) ? 0 : -1;
+}
+
+// Takes back the reference the consumer held on a buffer, if it held one,
+// and requeues the buffer if that was the last
+static void release_shared(unsigned int index)
+{
+    if ((index >= n_buffers) || !atomic_exchange(&buffers[index].shared, 0))
+        return;
+
+    atomic_fetch_sub(&share_held, 1);
+    if (atomic_fetch_sub_explicit(&buffers[index].refs, 1, memory_order_acq_rel) == 1)
+    {
+        queue_buffer(index);
+        buffers_out--;
+    }
+}
+
+static void start_sharing(void)
+{
+    struct sockaddr_un addr;
+
+    CLEAR(addr);
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, share_path, sizeof(addr.sun_path) - 1);
+
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == listen_fd)
+        errno_exit("socket");
+
+    unlink(share_path);
+    if ((-1 == bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr))) || (-1 == listen(listen_fd, 1)))
+        errno_exit(share_path);
+
+    printf("Sharing DMABUF frames on %s\n", share_path);
+}
+
+// One consumer at a time; it gets every buffer first
+static void accept_consumer(void)
+{
+    int consumer = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (-1 == consumer)
+        return;
+
+    pthread_mutex_lock(&share_lock);
+    if (share_fd >= 0)
+    {
+        close(consumer);
+    }
+    else
+    {
+        share_fd = consumer;
+        if (send_buffers(0, n_buffers) != 0)
+        {
+            perror("send_buffers");
+            close(share_fd);
+            share_fd = -1;
+        }
+        else
+        {
+            consumers++;
+        }
+    }
+    pthread_mutex_unlock(&share_lock);
+}
+
+static void drop_consumer(void)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&share_lock);
+    close(share_fd);
+    share_fd = -1;
+    pthread_mutex_unlock(&share_lock);
+
+    for (i = 0; i < n_buffers; ++i)
+        release_shared(i);
+}
+
+static void receive_releases(void)
+{
+    dmabuf_msg_t msg;
+    ssize_t r;
+
+    while ((r = recv(share_fd, &msg, sizeof(msg), MSG_DONTWAIT)) == sizeof(msg))
+        if (msg.type == DMABUF_MSG_RELEASE)
+            release_shared(msg.index);
+
+    if ((0 == r) || ((-1 == r) && (EAGAIN != errno) && (EINTR != errno)))
+        drop_consumer();
+}
+
+static void stop_sharing(void)
+{
+    if (share_fd >= 0)
+        drop_consumer();
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(share_path);
+}
+
+// Gives the driver more buffers while streaming, when the stages hold all
+// but CAPTURE_MIN_QUEUED of them
+static void grow_buffers(void)
+{
+    struct v4l2_create_buffers create;
+    unsigned int i;
+    int sent = 0;
+
+    if ((io == IO_METHOD_READ) || buffers_fixed || (n_buffers >= CAPTURE_MAX_BUFFERS) ||
+        (n_buffers - buffers_out > CAPTURE_MIN_QUEUED))
+        return;
+
+    CLEAR(create);
+    create.count = CAPTURE_MAX_BUFFERS - n_buffers;
+    if (create.count > CAPTURE_GROW_BUFFERS)
+        create.count = CAPTURE_GROW_BUFFERS;
+    create.memory = (io == IO_METHOD_USERPTR) ? V4L2_MEMORY_USERPTR : V4L2_MEMORY_MMAP;
+    create.format = fmt;
+
+    if (-1 == xioctl(fd, VIDIOC_CREATE_BUFS, &create) || create.count == 0)
+    {
+        /* Not every driver can add buffers while streaming, carry on with these. */
+        fprintf(stderr, "Cannot add capture buffers, %u in use: %s\n", n_buffers, strerror(errno));
+        buffers_fixed = 1;
+        return;
+    }
+
+    for (i = create.index; i < create.index + create.count && i < CAPTURE_MAX_BUFFERS; ++i)
+    {
+        if (io != IO_METHOD_USERPTR)
+        {
+            map_buffer(i);
+        }
+        else
+        {
+            buffers[i].length = fmt.fmt.pix.sizeimage;
+            buffers[i].start = malloc(fmt.fmt.pix.sizeimage);
+            if (!buffers[i].start)
+            {
+                fprintf(stderr, "Out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        n_buffers = i + 1;
+    }
+
+    // the consumer needs the new buffers before any frame in them
+    if ((io == IO_METHOD_DMABUF) && (share_fd >= 0))
+    {
+        pthread_mutex_lock(&share_lock);
+        sent = send_buffers(create.index, n_buffers - create.index);
+        pthread_mutex_unlock(&share_lock);
+
+        if (sent != 0)
+        {
+            perror("send_buffers, dropping the DMABUF consumer");
+            drop_consumer();
+        }
+    }
+
+    for (i = create.index; i < n_buffers; ++i)
+        queue_buffer(i);
+}
+
+static void stop_pipeline(void)
+{
+    frame_t *frame = frame_queue_back(&convert_queue);
+
+    frame->last = 1;
+    frame_queue_push(&convert_queue);
+
+    pthread_join(convert_thread, NULL);
+    pthread_join(write_thread, NULL);
+    if (io == IO_METHOD_DMABUF)
+        stop_sharing();
+    requeue_buffers();
+}
+
+static void print_pipeline(void)
+{
+    printf("Pipeline: %u frames, %llu dropped by the driver, %llu dropped with %u waiting to be written\n",
+           framecnt, driver_drops, writer_drops, backlog);
+    printf("   %llu frames written in place from the driver's buffer, %u buffers",
+           in_place, n_buffers);
+    if(n_buffers > buffers_initial)
+        printf(", %u added while streaming", n_buffers - buffers_initial);
+    printf("\n");
+    if(io == IO_METHOD_DMABUF)
+        printf("   DMABUF: %llu consumer%s, %llu frames shared, %llu not (consumer holding %d or gone)\n",
+               consumers, (consumers == 1) ? "" : "s", shared_frames, share_skips, DMABUF_MAX_HELD);
+    frame_queue_print(&convert_queue);
+    frame_queue_print(&convert_requeue);
+    frame_queue_print(&write_queue);
+    frame_queue_print(&write_requeue);
+    printf("   stages\n");
+    seq_stat_print(&convert_stat, "convert");
+    seq_stat_print(&write_stat, "write");
+    seq_stat_print(&latency_stat, "dq->disk");
+}
+
+static void free_pipeline(void)
+{
+    frame_queue_free(&convert_queue);
+    frame_queue_free(&convert_requeue);
+    frame_queue_free(&write_queue);
+    frame_queue_free(&write_requeue);
+    close(requeue_fd);
+}
+
 
 static int read_frame(void)
 {
@@ -316,10 +914,11 @@ static int read_frame(void)
                 }
             }
 
-            process_image(buffers[0].start, buffers[0].length);
+            hand_off(0, buffers[0].length);
             break;
 
         case IO_METHOD_MMAP:
+        case IO_METHOD_DMABUF:
             CLEAR(buf);
 
             buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -347,10 +946,9 @@ static int read_frame(void)
 
             assert(buf.index < n_buffers);
 
-            process_image(buffers[buf.index].start, buf.bytesused);
-
-            if (-1 == xioctl(fd, VIDIOC_QBUF, &buf))
-                    errno_exit("VIDIOC_QBUF");
+            // requeued by requeue_buffers() once released
+            check_sequence(buf.sequence);
+            hand_off(buf.index, buf.bytesused);
             break;
 
         case IO_METHOD_USERPTR:
@@ -383,10 +981,8 @@ static int read_frame(void)
 
             assert(i < n_buffers);
 
-            process_image((void *)buf.m.userptr, buf.bytesused);
-
-            if (-1 == xioctl(fd, VIDIOC_QBUF, &buf))
-                    errno_exit("VIDIOC_QBUF");
+            check_sequence(buf.sequence);
+            hand_off(i, buf.bytesused);
             break;
     }
 
@@ -398,11 +994,7 @@ static int read_frame(void)
 static void mainloop(void)
 {
     unsigned int count;
-    struct timespec read_delay;
-    struct timespec time_error;
-
-    read_delay.tv_sec=0;
-    read_delay.tv_nsec=30000;
+    eventfd_t requeued;
 
     count = frame_count;
 
@@ -412,16 +1004,35 @@ static void mainloop(void)
         {
             fd_set fds;
             struct timeval tv;
-            int r;
+            int r, maxfd, consumer;
+
+            requeue_buffers();
+            grow_buffers();
 
             FD_ZERO(&fds);
-            FD_SET(fd, &fds);
+            FD_SET(requeue_fd, &fds);
+            maxfd = (fd > requeue_fd) ? fd : requeue_fd;
+
+            // the device only has a frame to give while the driver holds
+            // a buffer, and V4L2 polls as an error when it holds none; with
+            // read() the one buffer has to be free before the next read
+            if (buffers_out < n_buffers)
+                FD_SET(fd, &fds);
+
+            // a DMABUF consumer to accept, or releases from the one there is
+            consumer = share_fd;
+            if (listen_fd >= 0)
+            {
+                FD_SET((consumer >= 0) ? consumer : listen_fd, &fds);
+                if (((consumer >= 0) ? consumer : listen_fd) > maxfd)
+                    maxfd = (consumer >= 0) ? consumer : listen_fd;
+            }
 
             /* Timeout. */
             tv.tv_sec = 2;
             tv.tv_usec = 0;
 
-            r = select(fd + 1, &fds, NULL, NULL, &tv);
+            r = select(maxfd + 1, &fds, NULL, NULL, &tv);
 
             if (-1 == r)
             {
@@ -436,13 +1047,20 @@ static void mainloop(void)
                 exit(EXIT_FAILURE);
             }
 
+            if ((listen_fd >= 0) && (consumer < 0) && FD_ISSET(listen_fd, &fds))
+                accept_consumer();
+            if ((consumer >= 0) && FD_ISSET(consumer, &fds))
+                receive_releases();
+
+            // buffers came back, requeue them and wait again
+            if (FD_ISSET(requeue_fd, &fds))
+                eventfd_read(requeue_fd, &requeued);
+
+            if (!FD_ISSET(fd, &fds))
+                continue;
+
             if (read_frame())
             {
-                if(nanosleep(&read_delay, &time_error) != 0)
-                    perror("nanosleep");
-                else
-                    printf("time_error.tv_sec=%ld, time_error.tv_nsec=%ld\n", time_error.tv_sec, time_error.tv_nsec);
-
                 count--;
                 break;
             }
@@ -465,6 +1083,7 @@ static void stop_capturing(void)
                 break;
 
         case IO_METHOD_MMAP:
+        case IO_METHOD_DMABUF:
         case IO_METHOD_USERPTR:
                 type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
                 if (-1 == xioctl(fd, VIDIOC_STREAMOFF, &type))
@@ -486,6 +1105,7 @@ static void start_capturing(void)
                 break;
 
         case IO_METHOD_MMAP:
+        case IO_METHOD_DMABUF:
                 for (i = 0; i < n_buffers; ++i) 
                 {
                         printf("allocated buffer %d\n", i);
@@ -535,9 +1155,13 @@ static void uninit_device(void)
                 break;
 
         case IO_METHOD_MMAP:
-                for (i = 0; i < n_buffers; ++i)
+        case IO_METHOD_DMABUF:
+                for (i = 0; i < n_buffers; ++i) {
+                        if (io == IO_METHOD_DMABUF)
+                                close(buffers[i].dmabuf_fd);
                         if (-1 == munmap(buffers[i].start, buffers[i].length))
                                 errno_exit("munmap");
+                }
                 break;
 
         case IO_METHOD_USERPTR:
@@ -567,6 +1191,10 @@ static void init_read(unsigned int buffer_size)
                 fprintf(stderr, "Out of memory\n");
                 exit(EXIT_FAILURE);
         }
+
+        // one buffer, so mainloop() only reads into it again once the
+        // stages have released the last frame read
+        n_buffers = 1;
 }
 
 static void init_mmap(void)
@@ -598,7 +1226,8 @@ static void init_mmap(void)
                 exit(EXIT_FAILURE);
         }
 
-        buffers = calloc(req.count, sizeof(*buffers));
+        /* Room for the buffers grow_buffers() may add, so none move. */
+        buffers = calloc(CAPTURE_MAX_BUFFERS, sizeof(*buffers));
 
         if (!buffers) 
         {
@@ -606,28 +1235,47 @@ static void init_mmap(void)
                 exit(EXIT_FAILURE);
         }
 
-        for (n_buffers = 0; n_buffers < req.count; ++n_buffers) {
-                struct v4l2_buffer buf;
+        for (n_buffers = 0; n_buffers < req.count && n_buffers < CAPTURE_MAX_BUFFERS; ++n_buffers)
+                map_buffer(n_buffers);
+}
+
+static void map_buffer(unsigned int index)
+{
+        struct v4l2_buffer buf;
 
-                CLEAR(buf);
+        CLEAR(buf);
 
-                buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                buf.memory      = V4L2_MEMORY_MMAP;
-                buf.index       = n_buffers;
+        buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory      = V4L2_MEMORY_MMAP;
+        buf.index       = index;
 
-                if (-1 == xioctl(fd, VIDIOC_QUERYBUF, &buf))
-                        errno_exit("VIDIOC_QUERYBUF");
+        if (-1 == xioctl(fd, VIDIOC_QUERYBUF, &buf))
+                errno_exit("VIDIOC_QUERYBUF");
 
-                buffers[n_buffers].length = buf.length;
-                buffers[n_buffers].start =
-                        mmap(NULL /* start anywhere */,
-                              buf.length,
-                              PROT_READ | PROT_WRITE /* required */,
-                              MAP_SHARED /* recommended */,
-                              fd, buf.m.offset);
+        buffers[index].length = buf.length;
+        buffers[index].start =
+                mmap(NULL /* start anywhere */,
+                      buf.length,
+                      PROT_READ | PROT_WRITE /* required */,
+                      MAP_SHARED /* recommended */,
+                      fd, buf.m.offset);
 
-                if (MAP_FAILED == buffers[n_buffers].start)
-                        errno_exit("mmap");
+        if (MAP_FAILED == buffers[index].start)
+                errno_exit("mmap");
+
+        if (io == IO_METHOD_DMABUF)
+        {
+                struct v4l2_exportbuffer expbuf;
+
+                CLEAR(expbuf);
+                expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                expbuf.index = index;
+                expbuf.flags = O_RDONLY | O_CLOEXEC;
+
+                if (-1 == xioctl(fd, VIDIOC_EXPBUF, &expbuf))
+                        errno_exit("VIDIOC_EXPBUF");
+
+                buffers[index].dmabuf_fd = expbuf.fd;
         }
 }
 
@@ -651,7 +1299,8 @@ static void init_userp(unsigned int buffer_size)
                 }
         }
 
-        buffers = calloc(4, sizeof(*buffers));
+        /* Room for the buffers grow_buffers() may add, so none move. */
+        buffers = calloc(CAPTURE_MAX_BUFFERS, sizeof(*buffers));
 
         if (!buffers) {
                 fprintf(stderr, "Out of memory\n");
@@ -708,6 +1357,7 @@ static void init_device(void)
             break;
 
         case IO_METHOD_MMAP:
+        case IO_METHOD_DMABUF:
         case IO_METHOD_USERPTR:
             if (!(cap.capabilities & V4L2_CAP_STREAMING))
             {
@@ -804,6 +1454,7 @@ static void init_device(void)
             break;
 
         case IO_METHOD_MMAP:
+        case IO_METHOD_DMABUF:
             init_mmap();
             break;
 
@@ -857,14 +1508,18 @@ static void usage(FILE *fp, int argc, char **argv)
                  "-m | --mmap          Use memory mapped buffers [default]\n"
                  "-r | --read          Use read() calls\n"
                  "-u | --userp         Use application allocated buffers\n"
+                 "-x | --dmabuf        Use memory mapped buffers exported as DMABUF, shared on the socket\n"
+                 "-s | --share path    DMABUF socket [%s]\n"
                  "-o | --output        Outputs stream to stdout\n"
                  "-f | --format        Force format to 640x480 GREY\n"
                  "-c | --count         Number of frames to grab [%i]\n"
+                 "-t | --threads       Conversion threads, 0 converts inline [non-RT CPUs, up to %d]\n"
+                 "-b | --backlog       Converted frames waiting to be written before dropping [%u]\n"
                  "",
-                 argv[0], dev_name, frame_count);
+                 argv[0], dev_name, share_path, frame_count, CONV_MAX_WORKERS, backlog);
 }
 
-static const char short_options[] = "d:hmruofc:";
+static const char short_options[] = "d:hmruxs:ofc:t:b:";
 
 static const struct option
 long_options[] = {
@@ -873,14 +1528,22 @@ long_options[] = {
         { "mmap",   no_argument,       NULL, 'm' },
         { "read",   no_argument,       NULL, 'r' },
         { "userp",  no_argument,       NULL, 'u' },
+        { "dmabuf", no_argument,       NULL, 'x' },
+        { "share",  required_argument, NULL, 's' },
         { "output", no_argument,       NULL, 'o' },
         { "format", no_argument,       NULL, 'f' },
         { "count",  required_argument, NULL, 'c' },
+        { "threads", required_argument, NULL, 't' },
+        { "backlog", required_argument, NULL, 'b' },
         { 0, 0, 0, 0 }
 };
 
 int main(int argc, char **argv)
 {
+    rt_faults_t steadyFaults;
+    seq_cpus_t cpus;
+    cpu_set_t *conv_cpus;
+
     if(argc > 1)
         dev_name = argv[1];
     else
@@ -922,6 +1585,14 @@ int main(int argc, char **argv)
                 io = IO_METHOD_USERPTR;
                 break;
 
+            case 'x':
+                io = IO_METHOD_DMABUF;
+                break;
+
+            case 's':
+                share_path = optarg;
+                break;
+
             case 'o':
                 out_buf++;
                 break;
@@ -937,17 +1608,52 @@ int main(int argc, char **argv)
                         errno_exit(optarg);
                 break;
 
+            case 't':
+                errno = 0;
+                conv_workers = strtol(optarg, NULL, 0);
+                if (errno)
+                        errno_exit(optarg);
+                break;
+
+            case 'b':
+                errno = 0;
+                backlog = strtoul(optarg, NULL, 0);
+                if (errno || backlog == 0)
+                        errno_exit(optarg);
+                break;
+
             default:
                 usage(stderr, argc, argv);
                 exit(EXIT_FAILURE);
         }
     }
 
+    // lock memory, so the heap, stack and mapped frame buffers stay resident
+    rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
+
+    // convert on the CPUs left for housekeeping, or on any when none are
+    // isolated, one worker per CPU by default
+    if(seq_read_cpus(&cpus) != 0)
+        exit(EXIT_FAILURE);
+    conv_cpus = (CPU_COUNT(&cpus.housekeeping) > 0) ? &cpus.housekeeping : &cpus.online;
+    if(conv_workers < 0)
+        conv_workers = CPU_COUNT(conv_cpus);
+    if(conv_pool_start(&conv_pool, conv_workers, conv_cpus) != 0)
+        exit(EXIT_FAILURE);
+
     open_device();
     init_device();
+    start_pipeline();
     start_capturing();
+    rt_faults(&steadyFaults);
     mainloop();
+    stop_pipeline();
+    rt_print_faults("while capturing", &steadyFaults);
+    print_pipeline();
+    conv_pool_print(&conv_pool);
+    conv_pool_stop(&conv_pool);
     stop_capturing();
+    free_pipeline();
     uninit_device();
     close_device();
     fprintf(stderr, "\n");
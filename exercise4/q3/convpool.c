@@ -0,0 +1,237 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Parallel frame conversion, see convpool.h.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "convpool.h"
+#include "rtinit.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define TRUE (1)
+#define FALSE (0)
+
+static unsigned long long conv_nsec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (unsigned long long)now.tv_sec * NANOSEC_PER_SEC + (unsigned long long)now.tv_nsec;
+}
+
+static void conv_strip(conv_pool_t *pool, unsigned int strip)
+{
+    unsigned int row = strip * pool->strip_rows;
+    unsigned int rows = pool->strip_rows;
+    unsigned int first = row * pool->width;
+
+    if(row + rows > pool->rows)
+        rows = pool->rows - row;
+
+    if(pool->format == CONV_RGB)
+        pool->rgb(pool->yuyv + 2*first, pool->out + 3*first, rows * pool->width);
+    else
+        yuyv2y(pool->yuyv + 2*first, pool->out + first, rows * pool->width);
+}
+
+// Converts strips until none are left; returns how many.
+static unsigned long long conv_take_strips(conv_pool_t *pool)
+{
+    unsigned long long strips = 0;
+    unsigned int strip;
+
+    while((strip = atomic_fetch_add_explicit(&pool->next_strip, 1, memory_order_relaxed)) < pool->num_strips)
+    {
+        conv_strip(pool, strip);
+        strips++;
+    }
+
+    return strips;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Worker
+//      * Prefault the stack
+//      * LOOP:
+//      *       Wait for the start event
+//      *       IF the pool is stopping: exit
+//      *       Take and convert strips until none are left
+//      *       Post the done event
+////////////////////////////////////////////////////////////////////////////////
+static void *conv_worker(void *arg)
+{
+    conv_worker_t *worker = (conv_worker_t *)arg;
+    conv_pool_t *pool = worker->pool;
+
+    rt_prefault_stack();
+
+    for(;;)
+    {
+        seq_event_wait(&worker->start);
+        if(pool->stop)
+            break;
+
+        worker->strips += conv_take_strips(pool);
+        seq_event_post(&worker->done);
+    }
+
+    return NULL;
+}
+
+int conv_pool_start(conv_pool_t *pool, unsigned int workers, const cpu_set_t *cpus)
+{
+    const yuyv2rgb_kernel_t *kernels;
+    pthread_attr_t attr;
+    cpu_set_t cpuset;
+    unsigned int i, count;
+    int cpu = -1, rc;
+
+    memset(pool, 0, sizeof(*pool));
+    atomic_init(&pool->next_strip, 0);
+
+    // chosen here, once, rather than by yuyv2rgb() racing in every worker
+    count = yuyv2rgb_kernels(&kernels);
+    pool->rgb = kernels[count - 1].convert;
+
+    if(workers > CONV_MAX_WORKERS)
+        workers = CONV_MAX_WORKERS;
+
+    // workers sharing a CPU only take turns on it, and a lone worker only
+    // adds a wake up and a wait to every frame while the caller sits idle
+    if((cpus != NULL) && (CPU_COUNT(cpus) > 0) && (workers > (unsigned int)CPU_COUNT(cpus)))
+        workers = (unsigned int)CPU_COUNT(cpus);
+    if(workers == 1)
+        workers = 0;
+
+    for(i = 0; i < workers; i++)
+    {
+        conv_worker_t *worker = &pool->workers[i];
+
+        worker->pool = pool;
+        worker->cpu = CONV_NO_AFFINITY;
+        seq_event_init(&worker->start, 0);
+        seq_event_init(&worker->done, 0);
+
+        pthread_attr_init(&attr);
+        rt_stack_attr(&attr);
+
+        // next CPU in the set, round robin
+        if((cpus != NULL) && (CPU_COUNT(cpus) > 0))
+        {
+            do
+                cpu = (cpu + 1) % CPU_SETSIZE;
+            while(!CPU_ISSET(cpu, cpus));
+
+            worker->cpu = cpu;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cpu, &cpuset);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+        }
+
+        rc = pthread_create(&worker->thread, &attr, conv_worker, (void *)worker);
+        pthread_attr_destroy(&attr);
+        if(rc != 0)
+        {
+            errno = rc;
+            perror("conv_pool_start: pthread_create");
+            conv_pool_stop(pool);
+            return -1;
+        }
+
+        pool->num_workers++;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Frame
+//      * Cut the frame into strips of CONV_STRIP_BYTES in and out
+//      * IF no workers: convert every strip here
+//      * ELSE post every worker's start event, then wait for each done event
+//      * Record the time taken
+////////////////////////////////////////////////////////////////////////////////
+unsigned long long conv_frame(conv_pool_t *pool, conv_format_t format, const unsigned char *yuyv,
+                              unsigned char *out, unsigned int width, unsigned int height)
+{
+    seq_event_t *starts[CONV_MAX_WORKERS];
+    unsigned int row_bytes = width * ((format == CONV_RGB) ? (2 + 3) : (2 + 1));
+    unsigned long long start, elapsed;
+    unsigned int i;
+
+    start = conv_nsec();
+
+    pool->format = format;
+    pool->yuyv = yuyv;
+    pool->out = out;
+    pool->width = width;
+    pool->rows = height;
+    pool->strip_rows = (row_bytes < CONV_STRIP_BYTES) ? (CONV_STRIP_BYTES / row_bytes) : 1;
+    pool->num_strips = (height + pool->strip_rows - 1) / pool->strip_rows;
+    atomic_store_explicit(&pool->next_strip, 0, memory_order_relaxed);
+
+    if(pool->num_workers == 0)
+    {
+        pool->caller_strips += conv_take_strips(pool);
+    }
+    else
+    {
+        // the frame is published by the sequentially consistent posts
+        for(i = 0; i < pool->num_workers; i++)
+            starts[i] = &pool->workers[i].start;
+        seq_event_post_set(starts, pool->num_workers);
+
+        for(i = 0; i < pool->num_workers; i++)
+            seq_event_wait(&pool->workers[i].done);
+    }
+
+    elapsed = conv_nsec() - start;
+    pool->frames++;
+    seq_stat_record(&pool->latency, elapsed);
+
+    return elapsed;
+}
+
+void conv_pool_print(conv_pool_t *pool)
+{
+    unsigned int i;
+
+    printf("Conversion: %u worker%s, %llu frames\n", pool->num_workers, (pool->num_workers == 1) ? "" : "s",
+           pool->frames);
+
+    if((pool->num_workers == 0) && (pool->frames > 0))
+        printf("   caller     %.1lf strips per frame\n", (double)pool->caller_strips / (double)pool->frames);
+
+    for(i = 0; i < pool->num_workers; i++)
+    {
+        if(pool->workers[i].cpu == CONV_NO_AFFINITY)
+            printf("   worker %-3u unpinned", i);
+        else
+            printf("   worker %-3u CPU %-3d ", i, pool->workers[i].cpu);
+        if(pool->frames > 0)
+            printf(" %.1lf strips per frame", (double)pool->workers[i].strips / (double)pool->frames);
+        printf("\n");
+    }
+
+    seq_stat_print(&pool->latency, "per frame");
+}
+
+void conv_pool_stop(conv_pool_t *pool)
+{
+    unsigned int i;
+
+    pool->stop = TRUE;
+    for(i = 0; i < pool->num_workers; i++)
+        seq_event_post(&pool->workers[i].start);
+    for(i = 0; i < pool->num_workers; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    pool->num_workers = 0;
+}
@@ -0,0 +1,108 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Parallel frame conversion: YUYV to RGB24 or to Y (graymap) on a pool of
+// worker threads started once and kept for every frame.
+//
+// A frame is cut into strips of whole rows, CONV_STRIP_BYTES of input and
+// output together, so a strip stays in a core's L2 while it is converted.
+// conv_frame() posts every worker's start event at once, the workers take
+// strips off a shared counter until none are left, and conv_frame() waits
+// for each worker's done event before it returns, so the frame is complete
+// for whatever follows.  Taking strips as they go, rather than a fixed
+// band each, keeps a worker that is preempted from holding up the frame.
+//
+// The workers are ordinary (SCHED_OTHER) threads, each pinned to one of the
+// CPUs it is given, round robin: the housekeeping CPUs when the kernel
+// isolates some for real-time work (seq_read_cpus()), so conversion never
+// competes with it.  A pool of 0 workers converts in the calling thread,
+// which gives the single threaded time to compare against.  So does a pool
+// that would only have one worker, when one is asked for or there is one
+// CPU to run on: the caller waits for the frame anyway, so handing it to a
+// single worker only adds a wake up and a wait.  No more workers start than
+// there are CPUs.
+//
+// Every conv_frame() is timed, from posting the workers to the last done,
+// and conv_pool_print() reports the distribution and each worker's share.
+//
+// Usage:
+//      conv_pool_t pool;
+//      conv_pool_start(&pool, workers, &cpus.housekeeping);
+//      nsec = conv_frame(&pool, CONV_RGB, yuyv, rgb, width, height);
+//      conv_pool_print(&pool);
+//      conv_pool_stop(&pool);
+
+#ifndef CONVPOOL_H
+#define CONVPOOL_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "seqevent.h"
+#include "seqstats.h"
+#include "yuyv2rgb.h"
+
+#define CONV_MAX_WORKERS (8)
+#define CONV_STRIP_BYTES (64 * 1024)   // input and output of one strip
+#define CONV_NO_AFFINITY (-1)
+
+typedef enum
+{
+    CONV_RGB,                          // 3 bytes per pixel
+    CONV_Y                             // 1 byte per pixel
+} conv_format_t;
+
+typedef struct conv_pool conv_pool_t;
+
+typedef struct
+{
+    conv_pool_t *pool;
+    int cpu;                           // CPU, or CONV_NO_AFFINITY
+    pthread_t thread;
+    seq_event_t start;                 // posted by conv_frame()
+    seq_event_t done;                  // posted by the worker, once per frame
+    unsigned long long strips;         // converted by this worker
+} conv_worker_t;
+
+struct conv_pool
+{
+    unsigned int num_workers;
+    conv_worker_t workers[CONV_MAX_WORKERS];
+    yuyv2rgb_fn rgb;                   // the yuyv2rgb() kernel, chosen at start
+    volatile int stop;
+
+    // the frame being converted, set before the start events are posted
+    conv_format_t format;
+    const unsigned char *yuyv;
+    unsigned char *out;
+    unsigned int width;                // pixels per row, even
+    unsigned int rows, strip_rows, num_strips;
+    atomic_uint next_strip;
+
+    unsigned long long frames;
+    unsigned long long caller_strips;  // converted by the caller, 0 workers only
+    seq_stat_t latency;                // per conv_frame()
+};
+
+// Starts workers threads (at most CONV_MAX_WORKERS and the CPUs in cpus,
+// 0 for none, and none rather than 1), pinned round robin to the CPUs in
+// cpus, or unpinned if cpus is NULL or empty.
+// Returns 0, or -1 after printing why if a thread cannot be created, in
+// which case none are left running.
+int conv_pool_start(conv_pool_t *pool, unsigned int workers, const cpu_set_t *cpus);
+
+// Converts height rows of width pixels of YUYV at yuyv to format at out,
+// and returns once all of it is done, with the nsec it took.
+unsigned long long conv_frame(conv_pool_t *pool, conv_format_t format, const unsigned char *yuyv,
+                              unsigned char *out, unsigned int width, unsigned int height);
+
+// Prints the workers and their CPUs, strips per frame and the conversion
+// time per frame.
+void conv_pool_print(conv_pool_t *pool);
+
+// Stops and joins the workers.
+void conv_pool_stop(conv_pool_t *pool);
+
+#endif
@@ -0,0 +1,211 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Example DMABUF consumer for capture -x (dmabufshare.h): connects to the
+// socket, maps each buffer it is sent once, and for each frame reads the
+// buffer in place between DMA_BUF_IOCTL_SYNC start and end, printing its
+// mean luma (every Y for YUYV, every byte otherwise), then releases it.
+//
+// Usage: dmabuf_consumer [-s socket] [-c frames] [-d hold msec]
+//
+// -d holds each frame that long before releasing it, to play a slow
+// consumer.  Exits after -c frames, or when capture closes the socket.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/dma-buf.h>
+#include <linux/videodev2.h>
+
+#include "dmabufshare.h"
+
+#define MAX_BUFFERS (64)
+
+typedef struct
+{
+    int fd;
+    const unsigned char *start;
+    size_t length;
+} shared_buffer_t;
+
+static shared_buffer_t sharedBuffers[MAX_BUFFERS];
+static dmabuf_msg_t format;
+
+static int sync_buffer(int fd, unsigned long long flags)
+{
+    struct dma_buf_sync sync;
+    static int warned = 0;
+
+    sync.flags = flags | DMA_BUF_SYNC_READ;
+    if(ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) == 0)
+        return 0;
+
+    if(!warned)
+    {
+        perror("DMA_BUF_IOCTL_SYNC");
+        warned = 1;
+    }
+    return -1;
+}
+
+// Maps the buffers a DMABUF_MSG_BUFFERS carries
+static int map_buffers(const dmabuf_msg_t *msg, int *fds, unsigned int count)
+{
+    unsigned int i, index;
+
+    format = *msg;
+
+    for(i = 0; i < count; i++)
+    {
+        index = msg->index + i;
+        if(index >= MAX_BUFFERS)
+        {
+            close(fds[i]);
+            continue;
+        }
+
+        sharedBuffers[index].fd = fds[i];
+        sharedBuffers[index].length = msg->length;
+        sharedBuffers[index].start = mmap(NULL, msg->length, PROT_READ, MAP_SHARED, fds[i], 0);
+        if(sharedBuffers[index].start == MAP_FAILED)
+        {
+            perror("mmap");
+            return -1;
+        }
+    }
+
+    printf("Buffers %u to %u: %ux%u %.4s, %u bytes each\n", msg->index, msg->index + count - 1, msg->width,
+           msg->height, (const char *)&msg->pixelformat, msg->length);
+    return 0;
+}
+
+static double mean_luma(const shared_buffer_t *buffer, unsigned int bytesused)
+{
+    unsigned long long sum = 0;
+    unsigned int i, step = (format.pixelformat == V4L2_PIX_FMT_YUYV) ? 2 : 1;
+
+    if(bytesused > buffer->length)
+        bytesused = buffer->length;
+
+    for(i = 0; i < bytesused; i += step)
+        sum += buffer->start[i];
+
+    return (bytesused > 0) ? (double)sum * step / (double)bytesused : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = DMABUF_SHARE_PATH;
+    unsigned int frames = 0, max_frames = 0, hold_msec = 0, count;
+    char control[CMSG_SPACE(sizeof(int) * DMABUF_MAX_FDS)];
+    int fds[DMABUF_MAX_FDS];
+    struct sockaddr_un addr;
+    struct cmsghdr *cmsg;
+    struct msghdr hdr;
+    struct iovec iov;
+    struct timespec hold;
+    dmabuf_msg_t msg;
+    int sock, opt;
+    ssize_t r;
+
+    while((opt = getopt(argc, argv, "s:c:d:")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': path = optarg; break;
+            case 'c': max_frames = (unsigned int)atoi(optarg); break;
+            case 'd': hold_msec = (unsigned int)atoi(optarg); break;
+            default:
+                printf("Usage: %s [-s socket] [-c frames] [-d hold msec]\n", argv[0]);
+                return -1;
+        }
+    }
+    hold.tv_sec = hold_msec / 1000;
+    hold.tv_nsec = (long)(hold_msec % 1000) * 1000000L;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if((sock == -1) || (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1))
+    {
+        perror(path);
+        return -1;
+    }
+
+    for(;;)
+    {
+        iov.iov_base = &msg;
+        iov.iov_len = sizeof(msg);
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+
+        r = recvmsg(sock, &hdr, MSG_CMSG_CLOEXEC);
+        if(r == 0)
+            break;
+        if(r != sizeof(msg))
+        {
+            if((r == -1) && (errno == EINTR))
+                continue;
+            perror("recvmsg");
+            return -1;
+        }
+
+        if(msg.type == DMABUF_MSG_BUFFERS)
+        {
+            count = 0;
+            for(cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+            {
+                if((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS))
+                {
+                    count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    memcpy(fds, CMSG_DATA(cmsg), count * sizeof(int));
+                }
+            }
+            if(map_buffers(&msg, fds, count) != 0)
+                return -1;
+        }
+        else if((msg.type == DMABUF_MSG_FRAME) && (msg.index < MAX_BUFFERS) &&
+                (sharedBuffers[msg.index].start != NULL))
+        {
+            sync_buffer(sharedBuffers[msg.index].fd, DMA_BUF_SYNC_START);
+            printf("frame %u: sequence %u, buffer %u, mean luma %.1lf\n", msg.tag, msg.sequence, msg.index,
+                   mean_luma(&sharedBuffers[msg.index], msg.bytesused));
+            sync_buffer(sharedBuffers[msg.index].fd, DMA_BUF_SYNC_END);
+
+            if(hold_msec > 0)
+                nanosleep(&hold, NULL);
+
+            msg.type = DMABUF_MSG_RELEASE;
+            if(send(sock, &msg, sizeof(msg), MSG_NOSIGNAL) != sizeof(msg))
+            {
+                // capture finished while we held the frame
+                if((errno == EPIPE) || (errno == ECONNRESET))
+                    break;
+                perror("send");
+                return -1;
+            }
+
+            if((++frames == max_frames) && (max_frames > 0))
+                break;
+        }
+    }
+
+    printf("%u frames read in place\n", frames);
+    close(sock);
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Sharing captured frames with other processes as DMABUF file descriptors,
+// so an analysis service, encoder or recorder reads the driver's buffers
+// without a copy.
+//
+// capture -x exports each V4L2 buffer with VIDIOC_EXPBUF and serves one
+// consumer at a time on a SOCK_SEQPACKET UNIX socket, with these messages:
+//
+//      DMABUF_MSG_BUFFERS  capture -> consumer, the format and the fds of
+//                          buffers index .. index+count-1 (SCM_RIGHTS); on
+//                          connect, and again when capture adds buffers
+//      DMABUF_MSG_FRAME    capture -> consumer, buffer index holds a frame
+//      DMABUF_MSG_RELEASE  consumer -> capture, done with buffer index
+//
+// The consumer maps each fd once and reads a frame between
+// DMA_BUF_IOCTL_SYNC start and end.  A frame shared is a reference held
+// for the consumer: capture requeues the buffer only once the consumer and
+// its own stages have all released it.  capture shares no more frames
+// while the consumer holds DMABUF_MAX_HELD, so a stalled consumer costs
+// frames of its own and not the driver's, and takes back every buffer it
+// held when it disconnects.
+
+#ifndef DMABUFSHARE_H
+#define DMABUFSHARE_H
+
+#include <stdint.h>
+
+#define DMABUF_SHARE_PATH "/tmp/capture-dmabuf.sock"
+#define DMABUF_MAX_FDS (32)            // per DMABUF_MSG_BUFFERS
+#define DMABUF_MAX_HELD (8)
+
+typedef enum
+{
+    DMABUF_MSG_BUFFERS,
+    DMABUF_MSG_FRAME,
+    DMABUF_MSG_RELEASE
+} dmabuf_msg_type_t;
+
+typedef struct
+{
+    uint32_t type;                     // dmabuf_msg_type_t
+    uint32_t index;                    // the buffer, or the first one attached
+    uint32_t count;                    // BUFFERS: fds attached
+    uint32_t length;                   // BUFFERS: bytes in each buffer
+    uint32_t width, height;            // BUFFERS: format
+    uint32_t pixelformat, bytesperline;
+    uint32_t tag, sequence;            // FRAME: capture's frame number, the driver's
+    uint32_t bytesused;                // FRAME
+    int64_t sec, nsec;                 // FRAME: CLOCK_REALTIME at dequeue
+} dmabuf_msg_t;
+
+#endif
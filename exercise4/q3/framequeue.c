@@ -0,0 +1,135 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Frame queues, see framequeue.h.
+//
+// pushed.count is the producer's tail and popped the consumer's head.  The
+// producer reads popped with acquire, so it never reuses a slot the
+// consumer is still reading; the consumer sees a pushed frame through the
+// event's sequentially consistent count.  pushed.taken runs ahead of
+// popped by the one frame the consumer holds between front and pop.
+//
+// Those counts wrap at 2^32, which no capacity but a power of two divides,
+// so they only ever give the depth, as differences.  The slots are picked
+// by back_slot and front_slot, each owned by one side and kept modulo the
+// capacity.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "framequeue.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define TRUE (1)
+#define FALSE (0)
+
+static unsigned long long frame_queue_nsec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (unsigned long long)now.tv_sec * NANOSEC_PER_SEC + (unsigned long long)now.tv_nsec;
+}
+
+int frame_queue_init(frame_queue_t *queue, unsigned int capacity, size_t data_bytes, const char *name)
+{
+    unsigned int i;
+
+    memset(queue, 0, sizeof(*queue));
+    queue->name = name;
+    queue->capacity = capacity;
+    seq_event_init(&queue->pushed, 0);
+    atomic_init(&queue->popped, 0);
+
+    queue->frames = calloc(capacity, sizeof(frame_t));
+    if(queue->frames == NULL)
+    {
+        perror("frame_queue_init");
+        return -1;
+    }
+
+    for(i = 0; (i < capacity) && (data_bytes > 0); i++)
+    {
+        queue->frames[i].data = malloc(data_bytes);
+        if(queue->frames[i].data == NULL)
+        {
+            perror("frame_queue_init");
+            frame_queue_free(queue);
+            return -1;
+        }
+        queue->frames[i].data_bytes = data_bytes;
+    }
+
+    return 0;
+}
+
+frame_t *frame_queue_back(frame_queue_t *queue)
+{
+    unsigned int tail = atomic_load_explicit(&queue->pushed.count, memory_order_relaxed);
+
+    if(tail - atomic_load_explicit(&queue->popped, memory_order_acquire) >= queue->capacity)
+        return NULL;
+
+    return &queue->frames[queue->back_slot];
+}
+
+void frame_queue_push(frame_queue_t *queue)
+{
+    unsigned int tail = atomic_load_explicit(&queue->pushed.count, memory_order_relaxed);
+    unsigned int depth = tail + 1 - atomic_load_explicit(&queue->popped, memory_order_relaxed);
+
+    queue->frames[queue->back_slot].queued_nsec = frame_queue_nsec();
+    if(depth > queue->depth_max)
+        queue->depth_max = depth;
+    if(++queue->back_slot == queue->capacity)
+        queue->back_slot = 0;
+
+    seq_event_post(&queue->pushed);
+}
+
+static frame_t *frame_queue_took(frame_queue_t *queue)
+{
+    frame_t *frame = &queue->frames[queue->front_slot];
+
+    if(++queue->front_slot == queue->capacity)
+        queue->front_slot = 0;
+    seq_stat_record(&queue->wait, frame_queue_nsec() - frame->queued_nsec);
+    return frame;
+}
+
+frame_t *frame_queue_front(frame_queue_t *queue)
+{
+    seq_event_wait(&queue->pushed);
+    return frame_queue_took(queue);
+}
+
+frame_t *frame_queue_try_front(frame_queue_t *queue)
+{
+    if(!seq_event_try_wait(&queue->pushed))
+        return NULL;
+
+    return frame_queue_took(queue);
+}
+
+void frame_queue_pop(frame_queue_t *queue)
+{
+    atomic_fetch_add_explicit(&queue->popped, 1, memory_order_release);
+}
+
+void frame_queue_print(frame_queue_t *queue)
+{
+    printf("   queue %-8s depth max=%u of %u\n", queue->name, queue->depth_max, queue->capacity);
+    seq_stat_print(&queue->wait, "wait");
+}
+
+void frame_queue_free(frame_queue_t *queue)
+{
+    unsigned int i;
+
+    for(i = 0; (queue->frames != NULL) && (i < queue->capacity); i++)
+        free(queue->frames[i].data);
+    free(queue->frames);
+    queue->frames = NULL;
+}
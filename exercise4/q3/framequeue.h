@@ -0,0 +1,96 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Frame queues between the capture pipeline's stages: a bounded ring of
+// frame slots with one producer thread and one consumer thread, and no
+// lock.  The producer fills the slot frame_queue_back() gives it and
+// publishes it with frame_queue_push(); the consumer takes the oldest with
+// frame_queue_front() and hands the slot back with frame_queue_pop().
+// Frames are used in place, so a queue whose slots carry data buffers
+// (data_bytes > 0) needs no copy between the stages either side of it.
+//
+// A full queue is never waited on: frame_queue_back() returns NULL, and
+// the producer decides what to drop.  An empty one is, through a release
+// event (seqevent.h) whose count of posts is the count of frames pushed,
+// so a consumer with frames waiting never makes a system call.
+//
+// Each queue keeps the most frames it has held and how long frames waited
+// in it, from push to front.
+//
+// Usage:
+//      frame_queue_init(&queue, 8, 0, "convert");
+//      producer: frame = frame_queue_back(&queue); ...; frame_queue_push(&queue);
+//      consumer: frame = frame_queue_front(&queue); ...; frame_queue_pop(&queue);
+
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "seqevent.h"
+#include "seqstats.h"
+
+typedef struct
+{
+    unsigned int tag;                  // frame number, names the file
+    unsigned int index;                // V4L2 buffer holding the frame
+    unsigned int bytesused;
+    unsigned int sequence;             // the driver's frame number
+    struct timespec frame_time;        // CLOCK_REALTIME at dequeue, for the file header
+    unsigned long long dequeued_nsec;  // CLOCK_MONOTONIC_RAW at dequeue
+    unsigned long long queued_nsec;    // CLOCK_MONOTONIC_RAW at push, set by frame_queue_push()
+    unsigned long long convert_nsec;   // time taken to convert
+    int last;                          // marks the end of the stream, no frame
+
+    // frame to dump: converted into data, in a queue with data buffers, or
+    // in place in the V4L2 buffer
+    unsigned char *data;
+    size_t data_bytes;                 // size of data
+    const unsigned char *pixels;       // data, or the V4L2 buffer
+    int in_place;                      // pixels is the V4L2 buffer, holding a reference
+    int size;                          // bytes used
+    int pgm;                           // dump as graymap, else pixmap
+    const char *what;                  // conversion, for the log
+} frame_t;
+
+typedef struct
+{
+    const char *name;
+    frame_t *frames;
+    unsigned int capacity;
+    seq_event_t pushed;                // count is frames pushed, taken is frames fronted
+    atomic_uint popped;                // frames handed back, by the consumer
+    unsigned int back_slot;            // next slot to fill, by the producer
+    unsigned int front_slot;           // next slot to front, by the consumer
+    unsigned int depth_max;            // by the producer
+    seq_stat_t wait;                   // push to front, by the consumer
+} frame_queue_t;
+
+// Allocates capacity slots, each with data_bytes of data if not 0.
+// Returns 0, or -1 after printing why if out of memory.
+int frame_queue_init(frame_queue_t *queue, unsigned int capacity, size_t data_bytes, const char *name);
+
+// Producer: the next free slot, or NULL if the queue is full.
+frame_t *frame_queue_back(frame_queue_t *queue);
+
+// Producer: publishes the slot frame_queue_back() gave.
+void frame_queue_push(frame_queue_t *queue);
+
+// Consumer: waits for and returns the oldest frame.  Once per pop.
+frame_t *frame_queue_front(frame_queue_t *queue);
+
+// Consumer: the oldest frame, or NULL at once if the queue is empty.
+frame_t *frame_queue_try_front(frame_queue_t *queue);
+
+// Consumer: hands back the slot frame_queue_front() gave.
+void frame_queue_pop(frame_queue_t *queue);
+
+// Prints "<name> depth max=<n> of <capacity>" and the wait times.
+void frame_queue_print(frame_queue_t *queue);
+
+void frame_queue_free(frame_queue_t *queue);
+
+#endif
@@ -0,0 +1,132 @@
+#!/bin/bash
+#
+# DMABUF sharing test on the vivid virtual driver, no camera needed.
+#
+# Loads vivid, finds its capture node, and runs capture -x with a
+# dmabuf_consumer attached, first one keeping up and then one holding each
+# frame for HOLD_MSEC.  Each run passes when both programs exit with 0,
+# capture grabbed all CAPTURE_FRAMES, the consumer read exactly the frames
+# it asked for, and capture shared at least that many.  The slow consumer
+# checks that a stalled consumer never stops acquisition; it reads
+# SLOW_FRAMES, few enough to finish while capture is still running.
+#
+# Usage: sudo ./test_dmabuf_vivid.sh [capture frames] [consumer frames]
+
+CAPTURE_FRAMES=${1:-300}
+CONSUMER_FRAMES=${2:-100}
+HOLD_MSEC=200
+SLOW_FRAMES=20
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SOCKET=/tmp/capture-dmabuf-test.sock
+WORK=$(mktemp -d)
+LOADED=0
+FAILED=0
+
+cleanup()
+{
+    rm -rf "$WORK"
+    rm -f "$SOCKET"
+    if [ $LOADED -eq 1 ]; then
+        modprobe -r vivid
+    fi
+}
+trap cleanup EXIT
+
+fail()
+{
+    echo "FAIL: $*"
+    FAILED=1
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo "Run as root (modprobe and RT scheduling)"
+    exit 1
+fi
+
+for tool in modprobe v4l2-ctl make; do
+    if ! command -v $tool > /dev/null; then
+        echo "$tool not found"
+        exit 1
+    fi
+done
+
+make -C "$HERE" capture dmabuf_consumer > /dev/null || exit 1
+
+if ! lsmod | grep -q '^vivid'; then
+    modprobe vivid n_devs=1 || exit 1
+    LOADED=1
+    sleep 1
+fi
+
+# the first video node of vivid with a capture format (the others are
+# output, VBI, SDR or touch nodes)
+DEVICE=""
+for node in $(v4l2-ctl --list-devices | awk '/^vivid/ { found = 1; next } /^[^ \t]/ { found = 0 } found && /\/dev\/video/ { print $1 }'); do
+    if v4l2-ctl -d "$node" --get-fmt-video > /dev/null 2>&1; then
+        DEVICE=$node
+        break
+    fi
+done
+
+if [ -z "$DEVICE" ]; then
+    echo "No vivid capture node found"
+    exit 1
+fi
+echo "vivid capture node: $DEVICE"
+
+# run_pair name consumer_frames [consumer options]
+run_pair()
+{
+    local name=$1 frames=$2 capture_rc consumer_rc grabbed shared read
+    shift 2
+
+    echo "== $name"
+    rm -f "$SOCKET"
+
+    (cd "$WORK" && exec "$HERE/capture" -d "$DEVICE" -x -s "$SOCKET" -c "$CAPTURE_FRAMES") \
+        > "$WORK/capture.log" 2>&1 &
+    local capture_pid=$!
+
+    for i in $(seq 50); do
+        [ -S "$SOCKET" ] && break
+        sleep 0.1
+    done
+    if [ ! -S "$SOCKET" ]; then
+        kill $capture_pid 2> /dev/null
+        wait $capture_pid
+        cat "$WORK/capture.log"
+        fail "$name: capture never opened $SOCKET"
+        return
+    fi
+
+    "$HERE/dmabuf_consumer" -s "$SOCKET" -c "$frames" "$@" > "$WORK/consumer.log" 2>&1
+    consumer_rc=$?
+    wait $capture_pid
+    capture_rc=$?
+
+    grabbed=$(sed -n 's/^Pipeline: \([0-9]*\) frames.*/\1/p' "$WORK/capture.log")
+    shared=$(sed -n 's/.* \([0-9]*\) frames shared.*/\1/p' "$WORK/capture.log")
+    read=$(sed -n 's/^\([0-9]*\) frames read in place/\1/p' "$WORK/consumer.log")
+    echo "capture exit $capture_rc, $grabbed frames, $shared shared; consumer exit $consumer_rc, $read read"
+
+    [ $capture_rc -eq 0 ] || fail "$name: capture exited with $capture_rc"
+    [ $consumer_rc -eq 0 ] || fail "$name: dmabuf_consumer exited with $consumer_rc"
+    [ "$grabbed" = "$CAPTURE_FRAMES" ] || fail "$name: capture grabbed ${grabbed:-no} frames, expected $CAPTURE_FRAMES"
+    [ "$read" = "$frames" ] || fail "$name: consumer read ${read:-no} frames, expected $frames"
+    [ "${shared:-0}" -ge "$frames" ] || fail "$name: capture shared ${shared:-no} frames, fewer than read"
+
+    if [ $FAILED -ne 0 ]; then
+        cat "$WORK/capture.log" "$WORK/consumer.log"
+    fi
+}
+
+run_pair "consumer keeping up" $CONSUMER_FRAMES
+run_pair "consumer holding each frame ${HOLD_MSEC} msec" $SLOW_FRAMES -d $HOLD_MSEC
+
+if [ $FAILED -ne 0 ]; then
+    echo "FAILED"
+    exit 1
+fi
+echo "PASSED"
+exit 0
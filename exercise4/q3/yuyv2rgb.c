@@ -0,0 +1,369 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// YUYV to RGB24 conversion, see yuyv2rgb.h.
+//
+// The x86 kernels work on 8 pixels per 128 bit lane, one 16 byte load of
+// YUYV.  Masking and shifting the 16 bit words splits it into Y and U,V as
+// int16; then pmaddwd, which multiplies int16 pairs and adds each pair
+// into an int32, does two terms of a sum at a time:
+//
+//      (c, 1) . (298, 128)          luma term and rounding, per pixel
+//      (d, e) . (0, 409)            R chroma term, per pair of pixels
+//      (d, e) . (-100, -208)        G
+//      (d, e) . (516, 0)            B
+//
+// The chroma terms are duplicated to both pixels of their pair, added to
+// the luma terms and shifted right by 8, then packssdw and packuswb narrow
+// to bytes and clamp to 0..255 in one go.  pshufb finally interleaves the
+// R, G and B bytes of 16 pixels into 48 bytes of RGB24.
+//
+// The kernels are compiled for their instruction set with a target
+// attribute and only run when the CPU reports it, so the file builds for
+// any x86 and the binary runs on any x86.
+
+#include <stdint.h>
+
+#include "yuyv2rgb.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define YUYV2RGB_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define YUYV2RGB_NEON
+#include <arm_neon.h>
+#endif
+
+// This is probably the most acceptable conversion from camera YUYV to RGB
+//
+// Wikipedia has a good discussion on the details of various conversions and cites good references:
+// http://en.wikipedia.org/wiki/YUV
+//
+// Also http://www.fourcc.org/yuv.php
+//
+// What's not clear without knowing more about the camera in question is how often U & V are sampled compared
+// to Y.
+//
+// E.g. YUV444, which is equivalent to RGB, where both require 3 bytes for each pixel
+//      YUV422, which we assume here, where there are 2 bytes for each pixel, with two Y samples for one U & V,
+//              or as the name implies, 4Y and 2 UV pairs
+//      YUV420, where for every 4 Ys, there is a single UV pair, 1.5 bytes for each pixel or 36 bytes for 24 pixels
+
+void yuv2rgb(int y, int u, int v, unsigned char *r, unsigned char *g, unsigned char *b)
+{
+   int r1, g1, b1;
+
+   // replaces floating point coefficients
+   int c = y-16, d = u - 128, e = v - 128;
+
+   // Conversion that avoids floating point
+   r1 = (298 * c           + 409 * e + 128) >> 8;
+   g1 = (298 * c - 100 * d - 208 * e + 128) >> 8;
+   b1 = (298 * c + 516 * d           + 128) >> 8;
+
+   // Computed values may need clipping.
+   if (r1 > 255) r1 = 255;
+   if (g1 > 255) g1 = 255;
+   if (b1 > 255) b1 = 255;
+
+   if (r1 < 0) r1 = 0;
+   if (g1 < 0) g1 = 0;
+   if (b1 < 0) b1 = 0;
+
+   *r = r1 ;
+   *g = g1 ;
+   *b = b1 ;
+}
+
+void yuyv2rgb_scalar(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels)
+{
+    unsigned int i, newi;
+
+    // Pixels are YU and YV alternating, so YUYV which is 4 bytes
+    // We want RGB, so RGBRGB which is 6 bytes
+    //
+    for(i=0, newi=0; i<pixels*2; i=i+4, newi=newi+6)
+    {
+        yuv2rgb(yuyv[i], yuyv[i+1], yuyv[i+3], &rgb[newi], &rgb[newi+1], &rgb[newi+2]);
+        yuv2rgb(yuyv[i+2], yuyv[i+1], yuyv[i+3], &rgb[newi+3], &rgb[newi+4], &rgb[newi+5]);
+    }
+}
+
+#if defined(YUYV2RGB_X86)
+
+#define YUYV2RGB_SSSE3 __attribute__((target("ssse3")))
+#define YUYV2RGB_AVX2 __attribute__((target("avx2")))
+
+// Converts the 8 pixels of one lane of YUYV to R, G and B as int16, not
+// yet clamped.
+static inline YUYV2RGB_SSSE3 void yuyv2rgb_sse_8(__m128i in, __m128i *r, __m128i *g, __m128i *b)
+{
+    const __m128i luma_k = _mm_setr_epi16(298, 128, 298, 128, 298, 128, 298, 128);
+    const __m128i r_k = _mm_setr_epi16(0, 409, 0, 409, 0, 409, 0, 409);
+    const __m128i g_k = _mm_setr_epi16(-100, -208, -100, -208, -100, -208, -100, -208);
+    const __m128i b_k = _mm_setr_epi16(516, 0, 516, 0, 516, 0, 516, 0);
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i c, de, luma_lo, luma_hi, chroma;
+
+    c = _mm_sub_epi16(_mm_and_si128(in, _mm_set1_epi16(0x00ff)), _mm_set1_epi16(16));
+    de = _mm_sub_epi16(_mm_srli_epi16(in, 8), _mm_set1_epi16(128));
+
+    luma_lo = _mm_madd_epi16(_mm_unpacklo_epi16(c, one), luma_k);
+    luma_hi = _mm_madd_epi16(_mm_unpackhi_epi16(c, one), luma_k);
+
+    chroma = _mm_madd_epi16(de, r_k);
+    *r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(luma_lo, _mm_unpacklo_epi32(chroma, chroma)), 8),
+                         _mm_srai_epi32(_mm_add_epi32(luma_hi, _mm_unpackhi_epi32(chroma, chroma)), 8));
+    chroma = _mm_madd_epi16(de, g_k);
+    *g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(luma_lo, _mm_unpacklo_epi32(chroma, chroma)), 8),
+                         _mm_srai_epi32(_mm_add_epi32(luma_hi, _mm_unpackhi_epi32(chroma, chroma)), 8));
+    chroma = _mm_madd_epi16(de, b_k);
+    *b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(luma_lo, _mm_unpacklo_epi32(chroma, chroma)), 8),
+                         _mm_srai_epi32(_mm_add_epi32(luma_hi, _mm_unpackhi_epi32(chroma, chroma)), 8));
+}
+
+// Interleaves 16 pixels of R, G and B bytes into 48 bytes of RGB24.
+static inline YUYV2RGB_SSSE3 void yuyv2rgb_sse_store(unsigned char *rgb, __m128i r, __m128i g, __m128i b)
+{
+    const __m128i r0 = _mm_setr_epi8( 0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5);
+    const __m128i r1 = _mm_setr_epi8(-1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+    const __m128i g0 = _mm_setr_epi8(-1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1);
+    const __m128i g1 = _mm_setr_epi8( 5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+    const __m128i b0 = _mm_setr_epi8(-1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1);
+    const __m128i b1 = _mm_setr_epi8(-1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+
+    _mm_storeu_si128((__m128i *)rgb, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)),
+                                                  _mm_shuffle_epi8(b, b0)));
+    _mm_storeu_si128((__m128i *)(rgb + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)),
+                                                         _mm_shuffle_epi8(b, b1)));
+    _mm_storeu_si128((__m128i *)(rgb + 32), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)),
+                                                         _mm_shuffle_epi8(b, b2)));
+}
+
+static YUYV2RGB_SSSE3 void yuyv2rgb_ssse3(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels)
+{
+    __m128i r0, g0, b0, r1, g1, b1;
+    unsigned int i;
+
+    for(i = 0; i + 16 <= pixels; i += 16)
+    {
+        yuyv2rgb_sse_8(_mm_loadu_si128((const __m128i *)(yuyv + 2*i)), &r0, &g0, &b0);
+        yuyv2rgb_sse_8(_mm_loadu_si128((const __m128i *)(yuyv + 2*i + 16)), &r1, &g1, &b1);
+        yuyv2rgb_sse_store(rgb + 3*i, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
+    }
+
+    yuyv2rgb_scalar(yuyv + 2*i, rgb + 3*i, pixels - i);
+}
+
+// yuyv2rgb_sse_8() on both lanes: 16 pixels, 0-7 in the low lane and 8-15
+// in the high one.
+static inline YUYV2RGB_AVX2 void yuyv2rgb_avx_16(__m256i in, __m256i *r, __m256i *g, __m256i *b)
+{
+    const __m256i luma_k = _mm256_setr_epi16(298, 128, 298, 128, 298, 128, 298, 128,
+                                             298, 128, 298, 128, 298, 128, 298, 128);
+    const __m256i r_k = _mm256_setr_epi16(0, 409, 0, 409, 0, 409, 0, 409, 0, 409, 0, 409, 0, 409, 0, 409);
+    const __m256i g_k = _mm256_setr_epi16(-100, -208, -100, -208, -100, -208, -100, -208,
+                                          -100, -208, -100, -208, -100, -208, -100, -208);
+    const __m256i b_k = _mm256_setr_epi16(516, 0, 516, 0, 516, 0, 516, 0, 516, 0, 516, 0, 516, 0, 516, 0);
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i c, de, luma_lo, luma_hi, chroma;
+
+    c = _mm256_sub_epi16(_mm256_and_si256(in, _mm256_set1_epi16(0x00ff)), _mm256_set1_epi16(16));
+    de = _mm256_sub_epi16(_mm256_srli_epi16(in, 8), _mm256_set1_epi16(128));
+
+    luma_lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(c, one), luma_k);
+    luma_hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(c, one), luma_k);
+
+    chroma = _mm256_madd_epi16(de, r_k);
+    *r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(luma_lo, _mm256_unpacklo_epi32(chroma, chroma)), 8),
+                            _mm256_srai_epi32(_mm256_add_epi32(luma_hi, _mm256_unpackhi_epi32(chroma, chroma)), 8));
+    chroma = _mm256_madd_epi16(de, g_k);
+    *g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(luma_lo, _mm256_unpacklo_epi32(chroma, chroma)), 8),
+                            _mm256_srai_epi32(_mm256_add_epi32(luma_hi, _mm256_unpackhi_epi32(chroma, chroma)), 8));
+    chroma = _mm256_madd_epi16(de, b_k);
+    *b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(luma_lo, _mm256_unpacklo_epi32(chroma, chroma)), 8),
+                            _mm256_srai_epi32(_mm256_add_epi32(luma_hi, _mm256_unpackhi_epi32(chroma, chroma)), 8));
+}
+
+// Packs 32 pixels to bytes.  packuswb works within lanes, leaving pixels
+// 0-7, 16-23 | 8-15, 24-31, so the middle quarters are swapped back.
+static inline YUYV2RGB_AVX2 __m256i yuyv2rgb_avx_pack(__m256i first, __m256i second)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xd8);
+}
+
+static YUYV2RGB_AVX2 void yuyv2rgb_avx2(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels)
+{
+    __m256i r0, g0, b0, r1, g1, b1, r, g, b;
+    unsigned int i;
+
+    for(i = 0; i + 32 <= pixels; i += 32)
+    {
+        yuyv2rgb_avx_16(_mm256_loadu_si256((const __m256i *)(yuyv + 2*i)), &r0, &g0, &b0);
+        yuyv2rgb_avx_16(_mm256_loadu_si256((const __m256i *)(yuyv + 2*i + 32)), &r1, &g1, &b1);
+        r = yuyv2rgb_avx_pack(r0, r1);
+        g = yuyv2rgb_avx_pack(g0, g1);
+        b = yuyv2rgb_avx_pack(b0, b1);
+
+        yuyv2rgb_sse_store(rgb + 3*i, _mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b));
+        yuyv2rgb_sse_store(rgb + 3*i + 48, _mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1),
+                           _mm256_extracti128_si256(b, 1));
+    }
+
+    yuyv2rgb_scalar(yuyv + 2*i, rgb + 3*i, pixels - i);
+}
+
+#endif
+
+#if defined(YUYV2RGB_NEON)
+
+// Shifts the sums of 8 pixels right by 8 and narrows them to clamped bytes.
+static inline uint8x8_t yuyv2rgb_neon_clamp(int32x4_t lo, int32x4_t hi)
+{
+    return vqmovun_s16(vcombine_s16(vqshrn_n_s32(lo, 8), vqshrn_n_s32(hi, 8)));
+}
+
+// Converts 8 pairs of pixels, even and odd Y with their shared U and V
+// already offset, to clamped R, G and B bytes for the even and the odd
+// pixels.
+static inline void yuyv2rgb_neon_8(int16x8_t c_even, int16x8_t c_odd, int16x8_t d, int16x8_t e,
+                                   uint8x8_t even[3], uint8x8_t odd[3])
+{
+    const int32x4_t round = vdupq_n_s32(128);
+    int32x4_t even_lo, even_hi, odd_lo, odd_hi, chroma_lo, chroma_hi;
+
+    even_lo = vmlal_n_s16(round, vget_low_s16(c_even), 298);
+    even_hi = vmlal_n_s16(round, vget_high_s16(c_even), 298);
+    odd_lo = vmlal_n_s16(round, vget_low_s16(c_odd), 298);
+    odd_hi = vmlal_n_s16(round, vget_high_s16(c_odd), 298);
+
+    chroma_lo = vmull_n_s16(vget_low_s16(e), 409);
+    chroma_hi = vmull_n_s16(vget_high_s16(e), 409);
+    even[0] = yuyv2rgb_neon_clamp(vaddq_s32(even_lo, chroma_lo), vaddq_s32(even_hi, chroma_hi));
+    odd[0] = yuyv2rgb_neon_clamp(vaddq_s32(odd_lo, chroma_lo), vaddq_s32(odd_hi, chroma_hi));
+
+    chroma_lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(d), -100), vget_low_s16(e), -208);
+    chroma_hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(d), -100), vget_high_s16(e), -208);
+    even[1] = yuyv2rgb_neon_clamp(vaddq_s32(even_lo, chroma_lo), vaddq_s32(even_hi, chroma_hi));
+    odd[1] = yuyv2rgb_neon_clamp(vaddq_s32(odd_lo, chroma_lo), vaddq_s32(odd_hi, chroma_hi));
+
+    chroma_lo = vmull_n_s16(vget_low_s16(d), 516);
+    chroma_hi = vmull_n_s16(vget_high_s16(d), 516);
+    even[2] = yuyv2rgb_neon_clamp(vaddq_s32(even_lo, chroma_lo), vaddq_s32(even_hi, chroma_hi));
+    odd[2] = yuyv2rgb_neon_clamp(vaddq_s32(odd_lo, chroma_lo), vaddq_s32(odd_hi, chroma_hi));
+}
+
+// Offsets 8 bytes to int16; the unsigned wrap of the widening subtract is
+// the signed difference.
+static inline int16x8_t yuyv2rgb_neon_offset(uint8x8_t value, uint8_t offset)
+{
+    return vreinterpretq_s16_u16(vsubl_u8(value, vdup_n_u8(offset)));
+}
+
+static void yuyv2rgb_neon(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels)
+{
+    uint8x16x4_t in;
+    uint8x16x3_t out;
+    uint8x16x2_t zipped;
+    uint8x8_t even_lo[3], odd_lo[3], even_hi[3], odd_hi[3];
+    unsigned int i, k;
+
+    for(i = 0; i + 32 <= pixels; i += 32)
+    {
+        // val[0] even Y, val[1] U, val[2] odd Y, val[3] V, 16 pairs each
+        in = vld4q_u8(yuyv + 2*i);
+
+        yuyv2rgb_neon_8(yuyv2rgb_neon_offset(vget_low_u8(in.val[0]), 16),
+                        yuyv2rgb_neon_offset(vget_low_u8(in.val[2]), 16),
+                        yuyv2rgb_neon_offset(vget_low_u8(in.val[1]), 128),
+                        yuyv2rgb_neon_offset(vget_low_u8(in.val[3]), 128), even_lo, odd_lo);
+        yuyv2rgb_neon_8(yuyv2rgb_neon_offset(vget_high_u8(in.val[0]), 16),
+                        yuyv2rgb_neon_offset(vget_high_u8(in.val[2]), 16),
+                        yuyv2rgb_neon_offset(vget_high_u8(in.val[1]), 128),
+                        yuyv2rgb_neon_offset(vget_high_u8(in.val[3]), 128), even_hi, odd_hi);
+
+        // even and odd pixels back in order, then R, G and B interleaved
+        for(k = 0; k < 3; k++)
+        {
+            zipped = vzipq_u8(vcombine_u8(even_lo[k], even_hi[k]), vcombine_u8(odd_lo[k], odd_hi[k]));
+            out.val[k] = zipped.val[0];
+            in.val[k] = zipped.val[1];
+        }
+        vst3q_u8(rgb + 3*i, out);
+
+        for(k = 0; k < 3; k++)
+            out.val[k] = in.val[k];
+        vst3q_u8(rgb + 3*i + 48, out);
+    }
+
+    yuyv2rgb_scalar(yuyv + 2*i, rgb + 3*i, pixels - i);
+}
+
+#endif
+
+static yuyv2rgb_kernel_t yuyv2rgbKernels[4];
+static unsigned int yuyv2rgbCount;
+static yuyv2rgb_fn yuyv2rgbSelected;
+
+unsigned int yuyv2rgb_kernels(const yuyv2rgb_kernel_t **kernels)
+{
+    unsigned int count = 0;
+
+    if(yuyv2rgbCount == 0)
+    {
+        yuyv2rgbKernels[count].name = "scalar";
+        yuyv2rgbKernels[count++].convert = yuyv2rgb_scalar;
+
+#if defined(YUYV2RGB_X86)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("ssse3"))
+        {
+            yuyv2rgbKernels[count].name = "ssse3";
+            yuyv2rgbKernels[count++].convert = yuyv2rgb_ssse3;
+        }
+        if(__builtin_cpu_supports("avx2"))
+        {
+            yuyv2rgbKernels[count].name = "avx2";
+            yuyv2rgbKernels[count++].convert = yuyv2rgb_avx2;
+        }
+#endif
+
+#if defined(YUYV2RGB_NEON)
+        yuyv2rgbKernels[count].name = "neon";
+        yuyv2rgbKernels[count++].convert = yuyv2rgb_neon;
+#endif
+
+        yuyv2rgbCount = count;
+    }
+
+    *kernels = yuyv2rgbKernels;
+    return yuyv2rgbCount;
+}
+
+void yuyv2rgb(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels)
+{
+    const yuyv2rgb_kernel_t *kernels;
+    unsigned int count;
+
+    if(yuyv2rgbSelected == NULL)
+    {
+        count = yuyv2rgb_kernels(&kernels);
+        yuyv2rgbSelected = kernels[count - 1].convert;
+    }
+
+    yuyv2rgbSelected(yuyv, rgb, pixels);
+}
+
+void yuyv2y(const unsigned char *yuyv, unsigned char *y, unsigned int pixels)
+{
+    unsigned int i;
+
+    for(i = 0; i < pixels; i++)
+        y[i] = yuyv[2*i];
+}
@@ -0,0 +1,56 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// YUYV (YUV 4:2:2, Y0 U Y1 V per pair of pixels) to RGB24 conversion.
+//
+// yuv2rgb() is the integer conversion capture.c has always used, one pixel
+// at a time:
+//
+//      c = Y - 16, d = U - 128, e = V - 128
+//      R = (298c        + 409e + 128) >> 8
+//      G = (298c - 100d - 208e + 128) >> 8
+//      B = (298c + 516d        + 128) >> 8
+//
+// each clamped to 0..255.  The vector kernels compute exactly the same
+// values, in 32 bit lanes as the sums do not fit 16 bits, and clamp with
+// saturating packs instead of branches:
+//
+//      ssse3   16 pixels per iteration, x86 with SSSE3
+//      avx2    32 pixels per iteration, x86 with AVX2
+//      neon    32 pixels per iteration, ARM with NEON (vld4/vst3 do the
+//              YUYV and RGB24 (de)interleaving)
+//
+// yuyv2rgb() runs the fastest kernel the CPU supports, chosen on its first
+// call.  yuyvbench checks every kernel against yuv2rgb() and measures them.
+
+#ifndef YUYV2RGB_H
+#define YUYV2RGB_H
+
+// Converts pixels (an even count) of YUYV at yuyv to RGB24 at rgb, which
+// must have room for 3 bytes per pixel.  Neither needs any alignment.
+typedef void (*yuyv2rgb_fn)(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels);
+
+typedef struct
+{
+    const char *name;
+    yuyv2rgb_fn convert;
+} yuyv2rgb_kernel_t;
+
+void yuv2rgb(int y, int u, int v, unsigned char *r, unsigned char *g, unsigned char *b);
+
+// yuv2rgb() for each pixel, the reference the others must match
+void yuyv2rgb_scalar(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels);
+
+// The kernels this build has and this CPU supports, slowest first, so the
+// last is the one yuyv2rgb() runs.  Returns how many.
+unsigned int yuyv2rgb_kernels(const yuyv2rgb_kernel_t **kernels);
+
+void yuyv2rgb(const unsigned char *yuyv, unsigned char *rgb, unsigned int pixels);
+
+// Copies the Y of each of pixels (an even count) to y, the graymap
+// capture.c dumps without COLOR_CONVERT.  A plain loop the compiler
+// vectorizes.
+void yuyv2y(const unsigned char *yuyv, unsigned char *y, unsigned int pixels);
+
+#endif
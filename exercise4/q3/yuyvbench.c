@@ -0,0 +1,259 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Checks and measures the YUYV to RGB24 kernels (yuyv2rgb.h).
+//
+// Usage: yuyvbench [seconds per kernel] [most conversion workers]
+//
+// Golden check: every kernel this CPU supports must produce exactly what
+// yuyv2rgb_scalar() (yuv2rgb() per pixel) does (and an ARM build with NEON
+// must have the neon kernel to check), for
+//
+//      * every Y, U and V, at both the even and the odd pixel of a pair
+//      * 2 to 130 pixels, from every byte alignment, so the vector loops
+//      * hand over to the scalar tail at every point, without writing
+//      * past the last pixel
+//
+// Throughput: each kernel converts 1280x960 frames of random YUYV for the
+// given time, and prints megapixels per second and frames per second.
+//
+// Parallel conversion: conv_frame() (convpool.h) converts 1920x1080 frames
+// inline and then on 1, 2, 4 ... workers up to the most given, pinned as
+// capture pins them, and prints each pool's time per frame and speedup
+// (and how many workers started, when conv_pool_start() started fewer).
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "seqplace.h"
+#include "convpool.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define FRAME_HRES (1280)
+#define FRAME_VRES (960)
+#define FRAME_PIXELS (FRAME_HRES * FRAME_VRES)
+#define POOL_HRES (1920)
+#define POOL_VRES (1080)
+#define POOL_PIXELS (POOL_HRES * POOL_VRES)
+#define TAIL_PIXELS (130)
+#define CANARY (0xa5)
+
+static unsigned long long raw_nsec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (unsigned long long)now.tv_sec * NANOSEC_PER_SEC + (unsigned long long)now.tv_nsec;
+}
+
+// Every (Y, U, V): one buffer per U, a pair for each V and Y, the odd Y
+// running down as the even one runs up.
+static int check_all_values(const yuyv2rgb_kernel_t *kernel, unsigned char *yuyv, unsigned char *golden,
+                            unsigned char *rgb)
+{
+    unsigned int u, v, y, i;
+
+    for(u = 0; u < 256; u++)
+    {
+        for(v = 0, i = 0; v < 256; v++)
+        {
+            for(y = 0; y < 256; y++, i += 4)
+            {
+                yuyv[i] = (unsigned char)y;
+                yuyv[i+1] = (unsigned char)u;
+                yuyv[i+2] = (unsigned char)(255 - y);
+                yuyv[i+3] = (unsigned char)v;
+            }
+        }
+
+        yuyv2rgb_scalar(yuyv, golden, 2*256*256);
+        kernel->convert(yuyv, rgb, 2*256*256);
+        if(memcmp(golden, rgb, 3*2*256*256) != 0)
+        {
+            for(i = 0; golden[i] == rgb[i]; i++);
+            printf("   %s differs from scalar at U=%u, pixel %u: got %u, expected %u\n", kernel->name, u, i / 3,
+                   rgb[i], golden[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int check_tails(const yuyv2rgb_kernel_t *kernel, unsigned char *yuyv, unsigned char *golden,
+                       unsigned char *rgb)
+{
+    unsigned int align, pixels, i;
+
+    for(i = 0; i < 2*TAIL_PIXELS + 64; i++)
+        yuyv[i] = (unsigned char)rand();
+
+    for(align = 0; align < 32; align++)
+    {
+        for(pixels = 2; pixels <= TAIL_PIXELS; pixels += 2)
+        {
+            memset(rgb, CANARY, 3*TAIL_PIXELS + 64);
+            yuyv2rgb_scalar(yuyv + align, golden, pixels);
+            kernel->convert(yuyv + align, rgb + align, pixels);
+
+            if(memcmp(golden, rgb + align, 3*pixels) != 0)
+            {
+                printf("   %s differs from scalar for %u pixels at alignment %u\n", kernel->name, pixels, align);
+                return -1;
+            }
+            for(i = 0; i < align; i++)
+                if(rgb[i] != CANARY)
+                    break;
+            if((i < align) || (rgb[align + 3*pixels] != CANARY))
+            {
+                printf("   %s wrote outside %u pixels at alignment %u\n", kernel->name, pixels, align);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// Returns the rate in megapixels per second.
+static double measure(const yuyv2rgb_kernel_t *kernel, const unsigned char *yuyv, unsigned char *rgb,
+                      unsigned int seconds, double scalar_mpps)
+{
+    unsigned long long start, elapsed, frames = 0;
+    double mpps;
+
+    // one frame first, so the output pages are in
+    kernel->convert(yuyv, rgb, FRAME_PIXELS);
+
+    start = raw_nsec();
+    do
+    {
+        kernel->convert(yuyv, rgb, FRAME_PIXELS);
+        frames++;
+        elapsed = raw_nsec() - start;
+    } while(elapsed < seconds * NANOSEC_PER_SEC);
+
+    mpps = (double)frames * FRAME_PIXELS * 1000.0 / (double)elapsed;
+    printf("   %-8s %8.1lf Mpixel/s, %7.1lf frames/s at %ux%u", kernel->name, mpps,
+           (double)frames * NANOSEC_PER_SEC / (double)elapsed, FRAME_HRES, FRAME_VRES);
+    if(scalar_mpps > 0.0)
+        printf(", %.1lfx scalar", mpps / scalar_mpps);
+    printf("\n");
+
+    return mpps;
+}
+
+// Returns the mean nsec per frame.
+static double measure_pool(unsigned int workers, const cpu_set_t *cpus, const unsigned char *yuyv,
+                           unsigned char *rgb, unsigned int seconds, double inline_nsec)
+{
+    conv_pool_t pool;
+    unsigned long long start;
+    double mean;
+
+    if(conv_pool_start(&pool, workers, cpus) != 0)
+        return 0.0;
+
+    // one frame first, so the output pages are in
+    conv_frame(&pool, CONV_RGB, yuyv, rgb, POOL_HRES, POOL_VRES);
+    memset(&pool.latency, 0, sizeof(pool.latency));
+
+    start = raw_nsec();
+    do
+        conv_frame(&pool, CONV_RGB, yuyv, rgb, POOL_HRES, POOL_VRES);
+    while(raw_nsec() - start < seconds * NANOSEC_PER_SEC);
+
+    mean = pool.latency.mean_nsec;
+    printf("   %u worker%s %8.1lf usec per frame, %7.1lf frames/s", workers, (workers == 1) ? " " : "s",
+           mean / 1000.0, (double)NANOSEC_PER_SEC / mean);
+    if((workers > 0) && (pool.num_workers < workers))
+        printf(", %u started", pool.num_workers);
+    if(inline_nsec > 0.0)
+        printf(", %.2lfx inline", inline_nsec / mean);
+    printf("\n");
+    seq_stat_print(&pool.latency, "per frame");
+
+    conv_pool_stop(&pool);
+    return mean;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int seconds = (argc > 1) ? (unsigned int)atoi(argv[1]) : 2;
+    unsigned int max_workers = (argc > 2) ? (unsigned int)atoi(argv[2]) : CONV_MAX_WORKERS;
+    const yuyv2rgb_kernel_t *kernels;
+    unsigned int count, k, i, workers;
+    unsigned char *yuyv, *golden, *rgb;
+    double scalar_mpps = 0.0, inline_nsec;
+    seq_cpus_t cpus;
+    cpu_set_t *conv_cpus;
+    int rc = 0;
+
+    if(seconds == 0)
+    {
+        printf("Usage: %s [seconds per kernel] [most conversion workers]\n", argv[0]);
+        return -1;
+    }
+
+    yuyv = malloc(2*POOL_PIXELS);
+    golden = malloc(3*FRAME_PIXELS);
+    rgb = malloc(3*POOL_PIXELS + 64);
+    if((yuyv == NULL) || (golden == NULL) || (rgb == NULL))
+    {
+        perror("yuyvbench");
+        return -1;
+    }
+
+    count = yuyv2rgb_kernels(&kernels);
+    printf("Kernels:");
+    for(k = 0; k < count; k++)
+        printf(" %s", kernels[k].name);
+    printf(", yuyv2rgb() runs %s\n", kernels[count - 1].name);
+
+    printf("\nGolden check against yuyv2rgb_scalar()\n");
+#if defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // the neon kernel only runs on ARM, so this check is all it gets
+    if(strcmp(kernels[count - 1].name, "neon") != 0)
+    {
+        printf("   ERROR: built for ARM with NEON but without the neon kernel\n");
+        rc = -1;
+    }
+#endif
+    for(k = 1; k < count; k++)
+    {
+        if((check_all_values(&kernels[k], yuyv, golden, rgb) == 0) &&
+           (check_tails(&kernels[k], yuyv, golden, rgb) == 0))
+            printf("   %-8s matches for all %u YUV values and every tail and alignment\n", kernels[k].name, 256*256*256);
+        else
+            rc = -1;
+    }
+
+    for(i = 0; i < 2*POOL_PIXELS; i++)
+        yuyv[i] = (unsigned char)rand();
+
+    printf("\nThroughput, %u sec per kernel\n", seconds);
+    scalar_mpps = measure(&kernels[0], yuyv, rgb, seconds, 0.0);
+    for(k = 1; k < count; k++)
+        measure(&kernels[k], yuyv, rgb, seconds, scalar_mpps);
+
+    if(seq_read_cpus(&cpus) != 0)
+        return -1;
+    conv_cpus = (CPU_COUNT(&cpus.housekeeping) > 0) ? &cpus.housekeeping : &cpus.online;
+
+    printf("\nParallel conversion at %ux%u with %s, %u sec per pool, %d CPUs to convert on\n", POOL_HRES,
+           POOL_VRES, kernels[count - 1].name, seconds, CPU_COUNT(conv_cpus));
+    inline_nsec = measure_pool(0, conv_cpus, yuyv, rgb, seconds, 0.0);
+    for(workers = 1; workers <= max_workers; workers *= 2)
+        measure_pool(workers, conv_cpus, yuyv, rgb, seconds, inline_nsec);
+
+    free(yuyv);
+    free(golden);
+    free(rgb);
+
+    return rc;
+}
@@ -84,66 +84,111 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <pthread.h>
 #include <sched.h>
 #include <time.h>
-#include <semaphore.h>
 
 #include <syslog.h>
 #include <sys/time.h>
 #include <sys/sysinfo.h>
 
-#include <errno.h>
+#include "sequencer.h"
+#include "seqplace.h"
+#include "rtinit.h"
 
 #define USEC_PER_MSEC (1000)
-#define NANOSEC_PER_SEC (1000000000)
-#define NUM_CPU_CORES (1)
 #define TRUE (1)
 #define FALSE (0)
 
-#define NUM_THREADS (7+1)
+#define SEQ_RATE_HZ (3000)
+// Event log records per thread, drained every 10 msec.
+#define EVLOG_RING_RECORDS (4096)
+#define EV_RELEASE (SEQ_EV_USER)
 
-int abortTest=FALSE;
-int abortS1=FALSE, abortS2=FALSE, abortS3=FALSE, abortS4=FALSE, abortS5=FALSE, abortS6=FALSE, abortS7=FALSE;
-sem_t semS1, semS2, semS3, semS4, semS5, semS6, semS7;
-struct timeval start_time_val;
+#define SEQ_PERIODS (900)
+
+// Used for prio below to run a service at RT_MIN rather than RT_MAX-prio.
+#define PRIO_RT_MIN (-1)
 
 typedef struct
 {
-    int threadIdx;
-    unsigned long long sequencePeriods;
-} threadParams_t;
+    const char *name;
+    unsigned int divisor;   // released every divisor sequencer loops
+    int prio;               // RT_MAX-prio, or PRIO_RT_MIN
+    unsigned int runtime;   // usec per release under SCHED_DEADLINE ("-d")
+} service_config_t;
+
+// One row per service; rates, priorities and budgets are changed here only.
+static const service_config_t serviceConfig[] =
+{
+    {"Frame Sampler",                        10, 1, 100},       // Service_1 @ 300 Hz
+    {"Time-stamp with Image Analysis",       30, 2, 100},       // Service_2 @ 100 Hz
+    {"Difference Image Proc",                60, 3, 100},       // Service_3 @ 50 Hz
+    {"Time-stamp Image Save to File",        30, 2, 100},       // Service_4 @ 100 Hz
+    {"Processed Image Save to File",         60, 3, 100},       // Service_5 @ 50 Hz
+    {"Send Time-stamped Image to Remote",    30, 2, 100},       // Service_6 @ 100 Hz
+    {"10 sec Tick Debug",                   300, PRIO_RT_MIN, 100} // Service_7 @ 10 Hz
+};
 
+#define NUM_SERVICES (sizeof(serviceConfig) / sizeof(serviceConfig[0]))
 
-void *Sequencer(void *threadp);
+struct timeval start_time_val;
 
-void *Service_1(void *threadp);
-void *Service_2(void *threadp);
-void *Service_3(void *threadp);
-void *Service_4(void *threadp);
-void *Service_5(void *threadp);
-void *Service_6(void *threadp);
-void *Service_7(void *threadp);
+void log_release(seq_service_t *service, unsigned long long release);
+int stop_on_overrun(seq_service_t *service, unsigned long long pending);
 double getTimeMsec(void);
 void print_scheduler(void);
 
 
-void main(void)
+void main(int argc, char *argv[])
 {
     struct timeval current_time_val;
-    int i, rc, scope;
-    cpu_set_t threadcpu;
-    pthread_t threads[NUM_THREADS];
-    threadParams_t threadParams[NUM_THREADS];
-    pthread_attr_t rt_sched_attr[NUM_THREADS];
+    int rc, scope;
+    unsigned int i;
+    int option = 0, deadline = FALSE, steerIrqs = FALSE;
+    const char *logPath = NULL, *wcetPath = NULL, *overrunPolicy = NULL, *placement = NULL;
     int rt_max_prio, rt_min_prio;
-    struct sched_param rt_param[NUM_THREADS];
     struct sched_param main_param;
     pthread_attr_t main_attr;
     pid_t mainpid;
-    cpu_set_t allcpuset;
+    seq_cpus_t cpus;
+    rt_faults_t startFaults, steadyFaults;
+    sequencer_t seq;
+    evlog_t eventLog;
+
+    // "-r" or "-t" picks the sequencer backend, "-d" runs the services under
+    // SCHED_DEADLINE, "-l <file>" logs in binary, "-w <file>" writes the
+    // observed WCETs for the feasibility tests, "-o skip|stop|<cap>" sets
+    // what an overrunning service does, "-c auto|<core map>" places the
+    // threads on CPUs (see seqplace.h) and "-i" moves the interrupts it can
+    // off the real-time CPUs
+    for(i=1; i < (unsigned int)argc; i++)
+    {
+        if((argv[i][0] == '-') && (argv[i][1] == 'l') && (i+1 < (unsigned int)argc))
+            logPath = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'w') && (i+1 < (unsigned int)argc))
+            wcetPath = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'o') && (i+1 < (unsigned int)argc))
+            overrunPolicy = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'c') && (i+1 < (unsigned int)argc))
+            placement = argv[++i];
+        else if((argv[i][0] == '-') && (argv[i][1] == 'd'))
+            deadline = TRUE;
+        else if((argv[i][0] == '-') && (argv[i][1] == 'i'))
+            steerIrqs = TRUE;
+        else if(argv[i][0] == '-')
+            option = argv[i][1];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Lock memory and prefault the heap and main stack, so no page fault
+    // lands in a release; the service threads prefault their own stacks
+    ////////////////////////////////////////////////////////////////////////////
+    rt_faults(&startFaults);
+    rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
 
     ////////////////////////////////////////////////////////////////////////////
     // Init time variables
@@ -157,23 +202,12 @@ void main(void)
 
     ////////////////////////////////////////////////////////////////////////////
     // CONFIG CPUs
+    //      * Online and isolated (isolcpus=) CPUs from sysfs; real-time
+    //      * threads go on the isolated ones if there are any
     ////////////////////////////////////////////////////////////////////////////
-    CPU_ZERO(&allcpuset);
-    for(i=0; i < NUM_CPU_CORES; i++)
-        CPU_SET(i, &allcpuset);
-    printf("Using CPUS=%d from total available.\n", CPU_COUNT(&allcpuset));
-
-
-    ////////////////////////////////////////////////////////////////////////////
-    // Init task semaphores
-    ////////////////////////////////////////////////////////////////////////////
-    if (sem_init (&semS1, 0, 0)) { printf ("Failed to initialize S1 semaphore\n"); exit (-1); }
-    if (sem_init (&semS2, 0, 0)) { printf ("Failed to initialize S2 semaphore\n"); exit (-1); }
-    if (sem_init (&semS3, 0, 0)) { printf ("Failed to initialize S3 semaphore\n"); exit (-1); }
-    if (sem_init (&semS4, 0, 0)) { printf ("Failed to initialize S4 semaphore\n"); exit (-1); }
-    if (sem_init (&semS5, 0, 0)) { printf ("Failed to initialize S5 semaphore\n"); exit (-1); }
-    if (sem_init (&semS6, 0, 0)) { printf ("Failed to initialize S6 semaphore\n"); exit (-1); }
-    if (sem_init (&semS7, 0, 0)) { printf ("Failed to initialize S7 semaphore\n"); exit (-1); }
+    if(seq_read_cpus(&cpus) != 0)
+        exit(-1);
+    printf("Using CPUS=%d from total available.\n", CPU_COUNT(&cpus.rt));
 
     ////////////////////////////////////////////////////////////////////////////
     // Set scheduler=SCHED_FIFO and max priority for main thread
@@ -194,6 +228,7 @@ void main(void)
     ////////////////////////////////////////////////////////////////////////////
     // Get pthread attribute scope
     ////////////////////////////////////////////////////////////////////////////
+    pthread_attr_init(&main_attr);
     pthread_attr_getscope(&main_attr, &scope);
 
     if(scope == PTHREAD_SCOPE_SYSTEM)
@@ -204,437 +239,128 @@ void main(void)
       printf("PTHREAD SCOPE UNKNOWN\n");
 
     ////////////////////////////////////////////////////////////////////////////
-    // Initialize thread parameters
-    //      * Set scheduling policy to SCHED_FIFO
-    //      * Set priority to (rt_max_prio - i)
-    //      * Set thread ID in threadParams array
-    //      * Set threads to run on CPU #3.
+    // Register services
+    //      * Sequencer = RT_MAX @ SEQ_RATE_HZ
+    //      * One service per serviceConfig row, SCHED_FIFO at its priority
+    //      * No affinity unless "-c": Linux load balances the threads over
+    //      * the cores
     ////////////////////////////////////////////////////////////////////////////
-    for(i=0; i < NUM_THREADS; i++)
+    if(seq_init(&seq, SEQ_RATE_HZ, SEQ_PERIODS) != 0)
+        exit(-1);
+
+    // By default each release is an absolute time from the sequencer's
+    // start, so wakeup overhead cannot accumulate.  "-r" runs the original
+    // relative nanosleep() loop instead, for comparison, with its delay for
+    // 333 usec slightly fudged as nanosleep() is not very accurate at
+    // smaller values.  "-t" reads a periodic timerfd instead, releasing any
+    // ticks it missed in one batch.
+    if(option == 'r')
     {
+        seq.backend = SEQ_RELATIVE;
+        seq.relative_delay_nsec = 288000;
+    }
+    else if(option == 't')
+        seq.backend = SEQ_TIMERFD;
 
-      CPU_ZERO(&threadcpu);
-      CPU_SET(3, &threadcpu);
-
-      rc=pthread_attr_init(&rt_sched_attr[i]);
-      rc=pthread_attr_setinheritsched(&rt_sched_attr[i], PTHREAD_EXPLICIT_SCHED);
-      rc=pthread_attr_setschedpolicy(&rt_sched_attr[i], SCHED_FIFO);
-      //rc=pthread_attr_setaffinity_np(&rt_sched_attr[i], sizeof(cpu_set_t), &threadcpu);
+    for(i=0; i < NUM_SERVICES; i++)
+    {
+        if(seq_add_service(&seq, serviceConfig[i].name, serviceConfig[i].divisor,
+                           (serviceConfig[i].prio == PRIO_RT_MIN) ? rt_min_prio : rt_max_prio-serviceConfig[i].prio,
+                           SEQ_NO_AFFINITY, log_release, NULL) < 0)
+            exit(-1);
+        if(seq_set_budget(&seq, (int)i, (unsigned long long)serviceConfig[i].runtime * 1000, 0) != 0)
+            exit(-1);
+    }
 
-      rt_param[i].sched_priority=rt_max_prio-i;
-      pthread_attr_setschedparam(&rt_sched_attr[i], &rt_param[i]);
+    // "-d" gives each service its runtime per period under SCHED_DEADLINE in
+    // place of its priority, so a service that overruns its budget is
+    // throttled rather than starving the ones below it
+    if(deadline)
+        seq.policy = SEQ_SCHED_DEADLINE;
 
-      threadParams[i].threadIdx=i;
+    if(placement != NULL)
+    {
+        if(seq_place(&seq, &cpus, placement) != 0)
+            exit(-1);
+        seq_print_placement(&seq, &cpus);
+    }
+    if(steerIrqs)
+        seq_steer_irqs(&cpus);
+
+    // A service that overruns has its late releases queued, up to SEQ_STAMPS
+    // of them, unless "-o" says otherwise: "skip" drops any release that
+    // finds the previous one unfinished, "stop" ends the run at the first
+    // overrun, and a number queues at most that many releases.
+    for(i=0; (overrunPolicy != NULL) && (i < NUM_SERVICES); i++)
+    {
+        if(strcmp(overrunPolicy, "skip") == 0)
+            rc = seq_set_overrun(&seq, (int)i, SEQ_OVERRUN_SKIP, 1, NULL);
+        else if(strcmp(overrunPolicy, "stop") == 0)
+            rc = seq_set_overrun(&seq, (int)i, SEQ_OVERRUN_CALLBACK, 1, stop_on_overrun);
+        else
+            rc = seq_set_overrun(&seq, (int)i, SEQ_OVERRUN_QUEUE, (unsigned int)atoi(overrunPolicy), NULL);
+
+        if(rc != 0)
+            exit(-1);
     }
-    printf("Service threads will run on %d CPU cores\n", CPU_COUNT(&threadcpu));
 
     ////////////////////////////////////////////////////////////////////////////
-    // Create service threads
+    // Event log instead of syslog() in the release path
+    //      * One ring per thread, so logging never takes a lock
+    //      * Drained at RT_MIN to syslog, or to the "-l" file for evlog_decode
     ////////////////////////////////////////////////////////////////////////////
+    if(evlog_init(&eventLog, NUM_SERVICES+1, EVLOG_RING_RECORDS, logPath) != 0)
+        exit(-1);
+    evlog_define(&eventLog, EV_RELEASE, "release %llu");
+    seq.log = &eventLog;
 
-    // Servcie_1 = RT_MAX-1	@ 300 Hz
-    //
-    rt_param[1].sched_priority=rt_max_prio-1;
-    pthread_attr_setschedparam(&rt_sched_attr[1], &rt_param[1]);
-    rc=pthread_create(&threads[1],               // pointer to thread descriptor
-                      &rt_sched_attr[1],         // use specific attributes
-                      //(void *)0,               // default attributes
-                      Service_1,                 // thread function entry point
-                      (void *)&(threadParams[1]) // parameters to pass in
-                     );
-    if(rc < 0)
-        perror("pthread_create for service 1");
-    else
-        printf("pthread_create successful for service 1\n");
-
-
-    // Service_2 = RT_MAX-2	@ 100 Hz
-    //
-    rt_param[2].sched_priority=rt_max_prio-2;
-    pthread_attr_setschedparam(&rt_sched_attr[2], &rt_param[2]);
-    rc=pthread_create(&threads[2], &rt_sched_attr[2], Service_2, (void *)&(threadParams[2]));
-    if(rc < 0)
-        perror("pthread_create for service 2");
-    else
-        printf("pthread_create successful for service 2\n");
-
-
-    // Service_3 = RT_MAX-3	@ 50 Hz
-    //
-    rt_param[3].sched_priority=rt_max_prio-3;
-    pthread_attr_setschedparam(&rt_sched_attr[3], &rt_param[3]);
-    rc=pthread_create(&threads[3], &rt_sched_attr[3], Service_3, (void *)&(threadParams[3]));
-    if(rc < 0)
-        perror("pthread_create for service 3");
-    else
-        printf("pthread_create successful for service 3\n");
-
-
-    // Service_4 = RT_MAX-2	@ 100 Hz
-    //
-    rt_param[4].sched_priority=rt_max_prio-2;
-    pthread_attr_setschedparam(&rt_sched_attr[4], &rt_param[4]);
-    rc=pthread_create(&threads[4], &rt_sched_attr[4], Service_4, (void *)&(threadParams[4]));
-    if(rc < 0)
-        perror("pthread_create for service 4");
-    else
-        printf("pthread_create successful for service 4\n");
-
-
-    // Service_5 = RT_MAX-3	@ 50 Hz
-    //
-    rt_param[5].sched_priority=rt_max_prio-3;
-    pthread_attr_setschedparam(&rt_sched_attr[5], &rt_param[5]);
-    rc=pthread_create(&threads[5], &rt_sched_attr[5], Service_5, (void *)&(threadParams[5]));
-    if(rc < 0)
-        perror("pthread_create for service 5");
-    else
-        printf("pthread_create successful for service 5\n");
-
-
-    // Service_6 = RT_MAX-2	@ 100 Hz
-    //
-    rt_param[6].sched_priority=rt_max_prio-2;
-    pthread_attr_setschedparam(&rt_sched_attr[6], &rt_param[6]);
-    rc=pthread_create(&threads[6], &rt_sched_attr[6], Service_6, (void *)&(threadParams[6]));
-    if(rc < 0)
-        perror("pthread_create for service 6");
-    else
-        printf("pthread_create successful for service 6\n");
-
-
-    // Service_7 = RT_MIN	10 Hz
-    //
-    rt_param[7].sched_priority=rt_min_prio;
-    pthread_attr_setschedparam(&rt_sched_attr[7], &rt_param[7]);
-    rc=pthread_create(&threads[7], &rt_sched_attr[7], Service_7, (void *)&(threadParams[7]));
-    if(rc < 0)
-        perror("pthread_create for service 7");
-    else
-        printf("pthread_create successful for service 7\n");
-
-
-    // Wait for service threads to initialize and await release by sequencer.
-    //
-    // Note that the sleep is not necessary of RT service threads are created wtih 
-    // correct POSIX SCHED_FIFO priorities compared to non-RT priority of this main
-    // program.
-    //
-    // usleep(1000000);
- 
     ////////////////////////////////////////////////////////////////////////////
-    // Create sequencer thread w/highest priority
+    // Start the service threads, then the sequencer thread w/highest priority
     ////////////////////////////////////////////////////////////////////////////
     printf("Start sequencer\n");
-    threadParams[0].sequencePeriods=900;
-
-    // Sequencer = RT_MAX	@ 3000 Hz
-    //
-    rt_param[0].sched_priority=rt_max_prio;
-    pthread_attr_setschedparam(&rt_sched_attr[0], &rt_param[0]);
-    rc=pthread_create(&threads[0], &rt_sched_attr[0], Sequencer, (void *)&(threadParams[0]));
-    if(rc < 0)
-        perror("pthread_create for sequencer service 0");
-    else
-        printf("pthread_create successful for sequeencer service 0\n");
+    if(seq_start(&seq) != 0)
+        exit(-1);
+
+    if(evlog_start(&eventLog, rt_min_prio) != 0)
+        exit(-1);
+    rt_faults(&steadyFaults);
 
     ////////////////////////////////////////////////////////////////////////////
     // Wait for threads to complete
     ////////////////////////////////////////////////////////////////////////////
-    for(i=0;i<NUM_THREADS;i++)
-        pthread_join(threads[i], NULL);
+    seq_join(&seq);
+    rt_print_faults("since start", &startFaults);
+    rt_print_faults("once running", &steadyFaults);
+    evlog_stop(&eventLog);
+    seq_print_stats(&seq);
+    if(wcetPath != NULL)
+        seq_write_wcet(&seq, wcetPath);
+    seq_destroy(&seq);
+    evlog_destroy(&eventLog);
 
     printf("\nTEST COMPLETE\n");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Sequencer definitions 
-//      * Initially print/log its start time.
-//      * DO/WHILE (!abortTest && (sequence count < total sequences)):
-//      *       DO/WHILE (there is still sleep time remaining):
-//      *           SLEEP FOR 33.33 msec (30 Hz)
-//      *           IF (pause interrupted by signal):
-//      *               save and print remaining time
-//      *               increment delay counter
-//      *           IF (pause return < 0):
-//      *               error. terminate thread.
-//      *       Increment sequence count
-//      *       Log current time
-//      *       IF (looping delay > 0), Log
-//      *       IF (sequence count a ratio of task period): release the sem.
+// Service release callback, run by each service thread once per release
+//      * LOG RELEASE (the event log adds the thread and time)
 ////////////////////////////////////////////////////////////////////////////////
-void *Sequencer(void *threadp)
+void log_release(seq_service_t *service, unsigned long long release)
 {
-    struct timeval current_time_val;
-    struct timespec delay_time = {0, 288000}; // delay for 333 usec, or 3000 Hz. The actual value is slightly fudged to get the proper delay, as nanosleep() is not very accurate at smaller values.
-    struct timespec remaining_time;
-    double current_time;
-    double residual;
-    int rc, delay_cnt=0;
-    unsigned long long seqCnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Sequencer thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Sequencer thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    do
-    {
-        delay_cnt=0; residual=0.0;
-
-        //gettimeofday(&current_time_val, (struct timezone *)0);
-        //syslog(LOG_CRIT, "Sequencer thread prior to delay @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-        do
-        {
-            rc=nanosleep(&delay_time, &remaining_time);
-
-            if(rc == EINTR)
-            { 
-                residual = remaining_time.tv_sec + ((double)remaining_time.tv_nsec / (double)NANOSEC_PER_SEC);
-
-                if(residual > 0.0) printf("residual=%lf, sec=%d, nsec=%d\n", residual, (int)remaining_time.tv_sec, (int)remaining_time.tv_nsec);
- 
-                delay_cnt++;
-            }
-            else if(rc < 0)
-            {
-                perror("Sequencer nanosleep");
-                exit(-1);
-            }
-           
-        } while((residual > 0.0) && (delay_cnt < 100));
-
-        seqCnt++;
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Sequencer cycle %llu @ sec=%d, usec=%d\n", seqCnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-
-        if(delay_cnt > 1) printf("Sequencer looping delay %d\n", delay_cnt);
-
-
-        // Release each service at a sub-rate of the generic sequencer rate
-
-        // Servcie_1 = RT_MAX-1	@ 300 Hz
-        if((seqCnt % 10) == 0) sem_post(&semS1);
-
-        // Service_2 = RT_MAX-2	@ 100 Hz
-        if((seqCnt % 30) == 0) sem_post(&semS2);
-
-        // Service_3 = RT_MAX-3	@ 50 Hz
-        if((seqCnt % 60) == 0) sem_post(&semS3);
-
-        // Service_4 = RT_MAX-2	@ 100 Hz
-        if((seqCnt % 30) == 0) sem_post(&semS4);
-
-        // Service_5 = RT_MAX-3	@ 50 Hz
-        if((seqCnt % 60) == 0) sem_post(&semS5);
-
-        // Service_6 = RT_MAX-2	@ 100 Hz
-        if((seqCnt % 30) == 0) sem_post(&semS6);
-
-        // Service_7 = RT_MIN	10 Hz
-        if((seqCnt % 300) == 0) sem_post(&semS7);
-
-        //gettimeofday(&current_time_val, (struct timezone *)0);
-        //syslog(LOG_CRIT, "Sequencer release all sub-services @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    } while(!abortTest && (seqCnt < threadParams->sequencePeriods));
-
-    sem_post(&semS1); sem_post(&semS2); sem_post(&semS3);
-    sem_post(&semS4); sem_post(&semS5); sem_post(&semS6);
-    sem_post(&semS7);
-    abortS1=TRUE; abortS2=TRUE; abortS3=TRUE;
-    abortS4=TRUE; abortS5=TRUE; abortS6=TRUE;
-    abortS7=TRUE;
-
-    pthread_exit((void *)0);
+    evlog_write(service->ring, EV_RELEASE, release, 0, 0, 0);
 }
 
-
 ////////////////////////////////////////////////////////////////////////////////
-// Task definitions 
-// All threads will:
-//      * Initially print/log their start time.
-//      * WHILE !abortS#
-//      *       SEM_WAIT(semS#)
-//      *       S#Cnt++
-//      *       GET TIME
-//      *       LOG RELEASE TIME
+// Overrun callback for "-o stop", run by the sequencer thread
+//      * STOP the sequencer and skip the release; the sequencer's event log
+//      * already has the overrun, with the releases pending
 ////////////////////////////////////////////////////////////////////////////////
-void *Service_1(void *threadp)
+int stop_on_overrun(seq_service_t *service, unsigned long long pending)
 {
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S1Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
+    (void)pending;
 
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Frame Sampler thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Frame Sampler thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS1)
-    {
-        sem_wait(&semS1);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S1Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Frame Sampler release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S1Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
-}
-
-
-void *Service_2(void *threadp)
-{
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S2Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Time-stamp with Image Analysis thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Time-stamp with Image Analysis thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS2)
-    {
-        sem_wait(&semS2);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S2Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Time-stamp with Image Analysis release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S2Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_3(void *threadp)
-{
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S3Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Difference Image Proc thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Difference Image Proc thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS3)
-    {
-        sem_wait(&semS3);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S3Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Difference Image Proc release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S3Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_4(void *threadp)
-{
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S4Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Time-stamp Image Save to File thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Time-stamp Image Save to File thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS4)
-    {
-        sem_wait(&semS4);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S4Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Time-stamp Image Save to File release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S4Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_5(void *threadp)
-{
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S5Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Processed Image Save to File thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Processed Image Save to File thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS5)
-    {
-        sem_wait(&semS5);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S5Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Processed Image Save to File release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S5Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_6(void *threadp)
-{
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S6Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "Send Time-stamped Image to Remote thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("Send Time-stamped Image to Remote thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS6)
-    {
-        sem_wait(&semS6);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S6Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "Send Time-stamped Image to Remote release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S6Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
-}
-
-void *Service_7(void *threadp)
-{
-    struct timeval current_time_val, load_start_time, load_end_time;
-    double current_time;
-    unsigned long long S7Cnt=0;
-    threadParams_t *threadParams = (threadParams_t *)threadp;
-
-    gettimeofday(&current_time_val, (struct timezone *)0);
-    syslog(LOG_CRIT, "10 sec Tick Debug thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-    printf("10 sec Tick Debug thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec);
-
-    while(!abortS7)
-    {
-        sem_wait(&semS7);
-        gettimeofday(&load_start_time, (struct timezone *)0);
-        S7Cnt++;
-        gettimeofday(&load_end_time, (struct timezone *)0);
-
-        gettimeofday(&current_time_val, (struct timezone *)0);
-        syslog(LOG_CRIT, "10 Sec Tick Debug release %llu @ sec=%d, usec=%d, duration %d sec, %d usec\n", S7Cnt, (int)(current_time_val.tv_sec-start_time_val.tv_sec), (int)current_time_val.tv_usec, load_end_time.tv_sec - load_start_time.tv_sec, load_end_time.tv_usec - load_start_time.tv_usec);
-    }
-
-    pthread_exit((void *)0);
+    seq_stop(service->seq);
+    return FALSE;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -672,4 +398,3 @@ void print_scheduler(void)
            printf("Pthread Policy is UNKNOWN\n"); exit(-1);
    }
 }
-
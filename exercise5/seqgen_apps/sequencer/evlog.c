@@ -0,0 +1,307 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// In-memory event logger, see evlog.h.
+//
+// Only the drain thread formats, calls syslog() or touches the file, so the
+// threads that log pay for a clock read and a 48 byte copy.  The drain takes
+// each ring's records in order but does not merge rings by time; sort the
+// text by its timestamps when the interleaving matters.
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <syslog.h>
+
+#include "evlog.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define TRUE (1)
+#define FALSE (0)
+
+static uint64_t evlog_epoch_nsec(evlog_t *log)
+{
+    return (uint64_t)log->epoch.tv_sec * NANOSEC_PER_SEC + (uint64_t)log->epoch.tv_nsec;
+}
+
+int evlog_init(evlog_t *log, unsigned int max_rings, unsigned long ring_records, const char *path)
+{
+    uint64_t epoch;
+
+    memset(log, 0, sizeof(*log));
+
+    // a full ring is head - tail == size, so the size is a power of 2 and
+    // the index masks rather than divides
+    log->ring_records = 2;
+    while(log->ring_records < ring_records)
+        log->ring_records *= 2;
+
+    log->max_rings = max_rings;
+    log->rings = aligned_alloc(64, ((max_rings > 0) ? max_rings : 1) * sizeof(evlog_ring_t));
+    if(log->rings == NULL)
+    {
+        perror("evlog_init");
+        return -1;
+    }
+    memset(log->rings, 0, ((max_rings > 0) ? max_rings : 1) * sizeof(evlog_ring_t));
+
+    clock_gettime(CLOCK_MONOTONIC, &log->epoch);
+
+    if(path != NULL)
+    {
+        log->file = fopen(path, "wb");
+        if(log->file == NULL)
+        {
+            perror(path);
+            free(log->rings);
+            log->rings = NULL;
+            return -1;
+        }
+
+        epoch = evlog_epoch_nsec(log);
+        fwrite(EVLOG_MAGIC, 1, sizeof(EVLOG_MAGIC), log->file);
+        fwrite(&epoch, sizeof(epoch), 1, log->file);
+    }
+
+    return 0;
+}
+
+int evlog_define(evlog_t *log, unsigned int id, const char *format)
+{
+    if(log->started || (id >= EVLOG_MAX_EVENTS))
+    {
+        printf("Cannot define event %u\n", id);
+        return -1;
+    }
+
+    log->formats[id] = format;
+    return 0;
+}
+
+evlog_ring_t *evlog_open(evlog_t *log, const char *name)
+{
+    unsigned int index = atomic_load_explicit(&log->num_rings, memory_order_relaxed);
+    evlog_ring_t *ring;
+
+    if(index >= log->max_rings)
+    {
+        printf("No event log ring left for %s\n", name);
+        return NULL;
+    }
+
+    ring = &log->rings[index];
+    ring->records = malloc(log->ring_records * sizeof(evlog_record_t));
+    if(ring->records == NULL)
+    {
+        perror("evlog_open");
+        return NULL;
+    }
+
+    // touch every slot now, so no page faults happen while logging
+    memset(ring->records, 0, log->ring_records * sizeof(evlog_record_t));
+
+    ring->name = name;
+    ring->mask = log->ring_records - 1;
+    ring->index = (uint16_t)index;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+
+    // publishes the ring to the drain
+    atomic_store_explicit(&log->num_rings, index + 1, memory_order_release);
+
+    return ring;
+}
+
+void evlog_format(char *line, size_t size, const char *thread, const char *format,
+                  uint64_t epoch_nsec, const evlog_record_t *record)
+{
+    uint64_t elapsed = (record->timestamp_nsec > epoch_nsec) ? record->timestamp_nsec - epoch_nsec : 0;
+    int len;
+
+    len = snprintf(line, size, "%s ", (thread != NULL) ? thread : "?");
+    if((len < 0) || ((size_t)len >= size))
+        return;
+
+    if(format != NULL)
+        len += snprintf(line + len, size - len, format,
+                        (unsigned long long)record->args[0], (unsigned long long)record->args[1],
+                        (unsigned long long)record->args[2], (unsigned long long)record->args[3]);
+    else
+        len += snprintf(line + len, size - len, "event %u", (unsigned int)record->event);
+    if((len < 0) || ((size_t)len >= size))
+        return;
+
+    snprintf(line + len, size - len, " @ sec=%d, usec=%d",
+             (int)(elapsed / NANOSEC_PER_SEC), (int)((elapsed % NANOSEC_PER_SEC) / 1000));
+}
+
+static void evlog_write_string(FILE *file, uint32_t tag, uint32_t key, const char *string)
+{
+    uint32_t length = (uint32_t)strlen(string);
+
+    fwrite(&tag, sizeof(tag), 1, file);
+    fwrite(&key, sizeof(key), 1, file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(string, 1, length, file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Drain pass
+//      * Name any rings opened since the last pass (file only).
+//      * FOR each ring:
+//      *       read head (acquire), copy out and emit every record up to it
+//      *       store tail (release) so the producer can reuse the slots
+////////////////////////////////////////////////////////////////////////////////
+static void evlog_drain_once(evlog_t *log)
+{
+    unsigned int num_rings = atomic_load_explicit(&log->num_rings, memory_order_acquire);
+    uint32_t tag = EVLOG_TAG_RECORD;
+    evlog_ring_t *ring;
+    evlog_record_t record;
+    unsigned long head, tail;
+    unsigned int i;
+    char line[256];
+
+    if(log->file != NULL)
+        for(; log->rings_named < num_rings; log->rings_named++)
+            evlog_write_string(log->file, EVLOG_TAG_THREAD, log->rings_named, log->rings[log->rings_named].name);
+
+    for(i = 0; i < num_rings; i++)
+    {
+        ring = &log->rings[i];
+        head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        for(tail = atomic_load_explicit(&ring->tail, memory_order_relaxed); tail != head; tail++)
+        {
+            record = ring->records[tail & ring->mask];
+
+            if(log->file != NULL)
+            {
+                fwrite(&tag, sizeof(tag), 1, log->file);
+                fwrite(&record, sizeof(record), 1, log->file);
+            }
+            else
+            {
+                evlog_format(line, sizeof(line), ring->name,
+                             (record.event < EVLOG_MAX_EVENTS) ? log->formats[record.event] : NULL,
+                             evlog_epoch_nsec(log), &record);
+                syslog(LOG_CRIT, "%s\n", line);
+            }
+        }
+
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+}
+
+static void *evlog_drain(void *threadp)
+{
+    evlog_t *log = (evlog_t *)threadp;
+
+    // sleeps even after a busy pass, since at SCHED_FIFO a drain that kept
+    // up with a fast sequencer would never give the CPU to SCHED_OTHER work
+    while(!atomic_load(&log->stop))
+    {
+        evlog_drain_once(log);
+        usleep(EVLOG_DRAIN_USEC);
+    }
+
+    // whatever was logged before stop was set
+    evlog_drain_once(log);
+
+    pthread_exit((void *)0);
+}
+
+int evlog_start(evlog_t *log, int priority)
+{
+    pthread_attr_t attr;
+    struct sched_param param;
+    unsigned int id;
+    int rc;
+
+    if(log->started)
+        return -1;
+
+    if(log->file != NULL)
+        for(id = 0; id < EVLOG_MAX_EVENTS; id++)
+            if(log->formats[id] != NULL)
+                evlog_write_string(log->file, EVLOG_TAG_EVENT, id, log->formats[id]);
+
+    // explicit even for SCHED_OTHER, as the creating thread is often SCHED_FIFO
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, (priority > 0) ? SCHED_FIFO : SCHED_OTHER);
+    param.sched_priority = (priority > 0) ? priority : 0;
+    pthread_attr_setschedparam(&attr, &param);
+
+    atomic_store(&log->stop, FALSE);
+    rc = pthread_create(&log->drain, &attr, evlog_drain, (void *)log);
+    pthread_attr_destroy(&attr);
+
+    if(rc != 0)
+    {
+        errno = rc;
+        perror("Event log drain");
+        return -1;
+    }
+
+    log->started = TRUE;
+    return 0;
+}
+
+void evlog_stop(evlog_t *log)
+{
+    unsigned int i, num_rings;
+    uint32_t tag = EVLOG_TAG_DROPPED, ring;
+    uint64_t dropped;
+
+    if(log->started)
+    {
+        atomic_store(&log->stop, TRUE);
+        pthread_join(log->drain, NULL);
+        log->started = FALSE;
+    }
+
+    num_rings = atomic_load(&log->num_rings);
+    for(i = 0; i < num_rings; i++)
+    {
+        dropped = atomic_load(&log->rings[i].dropped);
+        if(dropped == 0)
+            continue;
+
+        printf("Event log: %s dropped %llu records\n", log->rings[i].name, (unsigned long long)dropped);
+        if(log->file != NULL)
+        {
+            ring = i;
+            fwrite(&tag, sizeof(tag), 1, log->file);
+            fwrite(&ring, sizeof(ring), 1, log->file);
+            fwrite(&dropped, sizeof(dropped), 1, log->file);
+        }
+    }
+
+    if(log->file != NULL)
+        fflush(log->file);
+}
+
+void evlog_destroy(evlog_t *log)
+{
+    unsigned int i;
+
+    if(log->started)
+        evlog_stop(log);
+
+    if(log->rings != NULL)
+        for(i = 0; i < atomic_load(&log->num_rings); i++)
+            free(log->rings[i].records);
+
+    if(log->file != NULL)
+        fclose(log->file);
+
+    free(log->rings);
+    memset(log, 0, sizeof(*log));
+}
@@ -0,0 +1,151 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// In-memory event logger for real-time threads.  Each logging thread opens
+// its own ring, so every ring has one producer and one consumer and needs
+// no locks: evlog_write() takes a CLOCK_MONOTONIC timestamp, copies four
+// integer arguments into the next slot and publishes it with one release
+// store.  It never blocks or waits; when the ring is full the record is
+// dropped and counted instead.
+//
+// A drain thread, at a priority below the real-time work, empties the rings
+// every EVLOG_DRAIN_USEC and either formats each record to syslog or writes
+// it in binary to a file, which evlog_decode turns back into the same text.
+// A record prints as
+//
+//      <thread name> <event format applied to the args> @ sec=S, usec=U
+//
+// with the time from evlog_init().  Event formats may only use long long
+// conversions (%llu, %lld, %llx), one per argument, at most EVLOG_ARGS.
+//
+// Binary file: EVLOG_MAGIC, the epoch as a uint64_t in nsec, then tagged
+// entries, each a uint32_t tag followed by
+//
+//      EVLOG_TAG_EVENT     uint32_t id, uint32_t length, format (no NUL)
+//      EVLOG_TAG_THREAD    uint32_t ring, uint32_t length, name (no NUL)
+//      EVLOG_TAG_RECORD    evlog_record_t
+//      EVLOG_TAG_DROPPED   uint32_t ring, uint64_t records dropped
+//
+// in host byte order, so decode on the same kind of machine.
+
+#ifndef EVLOG_H
+#define EVLOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#define EVLOG_ARGS (4)
+#define EVLOG_MAX_EVENTS (256)
+#define EVLOG_DRAIN_USEC (10000)
+
+#define EVLOG_MAGIC "EVLOG01"          // with its NUL, 8 bytes
+#define EVLOG_TAG_EVENT (1)
+#define EVLOG_TAG_THREAD (2)
+#define EVLOG_TAG_RECORD (3)
+#define EVLOG_TAG_DROPPED (4)
+
+typedef struct
+{
+    uint64_t timestamp_nsec;           // CLOCK_MONOTONIC
+    uint16_t event;
+    uint16_t thread;                   // ring index
+    uint32_t reserved;
+    uint64_t args[EVLOG_ARGS];
+} evlog_record_t;
+
+// Producer and consumer indices count records forever and are masked into
+// the ring, each on its own cache line so the two threads do not share one.
+typedef struct
+{
+    _Alignas(64) atomic_ulong head;    // next record to write, producer only
+    atomic_ulong dropped;
+    _Alignas(64) atomic_ulong tail;    // next record to drain, consumer only
+    _Alignas(64) const char *name;
+    unsigned long mask;
+    uint16_t index;
+    evlog_record_t *records;
+} evlog_ring_t;
+
+typedef struct
+{
+    evlog_ring_t *rings;
+    unsigned int max_rings;
+    atomic_uint num_rings;
+    unsigned long ring_records;
+
+    const char *formats[EVLOG_MAX_EVENTS];
+    struct timespec epoch;
+
+    FILE *file;                        // NULL drains to syslog
+    unsigned int rings_named;          // thread entries already in the file
+    atomic_int stop;
+    int started;
+    pthread_t drain;
+} evlog_t;
+
+// Sets up a log with room for max_rings threads, each ring holding
+// ring_records (rounded up to a power of 2).  path is the binary file to
+// write, or NULL for syslog.  Returns 0, or -1 after printing why.
+int evlog_init(evlog_t *log, unsigned int max_rings, unsigned long ring_records, const char *path);
+
+// Names event id with its format; only before evlog_start().
+int evlog_define(evlog_t *log, unsigned int id, const char *format);
+
+// Gives the calling thread its own ring, or NULL if there is no room.  The
+// name must stay valid until evlog_destroy().  May be called after
+// evlog_start(), but only from one thread at a time.
+evlog_ring_t *evlog_open(evlog_t *log, const char *name);
+
+// Starts the drain thread at the given SCHED_FIFO priority, or SCHED_OTHER
+// if priority is 0.  Returns 0, or -1 after printing why.
+int evlog_start(evlog_t *log, int priority);
+
+// Drains what is left, stops the drain thread and prints any drops.  Once
+// the logging threads are done; evlog_destroy() calls it if still running.
+void evlog_stop(evlog_t *log);
+
+void evlog_destroy(evlog_t *log);
+
+// Records an event, or counts it dropped if the ring is full.  A NULL ring
+// logs nothing, so callers need not check whether logging is on.
+static inline void evlog_write(evlog_ring_t *ring, unsigned int event,
+                               uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3)
+{
+    evlog_record_t *record;
+    struct timespec now;
+    unsigned long head;
+
+    if(ring == NULL)
+        return;
+
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if(head - atomic_load_explicit(&ring->tail, memory_order_acquire) > ring->mask)
+    {
+        atomic_store_explicit(&ring->dropped, atomic_load_explicit(&ring->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    record = &ring->records[head & ring->mask];
+    record->timestamp_nsec = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+    record->event = (uint16_t)event;
+    record->thread = ring->index;
+    record->args[0] = a0;
+    record->args[1] = a1;
+    record->args[2] = a2;
+    record->args[3] = a3;
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// Formats one record as text into line, for the drain and evlog_decode.
+void evlog_format(char *line, size_t size, const char *thread, const char *format,
+                  uint64_t epoch_nsec, const evlog_record_t *record);
+
+#endif
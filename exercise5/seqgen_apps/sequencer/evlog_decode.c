@@ -0,0 +1,138 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Prints a binary event log (see evlog.h) as the text the drain thread
+// would have sent to syslog, one record per line, in the order drained.
+//
+// Usage: evlog_decode <log file>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "evlog.h"
+
+#define MAX_THREADS (65536)
+
+// Reads a length prefixed string into a new buffer, or NULL at end of file.
+static char *read_string(FILE *file)
+{
+    uint32_t length;
+    char *string;
+
+    if(fread(&length, sizeof(length), 1, file) != 1)
+        return NULL;
+
+    string = malloc((size_t)length + 1);
+    if((string == NULL) || (fread(string, 1, length, file) != length))
+    {
+        free(string);
+        return NULL;
+    }
+    string[length] = '\0';
+
+    return string;
+}
+
+int main(int argc, char *argv[])
+{
+    static char *formats[EVLOG_MAX_EVENTS];
+    static char *threads[MAX_THREADS];
+    char magic[sizeof(EVLOG_MAGIC)];
+    char line[256];
+    evlog_record_t record;
+    uint64_t epoch, dropped, records = 0;
+    uint32_t tag, key;
+    FILE *file;
+    int rc = 0, complete = 1;
+
+    if(argc != 2)
+    {
+        printf("Usage: %s <log file>\n", argv[0]);
+        return -1;
+    }
+
+    file = fopen(argv[1], "rb");
+    if(file == NULL)
+    {
+        perror(argv[1]);
+        return -1;
+    }
+
+    if((fread(magic, 1, sizeof(magic), file) != sizeof(magic)) || (memcmp(magic, EVLOG_MAGIC, sizeof(magic)) != 0) ||
+       (fread(&epoch, sizeof(epoch), 1, file) != 1))
+    {
+        printf("ERROR: %s is not an event log\n", argv[1]);
+        fclose(file);
+        return -1;
+    }
+
+    // each entry is read whole before the next tag, so a file cut short
+    // stops inside one
+    while(fread(&tag, sizeof(tag), 1, file) == 1)
+    {
+        complete = 0;
+
+        if(tag == EVLOG_TAG_RECORD)
+        {
+            if(fread(&record, sizeof(record), 1, file) != 1)
+                break;
+
+            evlog_format(line, sizeof(line), threads[record.thread],
+                         (record.event < EVLOG_MAX_EVENTS) ? formats[record.event] : NULL, epoch, &record);
+            printf("%s\n", line);
+            records++;
+            complete = 1;
+        }
+        else if((tag == EVLOG_TAG_EVENT) || (tag == EVLOG_TAG_THREAD))
+        {
+            if(fread(&key, sizeof(key), 1, file) != 1)
+                break;
+
+            if((tag == EVLOG_TAG_EVENT) && (key < EVLOG_MAX_EVENTS))
+            {
+                free(formats[key]);
+                if((formats[key] = read_string(file)) == NULL)
+                    break;
+            }
+            else if((tag == EVLOG_TAG_THREAD) && (key < MAX_THREADS))
+            {
+                free(threads[key]);
+                if((threads[key] = read_string(file)) == NULL)
+                    break;
+            }
+            else
+            {
+                printf("ERROR: bad %s id %u\n", (tag == EVLOG_TAG_EVENT) ? "event" : "thread", key);
+                rc = -1;
+                break;
+            }
+            complete = 1;
+        }
+        else if(tag == EVLOG_TAG_DROPPED)
+        {
+            if((fread(&key, sizeof(key), 1, file) != 1) || (fread(&dropped, sizeof(dropped), 1, file) != 1))
+                break;
+
+            printf("%s dropped %llu records\n", (key < MAX_THREADS) && threads[key] ? threads[key] : "?",
+                   (unsigned long long)dropped);
+            complete = 1;
+        }
+        else
+        {
+            printf("ERROR: bad tag %u after %llu records\n", tag, (unsigned long long)records);
+            rc = -1;
+            break;
+        }
+    }
+
+    if((rc == 0) && !complete)
+    {
+        printf("ERROR: truncated entry after %llu records\n", (unsigned long long)records);
+        rc = -1;
+    }
+
+    fclose(file);
+    return rc;
+}
@@ -0,0 +1,106 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Real-time process startup, see rtinit.h.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <alloca.h>
+#include <limits.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include "rtinit.h"
+
+// Left untouched at the top of a thread stack: the frames already in use,
+// and in a pthread stack the thread's own descriptor and TLS.
+#define RT_STACK_MARGIN (32 * 1024)
+
+static size_t rtStackBytes;
+
+static void rt_touch(volatile unsigned char *memory, size_t bytes)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), i;
+
+    for(i = 0; i < bytes; i += page)
+        memory[i] = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Real-time startup
+//      * malloc: never trim the heap, never mmap, one arena for all threads,
+//      * so memory once touched stays with the process
+//      * MLOCKALL current and future pages
+//      * Touch heap_bytes of heap, then free it back to the arena
+//      * Touch the stack
+////////////////////////////////////////////////////////////////////////////////
+int rt_init(size_t stack_bytes, size_t heap_bytes)
+{
+    unsigned char *heap;
+    int rc = 0;
+
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_ARENA_MAX, 1);
+
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        perror("******** WARNING: mlockall");
+        rc = -1;
+    }
+
+    heap = malloc(heap_bytes);
+    if(heap == NULL)
+    {
+        perror("******** WARNING: rt_init heap");
+        rc = -1;
+    }
+    else
+    {
+        rt_touch(heap, heap_bytes);
+        free(heap);
+    }
+
+    rtStackBytes = stack_bytes;
+    rt_prefault_stack();
+
+    printf("RT init: memory %slocked, %zu KB heap reserved, %zu KB stacks\n",
+           (rc == 0) ? "" : "NOT ", heap_bytes / 1024, stack_bytes / 1024);
+
+    return rc;
+}
+
+void rt_stack_attr(pthread_attr_t *attr)
+{
+    if(rtStackBytes >= (size_t)PTHREAD_STACK_MIN)
+        pthread_attr_setstacksize(attr, rtStackBytes);
+}
+
+void rt_prefault_stack(void)
+{
+    if(rtStackBytes > RT_STACK_MARGIN)
+        rt_touch(alloca(rtStackBytes - RT_STACK_MARGIN), rtStackBytes - RT_STACK_MARGIN);
+}
+
+void rt_faults(rt_faults_t *faults)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    faults->minor = usage.ru_minflt;
+    faults->major = usage.ru_majflt;
+}
+
+void rt_print_faults(const char *label, const rt_faults_t *since)
+{
+    rt_faults_t now;
+
+    rt_faults(&now);
+    printf("Page faults %s: %ld minor, %ld major\n", label, now.minor - since->minor, now.major - since->major);
+}
@@ -0,0 +1,63 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Real-time process startup: keeps page faults out of the periodic work by
+// taking them all before it starts.
+//
+// rt_init() locks every current and future page in memory (mlockall), so
+// nothing is paged out or lazily mapped later; stops malloc from giving
+// memory back to the kernel or using mmap for large blocks, and keeps it to
+// one arena; then touches a reserved heap and the main thread's stack so
+// their pages are in place before use.  Each real-time thread is created
+// with rt_stack_attr(), which sizes its stack (mlockall would otherwise
+// lock the 8 MB default for every thread), and calls rt_prefault_stack()
+// before its loop.
+//
+// rt_faults() snapshots the process's page fault counts, and
+// rt_print_faults() prints how many happened since, so a run can show it
+// took none once started.
+//
+// Usage:
+//      rt_faults_t steady;
+//      rt_init(RT_DEFAULT_STACK_BYTES, RT_DEFAULT_HEAP_BYTES);
+//      ... create threads with rt_stack_attr(&attr) ...
+//      rt_faults(&steady);
+//      ... run ...
+//      rt_print_faults("in steady state", &steady);
+
+#ifndef RTINIT_H
+#define RTINIT_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+#define RT_DEFAULT_STACK_BYTES (256 * 1024)
+#define RT_DEFAULT_HEAP_BYTES (8 * 1024 * 1024)
+
+typedef struct
+{
+    long minor;                        // page reclaimed or zero filled, no I/O
+    long major;                        // page read in
+} rt_faults_t;
+
+// Locks memory, disables malloc trimming and mmap, reserves and touches
+// heap_bytes of heap and stack_bytes of the calling thread's stack, and
+// sets the stack size rt_stack_attr() gives threads.  Returns 0, or -1
+// after printing why if memory cannot be locked (needs root, or a big
+// enough RLIMIT_MEMLOCK), in which case the rest is still done.
+int rt_init(size_t stack_bytes, size_t heap_bytes);
+
+// Sets attr's stack size to the one given to rt_init(), if it was called.
+void rt_stack_attr(pthread_attr_t *attr);
+
+// Touches the calling thread's stack, up to the size given to rt_init().
+void rt_prefault_stack(void);
+
+void rt_faults(rt_faults_t *faults);
+
+// Prints "Page faults <label>: <minor> minor, <major> major" counted since
+// the snapshot.
+void rt_print_faults(const char *label, const rt_faults_t *since);
+
+#endif
@@ -0,0 +1,445 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Sequencer benchmarks.  Each service burns a fixed amount of its own CPU
+// time per release.  Needs root.
+//
+// Usage: seqbench <benchmark> [seconds per case]
+//
+//    policy    - SCHED_FIFO against SCHED_DEADLINE on a frame acquisition,
+//                image processing and image save set at a 1 kHz sequencer.
+//                In the runaway cases image processing needs twice its
+//                period every release, and the question is which services
+//                still keep up:
+//
+//                SCHED_FIFO with RM priorities protects acquisition, which
+//                is above processing, but starves the image save below it.
+//                With processing given the higher priority it starves
+//                acquisition too.  Under SCHED_DEADLINE processing is
+//                throttled to its runtime and the other two keep their
+//                budgets whatever the priorities.  Needs 0.6 CPUs of
+//                admissible SCHED_DEADLINE bandwidth.
+//
+//    placement - the 3 kHz Q3 seqgen set with and without "auto" placement
+//                (seqplace.h), while a SCHED_OTHER thread per online CPU
+//                streams through memory to pollute the caches.  Pinned,
+//                the sequencer keeps a CPU (and its cache) to itself when
+//                there are two or more, and no thread migrates.
+//
+//    wakeup    - the same set with no work, placed "auto", released through
+//                semaphores, futex release events, and futex release
+//                events with every service that has a CPU to itself
+//                spinning SEQ_SPIN_NSEC before it blocks.  Prints the
+//                sequencer's overhead per wakeup (its share of the release
+//                cost), the futex wake calls made, and the distribution of
+//                the release to callback start latency over all services.
+//
+// Per case it prints the sequencer's release error (which SCHED_DEADLINE
+// services can delay, as they run ahead of the SCHED_FIFO sequencer) and
+// per service the releases run out of those due, deadline misses and
+// release latency or response times.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "sequencer.h"
+#include "seqplace.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define TRUE (1)
+#define FALSE (0)
+
+#define BENCH_RATE_HZ (1000)
+#define NUM_SERVICES (3)
+#define PROCESSING (1)                 // the service that runs away
+
+#define PLACE_RATE_HZ (3000)
+#define PLACE_SERVICES (7)
+#define LOAD_BYTES (32 << 20)          // streamed by each load thread
+
+typedef struct
+{
+    const char *name;
+    unsigned int divisor;
+    int prio;                          // RT_MAX-prio under SCHED_FIFO
+    unsigned long long work_usec;      // CPU time per release
+    unsigned long long runtime_usec;   // SCHED_DEADLINE budget per period
+} bench_service_t;
+
+static const bench_service_t benchServices[NUM_SERVICES] =
+{
+    {"Frame Acquisition",  10, 1,  1000,  2000},     // 100 Hz
+    {"Image Processing",   30, 2,  6000, 10000},     // 33 Hz
+    {"Image Save",        100, 3,  5000, 10000}      // 10 Hz
+};
+
+typedef struct
+{
+    const char *name;
+    seq_policy_t policy;
+    int runaway;                       // processing needs two periods per release
+    int inverted;                      // processing above acquisition
+} bench_case_t;
+
+static const bench_case_t benchCases[] =
+{
+    {"SCHED_FIFO, RM priorities",                       SEQ_SCHED_FIFO,     FALSE, FALSE},
+    {"SCHED_DEADLINE",                                  SEQ_SCHED_DEADLINE, FALSE, FALSE},
+    {"SCHED_FIFO, runaway processing",                  SEQ_SCHED_FIFO,     TRUE,  FALSE},
+    {"SCHED_FIFO, runaway processing above acquisition", SEQ_SCHED_FIFO,     TRUE,  TRUE},
+    {"SCHED_DEADLINE, runaway processing",              SEQ_SCHED_DEADLINE, TRUE,  FALSE}
+};
+
+#define NUM_CASES (sizeof(benchCases) / sizeof(benchCases[0]))
+
+typedef struct
+{
+    const char *name;
+    unsigned int divisor;
+    int prio;
+    unsigned long long work_usec;
+} place_service_t;
+
+// The Q3 seqgen set, with some work per release
+static const place_service_t placeServices[PLACE_SERVICES] =
+{
+    {"Frame Sampler",                        10, 1, 100},
+    {"Time-stamp with Image Analysis",       30, 2, 200},
+    {"Difference Image Proc",                60, 3, 400},
+    {"Time-stamp Image Save to File",        30, 2, 200},
+    {"Processed Image Save to File",         60, 3, 200},
+    {"Send Time-stamped Image to Remote",    30, 2, 100},
+    {"10 sec Tick Debug",                   300, 4,  50}
+};
+
+typedef struct
+{
+    const char *name;
+    seq_wakeup_t wakeup;
+    int spin;                          // services with a CPU to themselves spin
+} wakeup_case_t;
+
+static const wakeup_case_t wakeupCases[] =
+{
+    {"Semaphores",                            SEQ_WAKE_SEMAPHORE, FALSE},
+    {"Futex release events",                  SEQ_WAKE_FUTEX,     FALSE},
+    {"Futex release events, spin then block", SEQ_WAKE_FUTEX,     TRUE}
+};
+
+#define NUM_WAKEUP_CASES (sizeof(wakeupCases) / sizeof(wakeupCases[0]))
+
+static unsigned long long workNsec[PLACE_SERVICES];
+static volatile int loadStop;
+
+static unsigned long long thread_cpu_nsec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (unsigned long long)now.tv_sec * NANOSEC_PER_SEC + (unsigned long long)now.tv_nsec;
+}
+
+// Burns the service's work in its own CPU time, so preemption and
+// throttling stretch the release rather than shorten the work.  Every
+// release does the same work, the number is only there for seq_callback_t.
+static void burn(seq_service_t *service, unsigned long long release)
+{
+    unsigned long long end = thread_cpu_nsec() + workNsec[(unsigned long)service->arg];
+
+    (void)release;
+    while(thread_cpu_nsec() < end);
+}
+
+static int run_policy_case(const bench_case_t *bench, unsigned int seconds)
+{
+    int rt_max_prio = sched_get_priority_max(SCHED_FIFO);
+    seq_service_stats_t *stats;
+    seq_overload_t overload;
+    sequencer_t seq;
+    unsigned int i;
+    int prio;
+
+    if(seq_init(&seq, BENCH_RATE_HZ, (unsigned long long)seconds * BENCH_RATE_HZ) != 0)
+        return -1;
+    seq.policy = bench->policy;
+
+    for(i = 0; i < NUM_SERVICES; i++)
+    {
+        workNsec[i] = benchServices[i].work_usec * 1000;
+        if(bench->runaway && (i == PROCESSING))
+            workNsec[i] = 2 * (benchServices[i].divisor * NANOSEC_PER_SEC / BENCH_RATE_HZ);
+
+        prio = benchServices[i].prio;
+        if(bench->inverted && (i == PROCESSING))
+            prio = 0;
+
+        if((seq_add_service(&seq, benchServices[i].name, benchServices[i].divisor, rt_max_prio-1-prio,
+                            SEQ_NO_AFFINITY, burn, (void *)(unsigned long)i) < 0) ||
+           (seq_set_budget(&seq, (int)i, benchServices[i].runtime_usec * 1000, 0) != 0))
+        {
+            seq_destroy(&seq);
+            return -1;
+        }
+    }
+
+    printf("\n%s\n", bench->name);
+    fflush(stdout);
+
+    if(seq_start(&seq) != 0)
+    {
+        seq_destroy(&seq);
+        return -1;
+    }
+    seq_join(&seq);
+
+    printf("   release error usec: avg=%.3lf max=%.3lf, %llu overruns\n",
+           (double)seq.jitter.sum_nsec / (double)seq.jitter.releases / 1000.0,
+           (double)seq.jitter.max_nsec / 1000.0, seq.jitter.overruns);
+    for(i = 0; i < NUM_SERVICES; i++)
+    {
+        stats = seq.services[i].stats;
+        seq_read_overload(&seq, (int)i, &overload);
+        printf("   %-18s %4llu of %4llu releases, %4llu misses, response msec: p99<=%.3lf max=%.3lf\n",
+               seq.services[i].name, seq.services[i].releases,
+               (unsigned long long)seconds * BENCH_RATE_HZ / seq.services[i].divisor, overload.misses,
+               (double)seq_stat_percentile(&stats->response, 0.99) / 1000000.0,
+               (double)stats->response.max_nsec / 1000000.0);
+    }
+
+    seq_destroy(&seq);
+    return 0;
+}
+
+// Streams through a buffer much larger than the caches until told to stop.
+static void *load_thread(void *threadp)
+{
+    unsigned char *buffer = (unsigned char *)threadp;
+    unsigned long i;
+
+    while(!loadStop)
+        for(i = 0; i < LOAD_BYTES; i += 64)
+            buffer[i]++;
+
+    return NULL;
+}
+
+static int run_placement_case(const seq_cpus_t *cpus, int placed, unsigned int seconds)
+{
+    int rt_max_prio = sched_get_priority_max(SCHED_FIFO);
+    pthread_t load[CPU_SETSIZE];
+    unsigned char *buffers;
+    unsigned long long p99, worst_p99 = 0, worst_max = 0;
+    unsigned int i, loads = (unsigned int)CPU_COUNT(&cpus->online);
+    sequencer_t seq;
+    int rc = -1;
+
+    if(seq_init(&seq, PLACE_RATE_HZ, (unsigned long long)seconds * PLACE_RATE_HZ) != 0)
+        return -1;
+
+    for(i = 0; i < PLACE_SERVICES; i++)
+    {
+        workNsec[i] = placeServices[i].work_usec * 1000;
+        if((seq_add_service(&seq, placeServices[i].name, placeServices[i].divisor, rt_max_prio-placeServices[i].prio,
+                            SEQ_NO_AFFINITY, burn, (void *)(unsigned long)i) < 0) ||
+           (seq_set_budget(&seq, (int)i, placeServices[i].work_usec * 1000, 0) != 0))
+        {
+            seq_destroy(&seq);
+            return -1;
+        }
+    }
+
+    printf("\n%s\n", placed ? "Automatic placement" : "No placement");
+    if(placed && ((seq_place(&seq, cpus, "auto") != 0)))
+    {
+        seq_destroy(&seq);
+        return -1;
+    }
+    if(placed)
+        seq_print_placement(&seq, cpus);
+    fflush(stdout);
+
+    buffers = malloc((size_t)loads * LOAD_BYTES);
+    if(buffers == NULL)
+    {
+        perror("seqbench");
+        seq_destroy(&seq);
+        return -1;
+    }
+    memset(buffers, 0, (size_t)loads * LOAD_BYTES);
+
+    loadStop = FALSE;
+    for(i = 0; i < loads; i++)
+        if(pthread_create(&load[i], NULL, load_thread, (void *)(buffers + (size_t)i * LOAD_BYTES)) != 0)
+            break;
+    loads = i;
+
+    if(seq_start(&seq) == 0)
+    {
+        seq_join(&seq);
+        rc = 0;
+    }
+
+    loadStop = TRUE;
+    for(i = 0; i < loads; i++)
+        pthread_join(load[i], NULL);
+    free(buffers);
+
+    if(rc == 0)
+    {
+        for(i = 0; i < PLACE_SERVICES; i++)
+        {
+            p99 = seq_stat_percentile(&seq.stats[i].latency, 0.99);
+            if(p99 > worst_p99) worst_p99 = p99;
+            if(seq.stats[i].latency.max_nsec > worst_max) worst_max = seq.stats[i].latency.max_nsec;
+        }
+
+        printf("   %u load threads, release error usec: avg=%.3lf max=%.3lf, %llu overruns\n", loads,
+               (double)seq.jitter.sum_nsec / (double)seq.jitter.releases / 1000.0,
+               (double)seq.jitter.max_nsec / 1000.0, seq.jitter.overruns);
+        printf("   worst service latency usec: p99<=%.3lf max=%.3lf\n",
+               (double)worst_p99 / 1000.0, (double)worst_max / 1000.0);
+    }
+
+    seq_destroy(&seq);
+    return rc;
+}
+
+static void print_latency(const char *label, const seq_stat_t *stat)
+{
+    printf("   %-22s latency usec: avg=%.3lf p50<=%.3lf p90<=%.3lf p99<=%.3lf p99.9<=%.3lf max=%.3lf\n", label,
+           stat->mean_nsec / 1000.0, (double)seq_stat_percentile(stat, 0.5) / 1000.0,
+           (double)seq_stat_percentile(stat, 0.9) / 1000.0, (double)seq_stat_percentile(stat, 0.99) / 1000.0,
+           (double)seq_stat_percentile(stat, 0.999) / 1000.0, (double)stat->max_nsec / 1000.0);
+}
+
+static int run_wakeup_case(const wakeup_case_t *bench, const seq_cpus_t *cpus, unsigned int seconds)
+{
+    int rt_max_prio = sched_get_priority_max(SCHED_FIFO);
+    unsigned int threads[CPU_SETSIZE];
+    unsigned long long posted = 0, wakes = 0;
+    unsigned int i, spinning = 0;
+    seq_stat_t all;
+    sequencer_t seq;
+    int cpu;
+
+    if(seq_init(&seq, PLACE_RATE_HZ, (unsigned long long)seconds * PLACE_RATE_HZ) != 0)
+        return -1;
+    seq.wakeup = bench->wakeup;
+
+    for(i = 0; i < PLACE_SERVICES; i++)
+    {
+        workNsec[i] = 0;
+        if(seq_add_service(&seq, placeServices[i].name, placeServices[i].divisor, rt_max_prio-placeServices[i].prio,
+                           SEQ_NO_AFFINITY, burn, (void *)(unsigned long)i) < 0)
+        {
+            seq_destroy(&seq);
+            return -1;
+        }
+    }
+
+    if(seq_place(&seq, cpus, "auto") != 0)
+    {
+        seq_destroy(&seq);
+        return -1;
+    }
+
+    // the same placement every case, spinning where a service is alone
+    memset(threads, 0, sizeof(threads));
+    threads[seq.affinity]++;
+    for(i = 0; i < PLACE_SERVICES; i++)
+        threads[seq.services[i].affinity]++;
+    for(i = 0; i < PLACE_SERVICES; i++)
+    {
+        cpu = seq.services[i].affinity;
+        seq_set_spin(&seq, (int)i, (bench->spin && (threads[cpu] == 1)) ? SEQ_SPIN_NSEC : 0);
+        if(seq.services[i].spin_nsec > 0)
+            spinning++;
+    }
+
+    printf("\n%s\n", bench->name);
+    fflush(stdout);
+
+    if(seq_start(&seq) != 0)
+    {
+        seq_destroy(&seq);
+        return -1;
+    }
+    seq_join(&seq);
+
+    memset(&all, 0, sizeof(all));
+    for(i = 0; i < PLACE_SERVICES; i++)
+    {
+        seq_stat_merge(&all, &seq.stats[i].latency);
+        posted += atomic_load(&seq.services[i].due);
+        wakes += seq.services[i].event.wakes;
+    }
+
+    printf("   sequencer overhead usec: avg=%.3lf max=%.3lf, release error usec: max=%.3lf\n",
+           (double)seq.counters.overhead_sum_nsec / (double)seq.counters.wakeups / 1000.0,
+           (double)seq.counters.overhead_max_nsec / 1000.0, (double)seq.jitter.max_nsec / 1000.0);
+    if(bench->wakeup == SEQ_WAKE_FUTEX)
+        printf("   %llu releases, %llu futex wake calls, %u of %u services spinning\n",
+               posted, wakes, spinning, PLACE_SERVICES);
+    else
+        printf("   %llu releases\n", posted);
+    print_latency("all services", &all);
+    print_latency(seq.services[0].name, &seq.stats[0].latency);
+
+    seq_destroy(&seq);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int seconds = (argc > 2) ? (unsigned int)atoi(argv[2]) : 3;
+    seq_cpus_t cpus;
+    unsigned int i;
+    int rc = 0;
+
+    if((argc < 2) || (seconds == 0))
+    {
+        printf("Usage: %s <policy|placement|wakeup> [seconds per case]\n", argv[0]);
+        return -1;
+    }
+
+    if(strcmp(argv[1], "policy") == 0)
+    {
+        printf("%u Hz sequencer, %u sec per case\n", BENCH_RATE_HZ, seconds);
+        for(i = 0; i < NUM_CASES; i++)
+            if(run_policy_case(&benchCases[i], seconds) != 0)
+                rc = -1;
+    }
+    else if(strcmp(argv[1], "placement") == 0)
+    {
+        if(seq_read_cpus(&cpus) != 0)
+            return -1;
+
+        printf("%u Hz sequencer, %u sec per case\n", PLACE_RATE_HZ, seconds);
+        if((run_placement_case(&cpus, FALSE, seconds) != 0) || (run_placement_case(&cpus, TRUE, seconds) != 0))
+            rc = -1;
+    }
+    else if(strcmp(argv[1], "wakeup") == 0)
+    {
+        if(seq_read_cpus(&cpus) != 0)
+            return -1;
+
+        printf("%u Hz sequencer, %u sec per case\n", PLACE_RATE_HZ, seconds);
+        for(i = 0; i < NUM_WAKEUP_CASES; i++)
+            if(run_wakeup_case(&wakeupCases[i], &cpus, seconds) != 0)
+                rc = -1;
+    }
+    else
+    {
+        printf("Unknown benchmark %s\n", argv[1]);
+        rc = -1;
+    }
+
+    return rc;
+}
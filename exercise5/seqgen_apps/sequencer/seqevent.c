@@ -0,0 +1,131 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Release events, see seqevent.h.
+//
+// The poster adds to the count and then reads the flag; the waiter raises
+// the flag and then has the kernel compare the count, all sequentially
+// consistent.  Whichever order they run in, either the poster sees the
+// flag and wakes the waiter, or the futex compare sees the new count and
+// FUTEX_WAIT returns at once, so no post is ever missed.  A wake the
+// waiter no longer needs, from a flag seen just before it was lowered,
+// costs one system call and nothing else.
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "seqevent.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define TRUE (1)
+#define FALSE (0)
+
+// Polls between clock reads while spinning
+#define SEQ_EVENT_POLLS (64)
+
+// Tells the core this is a spin loop: frees pipeline resources for a
+// hyperthread sibling, and saves power.
+#if defined(__x86_64__) || defined(__i386__)
+#define SEQ_EVENT_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define SEQ_EVENT_PAUSE() __asm__ __volatile__("yield")
+#else
+#define SEQ_EVENT_PAUSE() do {} while(0)
+#endif
+
+static unsigned long long seq_event_nsec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (unsigned long long)now.tv_sec * NANOSEC_PER_SEC + (unsigned long long)now.tv_nsec;
+}
+
+static int seq_event_ready(seq_event_t *event)
+{
+    return atomic_load_explicit(&event->count, memory_order_acquire) != event->taken;
+}
+
+void seq_event_init(seq_event_t *event, unsigned long long spin_nsec)
+{
+    atomic_init(&event->count, 0);
+    atomic_init(&event->waiting, FALSE);
+    event->taken = 0;
+    event->spin_nsec = spin_nsec;
+    event->wakes = 0;
+}
+
+static void seq_event_wake(seq_event_t *event)
+{
+    if(atomic_load_explicit(&event->waiting, memory_order_seq_cst))
+    {
+        syscall(SYS_futex, (uint32_t *)&event->count, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        event->wakes++;
+    }
+}
+
+void seq_event_post(seq_event_t *event)
+{
+    atomic_fetch_add_explicit(&event->count, 1, memory_order_seq_cst);
+    seq_event_wake(event);
+}
+
+void seq_event_post_set(seq_event_t **events, unsigned int count)
+{
+    unsigned int i;
+
+    for(i = 0; i < count; i++)
+        atomic_fetch_add_explicit(&events[i]->count, 1, memory_order_seq_cst);
+
+    for(i = 0; i < count; i++)
+        seq_event_wake(events[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Wait
+//      * IF spin_nsec and no post: poll the count, reading the clock every
+//      * SEQ_EVENT_POLLS polls, until a post or spin_nsec has passed
+//      * WHILE no post:
+//      *       Raise the waiting flag
+//      *       FUTEX_WAIT while the count is still the one taken
+//      * Lower the flag and take the post
+////////////////////////////////////////////////////////////////////////////////
+void seq_event_wait(seq_event_t *event)
+{
+    unsigned long long spin_end;
+    unsigned int i;
+
+    if((event->spin_nsec > 0) && !seq_event_ready(event))
+    {
+        spin_end = seq_event_nsec() + event->spin_nsec;
+        do
+        {
+            for(i = 0; (i < SEQ_EVENT_POLLS) && !seq_event_ready(event); i++)
+                SEQ_EVENT_PAUSE();
+        } while(!seq_event_ready(event) && (seq_event_nsec() < spin_end));
+    }
+
+    while(!seq_event_ready(event))
+    {
+        atomic_store_explicit(&event->waiting, TRUE, memory_order_seq_cst);
+        syscall(SYS_futex, (uint32_t *)&event->count, FUTEX_WAIT_PRIVATE, event->taken, NULL, NULL, 0);
+    }
+
+    atomic_store_explicit(&event->waiting, FALSE, memory_order_relaxed);
+    event->taken++;
+}
+
+int seq_event_try_wait(seq_event_t *event)
+{
+    if(!seq_event_ready(event))
+        return FALSE;
+
+    event->taken++;
+    return TRUE;
+}
@@ -0,0 +1,60 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Release events: a counting semaphore for one poster and one waiter, built
+// on a futex.  The futex word is the count of posts so far, and the waiter
+// keeps the count it has taken, so a wait returns as soon as the two differ
+// without entering the kernel.  The waiter raises a flag before it blocks,
+// and the poster only makes the FUTEX_WAKE system call when it sees the
+// flag, so a post to a service that is still running, or spinning, is one
+// atomic add.  sem_post() and sem_wait() make the same checks, but through
+// a shared library call each and with no way to spin first or to post a
+// set of events before waking any of them.
+//
+// seq_event_post_set() publishes every event of a set before it wakes the
+// first waiter, so a service spinning on another CPU sees its release
+// without waiting for the system calls that wake the others.  A waiter
+// given a spin time polls the count that long before it blocks: worth it
+// only on a CPU the waiter has to itself, an isolated one, as it keeps
+// everything at a lower priority there off the CPU while it spins.
+//
+// Usage:
+//      seq_event_t event;
+//      seq_event_init(&event, 0);
+//      poster: seq_event_post(&event);
+//      waiter: seq_event_wait(&event);
+
+#ifndef SEQEVENT_H
+#define SEQEVENT_H
+
+#include <stdatomic.h>
+
+typedef struct
+{
+    atomic_uint count;                 // posts so far, the futex word
+    atomic_uint waiting;               // nonzero while the waiter may be blocked
+    unsigned int taken;                // posts the waiter has returned for
+    unsigned long long spin_nsec;      // polled before blocking, 0 blocks at once
+    unsigned long long wakes;          // FUTEX_WAKE calls, by the poster
+} seq_event_t;
+
+// Sets up an event with no posts.  spin_nsec is how long a wait polls
+// before it blocks.
+void seq_event_init(seq_event_t *event, unsigned long long spin_nsec);
+
+// Posts once, waking the waiter if it is blocked.
+void seq_event_post(seq_event_t *event);
+
+// Posts once to each of count events, then wakes those whose waiter is
+// blocked.  An event may appear more than once.
+void seq_event_post_set(seq_event_t **events, unsigned int count);
+
+// Returns once there is a post not yet taken, and takes it.
+void seq_event_wait(seq_event_t *event);
+
+// Takes a post if there is one not yet taken, without waiting.  Returns
+// TRUE if it took one.
+int seq_event_try_wait(seq_event_t *event);
+
+#endif
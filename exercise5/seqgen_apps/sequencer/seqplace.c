@@ -0,0 +1,403 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// CPU placement for the sequencer, see seqplace.h.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+
+#include "seqplace.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define TRUE (1)
+#define FALSE (0)
+
+int seq_parse_cpulist(const char *list, cpu_set_t *set)
+{
+    const char *next = list;
+    char *end;
+    long first, last, cpu;
+
+    CPU_ZERO(set);
+
+    while(isspace((unsigned char)*next))
+        next++;
+
+    while(*next != '\0')
+    {
+        first = strtol(next, &end, 10);
+        if((end == next) || (first < 0))
+            return -1;
+
+        last = first;
+        if(*end == '-')
+        {
+            next = end + 1;
+            last = strtol(next, &end, 10);
+            if((end == next) || (last < first))
+                return -1;
+        }
+
+        if(last >= CPU_SETSIZE)
+            return -1;
+        for(cpu = first; cpu <= last; cpu++)
+            CPU_SET(cpu, set);
+
+        next = end;
+        if(*next == ',')
+            next++;
+        else if((*next != '\0') && !isspace((unsigned char)*next))
+            return -1;
+
+        while(isspace((unsigned char)*next))
+            next++;
+    }
+
+    return 0;
+}
+
+void seq_format_cpulist(const cpu_set_t *set, char *text, size_t size)
+{
+    size_t len = 0;
+    int cpu, last;
+
+    text[0] = '\0';
+    for(cpu = 0; (cpu < CPU_SETSIZE) && (len < size); cpu++)
+    {
+        if(!CPU_ISSET(cpu, set))
+            continue;
+
+        for(last = cpu; (last + 1 < CPU_SETSIZE) && CPU_ISSET(last + 1, set); last++);
+
+        if(last == cpu)
+            len += snprintf(text + len, size - len, "%s%d", (len > 0) ? "," : "", cpu);
+        else
+            len += snprintf(text + len, size - len, "%s%d-%d", (len > 0) ? "," : "", cpu, last);
+        cpu = last;
+    }
+
+    if(len == 0)
+        snprintf(text, size, "none");
+}
+
+// Reads one sysfs CPU list; a file that is missing reads as empty.
+static int seq_read_cpulist(const char *path, cpu_set_t *set, int required)
+{
+    char list[1024];
+    FILE *file;
+
+    CPU_ZERO(set);
+
+    file = fopen(path, "r");
+    if(file == NULL)
+    {
+        if(required)
+            perror(path);
+        return required ? -1 : 0;
+    }
+
+    if(fgets(list, sizeof(list), file) == NULL)
+        list[0] = '\0';
+    fclose(file);
+
+    if(seq_parse_cpulist(list, set) != 0)
+    {
+        printf("Cannot parse %s: %s\n", path, list);
+        return -1;
+    }
+
+    return 0;
+}
+
+int seq_read_cpus(seq_cpus_t *cpus)
+{
+    int cpu;
+
+    if((seq_read_cpulist(SEQ_SYSFS_CPU "/online", &cpus->online, TRUE) != 0) ||
+       (seq_read_cpulist(SEQ_SYSFS_CPU "/isolated", &cpus->isolated, FALSE) != 0))
+        return -1;
+
+    if(CPU_COUNT(&cpus->online) == 0)
+    {
+        printf("No CPU online in " SEQ_SYSFS_CPU "/online\n");
+        return -1;
+    }
+
+    // an isolated CPU that is offline is no use to anyone
+    CPU_AND(&cpus->isolated, &cpus->isolated, &cpus->online);
+
+    if(CPU_COUNT(&cpus->isolated) > 0)
+        cpus->rt = cpus->isolated;
+    else
+        cpus->rt = cpus->online;
+
+    CPU_ZERO(&cpus->housekeeping);
+    for(cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if(CPU_ISSET(cpu, &cpus->online) && !CPU_ISSET(cpu, &cpus->rt))
+            CPU_SET(cpu, &cpus->housekeeping);
+
+    return 0;
+}
+
+// Estimated utilization of a service, for balancing: its runtime per
+// period, or its rate in releases per tick when it has no runtime.
+static double seq_service_load(sequencer_t *seq, seq_service_t *service)
+{
+    if(service->runtime_nsec == 0)
+        return 1.0 / (double)service->divisor;
+
+    return (double)service->runtime_nsec * (double)seq->rate_hz / ((double)service->divisor * NANOSEC_PER_SEC);
+}
+
+// Parses one core map entry: a CPU number, or "-" (or nothing) for none.
+static int seq_map_entry(const char **next, const seq_cpus_t *cpus, int *cpu)
+{
+    const char *entry = *next;
+    char *end;
+    long value;
+
+    if((*entry == '-') || (*entry == ',') || (*entry == '\0'))
+    {
+        *cpu = SEQ_NO_AFFINITY;
+        end = (char *)entry + ((*entry == '-') ? 1 : 0);
+    }
+    else
+    {
+        value = strtol(entry, &end, 10);
+        if((end == entry) || (value < 0) || (value >= CPU_SETSIZE) || !CPU_ISSET(value, &cpus->online))
+        {
+            printf("Core map entry \"%.*s\" is not an online CPU\n", (int)strcspn(entry, ","), entry);
+            return -1;
+        }
+        *cpu = (int)value;
+    }
+
+    if((*end != ',') && (*end != '\0'))
+    {
+        printf("Core map entry \"%.*s\" is not a CPU or -\n", (int)strcspn(entry, ","), entry);
+        return -1;
+    }
+
+    *next = (*end == ',') ? end + 1 : end;
+    return 0;
+}
+
+static int seq_place_map(sequencer_t *seq, const seq_cpus_t *cpus, const char *map)
+{
+    const char *next = map;
+    unsigned int i;
+
+    if(seq_map_entry(&next, cpus, &seq->affinity) != 0)
+        return -1;
+
+    for(i = 0; i < seq->num_services; i++)
+        if(seq_map_entry(&next, cpus, &seq->services[i].affinity) != 0)
+            return -1;
+
+    if(*next != '\0')
+    {
+        printf("Core map has more entries than the sequencer and its %u services\n", seq->num_services);
+        return -1;
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Automatic placement
+//      * cores = real-time CPUs; the sequencer takes the first
+//      * IF more than one: remove the sequencer's CPU from the cores
+//      * Order the services by decreasing load (stable)
+//      * FOR each service: pin it to the core with the least load so far
+//      *       (lowest CPU on a tie) and add its load there
+////////////////////////////////////////////////////////////////////////////////
+static int seq_place_auto(sequencer_t *seq, const seq_cpus_t *cpus)
+{
+    double load[CPU_SETSIZE];
+    unsigned int *order;
+    unsigned int i, j, k;
+    cpu_set_t cores = cpus->rt;
+    int cpu, best;
+
+    for(cpu = 0; !CPU_ISSET(cpu, &cores); cpu++);
+    seq->affinity = cpu;
+    if(CPU_COUNT(&cores) > 1)
+        CPU_CLR(cpu, &cores);
+
+    if(seq->policy == SEQ_SCHED_DEADLINE)
+    {
+        for(i = 0; i < seq->num_services; i++)
+            seq->services[i].affinity = SEQ_NO_AFFINITY;
+        return 0;
+    }
+
+    order = malloc(((seq->num_services > 0) ? seq->num_services : 1) * sizeof(unsigned int));
+    if(order == NULL)
+    {
+        perror("seq_place");
+        return -1;
+    }
+
+    for(i = 0; i < seq->num_services; i++)
+    {
+        for(j = i; (j > 0) && (seq_service_load(seq, &seq->services[order[j-1]]) <
+                               seq_service_load(seq, &seq->services[i])); j--)
+            order[j] = order[j-1];
+        order[j] = i;
+    }
+
+    memset(load, 0, sizeof(load));
+    for(k = 0; k < seq->num_services; k++)
+    {
+        i = order[k];
+        best = -1;
+        for(cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            if(CPU_ISSET(cpu, &cores) && ((best < 0) || (load[cpu] < load[best])))
+                best = cpu;
+
+        seq->services[i].affinity = best;
+        load[best] += seq_service_load(seq, &seq->services[i]);
+    }
+
+    free(order);
+    return 0;
+}
+
+// A service with an isolated CPU to itself spins for its releases, as
+// nothing else there wants the CPU in the meantime.
+static void seq_place_spin(sequencer_t *seq, const seq_cpus_t *cpus)
+{
+    unsigned int threads[CPU_SETSIZE];
+    unsigned int i;
+    int cpu;
+
+    memset(threads, 0, sizeof(threads));
+    if(seq->affinity != SEQ_NO_AFFINITY)
+        threads[seq->affinity]++;
+    for(i = 0; i < seq->num_services; i++)
+        if(seq->services[i].affinity != SEQ_NO_AFFINITY)
+            threads[seq->services[i].affinity]++;
+
+    for(i = 0; i < seq->num_services; i++)
+    {
+        cpu = seq->services[i].affinity;
+        if((cpu != SEQ_NO_AFFINITY) && (threads[cpu] == 1) && CPU_ISSET(cpu, &cpus->isolated) &&
+           (seq->services[i].spin_nsec == 0))
+            seq->services[i].spin_nsec = SEQ_SPIN_NSEC;
+    }
+}
+
+int seq_place(sequencer_t *seq, const seq_cpus_t *cpus, const char *placement)
+{
+    int rc;
+
+    if(seq->started)
+    {
+        printf("Cannot place a running sequencer\n");
+        return -1;
+    }
+
+    if((placement == NULL) || (strcmp(placement, "auto") == 0))
+        rc = seq_place_auto(seq, cpus);
+    else
+        rc = seq_place_map(seq, cpus, placement);
+
+    if(rc == 0)
+        seq_place_spin(seq, cpus);
+    return rc;
+}
+
+static void seq_print_cpu(const char *name, int cpu, unsigned long long spin_nsec, const seq_cpus_t *cpus)
+{
+    if(cpu == SEQ_NO_AFFINITY)
+        printf("   %-36s CPU any\n", name);
+    else if(spin_nsec > 0)
+        printf("   %-36s CPU %d%s, spins %llu usec\n", name, cpu, CPU_ISSET(cpu, &cpus->isolated) ? " (isolated)" : "",
+               spin_nsec / 1000);
+    else
+        printf("   %-36s CPU %d%s\n", name, cpu, CPU_ISSET(cpu, &cpus->isolated) ? " (isolated)" : "");
+}
+
+void seq_print_placement(sequencer_t *seq, const seq_cpus_t *cpus)
+{
+    double load[CPU_SETSIZE];
+    char list[256];
+    unsigned int i;
+    int cpu;
+
+    seq_format_cpulist(&cpus->online, list, sizeof(list));
+    printf("CPUs online %s", list);
+    seq_format_cpulist(&cpus->isolated, list, sizeof(list));
+    printf(", isolated %s", list);
+    seq_format_cpulist(&cpus->housekeeping, list, sizeof(list));
+    printf(", housekeeping %s\n", list);
+
+    memset(load, 0, sizeof(load));
+    seq_print_cpu("Sequencer", seq->affinity, 0, cpus);
+    for(i = 0; i < seq->num_services; i++)
+    {
+        seq_print_cpu(seq->services[i].name, seq->services[i].affinity, seq->services[i].spin_nsec, cpus);
+        if(seq->services[i].affinity != SEQ_NO_AFFINITY)
+            load[seq->services[i].affinity] += seq_service_load(seq, &seq->services[i]);
+    }
+
+    for(cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if(load[cpu] > 0.0)
+            printf("   CPU %d estimated service utilization %.3lf%s\n", cpu, load[cpu],
+                   (load[cpu] > 1.0) ? ", OVERLOADED" : "");
+}
+
+int seq_steer_irqs(const seq_cpus_t *cpus)
+{
+    char list[256], path[320];
+    struct dirent *entry;
+    int moved = 0, failed = 0;
+    FILE *file;
+    DIR *dir;
+
+    if(CPU_COUNT(&cpus->housekeeping) == 0)
+    {
+        printf("No housekeeping CPU to move interrupts to\n");
+        return -1;
+    }
+    seq_format_cpulist(&cpus->housekeeping, list, sizeof(list));
+
+    dir = opendir("/proc/irq");
+    if(dir == NULL)
+    {
+        perror("/proc/irq");
+        return -1;
+    }
+
+    // per-CPU interrupts such as the local timer refuse the write
+    while((entry = readdir(dir)) != NULL)
+    {
+        if(!isdigit((unsigned char)entry->d_name[0]))
+            continue;
+
+        snprintf(path, sizeof(path), "/proc/irq/%s/smp_affinity_list", entry->d_name);
+        file = fopen(path, "w");
+        if(file == NULL)
+        {
+            failed++;
+            continue;
+        }
+
+        // the kernel only refuses the write when the buffer is flushed
+        fprintf(file, "%s\n", list);
+        if(fclose(file) == 0)
+            moved++;
+        else
+            failed++;
+    }
+    closedir(dir);
+
+    printf("Moved %d interrupts to CPUs %s, %d could not be moved\n", moved, list, failed);
+    return moved;
+}
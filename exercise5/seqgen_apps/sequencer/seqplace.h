@@ -0,0 +1,80 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// CPU placement for the sequencer and its services.  The CPUs come from
+// sysfs: the online ones, and the ones the kernel was booted to isolate
+// (isolcpus=), which the scheduler keeps ordinary threads off.  Real-time
+// threads go on the isolated CPUs when there are any, else on any online
+// CPU, and the rest are left for housekeeping: other processes, and the
+// interrupts seq_steer_irqs() can move there.
+//
+// A placement is either a core map, "<sequencer CPU>,<service 0 CPU>,...",
+// where "-" leaves a thread unpinned and missing entries leave the rest
+// unpinned, or "auto":
+//
+//      * The sequencer gets the first real-time CPU, to itself if there is
+//      * more than one.
+//      * The services go on the other real-time CPUs in order of decreasing
+//      * utilization (runtime / period, by rate when no runtime is set),
+//      * each on the least loaded CPU so far (worst fit).
+//
+// Either way, a service left alone on an isolated CPU is set to spin for
+// SEQ_SPIN_NSEC before blocking on each release (seq_set_spin()), unless
+// it already has a spin time.
+//
+// SCHED_DEADLINE services cannot be pinned, so "auto" places only the
+// sequencer under that policy.  seq_start() verifies every pinned thread's
+// affinity once it is running.
+//
+// Usage:
+//      seq_cpus_t cpus;
+//      seq_read_cpus(&cpus);
+//      ... seq_add_service() ...
+//      seq_place(&seq, &cpus, "auto");
+//      seq_start(&seq);
+
+#ifndef SEQPLACE_H
+#define SEQPLACE_H
+
+#include <sched.h>
+
+#include "sequencer.h"
+
+#define SEQ_SYSFS_CPU "/sys/devices/system/cpu"
+
+typedef struct
+{
+    cpu_set_t online;
+    cpu_set_t isolated;
+    cpu_set_t rt;                      // isolated if any, else online
+    cpu_set_t housekeeping;            // online and not rt
+} seq_cpus_t;
+
+// Reads the online and isolated CPUs.  Returns 0, or -1 after printing why
+// if no CPU is online or sysfs cannot be read.
+int seq_read_cpus(seq_cpus_t *cpus);
+
+// Parses a sysfs CPU list ("0-3,6") into set, which it clears first.  An
+// empty list is an empty set.  Returns 0, or -1 if the list is malformed.
+int seq_parse_cpulist(const char *list, cpu_set_t *set);
+
+// Formats set as a CPU list into text, "none" if it is empty.
+void seq_format_cpulist(const cpu_set_t *set, char *text, size_t size);
+
+// Sets the affinity of the sequencer and its services from the core map or
+// "auto", before seq_start().  Returns 0, or -1 after printing why if the
+// map is malformed or names a CPU that is not online.
+int seq_place(sequencer_t *seq, const seq_cpus_t *cpus, const char *placement);
+
+// Prints each thread's CPU, marking isolated ones, and each CPU's load.
+void seq_print_placement(sequencer_t *seq, const seq_cpus_t *cpus);
+
+// Moves every interrupt the kernel allows onto the housekeeping CPUs, by
+// writing /proc/irq/<n>/smp_affinity_list; their threaded handlers follow.
+// This changes the whole machine until reboot or irqbalance moves them
+// back.  Returns the number of interrupts moved, or -1 after printing why
+// if there is no housekeeping CPU or /proc/irq cannot be read.
+int seq_steer_irqs(const seq_cpus_t *cpus);
+
+#endif
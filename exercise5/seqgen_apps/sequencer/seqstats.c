@@ -0,0 +1,117 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Streaming timing statistics, see seqstats.h.
+//
+// Bucket index of a value v with highest set bit e:
+//
+//    v < SUB      v
+//    otherwise    (e - SUB_BITS + 1) SUB + (v >> (e - SUB_BITS)) - SUB
+//
+// which runs on without gaps from the linear range: 15 -> 15, 16 -> 16,
+// 31 -> 31, 32 -> 32 (width 2), 64 -> 48 (width 4) and so on.
+
+#include <stdio.h>
+#include <math.h>
+
+#include "seqstats.h"
+
+static unsigned int seq_hist_index(unsigned long long nsec)
+{
+    unsigned int e;
+
+    if(nsec < SEQ_HIST_SUB)
+        return (unsigned int)nsec;
+
+    e = 63 - (unsigned int)__builtin_clzll(nsec);
+    if(e >= SEQ_HIST_MAX_BITS)
+        return SEQ_HIST_BUCKETS - 1;
+
+    return (e - SEQ_HIST_SUB_BITS + 1) * SEQ_HIST_SUB + (unsigned int)(nsec >> (e - SEQ_HIST_SUB_BITS)) - SEQ_HIST_SUB;
+}
+
+// Largest value that falls in bucket index.
+static unsigned long long seq_hist_upper(unsigned int index)
+{
+    unsigned int e, sub;
+
+    if(index < SEQ_HIST_SUB)
+        return index;
+
+    e = index / SEQ_HIST_SUB + SEQ_HIST_SUB_BITS - 1;
+    sub = index % SEQ_HIST_SUB;
+
+    return ((unsigned long long)(SEQ_HIST_SUB + sub + 1) << (e - SEQ_HIST_SUB_BITS)) - 1;
+}
+
+void seq_stat_record(seq_stat_t *stat, unsigned long long nsec)
+{
+    double delta;
+
+    if((stat->count == 0) || (nsec < stat->min_nsec)) stat->min_nsec = nsec;
+    if((stat->count == 0) || (nsec > stat->max_nsec)) stat->max_nsec = nsec;
+
+    stat->count++;
+    delta = (double)nsec - stat->mean_nsec;
+    stat->mean_nsec += delta / (double)stat->count;
+    stat->m2 += delta * ((double)nsec - stat->mean_nsec);
+
+    stat->bins[seq_hist_index(nsec)]++;
+}
+
+// Chan's pairwise update combines the two means and m2 exactly.
+void seq_stat_merge(seq_stat_t *into, const seq_stat_t *from)
+{
+    double delta, count;
+    unsigned int index;
+
+    if(from->count == 0)
+        return;
+
+    if((into->count == 0) || (from->min_nsec < into->min_nsec)) into->min_nsec = from->min_nsec;
+    if((into->count == 0) || (from->max_nsec > into->max_nsec)) into->max_nsec = from->max_nsec;
+
+    count = (double)into->count + (double)from->count;
+    delta = from->mean_nsec - into->mean_nsec;
+    into->m2 += from->m2 + delta * delta * (double)into->count * (double)from->count / count;
+    into->mean_nsec += delta * (double)from->count / count;
+    into->count += from->count;
+
+    for(index = 0; index < SEQ_HIST_BUCKETS; index++)
+        into->bins[index] += from->bins[index];
+}
+
+double seq_stat_stddev(const seq_stat_t *stat)
+{
+    return (stat->count > 1) ? sqrt(stat->m2 / (double)(stat->count - 1)) : 0.0;
+}
+
+unsigned long long seq_stat_percentile(const seq_stat_t *stat, double fraction)
+{
+    unsigned long long count = 0, target = (unsigned long long)(fraction * (double)stat->count);
+    unsigned int index;
+
+    for(index = 0; index < SEQ_HIST_BUCKETS; index++)
+    {
+        count += stat->bins[index];
+        if(count > target)
+            return (seq_hist_upper(index) < stat->max_nsec) ? seq_hist_upper(index) : stat->max_nsec;
+    }
+
+    return stat->max_nsec;
+}
+
+void seq_stat_print(const seq_stat_t *stat, const char *label)
+{
+    if(stat->count == 0)
+    {
+        printf("      %-9s usec: none\n", label);
+        return;
+    }
+
+    printf("      %-9s usec: min=%.3lf avg=%.3lf sd=%.3lf p99<=%.3lf p99.9<=%.3lf max=%.3lf\n", label,
+           (double)stat->min_nsec / 1000.0, stat->mean_nsec / 1000.0, seq_stat_stddev(stat) / 1000.0,
+           (double)seq_stat_percentile(stat, 0.99) / 1000.0, (double)seq_stat_percentile(stat, 0.999) / 1000.0,
+           (double)stat->max_nsec / 1000.0);
+}
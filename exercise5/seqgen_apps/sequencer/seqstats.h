@@ -0,0 +1,45 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Streaming timing statistics: count, min, max, mean and variance (Welford's
+// update, so no sum of squares to overflow or cancel) and a log bucketed
+// histogram in the style of HdrHistogram.  Every power of 2 range of nsec is
+// split into SEQ_HIST_SUB linear buckets, so a bucket is never wider than
+// 1/SEQ_HIST_SUB of its values, from 1 nsec resolution at the bottom to
+// about 78 hours at the top.  Recording is a few integer operations on a
+// fixed array and never allocates.
+
+#ifndef SEQSTATS_H
+#define SEQSTATS_H
+
+#include <stdint.h>
+
+#define SEQ_HIST_SUB_BITS (4)
+#define SEQ_HIST_SUB (1 << SEQ_HIST_SUB_BITS)
+#define SEQ_HIST_MAX_BITS (48)         // values at or past 2^48 nsec share the last bucket
+#define SEQ_HIST_BUCKETS ((SEQ_HIST_MAX_BITS - SEQ_HIST_SUB_BITS + 1) * SEQ_HIST_SUB)
+
+typedef struct
+{
+    unsigned long long count;
+    unsigned long long min_nsec, max_nsec;
+    double mean_nsec, m2;              // m2 = sum of squared differences from the mean
+    uint32_t bins[SEQ_HIST_BUCKETS];
+} seq_stat_t;
+
+void seq_stat_record(seq_stat_t *stat, unsigned long long nsec);
+
+// Adds the values recorded in from to into, as if recorded there.
+void seq_stat_merge(seq_stat_t *into, const seq_stat_t *from);
+
+double seq_stat_stddev(const seq_stat_t *stat);
+
+// Upper edge of the bucket holding the given fraction of the values, or the
+// maximum if that is smaller.
+unsigned long long seq_stat_percentile(const seq_stat_t *stat, double fraction);
+
+// Prints "<label> usec: min= avg= sd= p99<= p99.9<= max=" on one line.
+void seq_stat_print(const seq_stat_t *stat, const char *label);
+
+#endif
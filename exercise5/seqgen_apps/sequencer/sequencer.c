@@ -0,0 +1,1130 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Table driven sequencer, see sequencer.h.
+//
+// The schedule is stored the way a sparse matrix row index is: one array
+// of start offsets per tick and one flat array of service indices, built
+// with a counting pass and a fill pass.  For the seqgen rates (divisors
+// 10, 30, 60 and 300) the hyperperiod is 300 ticks with 71 releases, and
+// 270 of the ticks post nothing at all.
+
+// This is necessary for CPU affinity macros in Linux
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <sys/timerfd.h>
+
+#include "sequencer.h"
+#include "rtinit.h"
+
+#define NANOSEC_PER_SEC (1000000000)
+#define TRUE (1)
+#define FALSE (0)
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE (6)
+#endif
+
+// The kernel's struct sched_attr, which glibc did not wrap until 2.41.
+typedef struct
+{
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+} seq_sched_attr_t;
+
+static void *seq_sequencer(void *threadp);
+static void *seq_service(void *threadp);
+
+// Service timing uses the raw clock, which NTP does not slew.
+static unsigned long long seq_raw_nsec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+    return (unsigned long long)now.tv_sec * NANOSEC_PER_SEC + (unsigned long long)now.tv_nsec;
+}
+
+int seq_init(sequencer_t *seq, unsigned int rate_hz, unsigned long long periods)
+{
+    memset(seq, 0, sizeof(*seq));
+
+    if((rate_hz == 0) || (rate_hz > NANOSEC_PER_SEC))
+    {
+        printf("Sequencer rate %u Hz not supported\n", rate_hz);
+        return -1;
+    }
+
+    seq->rate_hz = rate_hz;
+    seq->periods = periods;
+    seq->backend = SEQ_ABSOLUTE;
+    seq->relative_delay_nsec = NANOSEC_PER_SEC / rate_hz;
+    seq->priority = sched_get_priority_max(SCHED_FIFO);
+    seq->affinity = SEQ_NO_AFFINITY;
+    seq->timer_fd = -1;
+
+    gettimeofday(&seq->start_time_val, (struct timezone *)0);
+
+    return 0;
+}
+
+int seq_add_service(sequencer_t *seq, const char *name, unsigned int divisor, int priority, int affinity,
+                    seq_callback_t callback, void *arg)
+{
+    seq_service_t *services, *service;
+
+    if(seq->started || (divisor == 0) || (callback == NULL))
+    {
+        printf("Cannot add service %s\n", (name != NULL) ? name : "(null)");
+        return -1;
+    }
+
+    // services are not touched by any thread until seq_start(), so the
+    // table can still move
+    if(seq->num_services == seq->max_services)
+    {
+        services = realloc(seq->services, (seq->max_services ? 2 * seq->max_services : 8) * sizeof(seq_service_t));
+        if(services == NULL)
+        {
+            perror("seq_add_service");
+            return -1;
+        }
+        seq->services = services;
+        seq->max_services = seq->max_services ? 2 * seq->max_services : 8;
+    }
+
+    service = &seq->services[seq->num_services];
+    memset(service, 0, sizeof(*service));
+    service->name = name;
+    service->divisor = divisor;
+    service->priority = priority;
+    service->affinity = affinity;
+    service->callback = callback;
+    service->arg = arg;
+    service->overrun_policy = SEQ_OVERRUN_QUEUE;
+    service->queue_cap = SEQ_STAMPS;
+    service->seq = seq;
+
+    return (int)seq->num_services++;
+}
+
+int seq_set_overrun(sequencer_t *seq, int index, seq_overrun_policy_t policy, unsigned int queue_cap,
+                    seq_overrun_t callback)
+{
+    if(seq->started || (index < 0) || ((unsigned int)index >= seq->num_services) ||
+       (queue_cap == 0) || (queue_cap > SEQ_STAMPS) || ((policy == SEQ_OVERRUN_CALLBACK) && (callback == NULL)))
+    {
+        printf("Cannot set overrun policy of service %d\n", index);
+        return -1;
+    }
+
+    seq->services[index].overrun_policy = policy;
+    seq->services[index].queue_cap = queue_cap;
+    seq->services[index].overrun = callback;
+
+    return 0;
+}
+
+int seq_set_budget(sequencer_t *seq, int index, unsigned long long runtime_nsec, unsigned long long deadline_nsec)
+{
+    if(seq->started || (index < 0) || ((unsigned int)index >= seq->num_services) || (runtime_nsec == 0))
+    {
+        printf("Cannot set budget of service %d\n", index);
+        return -1;
+    }
+
+    seq->services[index].runtime_nsec = runtime_nsec;
+    seq->services[index].deadline_nsec = deadline_nsec;
+
+    return 0;
+}
+
+int seq_set_spin(sequencer_t *seq, int index, unsigned long long spin_nsec)
+{
+    if(seq->started || (index < 0) || ((unsigned int)index >= seq->num_services))
+    {
+        printf("Cannot set spin of service %d\n", index);
+        return -1;
+    }
+
+    seq->services[index].spin_nsec = spin_nsec;
+
+    return 0;
+}
+
+static unsigned long long seq_period_nsec(sequencer_t *seq, seq_service_t *service)
+{
+    return ((unsigned long long)service->divisor * NANOSEC_PER_SEC) / seq->rate_hz;
+}
+
+static unsigned long long gcd(unsigned long long a, unsigned long long b)
+{
+    unsigned long long t;
+
+    while(b != 0)
+    {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Release schedule
+//      * hyperperiod = LCM of all divisors, refused past SEQ_MAX_HYPERPERIOD
+//      * Order the services by priority, highest first (stable).
+//      * Count the releases at every tick: H / divisor for each service.
+//      * Prefix sum the counts into start offsets.
+//      * Fill in each service's ticks in priority order, so every tick's
+//      * list comes out highest priority first.
+//
+// Tick t of the hyperperiod is sequence count t mod H, so tick 0 holds every
+// service, as sequence count H does.
+////////////////////////////////////////////////////////////////////////////////
+static int seq_build_schedule(sequencer_t *seq)
+{
+    unsigned long long hyperperiod = 1, total = 0;
+    unsigned int *order, *fill;
+    unsigned int i, j, k, t;
+
+    for(i = 0; i < seq->num_services; i++)
+    {
+        hyperperiod = (hyperperiod / gcd(hyperperiod, seq->services[i].divisor)) * seq->services[i].divisor;
+        if(hyperperiod > SEQ_MAX_HYPERPERIOD)
+        {
+            printf("Sequencer hyperperiod exceeds %d ticks at service %s (divisor %u)\n",
+                   SEQ_MAX_HYPERPERIOD, seq->services[i].name, seq->services[i].divisor);
+            return -1;
+        }
+    }
+
+    for(i = 0; i < seq->num_services; i++)
+        total += hyperperiod / seq->services[i].divisor;
+
+    seq->hyperperiod = (unsigned int)hyperperiod;
+    seq->release_start = calloc(hyperperiod + 1, sizeof(unsigned int));
+    seq->release_list = malloc(((total > 0) ? total : 1) * sizeof(unsigned int));
+    order = malloc(((seq->num_services > 0) ? seq->num_services : 1) * sizeof(unsigned int));
+    fill = malloc(hyperperiod * sizeof(unsigned int));
+    if((seq->release_start == NULL) || (seq->release_list == NULL) || (order == NULL) || (fill == NULL))
+    {
+        perror("seq_build_schedule");
+        free(order);
+        free(fill);
+        return -1;
+    }
+
+    // insertion sort, registration order among equal priorities
+    for(i = 0; i < seq->num_services; i++)
+    {
+        for(j = i; (j > 0) && (seq->services[order[j-1]].priority < seq->services[i].priority); j--)
+            order[j] = order[j-1];
+        order[j] = i;
+    }
+
+    for(i = 0; i < seq->num_services; i++)
+        for(t = 0; t < seq->hyperperiod; t += seq->services[i].divisor)
+            seq->release_start[t+1]++;
+
+    for(t = 0; t < seq->hyperperiod; t++)
+    {
+        seq->release_start[t+1] += seq->release_start[t];
+        fill[t] = seq->release_start[t];
+    }
+
+    for(k = 0; k < seq->num_services; k++)
+    {
+        i = order[k];
+        for(t = 0; t < seq->hyperperiod; t += seq->services[i].divisor)
+            seq->release_list[fill[t]++] = i;
+    }
+
+    free(order);
+    free(fill);
+
+    return 0;
+}
+
+// SCHED_DEADLINE bandwidth the kernel admits over all CPUs, the same as
+// for SCHED_FIFO: sched_rt_runtime_us per sched_rt_period_us on each CPU.
+static double seq_deadline_limit(void)
+{
+    long long runtime_usec = 950000, period_usec = 1000000;
+    FILE *file;
+
+    if((file = fopen("/proc/sys/kernel/sched_rt_runtime_us", "r")) != NULL)
+    {
+        if(fscanf(file, "%lld", &runtime_usec) != 1) runtime_usec = 950000;
+        fclose(file);
+    }
+    if((file = fopen("/proc/sys/kernel/sched_rt_period_us", "r")) != NULL)
+    {
+        if(fscanf(file, "%lld", &period_usec) != 1) period_usec = 1000000;
+        fclose(file);
+    }
+
+    // -1 turns off the limit
+    if((runtime_usec < 0) || (period_usec <= 0))
+        return (double)get_nprocs();
+
+    return (double)get_nprocs() * (double)runtime_usec / (double)period_usec;
+}
+
+// Returns the total SCHED_DEADLINE bandwidth (runtime / period) of the
+// services, or -1.0 after printing any service the kernel would refuse
+// outright: no runtime, runtime > deadline > period, or pinned to a CPU
+// (SCHED_DEADLINE threads must be free to run on every CPU of their root
+// domain; use an exclusive cpuset to confine them instead).
+static double seq_deadline_bandwidth(sequencer_t *seq)
+{
+    seq_service_t *service;
+    double bandwidth = 0.0;
+    unsigned int i;
+    int rc = 0;
+
+    for(i = 0; i < seq->num_services; i++)
+    {
+        service = &seq->services[i];
+        if((service->runtime_nsec < 1024) || (service->runtime_nsec > service->deadline_nsec) ||
+           (service->deadline_nsec > seq_period_nsec(seq, service)))
+        {
+            printf("SCHED_DEADLINE service %s needs 1 usec <= runtime <= deadline <= period, has runtime %llu, "
+                   "deadline %llu, period %llu nsec\n", service->name, service->runtime_nsec, service->deadline_nsec,
+                   seq_period_nsec(seq, service));
+            rc = -1;
+        }
+        else if(service->affinity != SEQ_NO_AFFINITY)
+        {
+            printf("SCHED_DEADLINE service %s cannot be pinned to CPU %d\n", service->name, service->affinity);
+            rc = -1;
+        }
+
+        bandwidth += (double)service->runtime_nsec / (double)seq_period_nsec(seq, service);
+    }
+
+    return (rc == 0) ? bandwidth : -1.0;
+}
+
+static int seq_thread_attr(pthread_attr_t *attr, int priority, int affinity)
+{
+    struct sched_param param;
+    cpu_set_t cpuset;
+
+    pthread_attr_init(attr);
+    pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(attr, SCHED_FIFO);
+    rt_stack_attr(attr);
+
+    param.sched_priority = priority;
+    if(pthread_attr_setschedparam(attr, &param) != 0)
+        return -1;
+
+    if(affinity != SEQ_NO_AFFINITY)
+    {
+        CPU_ZERO(&cpuset);
+        CPU_SET(affinity, &cpuset);
+        if(pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), &cpuset) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+// Checks that a pinned thread may run on its CPU and no other.
+static int seq_check_affinity(pthread_t thread, int affinity, const char *name)
+{
+    cpu_set_t cpuset;
+
+    if(affinity == SEQ_NO_AFFINITY)
+        return 0;
+
+    if((pthread_getaffinity_np(thread, sizeof(cpu_set_t), &cpuset) != 0) ||
+       (CPU_COUNT(&cpuset) != 1) || !CPU_ISSET(affinity, &cpuset))
+    {
+        printf("%s is not pinned to CPU %d\n", name, affinity);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Wakes one service thread the way seq.wakeup says.
+static void seq_post(sequencer_t *seq, seq_service_t *service)
+{
+    if(seq->wakeup == SEQ_WAKE_FUTEX)
+        seq_event_post(&service->event);
+    else
+        sem_post(&service->sem);
+}
+
+// Wakes the first count service threads to see abort and exit.
+static void seq_release_all(sequencer_t *seq, unsigned int count)
+{
+    unsigned int i;
+
+    seq->abort = TRUE;
+    for(i = 0; i < count; i++)
+        seq_post(seq, &seq->services[i]);
+}
+
+// Undoes the allocations of a seq_start() that failed, or of seq_destroy().
+static void seq_free_schedule(sequencer_t *seq)
+{
+    free(seq->release_start);
+    free(seq->release_list);
+    seq->release_start = NULL;
+    seq->release_list = NULL;
+
+    free(seq->stats);
+    seq->stats = NULL;
+
+    free(seq->released);
+    seq->released = NULL;
+
+    if(seq->timer_fd >= 0)
+        close(seq->timer_fd);
+    seq->timer_fd = -1;
+}
+
+int seq_start(sequencer_t *seq)
+{
+    pthread_attr_t attr;
+    double bandwidth = 0.0;
+    unsigned int i, j, k;
+    int rc, refused = 0;
+
+    if(seq->started)
+        return -1;
+
+    // calloc() touches nothing, so clear the statistics once here rather
+    // than page faulting on them in the service threads
+    seq->stats = malloc(((seq->num_services > 0) ? seq->num_services : 1) * sizeof(seq_service_stats_t));
+    seq->released = malloc(((seq->num_services > 0) ? seq->num_services : 1) * sizeof(seq_event_t *));
+    if((seq->stats == NULL) || (seq->released == NULL) || (seq_build_schedule(seq) != 0))
+    {
+        if((seq->stats == NULL) || (seq->released == NULL))
+            perror("seq_start");
+        seq_free_schedule(seq);
+        return -1;
+    }
+    memset(seq->stats, 0, ((seq->num_services > 0) ? seq->num_services : 1) * sizeof(seq_service_stats_t));
+
+    for(i = 0; i < seq->num_services; i++)
+    {
+        seq->services[i].stats = &seq->stats[i];
+        if(seq->services[i].deadline_nsec == 0)
+            seq->services[i].deadline_nsec = seq_period_nsec(seq, &seq->services[i]);
+        seq->services[i].admit_errno = 0;
+    }
+
+    if((seq->policy == SEQ_SCHED_DEADLINE) && ((bandwidth = seq_deadline_bandwidth(seq)) < 0.0))
+    {
+        seq_free_schedule(seq);
+        return -1;
+    }
+
+    // events must be defined before the drain starts, so evlog_start() comes
+    // after this; records logged before then wait in the rings
+    if(seq->log != NULL)
+    {
+        evlog_define(seq->log, SEQ_EV_THREAD, "thread");
+        evlog_define(seq->log, SEQ_EV_CYCLE, "cycle %llu");
+        evlog_define(seq->log, SEQ_EV_OVERRUN, "overrun of service %llu, %llu pending, released %llu");
+
+        seq->ring = evlog_open(seq->log, "Sequencer");
+        for(i = 0; i < seq->num_services; i++)
+            seq->services[i].ring = evlog_open(seq->log, seq->services[i].name);
+    }
+
+    // armed by the sequencer thread once it has its epoch
+    if(seq->backend == SEQ_TIMERFD)
+    {
+        seq->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if(seq->timer_fd < 0)
+        {
+            perror("Sequencer timerfd_create");
+            seq_free_schedule(seq);
+            return -1;
+        }
+    }
+
+    if(sem_init(&seq->ready, 0, 0))
+    {
+        printf("Failed to initialize sequencer semaphore\n");
+        seq_free_schedule(seq);
+        return -1;
+    }
+
+    for(i = 0; i < seq->num_services; i++)
+    {
+        if(sem_init(&seq->services[i].sem, 0, 0))
+        {
+            printf("Failed to initialize %s semaphore\n", seq->services[i].name);
+            break;
+        }
+        seq_event_init(&seq->services[i].event, seq->services[i].spin_nsec);
+    }
+
+    // service threads first, so each is waiting before its first release
+    for(j = 0; j < i; j++)
+    {
+        rc = seq_thread_attr(&attr, seq->services[j].priority, seq->services[j].affinity);
+        if(rc == 0)
+            rc = pthread_create(&seq->services[j].thread, &attr, seq_service, (void *)&seq->services[j]);
+        pthread_attr_destroy(&attr);
+
+        if(rc != 0)
+        {
+            errno = (rc > 0) ? rc : EINVAL;
+            perror(seq->services[j].name);
+            break;
+        }
+    }
+
+    // every thread has its policy, or has failed to, before any release
+    for(k = 0; k < j; k++)
+        while(sem_wait(&seq->ready) != 0);
+
+    for(k = 0; k < j; k++)
+    {
+        if(seq->services[k].admit_errno == 0)
+            continue;
+
+        printf("SCHED_DEADLINE refused for %s (runtime %llu usec, deadline %llu usec, period %llu usec): %s\n",
+               seq->services[k].name, seq->services[k].runtime_nsec / 1000, seq->services[k].deadline_nsec / 1000,
+               seq_period_nsec(seq, &seq->services[k]) / 1000, strerror(seq->services[k].admit_errno));
+        refused = seq->services[k].admit_errno;
+    }
+
+    if(refused == EBUSY)
+        printf("Admission control: the services ask for %.3lf CPUs of bandwidth, the kernel admits %.3lf\n",
+               bandwidth, seq_deadline_limit());
+    else if(refused == EPERM)
+        printf("SCHED_DEADLINE needs root or CAP_SYS_NICE, and threads free to run on every CPU\n");
+
+    // placement is verified on the running threads, as a CPU that went
+    // offline or a cpuset can still override the requested affinity
+    for(k = 0; k < j; k++)
+        if(seq_check_affinity(seq->services[k].thread, seq->services[k].affinity, seq->services[k].name) != 0)
+            refused = (refused != 0) ? refused : EINVAL;
+
+    if((j == seq->num_services) && (refused == 0))
+    {
+        rc = seq_thread_attr(&attr, seq->priority, seq->affinity);
+        if(rc == 0)
+            rc = pthread_create(&seq->thread, &attr, seq_sequencer, (void *)seq);
+        pthread_attr_destroy(&attr);
+
+        if((rc == 0) && (seq_check_affinity(seq->thread, seq->affinity, "Sequencer") == 0))
+        {
+            seq->started = TRUE;
+            return 0;
+        }
+
+        if(rc == 0)
+        {
+            // it releases and wakes the services itself on the way out
+            seq->abort = TRUE;
+            pthread_join(seq->thread, NULL);
+        }
+        else
+        {
+            errno = (rc > 0) ? rc : EINVAL;
+            perror("Sequencer");
+        }
+    }
+
+    seq_release_all(seq, j);
+    for(rc = 0; rc < (int)j; rc++)
+        pthread_join(seq->services[rc].thread, NULL);
+    for(rc = 0; rc < (int)i; rc++)
+        sem_destroy(&seq->services[rc].sem);
+    sem_destroy(&seq->ready);
+
+    seq_free_schedule(seq);
+
+    return -1;
+}
+
+void seq_stop(sequencer_t *seq)
+{
+    seq->abort = TRUE;
+}
+
+void seq_join(sequencer_t *seq)
+{
+    unsigned int i;
+
+    if(!seq->started)
+        return;
+
+    pthread_join(seq->thread, NULL);
+    for(i = 0; i < seq->num_services; i++)
+        pthread_join(seq->services[i].thread, NULL);
+
+    seq->started = FALSE;
+}
+
+void seq_destroy(sequencer_t *seq)
+{
+    unsigned int i;
+
+    // the schedule is only kept once the semaphores are initialized
+    if(seq->release_start != NULL)
+    {
+        for(i = 0; i < seq->num_services; i++)
+            sem_destroy(&seq->services[i].sem);
+        sem_destroy(&seq->ready);
+    }
+
+    seq_free_schedule(seq);
+    free(seq->services);
+    memset(seq, 0, sizeof(*seq));
+    seq->timer_fd = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Release error statistics
+//      * seq_jitter_record: called by the sequencer for each release it makes
+//      * on waking; the error is the wake time less the time that release was
+//      * due on the ideal schedule from epoch.  Only counters are updated.
+//      * seq_print_stats: called once the threads are joined.
+////////////////////////////////////////////////////////////////////////////////
+static void seq_jitter_record(sequencer_t *seq, struct timespec *epoch, struct timespec *now, unsigned long long offset_nsec)
+{
+    seq_jitter_t *stats = &seq->jitter;
+    long long error_nsec;
+    unsigned long long bin;
+
+    error_nsec = ((long long)(now->tv_sec - epoch->tv_sec) * NANOSEC_PER_SEC + (now->tv_nsec - epoch->tv_nsec)) -
+                 (long long)offset_nsec;
+
+    if((stats->releases == 0) || (error_nsec < stats->min_nsec)) stats->min_nsec = error_nsec;
+    if((stats->releases == 0) || (error_nsec > stats->max_nsec)) stats->max_nsec = error_nsec;
+    stats->sum_nsec += error_nsec;
+    stats->releases++;
+
+    if(error_nsec >= (long long)(NANOSEC_PER_SEC / seq->rate_hz)) stats->overruns++;
+
+    // a relative sleep can also wake early, which goes in the first bin
+    bin = (error_nsec > 0) ? (unsigned long long)error_nsec / SEQ_JITTER_BIN_NSEC : 0;
+    stats->bins[(bin < SEQ_JITTER_BINS) ? bin : SEQ_JITTER_BINS - 1]++;
+}
+
+// Upper edge of the bin holding the given fraction of releases, in usec, or
+// the maximum if that is past the last bin.
+static double seq_jitter_percentile(seq_jitter_t *stats, double fraction)
+{
+    unsigned long long count = 0, target = (unsigned long long)(fraction * (double)stats->releases);
+    int bin;
+
+    for(bin = 0; bin < SEQ_JITTER_BINS - 1; bin++)
+    {
+        count += stats->bins[bin];
+        if(count > target)
+            return (double)((bin + 1) * SEQ_JITTER_BIN_NSEC) / 1000.0;
+    }
+
+    return (double)stats->max_nsec / 1000.0;
+}
+
+int seq_read_overload(sequencer_t *seq, int index, seq_overload_t *overload)
+{
+    seq_service_t *service;
+    unsigned int i;
+
+    memset(overload, 0, sizeof(*overload));
+
+    if(index == SEQ_ALL_SERVICES)
+    {
+        for(i = 0; i < seq->num_services; i++)
+        {
+            service = &seq->services[i];
+            overload->overruns += atomic_load_explicit(&service->overruns, memory_order_relaxed);
+            overload->skipped += atomic_load_explicit(&service->skipped, memory_order_relaxed);
+            overload->misses += atomic_load_explicit(&service->misses, memory_order_relaxed);
+        }
+        overload->pending_max = atomic_load_explicit(&seq->pending_max, memory_order_relaxed);
+
+        return 0;
+    }
+
+    if((index < 0) || ((unsigned int)index >= seq->num_services))
+        return -1;
+
+    service = &seq->services[index];
+    overload->overruns = atomic_load_explicit(&service->overruns, memory_order_relaxed);
+    overload->skipped = atomic_load_explicit(&service->skipped, memory_order_relaxed);
+    overload->misses = atomic_load_explicit(&service->misses, memory_order_relaxed);
+    overload->pending_max = atomic_load_explicit(&service->pending_max, memory_order_relaxed);
+
+    return 0;
+}
+
+void seq_print_stats(sequencer_t *seq)
+{
+    seq_jitter_t *stats = &seq->jitter;
+    seq_counters_t *counters = &seq->counters;
+    seq_overload_t overload;
+    unsigned long long count = 0, posted = 0, wakes = 0;
+    unsigned int i;
+    int bin, edge_usec = 1;
+
+    printf("\nSequencer (%s): %llu releases at %u Hz, %llu overruns\n",
+           (seq->backend == SEQ_RELATIVE) ? "relative nanosleep" :
+           (seq->backend == SEQ_TIMERFD) ? "timerfd" : "absolute clock_nanosleep",
+           stats->releases, seq->rate_hz, stats->overruns);
+    if(counters->wakeups > 0)
+        printf("Wakeups: %llu, missed ticks %llu, max batch %llu, overhead usec avg=%.3lf max=%.3lf\n",
+               counters->wakeups, counters->missed_ticks, counters->max_batch,
+               (double)counters->overhead_sum_nsec / (double)counters->wakeups / 1000.0,
+               (double)counters->overhead_max_nsec / 1000.0);
+    printf("Schedule: %u %s services, hyperperiod %u ticks, %u releases\n",
+           seq->num_services, (seq->policy == SEQ_SCHED_DEADLINE) ? "SCHED_DEADLINE" : "SCHED_FIFO", seq->hyperperiod, (seq->release_start != NULL) ? seq->release_start[seq->hyperperiod] : 0);
+    if(seq->wakeup == SEQ_WAKE_FUTEX)
+    {
+        for(i = 0; i < seq->num_services; i++)
+        {
+            posted += atomic_load(&seq->services[i].due);
+            wakes += seq->services[i].event.wakes;
+        }
+        printf("Release: futex events, %llu wake calls for %llu releases\n", wakes, posted);
+    }
+    else
+        printf("Release: semaphores\n");
+    seq_read_overload(seq, SEQ_ALL_SERVICES, &overload);
+    printf("Overload: %llu overruns, %llu releases skipped, %llu deadline misses, max %llu releases pending\n",
+           overload.overruns, overload.skipped, overload.misses, overload.pending_max);
+    for(i = 0; i < seq->num_services; i++)
+    {
+        seq_read_overload(seq, (int)i, &overload);
+        printf("   %-36s every %4u ticks, prio %2d: %llu releases, %llu deadline misses\n",
+               seq->services[i].name, seq->services[i].divisor, seq->services[i].priority, seq->services[i].releases,
+               overload.misses);
+        if(seq->policy == SEQ_SCHED_DEADLINE)
+            printf("      budget    usec: runtime=%llu deadline=%llu period=%llu\n",
+                   seq->services[i].runtime_nsec / 1000, seq->services[i].deadline_nsec / 1000,
+                   seq_period_nsec(seq, &seq->services[i]) / 1000);
+        printf("      overrun   %s: %llu overruns, %llu skipped, max %llu pending\n",
+               (seq->services[i].overrun_policy == SEQ_OVERRUN_SKIP) ? "skip" :
+               (seq->services[i].overrun_policy == SEQ_OVERRUN_CALLBACK) ? "callback" : "queue",
+               overload.overruns, overload.skipped, overload.pending_max);
+        if(seq->stats != NULL)
+        {
+            seq_stat_print(&seq->stats[i].latency, "latency");
+            seq_stat_print(&seq->stats[i].exec, "exec");
+            seq_stat_print(&seq->stats[i].response, "response");
+        }
+    }
+
+    if(stats->releases == 0)
+        return;
+
+    printf("Release error usec: min=%.3lf avg=%.3lf max=%.3lf p99<=%.3lf p99.9<=%.3lf\n",
+           (double)stats->min_nsec / 1000.0, (double)stats->sum_nsec / (double)stats->releases / 1000.0,
+           (double)stats->max_nsec / 1000.0, seq_jitter_percentile(stats, 0.99), seq_jitter_percentile(stats, 0.999));
+
+    // printed in power of 2 usec ranges
+    for(bin = 0; bin < SEQ_JITTER_BINS - 1; bin++)
+    {
+        if((bin * SEQ_JITTER_BIN_NSEC) >= (edge_usec * 1000))
+        {
+            printf("   < %4d usec: %llu\n", edge_usec, count);
+            count = 0;
+            edge_usec *= 2;
+        }
+        count += stats->bins[bin];
+    }
+    printf("   < %4d usec: %llu\n", (SEQ_JITTER_BINS - 1) * SEQ_JITTER_BIN_NSEC / 1000, count);
+    printf("   >=%4d usec: %llu\n", (SEQ_JITTER_BINS - 1) * SEQ_JITTER_BIN_NSEC / 1000, stats->bins[SEQ_JITTER_BINS - 1]);
+}
+
+int seq_write_wcet(sequencer_t *seq, const char *path)
+{
+    unsigned long long period_usec, wcet_usec, deadline_usec;
+    unsigned int i;
+    FILE *file;
+
+    file = fopen(path, "w");
+    if(file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(file, "# observed WCET from %u Hz sequencer, usec: set,period,wcet,deadline\n", seq->rate_hz);
+    for(i = 0; i < seq->num_services; i++)
+    {
+        period_usec = ((unsigned long long)seq->services[i].divisor * 1000000ULL) / seq->rate_hz;
+        deadline_usec = seq->services[i].deadline_nsec / 1000;
+        wcet_usec = (seq->stats != NULL) ? (seq->stats[i].exec.max_nsec + 999) / 1000 : 0;
+
+        // a service that never ran still needs a positive WCET to be a service
+        fprintf(file, "# %s: %llu releases, %llu deadline misses, %llu skipped\n", seq->services[i].name,
+                seq->services[i].releases, (unsigned long long)atomic_load(&seq->services[i].misses),
+                (unsigned long long)atomic_load(&seq->services[i].skipped));
+        fprintf(file, "0,%llu,%llu,%llu\n", period_usec, (wcet_usec > 0) ? wcet_usec : 1, deadline_usec);
+    }
+
+    if(fclose(file) != 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Release time of sequence count seqCnt from the epoch.  The timerfd runs
+// on a whole nsec interval, so its schedule is in multiples of that.
+static unsigned long long seq_release_offset(sequencer_t *seq, unsigned long long seqCnt)
+{
+    if(seq->backend == SEQ_TIMERFD)
+        return seqCnt * (NANOSEC_PER_SEC / seq->rate_hz);
+    else
+        return (seqCnt * NANOSEC_PER_SEC) / seq->rate_hz;
+}
+
+static struct timespec seq_timespec_add(struct timespec *base, unsigned long long offset_nsec)
+{
+    struct timespec t;
+
+    t.tv_sec = base->tv_sec + (time_t)(offset_nsec / NANOSEC_PER_SEC);
+    t.tv_nsec = base->tv_nsec + (long)(offset_nsec % NANOSEC_PER_SEC);
+    if(t.tv_nsec >= NANOSEC_PER_SEC)
+    {
+        t.tv_sec++;
+        t.tv_nsec -= NANOSEC_PER_SEC;
+    }
+
+    return t;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Wait for the next tick, sequence count seqCnt, to be due.
+//      * SEQ_ABSOLUTE: SLEEP UNTIL epoch + seqCnt / rate, restart on EINTR
+//      * SEQ_RELATIVE: SLEEP one period, restarting with the remainder
+//      * SEQ_TIMERFD: READ the timerfd, restart on EINTR
+//
+// Returns the number of ticks now due.  That is always 1 for the sleeps,
+// which each wait for one tick however late they are (an absolute wait for
+// a time already past returns at once).  The timerfd read returns every
+// expiration since the last read, so a late wakeup reports all the ticks
+// it owes.
+////////////////////////////////////////////////////////////////////////////////
+static unsigned long long seq_wait_tick(sequencer_t *seq, struct timespec *epoch, unsigned long long seqCnt)
+{
+    struct timespec release_time, delay_time, remaining_time;
+    unsigned long long expirations;
+    ssize_t len;
+    int rc;
+
+    if(seq->backend == SEQ_TIMERFD)
+    {
+        while((len = read(seq->timer_fd, &expirations, sizeof(expirations))) < 0)
+        {
+            if(errno != EINTR)
+            {
+                perror("Sequencer timerfd read");
+                exit(-1);
+            }
+        }
+
+        return (len == sizeof(expirations)) ? expirations : 0;
+    }
+    else if(seq->backend == SEQ_RELATIVE)
+    {
+        delay_time.tv_sec = seq->relative_delay_nsec / NANOSEC_PER_SEC;
+        delay_time.tv_nsec = seq->relative_delay_nsec % NANOSEC_PER_SEC;
+
+        while((rc = nanosleep(&delay_time, &remaining_time)) != 0)
+        {
+            if(errno != EINTR)
+            {
+                perror("Sequencer nanosleep");
+                exit(-1);
+            }
+            delay_time = remaining_time;
+        }
+    }
+    else
+    {
+        release_time = seq_timespec_add(epoch, seq_release_offset(seq, seqCnt));
+
+        // clock_nanosleep() returns the error rather than setting errno, and
+        // an interrupted absolute wait can simply be restarted
+        while((rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &release_time, NULL)) == EINTR);
+        if(rc != 0)
+        {
+            errno = rc;
+            perror("Sequencer clock_nanosleep");
+            exit(-1);
+        }
+    }
+
+    return 1;
+}
+
+// Adds one to a counter only the calling thread writes.
+static void seq_count(atomic_ullong *counter)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+// Raises a watermark only the calling thread writes.
+static void seq_watermark(atomic_ullong *watermark, unsigned long long value)
+{
+    if(value > atomic_load_explicit(watermark, memory_order_relaxed))
+        atomic_store_explicit(watermark, value, memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Overrun check, for each release of a service
+//      * pending = releases posted - releases completed (acquire)
+//      * IF pending > 0: count an overrun and apply the policy
+//      *       SKIP: do not release
+//      *       QUEUE: release unless pending has reached queue_cap
+//      *       CALLBACK: ask the callback; if it says queue, as QUEUE
+//      *       Log the overrun
+//      * Count a skip, or raise the service and sequencer watermarks
+//
+// Returns TRUE if the release is to be posted.  A skipped release is not
+// due, so the service's release numbers count only the releases it runs.
+////////////////////////////////////////////////////////////////////////////////
+static int seq_admit(sequencer_t *seq, seq_service_t *service)
+{
+    unsigned long long pending = atomic_load_explicit(&service->due, memory_order_relaxed) -
+                                 atomic_load_explicit(&service->completed, memory_order_acquire);
+    int release = TRUE;
+
+    if(pending > 0)
+    {
+        seq_count(&service->overruns);
+
+        if(service->overrun_policy == SEQ_OVERRUN_SKIP)
+            release = FALSE;
+        else if(service->overrun_policy == SEQ_OVERRUN_CALLBACK)
+            release = service->overrun(service, pending);
+        if(pending >= service->queue_cap)
+            release = FALSE;
+
+        evlog_write(seq->ring, SEQ_EV_OVERRUN, (uint64_t)(service - seq->services), pending, release ? 1 : 0, 0);
+    }
+
+    if(!release)
+    {
+        seq_count(&service->skipped);
+        return FALSE;
+    }
+
+    seq_watermark(&service->pending_max, pending + 1);
+    seq_watermark(&seq->pending_max, atomic_fetch_add(&seq->pending, 1) + 1);
+
+    return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sequencer thread
+//      * Prefault its stack.
+//      * Read CLOCK_MONOTONIC once as the epoch, and arm the timerfd to
+//      * expire every period from it.
+//      * DO/WHILE (!abort && (sequence count < total sequences)):
+//      *       WAIT for the next tick; n = ticks now due
+//      *       FOR each of the n ticks (stopping at total sequences):
+//      *           Increment sequence count and schedule tick (mod hyperperiod)
+//      *           Record the release error; a whole period late is an overrun
+//      *           Post the services on this tick's list that seq_admit()
+//      *           releases: all their events, then the wakes
+//      *       Count the wakeup, missed ticks and overhead
+//      *       Log the cycle
+//      * Post every service once more so each sees abort and exits.
+//
+// With SEQ_ABSOLUTE and SEQ_TIMERFD nothing done in a cycle moves the next
+// release, so the rate does not drift.  After a sequencer overrun no tick
+// is skipped: the absolute waits for releases already due return at once,
+// and the timerfd hands back all of them in one batch.  Which releases of
+// a late service are posted is then up to its overrun policy.
+////////////////////////////////////////////////////////////////////////////////
+static void *seq_sequencer(void *threadp)
+{
+    sequencer_t *seq = (sequencer_t *)threadp;
+    seq_counters_t *counters = &seq->counters;
+    struct timeval current_time_val;
+    struct timespec epoch, wake_time, done_time;
+    struct itimerspec timer;
+    struct timespec zero = {0, 0};
+    unsigned long long seqCnt=0, due, batch, overhead_nsec, release_nsec, posted;
+    seq_service_t *service;
+    unsigned int tick=0, j, released;
+
+    rt_prefault_stack();
+    evlog_write(seq->ring, SEQ_EV_THREAD, 0, 0, 0, 0);
+    gettimeofday(&current_time_val, (struct timezone *)0);
+    printf("Sequencer thread @ sec=%d, usec=%d\n", (int)(current_time_val.tv_sec-seq->start_time_val.tv_sec), (int)current_time_val.tv_usec);
+
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+
+    if(seq->backend == SEQ_TIMERFD)
+    {
+        timer.it_interval = seq_timespec_add(&zero, seq_release_offset(seq, 1));
+        timer.it_value = seq_timespec_add(&epoch, seq_release_offset(seq, 1));
+        if(timerfd_settime(seq->timer_fd, TFD_TIMER_ABSTIME, &timer, NULL) != 0)
+        {
+            perror("Sequencer timerfd_settime");
+            exit(-1);
+        }
+    }
+
+    do
+    {
+        due = seq_wait_tick(seq, &epoch, seqCnt + 1);
+        clock_gettime(CLOCK_MONOTONIC, &wake_time);
+        release_nsec = seq_raw_nsec();
+
+        // one table lookup per tick, before logging so even the event log
+        // write does not delay the releases
+        for(batch = 0; (batch < due) && ((seq->periods == 0) || (seqCnt < seq->periods)); batch++)
+        {
+            seqCnt++;
+            if(++tick == seq->hyperperiod)
+                tick = 0;
+
+            seq_jitter_record(seq, &epoch, &wake_time, seq_release_offset(seq, seqCnt));
+
+            released = 0;
+            for(j = seq->release_start[tick]; j < seq->release_start[tick+1]; j++)
+            {
+                service = &seq->services[seq->release_list[j]];
+                if(!seq_admit(seq, service))
+                    continue;
+
+                // stamp first, then publish the release that reads it
+                posted = atomic_load_explicit(&service->due, memory_order_relaxed) + 1;
+                service->release_nsec[posted % SEQ_STAMPS] = release_nsec;
+                atomic_store_explicit(&service->due, posted, memory_order_release);
+                if(seq->wakeup == SEQ_WAKE_FUTEX)
+                    seq->released[released++] = &service->event;
+                else
+                    sem_post(&service->sem);
+            }
+
+            if(released > 0)
+                seq_event_post_set(seq->released, released);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &done_time);
+        overhead_nsec = (unsigned long long)((long long)(done_time.tv_sec - wake_time.tv_sec) * NANOSEC_PER_SEC +
+                                             (done_time.tv_nsec - wake_time.tv_nsec));
+
+        counters->wakeups++;
+        if(due > 1) counters->missed_ticks += due - 1;
+        if(due > counters->max_batch) counters->max_batch = due;
+        counters->overhead_sum_nsec += overhead_nsec;
+        if(overhead_nsec > counters->overhead_max_nsec) counters->overhead_max_nsec = overhead_nsec;
+
+        evlog_write(seq->ring, SEQ_EV_CYCLE, seqCnt, 0, 0, 0);
+
+    } while(!seq->abort && ((seq->periods == 0) || (seqCnt < seq->periods)));
+
+    seq_release_all(seq, seq->num_services);
+
+    pthread_exit((void *)0);
+}
+
+// Moves the calling service thread to SCHED_DEADLINE with its runtime,
+// deadline and period.  Returns 0, or the errno; EBUSY is admission
+// control refusing the bandwidth.
+static int seq_set_deadline(sequencer_t *seq, seq_service_t *service)
+{
+    seq_sched_attr_t attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = service->runtime_nsec;
+    attr.sched_deadline = service->deadline_nsec;
+    attr.sched_period = seq_period_nsec(seq, service);
+
+    return (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) ? 0 : errno;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Service thread
+//      * Prefault its stack, then print/log its start time.
+//      * Switch to SCHED_DEADLINE if asked, and tell seq_start() how it went.
+//      * LOOP:
+//      *       WAIT on the release event (or semaphore)
+//      *       IF abort and every due release is done: exit
+//      *       Count the release and run the callback
+//      *       Record latency, execution and response time, and any miss
+//      *       Mark the release completed (release), for seq_admit()
+//
+// The post that wakes a service for abort is not a release, so the count
+// of posted releases tells it apart from the last real ones still pending.
+////////////////////////////////////////////////////////////////////////////////
+static void *seq_service(void *threadp)
+{
+    seq_service_t *service = (seq_service_t *)threadp;
+    seq_service_stats_t *stats = service->stats;
+    sequencer_t *seq = service->seq;
+    struct timeval current_time_val;
+    unsigned long long release_nsec, start_nsec, end_nsec;
+
+    rt_prefault_stack();
+    evlog_write(service->ring, SEQ_EV_THREAD, 0, 0, 0, 0);
+    gettimeofday(&current_time_val, (struct timezone *)0);
+    printf("%s thread @ sec=%d, usec=%d\n", service->name, (int)(current_time_val.tv_sec-seq->start_time_val.tv_sec), (int)current_time_val.tv_usec);
+
+    // a refused thread still waits, for the post that makes it exit
+    if(seq->policy == SEQ_SCHED_DEADLINE)
+        service->admit_errno = seq_set_deadline(seq, service);
+    sem_post(&seq->ready);
+
+    while(TRUE)
+    {
+        if(seq->wakeup == SEQ_WAKE_FUTEX)
+            seq_event_wait(&service->event);
+        else
+            while(sem_wait(&service->sem) != 0);
+        if(seq->abort && (service->releases == atomic_load_explicit(&service->due, memory_order_acquire)))
+            break;
+
+        service->releases++;
+        release_nsec = service->release_nsec[service->releases % SEQ_STAMPS];
+
+        start_nsec = seq_raw_nsec();
+        service->callback(service, service->releases);
+        end_nsec = seq_raw_nsec();
+
+        seq_stat_record(&stats->latency, start_nsec - release_nsec);
+        seq_stat_record(&stats->exec, end_nsec - start_nsec);
+        seq_stat_record(&stats->response, end_nsec - release_nsec);
+        if((end_nsec - release_nsec) > service->deadline_nsec)
+            seq_count(&service->misses);
+
+        atomic_fetch_sub_explicit(&seq->pending, 1, memory_order_relaxed);
+        atomic_store_explicit(&service->completed, service->releases, memory_order_release);
+    }
+
+    pthread_exit((void *)0);
+}
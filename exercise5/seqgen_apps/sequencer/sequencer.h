@@ -0,0 +1,311 @@
+// Authors: Armando Pinales and Gautama Gandhi
+// ECEN 5623, Spring 2022
+// University of Colorado Boulder
+//
+// Table driven sequencer.  Services are registered with a divisor of the
+// sequencer rate, a SCHED_FIFO priority, an optional CPU and a callback,
+// and each gets its own thread that runs the callback once per release.
+//
+// With seq.policy = SEQ_SCHED_DEADLINE the service threads run under
+// SCHED_DEADLINE instead, each with the runtime given by seq_set_budget()
+// per period of its releases, and the priorities are not used.  The
+// kernel then orders the services by deadline and throttles any that
+// overruns its runtime, so one service cannot starve the others, but
+// every SCHED_DEADLINE thread runs ahead of every SCHED_FIFO one,
+// including the sequencer itself, whose release error grows by up to the
+// runtimes of the services running when a tick is due.
+//
+// seq_start() builds the release schedule once, over the hyperperiod
+// (least common multiple of the divisors): for every tick in it, the list
+// of services due, highest priority first.  Each sequencer tick then posts
+// exactly the services on its list, so the per-tick cost depends on how
+// many services are due and not on how many are registered.
+//
+// A release is a post of the service's futex release event (seqevent.h):
+// the sequencer publishes all of a tick's releases first, then makes one
+// wake system call per due service that is blocked, and none for one that
+// is still running or spinning.  A service given a spin time with
+// seq_set_spin() polls for its release that long before blocking, which
+// seq_place() sets for a service alone on an isolated CPU.  seq.wakeup =
+// SEQ_WAKE_SEMAPHORE goes back to a sem_post() per release, for comparison.
+//
+// A service still running when its next release comes has overrun.  The
+// sequencer tracks each service's outstanding releases and applies the
+// service's overrun policy (seq_set_overrun()) instead of letting a backlog
+// build up that the service would then work off back to back, starving
+// every lower priority service.
+//
+// Usage:
+//      sequencer_t seq;
+//      seq_init(&seq, 3000, 900);
+//      seq_add_service(&seq, "Frame Sampler", 10, rt_max_prio-1, SEQ_NO_AFFINITY, callback, NULL);
+//      ...
+//      seq_start(&seq);
+//      seq_join(&seq);
+//      seq_print_stats(&seq);
+//      seq_destroy(&seq);
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "evlog.h"
+#include "seqevent.h"
+#include "seqstats.h"
+
+#define SEQ_NO_AFFINITY (-1)
+#define SEQ_ALL_SERVICES (-1)          // seq_read_overload() of the whole sequencer
+
+// Events logged by the sequencer and service threads when seq.log is set;
+// seq_start() defines them.  Callbacks log their own from SEQ_EV_USER up.
+#define SEQ_EV_THREAD (0)              // thread started
+#define SEQ_EV_CYCLE (1)               // sequencer tick, arg 0 the sequence count
+#define SEQ_EV_OVERRUN (2)             // release of an unfinished service, see seq_admit()
+#define SEQ_EV_USER (16)
+
+// Largest schedule seq_start() will build, in ticks (about 6 minutes at
+// 3 kHz).  Divisors that are mostly coprime need a smaller set of rates.
+#define SEQ_MAX_HYPERPERIOD (1 << 20)
+
+// Default spin before blocking for a service alone on an isolated CPU,
+// set by seq_place()
+#define SEQ_SPIN_NSEC (20000)
+
+// Release times kept per service, for measuring latency and response time
+// while up to this many releases of the service are pending, which is also
+// the most a service may have queued.
+#define SEQ_STAMPS (64)
+
+// Release error histogram: 250 nsec bins up to 512 usec, and one more bin
+// for anything later (the exact maximum is kept separately).
+#define SEQ_JITTER_BIN_NSEC (250)
+#define SEQ_JITTER_BINS (2048+1)
+
+typedef enum
+{
+    SEQ_ABSOLUTE,       // clock_nanosleep() to release k at epoch + k periods
+    SEQ_RELATIVE,       // original nanosleep() of one period per tick
+    SEQ_TIMERFD         // blocking read() of a periodic timerfd
+} seq_backend_t;
+
+typedef enum
+{
+    SEQ_SCHED_FIFO,     // service priorities, as registered
+    SEQ_SCHED_DEADLINE  // service runtime, deadline and period
+} seq_policy_t;
+
+typedef enum
+{
+    SEQ_WAKE_FUTEX,     // release events, batched per tick
+    SEQ_WAKE_SEMAPHORE  // sem_post() and sem_wait() per release
+} seq_wakeup_t;
+
+// What the sequencer does with a release of a service whose previous
+// release has not finished.  Either way the overrun is counted, and a
+// release that is not posted is counted skipped.
+typedef enum
+{
+    SEQ_OVERRUN_QUEUE,  // post it, up to queue_cap releases pending
+    SEQ_OVERRUN_SKIP,   // drop it, so the service never runs back to back
+    SEQ_OVERRUN_CALLBACK // ask the service's overrun callback, then as QUEUE or SKIP
+} seq_overrun_policy_t;
+
+typedef struct
+{
+    unsigned long long releases;
+    unsigned long long overruns;       // releases a whole period or more late
+    long long min_nsec, max_nsec;
+    long long sum_nsec;
+    unsigned long long bins[SEQ_JITTER_BINS];
+} seq_jitter_t;
+
+// Sequencer loop counters.  A wakeup normally releases one tick; when the
+// timerfd reports more than one expiration, the ticks missed in between are
+// released in the same wakeup, in order.  Overhead is from the wakeup to
+// the last post of that wakeup.
+typedef struct
+{
+    unsigned long long wakeups;
+    unsigned long long missed_ticks;
+    unsigned long long max_batch;      // most ticks released by one wakeup
+    unsigned long long overhead_sum_nsec, overhead_max_nsec;
+} seq_counters_t;
+
+// Per release timing of one service, all from CLOCK_MONOTONIC_RAW:
+//
+//      latency     release (sequencer posts it) to callback start
+//      exec        callback start to end, including any preemption, so an
+//                  upper estimate of the execution time
+//      response    release to callback end, a miss when past the deadline
+typedef struct
+{
+    seq_stat_t latency, exec, response;
+} seq_service_stats_t;
+
+// Overload counters, read with seq_read_overload() at any time.  For one
+// service, pending_max is the most of its releases ever outstanding (posted
+// and not finished, 1 when it always keeps up); for SEQ_ALL_SERVICES the
+// counts are summed and pending_max is the most releases outstanding over
+// all services at once.
+typedef struct
+{
+    unsigned long long overruns;       // releases made while one was unfinished
+    unsigned long long skipped;        // of those, releases not posted
+    unsigned long long misses;         // responses past the deadline
+    unsigned long long pending_max;
+} seq_overload_t;
+
+typedef struct sequencer sequencer_t;
+typedef struct seq_service seq_service_t;
+
+// Runs in the service thread for each release, numbered from 1.
+typedef void (*seq_callback_t)(seq_service_t *service, unsigned long long release);
+
+// Runs in the sequencer thread, at its priority, when a release finds the
+// service with pending releases still outstanding.  Returns TRUE to queue
+// the release (up to queue_cap) or FALSE to skip it.  It may degrade the
+// service through its arg or call seq_stop(), but must not block, as every
+// later release waits for it.
+typedef int (*seq_overrun_t)(seq_service_t *service, unsigned long long pending);
+
+struct seq_service
+{
+    const char *name;
+    unsigned int divisor;              // released every divisor ticks
+    int priority;                      // SCHED_FIFO priority
+    int affinity;                      // CPU, or SEQ_NO_AFFINITY
+    seq_callback_t callback;
+    void *arg;                         // for the callback, not used here
+    unsigned long long deadline_nsec;  // relative deadline, 0 for the period
+    unsigned long long runtime_nsec;   // SEQ_SCHED_DEADLINE budget per period
+    seq_overrun_policy_t overrun_policy;
+    unsigned int queue_cap;            // 1 to SEQ_STAMPS releases pending
+    seq_overrun_t overrun;             // SEQ_OVERRUN_CALLBACK only
+    unsigned long long spin_nsec;      // SEQ_WAKE_FUTEX wait polled before blocking
+
+    sequencer_t *seq;
+    evlog_ring_t *ring;                // this thread's event log, or NULL
+    seq_event_t event;                 // SEQ_WAKE_FUTEX
+    sem_t sem;                         // SEQ_WAKE_SEMAPHORE
+    pthread_t thread;
+    int admit_errno;                   // why the thread could not get its policy, or 0
+    unsigned long long releases;       // releases run
+    unsigned long long release_nsec[SEQ_STAMPS];  // of release due, at due % SEQ_STAMPS
+    seq_service_stats_t *stats;
+
+    // written by one thread each and read by any: completed and misses by
+    // the service, the rest by the sequencer
+    atomic_ullong due;                 // releases posted, after their stamps
+    atomic_ullong completed;           // releases finished
+    atomic_ullong misses;
+    atomic_ullong overruns, skipped, pending_max;
+};
+
+struct sequencer
+{
+    unsigned int rate_hz;
+    unsigned long long periods;        // ticks to run, 0 runs until seq_stop()
+    seq_backend_t backend;
+    seq_policy_t policy;               // of the service threads
+    seq_wakeup_t wakeup;               // how releases reach the service threads
+    long relative_delay_nsec;          // SEQ_RELATIVE sleep, one period by default
+    int priority;                      // sequencer thread, RT_MAX by default
+    int affinity;
+    evlog_t *log;                      // event log, or NULL; start it after seq_start()
+    evlog_ring_t *ring;
+
+    seq_service_t *services;
+    unsigned int num_services, max_services;
+
+    // release schedule: the services due at tick t of the hyperperiod are
+    // release_list[release_start[t]] .. release_list[release_start[t+1]-1]
+    unsigned int hyperperiod;
+    unsigned int *release_start;
+    unsigned int *release_list;
+    seq_event_t **released;            // one tick's release events, for seq_event_post_set()
+
+    volatile int abort;
+    int started;
+    sem_t ready;                       // posted by each service thread once set up
+    int timer_fd;                      // SEQ_TIMERFD only, else -1
+    pthread_t thread;
+    struct timeval start_time_val;
+    seq_jitter_t jitter;
+    seq_counters_t counters;
+    seq_service_stats_t *stats;        // one per service, from seq_start()
+
+    atomic_ullong pending;             // releases outstanding over all services
+    atomic_ullong pending_max;
+};
+
+// Sets up an empty sequencer running at rate_hz for the given number of
+// ticks.  Returns 0, or -1 if the rate is 0 or above 1 GHz.
+int seq_init(sequencer_t *seq, unsigned int rate_hz, unsigned long long periods);
+
+// Registers a service released every divisor ticks, the first time at tick
+// divisor, queuing up to SEQ_STAMPS releases when it overruns.  Returns its
+// index, or -1 if the arguments are bad or the sequencer has already
+// started.
+int seq_add_service(sequencer_t *seq, const char *name, unsigned int divisor, int priority, int affinity,
+                    seq_callback_t callback, void *arg);
+
+// Sets service index's SEQ_SCHED_DEADLINE runtime and relative deadline (0
+// for the period).  Returns 0, or -1 if the arguments are bad or the
+// sequencer has already started.  seq_start() checks that runtime <=
+// deadline <= period.
+int seq_set_budget(sequencer_t *seq, int index, unsigned long long runtime_nsec, unsigned long long deadline_nsec);
+
+// Sets how service index handles overruns: policy, the most releases it may
+// have pending under SEQ_OVERRUN_QUEUE or CALLBACK (1 to SEQ_STAMPS), and
+// the callback for SEQ_OVERRUN_CALLBACK.  Returns 0, or -1 if the arguments
+// are bad or the sequencer has already started.
+int seq_set_overrun(sequencer_t *seq, int index, seq_overrun_policy_t policy, unsigned int queue_cap,
+                    seq_overrun_t callback);
+
+// Sets how long service index polls for a release before blocking under
+// SEQ_WAKE_FUTEX, 0 to block at once (the default).  Only worth it for a
+// service with a CPU to itself.  Returns 0, or -1 if the index is bad or the
+// sequencer has already started.
+int seq_set_spin(sequencer_t *seq, int index, unsigned long long spin_nsec);
+
+// Builds the release schedule and the service statistics, then opens an event log ring per thread if
+// seq.log is set, creates the timerfd if needed, the service threads and
+// the sequencer thread.  Returns 0, or -1 (after
+// printing why) if the schedule is too long, memory runs out, the timer or
+// a thread cannot be created, the kernel refuses a SCHED_DEADLINE service
+// (admission control), or a pinned thread is found able to run on any CPU
+// but its own, in which case no threads are left running.
+int seq_start(sequencer_t *seq);
+
+// Makes the sequencer stop after the current tick.
+void seq_stop(sequencer_t *seq);
+
+// Waits for the sequencer to finish its ticks and every service thread to
+// finish its last release.
+void seq_join(sequencer_t *seq);
+
+// Copies the overload counters of service index, or of SEQ_ALL_SERVICES,
+// into overload.  Safe from any thread while the sequencer runs, though the
+// counters are read one at a time.  Returns 0, or -1 for a bad index.
+int seq_read_overload(sequencer_t *seq, int index, seq_overload_t *overload);
+
+// Prints the sequencer's release error and counters, then each service's
+// latency, execution and response time statistics, deadline misses and
+// overruns.
+void seq_print_stats(sequencer_t *seq);
+
+// Writes the services as a service set for the exercise2 feasibility tests
+// (feasibility_batch -i): one "0,period,wcet,deadline" line per service in
+// usec, the period and deadline rounded down and the observed worst case
+// execution time rounded up, so the set is never made to look easier than
+// what ran.  Returns 0, or -1 if the file cannot be written.
+int seq_write_wcet(sequencer_t *seq, const char *path);
+
+void seq_destroy(sequencer_t *seq);
+
+#endif